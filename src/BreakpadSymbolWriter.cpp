@@ -0,0 +1,162 @@
+#include "BreakpadSymbolWriter.h"
+
+#include "IncludeTable.h"
+#include "LineTable.h"
+#include "MachOReader.h"
+
+#include <LIEF/MachO.hpp>
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+struct VariantEntry
+{
+    uint64_t m_address = 0;
+    index_t m_functionIndex = InvalidIndex;
+    uint32_t m_variantIndex = 0;
+};
+} // namespace
+
+BreakpadSymbolWriter::BreakpadSymbolWriter(std::ostream &stream) : m_stream(stream)
+{
+    m_buffer.reserve(FlushSize + 4096);
+}
+
+bool BreakpadSymbolWriter::Write(MachOReader &reader, std::string_view moduleName)
+{
+    // Breakpad addresses are relative to the load address of the module.
+    const LIEF::MachO::SegmentCommand *textSegment = reader.GetBinary().get_segment("__TEXT");
+    const uint64_t baseAddress = textSegment != nullptr ? textSegment->virtual_address() : 0;
+
+    WriteModule(reader, moduleName);
+    WriteFiles(reader);
+    WriteFunctions(reader, baseAddress);
+    Flush();
+    m_stream.flush();
+    return m_stream.good();
+}
+
+void BreakpadSymbolWriter::WriteModule(const MachOReader &reader, std::string_view moduleName)
+{
+    const LIEF::MachO::Binary &binary = reader.GetBinary();
+    uint8_t identifier[16] = {};
+    if (binary.has_uuid())
+    {
+        const LIEF::MachO::uuid_t &uuid = binary.uuid()->uuid();
+        std::copy(uuid.begin(), uuid.end(), identifier);
+    }
+    else if (const LIEF::MachO::SegmentCommand *textSegment = binary.get_segment("__TEXT"))
+    {
+        // Old linkers write no LC_UUID. The code identifies the build instead.
+        const LIEF::span<const uint8_t> content = textSegment->content();
+        const XXH128_hash_t hash = XXH3_128bits(content.data(), content.size());
+        for (size_t i = 0; i < 8; ++i)
+        {
+            identifier[i] = static_cast<uint8_t>(hash.high64 >> (56 - 8 * i));
+            identifier[8 + i] = static_cast<uint8_t>(hash.low64 >> (56 - 8 * i));
+        }
+    }
+
+    // The debug identifier is the UUID followed by the age, which is always 0 on Mac.
+    Print("MODULE mac x86 ");
+    for (uint8_t byte : identifier)
+        Print("{:02X}", byte);
+    Print("0 {}\n", moduleName);
+}
+
+void BreakpadSymbolWriter::WriteFiles(const MachOReader &reader)
+{
+    const SourceFiles &sourceFiles = reader.GetSourceFiles();
+    const HeaderFiles &headerFiles = reader.GetHeaderFiles();
+    const index_t fileCount = static_cast<index_t>(std::max(sourceFiles.size(), headerFiles.size()));
+    for (index_t fileIndex = 0; fileIndex < fileCount; ++fileIndex)
+    {
+        if (fileIndex < sourceFiles.size())
+            Print("FILE {} {}\n", IncludeTable::MakeFileId(InvalidIndex, fileIndex), sourceFiles[fileIndex].m_name);
+        if (fileIndex < headerFiles.size())
+            Print("FILE {} {}\n", IncludeTable::MakeFileId(fileIndex, InvalidIndex), headerFiles[fileIndex].m_name);
+    }
+}
+
+void BreakpadSymbolWriter::WriteFunctions(MachOReader &reader, uint64_t baseAddress)
+{
+    const Functions &functions = reader.GetFunctions();
+    const LineTable &lineTable = reader.GetLineTable();
+
+    std::vector<VariantEntry> variants;
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const std::vector<FunctionVariant> &functionVariants = functions[functionIndex].m_variants;
+        const uint32_t variantCount = static_cast<uint32_t>(functionVariants.size());
+        for (uint32_t variantIndex = 0; variantIndex < variantCount; ++variantIndex)
+        {
+            if (functionVariants[variantIndex].m_size != 0)
+                variants.push_back({functionVariants[variantIndex].m_address, functionIndex, variantIndex});
+        }
+    }
+    std::sort(variants.begin(), variants.end(), [](const VariantEntry &variant1, const VariantEntry &variant2) {
+        return variant1.m_address < variant2.m_address;
+    });
+
+    uint64_t previousEnd = 0;
+    for (const VariantEntry &entry : variants)
+    {
+        const Function &function = functions[entry.m_functionIndex];
+        const FunctionVariant &variant = function.m_variants[entry.m_variantIndex];
+        if (variant.m_address < previousEnd || variant.m_address < baseAddress)
+            continue; // Breakpad does not allow overlapping functions.
+        previousEnd = variant.m_address + variant.m_size;
+
+        const std::string &name = function.m_name.empty() ? variant.m_mangledName : function.m_name;
+        Print("FUNC {:x} {:x} 0 {}\n", variant.m_address - baseAddress, variant.m_size, name);
+
+        if (variant.m_lineRangeIndex == InvalidIndex)
+            continue;
+
+        // A line covers the code up to the next line or the end of the function.
+        const LineTable::Range &range = lineTable.GetRange(variant.m_lineRangeIndex);
+        for (uint32_t rowIndex = 0; rowIndex < range.m_rowCount; ++rowIndex)
+        {
+            const LineTableRow row = lineTable.GetRow(variant.m_lineRangeIndex, rowIndex);
+            const uint64_t rowEnd = rowIndex + 1 < range.m_rowCount
+                ? lineTable.GetRow(variant.m_lineRangeIndex, rowIndex + 1).m_address
+                : range.m_address + range.m_size;
+            if (rowEnd <= row.m_address)
+                continue;
+
+            index_t sourceFileIndex = row.m_sourceFileIndex;
+            if (row.m_headerFileIndex == InvalidIndex && sourceFileIndex == InvalidIndex)
+                sourceFileIndex = function.m_sourceFileIndex;
+            if (row.m_headerFileIndex == InvalidIndex && sourceFileIndex == InvalidIndex)
+                continue;
+
+            Print(
+                "{:x} {:x} {} {}\n",
+                row.m_address - baseAddress,
+                rowEnd - row.m_address,
+                row.m_line,
+                IncludeTable::MakeFileId(row.m_headerFileIndex, sourceFileIndex));
+        }
+    }
+}
+
+template<typename... Args>
+void BreakpadSymbolWriter::Print(fmt::format_string<Args...> format, Args &&...args)
+{
+    fmt::format_to(std::back_inserter(m_buffer), format, std::forward<Args>(args)...);
+    if (m_buffer.size() >= FlushSize)
+        Flush();
+}
+
+void BreakpadSymbolWriter::Flush()
+{
+    m_stream.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
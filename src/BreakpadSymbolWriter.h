@@ -0,0 +1,39 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <fmt/format.h>
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+class MachOReader;
+
+// Writes a Breakpad symbol file (.sym) for crash report symbolication. Emits the MODULE record, one FILE record per
+// source and header file, and one FUNC record per function variant with its line records. File numbers are the
+// IncludeTable file ids, so they come straight from the source and header file indices. Function variants are written
+// in address order, and the text is formatted into one large buffer that is written to the stream whenever it fills.
+class BreakpadSymbolWriter
+{
+public:
+    explicit BreakpadSymbolWriter(std::ostream &stream);
+
+    // Demangles all functions first in lazy demangling mode. Returns false if the stream failed.
+    bool Write(MachOReader &reader, std::string_view moduleName);
+
+private:
+    void WriteModule(const MachOReader &reader, std::string_view moduleName);
+    void WriteFiles(const MachOReader &reader);
+    void WriteFunctions(MachOReader &reader, uint64_t baseAddress);
+
+    template<typename... Args>
+    void Print(fmt::format_string<Args...> format, Args &&...args);
+    void Flush();
+
+private:
+    static constexpr size_t FlushSize = 1 << 20;
+
+    std::ostream &m_stream;
+    fmt::memory_buffer m_buffer;
+};
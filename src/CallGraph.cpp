@@ -0,0 +1,225 @@
+#include "CallGraph.h"
+
+#include "FunctionCode.h"
+#include "LineTable.h"
+#include "ThreadPool.h"
+
+#include <LIEF/MachO.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+constexpr uint8_t CallRel32 = 0xe8;
+constexpr uint8_t JmpRel32 = 0xe9;
+constexpr uint32_t Rel32InstructionSize = 5;
+constexpr uint32_t MaxThunkSize = 13; // add dword [esp+4], imm32 and jmp rel32.
+
+struct ThunkTarget
+{
+    uint64_t m_address = 0; // Thunk address.
+    index_t m_functionIndex = InvalidIndex;
+};
+
+uint64_t GetRel32Target(uint64_t address, const uint8_t *data, uint32_t offset)
+{
+    const int32_t displacement = static_cast<int32_t>(FunctionCode::ReadUInt32(data + offset + 1));
+    return address + offset + Rel32InstructionSize + displacement;
+}
+
+// Returns the function that begins at the address.
+index_t FindFunctionAt(const LineTable &lineTable, uint64_t address)
+{
+    const index_t rangeIndex = lineTable.FindRange(address);
+    if (rangeIndex == InvalidIndex)
+        return InvalidIndex;
+
+    const LineTable::Range &range = lineTable.GetRange(rangeIndex);
+    return range.m_address == address ? range.m_functionIndex : InvalidIndex;
+}
+
+// Non-virtual thunks adjust the this pointer on the stack and jump to the function.
+index_t FindThunkFunction(const LIEF::MachO::Binary &binary, const LineTable &lineTable, uint64_t address)
+{
+    auto data = binary.get_content_from_virtual_address(address, MaxThunkSize);
+    const uint8_t *code = data.data();
+    const size_t size = data.size();
+
+    uint32_t offset = 0;
+    if (size >= 5 && code[0] == 0x83 && code[1] == 0x44 && code[2] == 0x24 && code[3] == 0x04)
+    {
+        offset = 5; // add dword [esp+4], imm8
+    }
+    else if (size >= 8 && code[0] == 0x81 && code[1] == 0x44 && code[2] == 0x24 && code[3] == 0x04)
+    {
+        offset = 8; // add dword [esp+4], imm32
+    }
+    else
+    {
+        return InvalidIndex;
+    }
+
+    if (offset + Rel32InstructionSize > size || code[offset] != JmpRel32)
+        return InvalidIndex;
+
+    return FindFunctionAt(lineTable, GetRel32Target(address, code, offset));
+}
+} // namespace
+
+void CallGraph::Build(
+    const LIEF::MachO::Binary &binary,
+    const FunctionCode &functionCode,
+    index_t functionCount,
+    const NonVirtualThunks &thunks,
+    const LineTable &lineTable,
+    ThreadPool &threadPool)
+{
+    const tcb::span<const FunctionCode::Variant> variants = functionCode.GetVariants();
+
+    std::vector<ThunkTarget> thunkTargets;
+    for (const NonVirtualThunk &thunk : thunks)
+    {
+        ThunkTarget thunkTarget;
+        thunkTarget.m_address = thunk.m_address;
+        thunkTarget.m_functionIndex = FindThunkFunction(binary, lineTable, thunk.m_address);
+        if (thunkTarget.m_functionIndex != InvalidIndex)
+            thunkTargets.push_back(thunkTarget);
+    }
+    std::sort(thunkTargets.begin(), thunkTargets.end(), [](const ThunkTarget &target1, const ThunkTarget &target2) {
+        return target1.m_address < target2.m_address;
+    });
+
+    auto resolveTarget = [&](uint64_t address) {
+        const index_t functionIndex = FindFunctionAt(lineTable, address);
+        if (functionIndex != InvalidIndex)
+            return functionIndex;
+
+        auto it = std::lower_bound(
+            thunkTargets.begin(),
+            thunkTargets.end(),
+            address,
+            [](const ThunkTarget &target, uint64_t value) { return target.m_address < value; });
+        return it != thunkTargets.end() && it->m_address == address ? it->m_functionIndex : InvalidIndex;
+    };
+
+    // Every chunk collects sorted unique (caller, callee) pairs of a contiguous variant range.
+    std::vector<std::vector<uint64_t>> chunkPairs;
+    {
+        const size_t variantCount = variants.size();
+        const size_t chunkCount =
+            std::max<size_t>(std::min<size_t>(threadPool.GetThreadCount() * 4, variantCount), 1);
+        const size_t chunkSize = (variantCount + chunkCount - 1) / chunkCount;
+        chunkPairs.resize(chunkCount);
+        threadPool.ParallelFor(chunkCount, [&](size_t chunkIndex) {
+            const size_t variantBegin = std::min(chunkIndex * chunkSize, variantCount);
+            const size_t variantEnd = std::min(variantBegin + chunkSize, variantCount);
+            std::vector<uint64_t> &pairs = chunkPairs[chunkIndex];
+
+            for (size_t variantIndex = variantBegin; variantIndex < variantEnd; ++variantIndex)
+            {
+                const FunctionCode::Variant &variant = variants[variantIndex];
+                if (variant.m_size < Rel32InstructionSize)
+                    continue;
+
+                const uint8_t *code = variant.m_data;
+                const uint32_t end = variant.m_size - Rel32InstructionSize + 1;
+                for (uint32_t i = 0; i < end; ++i)
+                {
+                    if (code[i] != CallRel32 && code[i] != JmpRel32)
+                        continue;
+
+                    const index_t calleeIndex = resolveTarget(GetRel32Target(variant.m_address, code, i));
+                    if (calleeIndex == InvalidIndex)
+                        continue;
+
+                    // A jump to the own begin is a loop, not a call.
+                    if (code[i] == JmpRel32 && calleeIndex == variant.m_functionIndex)
+                        continue;
+
+                    pairs.push_back((uint64_t(variant.m_functionIndex) << 32) | calleeIndex);
+                    i += Rel32InstructionSize - 1;
+                }
+            }
+            std::sort(pairs.begin(), pairs.end());
+            pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        });
+    }
+
+    // Chunks cover ascending functions, but one function can span two chunks.
+    std::vector<uint64_t> pairs;
+    for (const std::vector<uint64_t> &chunk : chunkPairs)
+    {
+        pairs.insert(pairs.end(), chunk.begin(), chunk.end());
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    m_calleeOffsets.assign(functionCount + 1, 0);
+    m_callerOffsets.assign(functionCount + 1, 0);
+    m_callees.resize(pairs.size());
+    m_callers.resize(pairs.size());
+    for (size_t pairIndex = 0; pairIndex < pairs.size(); ++pairIndex)
+    {
+        const index_t callerIndex = static_cast<index_t>(pairs[pairIndex] >> 32);
+        const index_t calleeIndex = static_cast<index_t>(pairs[pairIndex]);
+        ++m_calleeOffsets[callerIndex + 1];
+        ++m_callerOffsets[calleeIndex + 1];
+        m_callees[pairIndex] = calleeIndex;
+    }
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        m_calleeOffsets[functionIndex + 1] += m_calleeOffsets[functionIndex];
+        m_callerOffsets[functionIndex + 1] += m_callerOffsets[functionIndex];
+    }
+
+    // Pairs are ordered by caller, so scattering them keeps every caller list sorted.
+    std::vector<uint32_t> cursors(m_callerOffsets.begin(), m_callerOffsets.end() - 1);
+    for (uint64_t pair : pairs)
+    {
+        const index_t calleeIndex = static_cast<index_t>(pair);
+        m_callers[cursors[calleeIndex]++] = static_cast<index_t>(pair >> 32);
+    }
+}
+
+tcb::span<const index_t> CallGraph::GetCallees(index_t functionIndex) const
+{
+    assert(functionIndex < GetFunctionCount());
+    const uint32_t begin = m_calleeOffsets[functionIndex];
+    return tcb::span<const index_t>(m_callees.data() + begin, m_calleeOffsets[functionIndex + 1] - begin);
+}
+
+tcb::span<const index_t> CallGraph::GetCallers(index_t functionIndex) const
+{
+    assert(functionIndex < GetFunctionCount());
+    const uint32_t begin = m_callerOffsets[functionIndex];
+    return tcb::span<const index_t>(m_callers.data() + begin, m_callerOffsets[functionIndex + 1] - begin);
+}
+
+void CallGraph::GetTransitiveCallers(index_t functionIndex, std::vector<index_t> &callerIndices) const
+{
+    callerIndices.clear();
+    std::vector<bool> visited(GetFunctionCount(), false);
+    std::vector<index_t> stack = {functionIndex};
+    while (!stack.empty())
+    {
+        const index_t calleeIndex = stack.back();
+        stack.pop_back();
+        for (index_t callerIndex : GetCallers(calleeIndex))
+        {
+            if (visited[callerIndex])
+                continue;
+
+            visited[callerIndex] = true;
+            callerIndices.push_back(callerIndex);
+            stack.push_back(callerIndex);
+        }
+    }
+    std::sort(callerIndices.begin(), callerIndices.end());
+}
+
+size_t CallGraph::GetMemoryUsage() const
+{
+    return m_calleeOffsets.capacity() * sizeof(uint32_t) + m_callees.capacity() * sizeof(index_t)
+        + m_callerOffsets.capacity() * sizeof(uint32_t) + m_callers.capacity() * sizeof(index_t);
+}
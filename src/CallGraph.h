@@ -0,0 +1,54 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+namespace LIEF::MachO
+{
+class Binary;
+} // namespace LIEF::MachO
+
+class FunctionCode;
+class LineTable;
+class ThreadPool;
+
+// Static call graph between functions, from the direct call rel32 and jmp rel32 instructions in the code of all
+// function variants. The code is not disassembled. Every E8 and E9 byte is taken as an instruction whose target must
+// be the exact begin of a function variant or of a non-virtual thunk, which filters out nearly all false decodes as
+// well as jumps within a function. Calls to thunks are resolved to the function the thunk jumps to. Calls to imported
+// functions go through stubs and are not in the graph. Callees and callers are stored in compressed sparse row form.
+class CallGraph
+{
+public:
+    // Scans the variant code in parallel chunks.
+    void Build(
+        const LIEF::MachO::Binary &binary,
+        const FunctionCode &functionCode,
+        index_t functionCount,
+        const NonVirtualThunks &thunks,
+        const LineTable &lineTable,
+        ThreadPool &threadPool);
+
+    index_t GetFunctionCount() const { return static_cast<index_t>(m_calleeOffsets.size() - 1); }
+    index_t GetEdgeCount() const { return static_cast<index_t>(m_callees.size()); }
+
+    // Distinct functions called by the function, ascending. Includes the function itself if it recurses.
+    tcb::span<const index_t> GetCallees(index_t functionIndex) const;
+    // Distinct functions that call the function, ascending.
+    tcb::span<const index_t> GetCallers(index_t functionIndex) const;
+
+    // Functions that reach the function through any chain of calls, ascending. Excludes the function itself unless it
+    // is part of a cycle.
+    void GetTransitiveCallers(index_t functionIndex, std::vector<index_t> &callerIndices) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint32_t> m_calleeOffsets = {0}; // Offsets into m_callees, one more than functions.
+    std::vector<index_t> m_callees;
+    std::vector<uint32_t> m_callerOffsets = {0}; // Offsets into m_callers, one more than functions.
+    std::vector<index_t> m_callers;
+};
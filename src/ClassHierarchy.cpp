@@ -0,0 +1,274 @@
+#include "ClassHierarchy.h"
+
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+index_t CountTrailingZeros(uint64_t value)
+{
+    assert(value != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<index_t>(index);
+#else
+    return static_cast<index_t>(__builtin_ctzll(value));
+#endif
+}
+} // namespace
+
+void ClassHierarchy::Build(const Classes &classes)
+{
+    BuildForest(classes);
+    BuildClosures(classes);
+
+    m_baseOffsets.clear();
+    const index_t classCount = classes.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        for (const BaseClass &baseClass : classes[classIndex].m_allBaseClasses)
+        {
+            m_baseOffsets.emplace(MakeKey(classIndex, baseClass.m_classIndex), baseClass.m_baseOffset);
+        }
+    }
+}
+
+bool ClassHierarchy::IsDerivedFrom(index_t classIndex, index_t baseClassIndex) const
+{
+    if (classIndex == baseClassIndex)
+        return false;
+
+    const uint64_t *row = GetClosureRow(classIndex);
+    if (row != nullptr)
+        return (row[baseClassIndex / 64] >> (baseClassIndex % 64)) & 1;
+
+    return IsTreeDescendant(classIndex, baseClassIndex);
+}
+
+bool ClassHierarchy::GetBaseOffset(index_t classIndex, index_t baseClassIndex, uint16_t &baseOffset) const
+{
+    std::unordered_map<uint64_t, uint16_t>::const_iterator it = m_baseOffsets.find(MakeKey(classIndex, baseClassIndex));
+    if (it == m_baseOffsets.end())
+        return false;
+
+    baseOffset = it->second;
+    return true;
+}
+
+void ClassHierarchy::GetDerivedClasses(index_t baseClassIndex, std::vector<index_t> &derivedClassIndices) const
+{
+    derivedClassIndices.clear();
+    ForEachDerivedClass(baseClassIndex, [&](index_t classIndex) { derivedClassIndices.push_back(classIndex); });
+    std::sort(derivedClassIndices.begin(), derivedClassIndices.end());
+}
+
+void ClassHierarchy::GetCommonBaseClasses(
+    index_t classIndex1,
+    index_t classIndex2,
+    std::vector<index_t> &baseClassIndices) const
+{
+    baseClassIndices.clear();
+
+    const uint64_t *row1 = GetClosureRow(classIndex1);
+    const uint64_t *row2 = GetClosureRow(classIndex2);
+    if (row1 != nullptr && row2 != nullptr)
+    {
+        for (size_t word = 0; word < m_closureRowWords; ++word)
+        {
+            uint64_t bits = row1[word] & row2[word];
+            while (bits != 0)
+            {
+                const index_t bit = CountTrailingZeros(bits);
+                baseClassIndices.push_back(static_cast<index_t>(word * 64 + bit));
+                bits &= bits - 1;
+            }
+        }
+        return;
+    }
+
+    // One class has single inheritance only, so its base classes are its tree ancestors.
+    const index_t classIndex = row1 == nullptr ? classIndex1 : classIndex2;
+    const index_t otherClassIndex = row1 == nullptr ? classIndex2 : classIndex1;
+    for (index_t baseClassIndex = m_treeParents[classIndex]; baseClassIndex != InvalidIndex;
+         baseClassIndex = m_treeParents[baseClassIndex])
+    {
+        if (IsDerivedFrom(otherClassIndex, baseClassIndex))
+            baseClassIndices.push_back(baseClassIndex);
+    }
+    std::sort(baseClassIndices.begin(), baseClassIndices.end());
+}
+
+size_t ClassHierarchy::GetMemoryUsage() const
+{
+    return m_treeParents.capacity() * sizeof(index_t) + m_preorderIndices.capacity() * sizeof(uint32_t)
+        + m_subtreeEnds.capacity() * sizeof(uint32_t) + m_preorder.capacity() * sizeof(index_t)
+        + m_closureRowIndices.capacity() * sizeof(index_t) + m_closureBits.capacity() * sizeof(uint64_t)
+        + m_extraDerivedOffsets.capacity() * sizeof(uint32_t)
+        + m_extraDerivedClassIndices.capacity() * sizeof(index_t)
+        + m_baseOffsets.size() * (sizeof(uint64_t) + sizeof(uint16_t) + 2 * sizeof(void *));
+}
+
+bool ClassHierarchy::IsTreeDescendant(index_t classIndex, index_t ancestorClassIndex) const
+{
+    const uint32_t preorderIndex = m_preorderIndices[classIndex];
+    return preorderIndex > m_preorderIndices[ancestorClassIndex] && preorderIndex < m_subtreeEnds[ancestorClassIndex];
+}
+
+void ClassHierarchy::BuildForest(const Classes &classes)
+{
+    const index_t classCount = classes.size();
+
+    m_treeParents.assign(classCount, InvalidIndex);
+    std::vector<uint32_t> childOffsets(classCount + 1, 0);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const std::vector<BaseClass> &directBaseClasses = classes[classIndex].m_directBaseClasses;
+        if (!directBaseClasses.empty() && !directBaseClasses.front().m_isVirtual)
+        {
+            m_treeParents[classIndex] = directBaseClasses.front().m_classIndex;
+            ++childOffsets[m_treeParents[classIndex] + 1];
+        }
+    }
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        childOffsets[classIndex + 1] += childOffsets[classIndex];
+    }
+
+    std::vector<index_t> children(childOffsets.back());
+    std::vector<uint32_t> childCursors(childOffsets.begin(), childOffsets.end() - 1);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        if (m_treeParents[classIndex] != InvalidIndex)
+            children[childCursors[m_treeParents[classIndex]]++] = classIndex;
+    }
+
+    // Iterative DFS from every root, so deep hierarchies do not exhaust the stack.
+    m_preorderIndices.assign(classCount, 0);
+    m_subtreeEnds.assign(classCount, 0);
+    m_preorder.clear();
+    m_preorder.reserve(classCount);
+
+    struct StackEntry
+    {
+        index_t m_classIndex;
+        uint32_t m_childOffset;
+    };
+    std::vector<StackEntry> stack;
+    for (index_t rootClassIndex = 0; rootClassIndex < classCount; ++rootClassIndex)
+    {
+        if (m_treeParents[rootClassIndex] != InvalidIndex)
+            continue;
+
+        m_preorderIndices[rootClassIndex] = static_cast<uint32_t>(m_preorder.size());
+        m_preorder.push_back(rootClassIndex);
+        stack.push_back({rootClassIndex, childOffsets[rootClassIndex]});
+        while (!stack.empty())
+        {
+            StackEntry &entry = stack.back();
+            if (entry.m_childOffset == childOffsets[entry.m_classIndex + 1])
+            {
+                m_subtreeEnds[entry.m_classIndex] = static_cast<uint32_t>(m_preorder.size());
+                stack.pop_back();
+                continue;
+            }
+
+            const index_t childClassIndex = children[entry.m_childOffset++];
+            m_preorderIndices[childClassIndex] = static_cast<uint32_t>(m_preorder.size());
+            m_preorder.push_back(childClassIndex);
+            stack.push_back({childClassIndex, childOffsets[childClassIndex]});
+        }
+    }
+
+    // Base class links are acyclic, so every class is reached from a root.
+    assert(m_preorder.size() == classCount);
+}
+
+void ClassHierarchy::BuildClosures(const Classes &classes)
+{
+    const index_t classCount = classes.size();
+
+    // A class needs a closure row if its base classes are not all on its tree path. Parents come first in preorder.
+    m_closureRowIndices.assign(classCount, InvalidIndex);
+    index_t closureRowCount = 0;
+    for (index_t classIndex : m_preorder)
+    {
+        const std::vector<BaseClass> &directBaseClasses = classes[classIndex].m_directBaseClasses;
+        const index_t parentClassIndex = m_treeParents[classIndex];
+        const bool isComplex = directBaseClasses.size() > 1
+            || (directBaseClasses.size() == 1 && directBaseClasses.front().m_isVirtual)
+            || (parentClassIndex != InvalidIndex && m_closureRowIndices[parentClassIndex] != InvalidIndex);
+        if (isComplex)
+            m_closureRowIndices[classIndex] = closureRowCount++;
+    }
+
+    m_closureRowWords = (static_cast<size_t>(classCount) + 63) / 64;
+    m_closureBits.assign(closureRowCount * m_closureRowWords, 0);
+
+    // Derived classes outside the subtree of a base class are listed per base class.
+    std::vector<uint32_t> extraDerivedCounts(classCount, 0);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const index_t rowIndex = m_closureRowIndices[classIndex];
+        if (rowIndex == InvalidIndex)
+            continue;
+
+        uint64_t *row = m_closureBits.data() + rowIndex * m_closureRowWords;
+        for (const BaseClass &baseClass : classes[classIndex].m_allBaseClasses)
+        {
+            const index_t baseClassIndex = baseClass.m_classIndex;
+            uint64_t &word = row[baseClassIndex / 64];
+            const uint64_t mask = uint64_t(1) << (baseClassIndex % 64);
+            if (word & mask)
+                continue;
+
+            word |= mask;
+            if (!IsTreeDescendant(classIndex, baseClassIndex))
+                ++extraDerivedCounts[baseClassIndex];
+        }
+    }
+
+    m_extraDerivedOffsets.assign(classCount + 1, 0);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        m_extraDerivedOffsets[classIndex + 1] = m_extraDerivedOffsets[classIndex] + extraDerivedCounts[classIndex];
+    }
+
+    m_extraDerivedClassIndices.resize(m_extraDerivedOffsets.back());
+    std::vector<uint32_t> cursors(m_extraDerivedOffsets.begin(), m_extraDerivedOffsets.end() - 1);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const uint64_t *row = GetClosureRow(classIndex);
+        if (row == nullptr)
+            continue;
+
+        for (size_t word = 0; word < m_closureRowWords; ++word)
+        {
+            uint64_t bits = row[word];
+            while (bits != 0)
+            {
+                const index_t baseClassIndex = static_cast<index_t>(word * 64 + CountTrailingZeros(bits));
+                bits &= bits - 1;
+                if (!IsTreeDescendant(classIndex, baseClassIndex))
+                    m_extraDerivedClassIndices[cursors[baseClassIndex]++] = classIndex;
+            }
+        }
+    }
+}
+
+const uint64_t *ClassHierarchy::GetClosureRow(index_t classIndex) const
+{
+    const index_t rowIndex = m_closureRowIndices[classIndex];
+    if (rowIndex == InvalidIndex)
+        return nullptr;
+    return m_closureBits.data() + static_cast<size_t>(rowIndex) * m_closureRowWords;
+}
+
+uint64_t ClassHierarchy::MakeKey(index_t classIndex, index_t baseClassIndex)
+{
+    return (uint64_t(classIndex) << 32) | baseClassIndex;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Subtype queries over all classes. Build after the base class links.
+// Every class is placed in a forest by its first non-virtual direct base class and labeled with a DFS interval, so
+// single inheritance chains are answered by two comparisons. Classes with several or virtual base classes anywhere in
+// their hierarchy additionally keep a packed bitset of all their base classes.
+class ClassHierarchy
+{
+public:
+    void Build(const Classes &classes);
+
+    // Returns true if baseClassIndex is a direct or indirect base class of classIndex. A class is not derived from
+    // itself.
+    bool IsDerivedFrom(index_t classIndex, index_t baseClassIndex) const;
+
+    // Gets the offset of the base class in the class. Repeated non-virtual base classes return the offset of the first
+    // one in Class::m_allBaseClasses. Returns false if it is not a base class.
+    bool GetBaseOffset(index_t classIndex, index_t baseClassIndex, uint16_t &baseOffset) const;
+
+    // Calls callback(derivedClassIndex) for every class that is derived from the class.
+    template<typename Callback>
+    void ForEachDerivedClass(index_t baseClassIndex, Callback &&callback) const;
+    void GetDerivedClasses(index_t baseClassIndex, std::vector<index_t> &derivedClassIndices) const;
+
+    // Gets the classes that are base classes of both classes, ascending.
+    void GetCommonBaseClasses(index_t classIndex1, index_t classIndex2, std::vector<index_t> &baseClassIndices) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    bool IsTreeDescendant(index_t classIndex, index_t ancestorClassIndex) const;
+    void BuildForest(const Classes &classes);
+    void BuildClosures(const Classes &classes);
+    const uint64_t *GetClosureRow(index_t classIndex) const;
+    static uint64_t MakeKey(index_t classIndex, index_t baseClassIndex);
+
+private:
+    std::vector<index_t> m_treeParents; // First non-virtual direct base class, if any.
+    std::vector<uint32_t> m_preorderIndices; // By class index.
+    std::vector<uint32_t> m_subtreeEnds; // Exclusive preorder end of the subtree, by class index.
+    std::vector<index_t> m_preorder; // Class indices in DFS preorder.
+
+    // Transitive closure of classes with several or virtual base classes in their hierarchy.
+    size_t m_closureRowWords = 0;
+    std::vector<index_t> m_closureRowIndices; // By class index. InvalidIndex for single inheritance.
+    std::vector<uint64_t> m_closureBits;
+
+    // Derived classes that are only reachable through the closure, in compressed sparse row form.
+    std::vector<uint32_t> m_extraDerivedOffsets;
+    std::vector<index_t> m_extraDerivedClassIndices;
+
+    std::unordered_map<uint64_t, uint16_t> m_baseOffsets;
+};
+
+template<typename Callback>
+void ClassHierarchy::ForEachDerivedClass(index_t baseClassIndex, Callback &&callback) const
+{
+    const uint32_t begin = m_preorderIndices[baseClassIndex] + 1;
+    const uint32_t end = m_subtreeEnds[baseClassIndex];
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        callback(m_preorder[i]);
+    }
+
+    for (uint32_t i = m_extraDerivedOffsets[baseClassIndex]; i < m_extraDerivedOffsets[baseClassIndex + 1]; ++i)
+    {
+        callback(m_extraDerivedClassIndices[i]);
+    }
+}
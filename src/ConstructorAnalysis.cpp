@@ -0,0 +1,283 @@
+#include "ConstructorAnalysis.h"
+
+#include "FunctionCode.h"
+#include "ThreadPool.h"
+#include "VTableAddressIndex.h"
+#include "X86ValueTracker.h"
+
+#include <LIEF/MachO.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <unordered_set>
+
+namespace
+{
+constexpr uint64_t EmptySlot = ~uint64_t(0);
+
+struct ConstructorAddress
+{
+    uint64_t m_address = 0; // Variant address.
+    index_t m_classIndex = InvalidIndex;
+};
+
+bool IsOperatorNew(const std::string &name)
+{
+    // operator new(size_t) and operator new(size_t, std::nothrow_t const&), with size_t as unsigned long or int.
+    return name == "__Znwm" || name == "__Znwj" || name == "__ZnwmRKSt9nothrow_t" || name == "__ZnwjRKSt9nothrow_t";
+}
+
+bool IsStubSection(const std::string &name)
+{
+    return name == "__jump_table" || name == "__symbol_stub" || name == "__symbol_stub1" || name == "__picsymbol_stub"
+        || name == "__stubs";
+}
+
+// Finds operator new in the binary, and the stubs that jump to it through the indirect symbol table.
+void CollectOperatorNewAddresses(const LIEF::MachO::Binary &binary, std::vector<uint64_t> &addresses)
+{
+    addresses.clear();
+    std::unordered_set<uint32_t> symbolIndices;
+    uint32_t symbolIndex = 0;
+    for (const LIEF::MachO::Symbol &symbol : binary.symbols())
+    {
+        if (IsOperatorNew(symbol.name()))
+        {
+            symbolIndices.insert(symbolIndex);
+            if (symbol.value() != 0)
+                addresses.push_back(symbol.value());
+        }
+        ++symbolIndex;
+    }
+
+    const LIEF::MachO::DynamicSymbolCommand *dynamicSymbolCommand = binary.dynamic_symbol_command();
+    if (!symbolIndices.empty() && dynamicSymbolCommand != nullptr)
+    {
+        const uint32_t indirectSymbolCount = dynamicSymbolCommand->nb_indirect_symbols();
+        const uint64_t indirectSymbolAddress =
+            binary.offset_to_virtual_address(dynamicSymbolCommand->indirect_symbol_offset()).value();
+        const LIEF::span<const uint8_t> span =
+            binary.get_content_from_virtual_address(indirectSymbolAddress, indirectSymbolCount * sizeof(uint32_t));
+        const uint32_t *indirectSymbols = reinterpret_cast<const uint32_t *>(span.data());
+        const uint32_t availableCount = static_cast<uint32_t>(span.size() / sizeof(uint32_t));
+
+        for (const LIEF::MachO::Section &section : binary.sections())
+        {
+            const uint32_t stubSize = section.reserved2();
+            if (!IsStubSection(section.name()) || stubSize == 0)
+                continue;
+
+            const uint64_t stubCount = section.size() / stubSize;
+            for (uint64_t stubIndex = 0; stubIndex < stubCount; ++stubIndex)
+            {
+                const uint64_t indirectIndex = section.reserved1() + stubIndex;
+                if (indirectIndex < availableCount && symbolIndices.count(indirectSymbols[indirectIndex]) != 0)
+                    addresses.push_back(section.virtual_address() + stubIndex * stubSize);
+            }
+        }
+    }
+
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+}
+
+// Keeps the smallest value in the slot. The lowest function index wins independent of the thread order.
+void StoreMinimum(std::atomic<uint64_t> &slot, uint64_t value)
+{
+    uint64_t current = slot.load(std::memory_order_relaxed);
+    while (value < current && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+bool IsDestructor(const Function &function)
+{
+    return function.m_functionBaseName.find('~') != std::string::npos;
+}
+
+// Keeps one store per object offset: the last one of a constructor, which runs after the base class constructors, and
+// the first one of a destructor, which runs before the base class destructors.
+void ReduceVTableStores(std::vector<ConstructorAnalysis::VTableStore> &stores, bool isDestructor)
+{
+    if (!isDestructor)
+        std::reverse(stores.begin(), stores.end());
+
+    std::stable_sort(
+        stores.begin(),
+        stores.end(),
+        [](const ConstructorAnalysis::VTableStore &store1, const ConstructorAnalysis::VTableStore &store2) {
+            return store1.m_objectOffset < store2.m_objectOffset;
+        });
+    stores.erase(
+        std::unique(
+            stores.begin(),
+            stores.end(),
+            [](const ConstructorAnalysis::VTableStore &store1, const ConstructorAnalysis::VTableStore &store2) {
+                return store1.m_objectOffset == store2.m_objectOffset;
+            }),
+        stores.end());
+}
+} // namespace
+
+void ConstructorAnalysis::Build(
+    const LIEF::MachO::Binary &binary,
+    const FunctionCode &functionCode,
+    const VTableAddressIndex &vtableAddressIndex,
+    const Functions &functions,
+    index_t classCount,
+    ThreadPool &threadPool)
+{
+    std::vector<uint64_t> operatorNewAddresses;
+    CollectOperatorNewAddresses(binary, operatorNewAddresses);
+
+    // Entry points of the constructors of all classes.
+    std::vector<ConstructorAddress> constructorAddresses;
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const Function &function = functions[functionIndex];
+        if (!function.m_isCtorOrDtor || function.m_parentClassIndex == InvalidIndex || IsDestructor(function))
+            continue;
+
+        for (const FunctionVariant &variant : function.m_variants)
+        {
+            constructorAddresses.push_back({variant.m_address, function.m_parentClassIndex});
+        }
+    }
+    std::sort(
+        constructorAddresses.begin(),
+        constructorAddresses.end(),
+        [](const ConstructorAddress &address1, const ConstructorAddress &address2) {
+            return address1.m_address < address2.m_address;
+        });
+
+    auto findConstructorClass = [&constructorAddresses](uint64_t address) {
+        auto it = std::lower_bound(
+            constructorAddresses.begin(),
+            constructorAddresses.end(),
+            address,
+            [](const ConstructorAddress &constructorAddress, uint64_t value) {
+                return constructorAddress.m_address < value;
+            });
+        return it != constructorAddresses.end() && it->m_address == address ? it->m_classIndex : InvalidIndex;
+    };
+
+    // Result slots hold function index << 32 | payload. Vtable slots prefer constructors over destructors.
+    std::unique_ptr<std::atomic<uint64_t>[]> vtableSlots = std::make_unique<std::atomic<uint64_t>[]>(classCount);
+    std::unique_ptr<std::atomic<uint64_t>[]> sizeSlots = std::make_unique<std::atomic<uint64_t>[]>(classCount);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        vtableSlots[classIndex].store(EmptySlot, std::memory_order_relaxed);
+        sizeSlots[classIndex].store(EmptySlot, std::memory_order_relaxed);
+    }
+    std::vector<std::vector<VTableStore>> functionStores(functionCount);
+
+    {
+        threadPool.ParallelFor(functionCount, [&](size_t functionIndex) {
+            const Function &function = functions[functionIndex];
+            const bool isStructor = function.m_isCtorOrDtor && function.m_parentClassIndex != InvalidIndex;
+            const bool isDestructor = isStructor && IsDestructor(function);
+            std::vector<VTableStore> &stores = functionStores[functionIndex];
+
+            X86ValueTracker tracker;
+            for (const FunctionCode::Variant &variant : functionCode.GetVariants(functionIndex))
+            {
+                const bool findStores = isStructor && stores.empty();
+                tracker.Reset(isStructor);
+
+                uint32_t offset = 0;
+                while (offset < variant.m_size)
+                {
+                    X86Instruction instruction;
+                    const uint64_t address = variant.m_address + offset;
+                    if (!X86Decoder::Decode(variant.m_data + offset, variant.m_size - offset, instruction))
+                    {
+                        tracker.ClearRegisters();
+                        ++offset;
+                        continue;
+                    }
+
+                    if (findStores && instruction.HasBaseDisplacementOperand()
+                        && tracker.GetRegister(instruction.m_baseRegister).m_kind == X86Value::This
+                        && instruction.m_displacement >= 0)
+                    {
+                        const X86Value storedValue = tracker.GetStoredValue(instruction);
+                        VTableStore store;
+                        if (storedValue.m_kind == X86Value::Constant
+                            && vtableAddressIndex.FindVTable(storedValue.m_value, store.m_vtableAddress))
+                        {
+                            store.m_objectOffset = static_cast<uint32_t>(instruction.m_displacement);
+                            store.m_addressPointOffset = static_cast<uint32_t>(storedValue.m_value - store.m_vtableAddress);
+                            stores.push_back(store);
+                        }
+                    }
+
+                    X86Value newObject;
+                    if (instruction.m_opcode == 0xe8) // call rel32
+                    {
+                        const uint64_t target = address + instruction.m_length + instruction.m_displacement;
+                        const X86Value argument = tracker.GetArgument(0);
+                        if (std::binary_search(operatorNewAddresses.begin(), operatorNewAddresses.end(), target))
+                        {
+                            if (argument.m_kind == X86Value::Constant)
+                                newObject = {X86Value::NewObject, argument.m_value};
+                        }
+                        else if (argument.m_kind == X86Value::NewObject)
+                        {
+                            const index_t classIndex = findConstructorClass(target);
+                            if (classIndex != InvalidIndex)
+                                StoreMinimum(sizeSlots[classIndex], (uint64_t(functionIndex) << 32) | argument.m_value);
+                        }
+                    }
+
+                    tracker.Track(instruction, address);
+                    if (newObject.m_kind == X86Value::NewObject)
+                        tracker.SetRegister(X86Register_Eax, newObject);
+                    offset += instruction.m_length;
+                }
+            }
+
+            if (!stores.empty())
+            {
+                ReduceVTableStores(stores, isDestructor);
+                const uint64_t key = (uint64_t(isDestructor) << 32) | functionIndex;
+                StoreMinimum(vtableSlots[function.m_parentClassIndex], key);
+            }
+        });
+    }
+
+    m_vtableStoreOffsets.assign(classCount + 1, 0);
+    m_vtableStores.clear();
+    m_vtableFunctionIndices.assign(classCount, InvalidIndex);
+    m_allocationSizes.assign(classCount, 0);
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const uint64_t vtableSlot = vtableSlots[classIndex].load(std::memory_order_relaxed);
+        if (vtableSlot != EmptySlot)
+        {
+            const index_t functionIndex = static_cast<index_t>(vtableSlot);
+            const std::vector<VTableStore> &stores = functionStores[functionIndex];
+            m_vtableStores.insert(m_vtableStores.end(), stores.begin(), stores.end());
+            m_vtableFunctionIndices[classIndex] = functionIndex;
+        }
+        m_vtableStoreOffsets[classIndex + 1] = static_cast<uint32_t>(m_vtableStores.size());
+
+        const uint64_t sizeSlot = sizeSlots[classIndex].load(std::memory_order_relaxed);
+        if (sizeSlot != EmptySlot)
+            m_allocationSizes[classIndex] = static_cast<uint32_t>(sizeSlot);
+    }
+}
+
+tcb::span<const ConstructorAnalysis::VTableStore> ConstructorAnalysis::GetVTableStores(index_t classIndex) const
+{
+    const uint32_t begin = m_vtableStoreOffsets[classIndex];
+    return tcb::span<const VTableStore>(m_vtableStores.data() + begin, m_vtableStoreOffsets[classIndex + 1] - begin);
+}
+
+size_t ConstructorAnalysis::GetMemoryUsage() const
+{
+    return m_vtableStoreOffsets.capacity() * sizeof(uint32_t) + m_vtableStores.capacity() * sizeof(VTableStore)
+        + m_vtableFunctionIndices.capacity() * sizeof(index_t) + m_allocationSizes.capacity() * sizeof(uint32_t);
+}
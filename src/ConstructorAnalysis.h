@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+namespace LIEF::MachO
+{
+class Binary;
+} // namespace LIEF::MachO
+
+class FunctionCode;
+class ThreadPool;
+class VTableAddressIndex;
+
+// Binds vtables and object sizes to classes from the code that creates objects. Constructors and destructors store the
+// address points of the vtables of their class into this, at the offsets of the vtable pointers. A new expression
+// passes the object size to operator new and the returned pointer to the constructor as this. Every function variant
+// is decoded by X86ValueTracker on a thread pool. Every class has one lock-free result slot per kind, which keeps the
+// result of the lowest function index, so the result does not depend on the thread count.
+class ConstructorAnalysis
+{
+public:
+    struct VTableStore
+    {
+        uint32_t m_objectOffset = 0; // Offset of the vtable pointer in the object.
+        uint32_t m_addressPointOffset = 0; // Offset of the stored address point from the vtable symbol.
+        uint64_t m_vtableAddress = 0; // Address of the __ZTV symbol.
+    };
+
+public:
+    void Build(
+        const LIEF::MachO::Binary &binary,
+        const FunctionCode &functionCode,
+        const VTableAddressIndex &vtableAddressIndex,
+        const Functions &functions,
+        index_t classCount,
+        ThreadPool &threadPool);
+
+    // Vtable stores of one constructor of the class, or of one destructor if no constructor stores vtables. Ascending
+    // object offsets.
+    tcb::span<const VTableStore> GetVTableStores(index_t classIndex) const;
+    // Constructor or destructor that the vtable stores come from.
+    index_t GetVTableFunctionIndex(index_t classIndex) const { return m_vtableFunctionIndices[classIndex]; }
+    // Constant size passed to operator new before a call of a constructor of the class. 0 if unknown.
+    uint32_t GetAllocationSize(index_t classIndex) const { return m_allocationSizes[classIndex]; }
+
+    // Classes that existed when the analysis was built. Classes created later have no results.
+    index_t GetClassCount() const { return static_cast<index_t>(m_allocationSizes.size()); }
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint32_t> m_vtableStoreOffsets = {0}; // Offsets into m_vtableStores, one more than classes.
+    std::vector<VTableStore> m_vtableStores;
+    std::vector<index_t> m_vtableFunctionIndices;
+    std::vector<uint32_t> m_allocationSizes;
+};
@@ -4,10 +4,112 @@
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 
-uint16_t VTable::Size() const
+void IndexSet::Insert(index_t index)
 {
-    return static_cast<uint16_t>(m_entries.size());
+    if (m_indices.empty() || m_indices.back() < index)
+    {
+        m_indices.push_back(index);
+        return;
+    }
+
+    std::vector<index_t>::iterator it = std::lower_bound(m_indices.begin(), m_indices.end(), index);
+    if (*it != index)
+    {
+        m_indices.insert(it, index);
+    }
+}
+
+bool IndexSet::Contains(index_t index) const
+{
+    return std::binary_search(m_indices.begin(), m_indices.end(), index);
+}
+
+void IndexSet::UnionWith(const IndexSet &other)
+{
+    if (other.m_indices.empty())
+        return;
+
+    if (m_indices.empty() || m_indices.back() < other.m_indices.front())
+    {
+        m_indices.insert(m_indices.end(), other.m_indices.begin(), other.m_indices.end());
+        return;
+    }
+
+    *this = Union(*this, other);
+}
+
+void IndexSet::IntersectWith(const IndexSet &other)
+{
+    std::vector<index_t>::iterator out = m_indices.begin();
+    std::vector<index_t>::const_iterator it = other.m_indices.begin();
+    std::vector<index_t>::const_iterator end = other.m_indices.end();
+    for (index_t index : m_indices)
+    {
+        while (it != end && *it < index)
+            ++it;
+        if (it == end)
+            break;
+        if (*it == index)
+            *out++ = index;
+    }
+    m_indices.erase(out, m_indices.end());
+}
+
+IndexSet IndexSet::Union(const IndexSet &set1, const IndexSet &set2)
+{
+    IndexSet set;
+    set.m_indices.reserve(set1.m_indices.size() + set2.m_indices.size());
+    std::set_union(
+        set1.m_indices.begin(),
+        set1.m_indices.end(),
+        set2.m_indices.begin(),
+        set2.m_indices.end(),
+        std::back_inserter(set.m_indices));
+    return set;
+}
+
+IndexSet IndexSet::Intersection(const IndexSet &set1, const IndexSet &set2)
+{
+    IndexSet set;
+    std::set_intersection(
+        set1.m_indices.begin(),
+        set1.m_indices.end(),
+        set2.m_indices.begin(),
+        set2.m_indices.end(),
+        std::back_inserter(set.m_indices));
+    return set;
+}
+
+size_t IndexSet::IntersectionSize(const IndexSet &set1, const IndexSet &set2)
+{
+    size_t size = 0;
+    std::vector<index_t>::const_iterator it1 = set1.m_indices.begin();
+    std::vector<index_t>::const_iterator it2 = set2.m_indices.begin();
+    while (it1 != set1.m_indices.end() && it2 != set2.m_indices.end())
+    {
+        if (*it1 < *it2)
+        {
+            ++it1;
+        }
+        else if (*it2 < *it1)
+        {
+            ++it2;
+        }
+        else
+        {
+            ++size;
+            ++it1;
+            ++it2;
+        }
+    }
+    return size;
+}
+
+bool IndexSet::IsSubset(const IndexSet &subset, const IndexSet &set)
+{
+    return std::includes(set.m_indices.begin(), set.m_indices.end(), subset.m_indices.begin(), subset.m_indices.end());
 }
 
 const BaseClass *Class::GetBaseClass(uint16_t baseOffset) const
@@ -24,6 +126,18 @@ const BaseClass *Class::GetBaseClass(uint16_t baseOffset) const
     return nullptr;
 }
 
+tcb::span<VTableEntry> Class::GetVTableEntries(const VTable &vtable)
+{
+    assert(vtable.m_entryBegin + vtable.m_entryCount <= m_vtableEntries.size());
+    return tcb::span<VTableEntry>(m_vtableEntries.data() + vtable.m_entryBegin, vtable.m_entryCount);
+}
+
+tcb::span<const VTableEntry> Class::GetVTableEntries(const VTable &vtable) const
+{
+    assert(vtable.m_entryBegin + vtable.m_entryCount <= m_vtableEntries.size());
+    return tcb::span<const VTableEntry>(m_vtableEntries.data() + vtable.m_entryBegin, vtable.m_entryCount);
+}
+
 const std::string &Function::GetMangledName(size_t variantIndex) const
 {
     assert(variantIndex < m_variants.size());
@@ -53,88 +167,24 @@ bool Function::IsClassMemberFunction() const
     return m_parentClassIndex != InvalidIndex;
 }
 
-std::vector<std::string> Function::GetParameterTypes(const std::string &functionParameters)
+std::set<std::string> CreateHeaderFileSet(const HeaderFiles &headerFiles, const Function &function)
 {
-    std::vector<std::string> types;
-    std::string type;
-    bool typeOpened = false;
-    int templateList = 0;
-    const char *c = functionParameters.c_str();
+    std::set<std::string> set;
 
-    for (; *c != '\0'; ++c)
+    for (index_t headerFileIndex : function.m_headerFileIndices)
     {
-        if (*c == '(')
-        {
-            typeOpened = true;
-            continue;
-        }
-        else if (*c == '<')
-        {
-            ++templateList;
-        }
-        else if (*c == '>')
-        {
-            --templateList;
-        }
-
-        if (templateList == 0)
-        {
-            if (*c == ',')
-            {
-                if (!type.empty())
-                {
-                    types.push_back(std::move(type));
-                }
-                ++c;
-                typeOpened = true;
-                continue;
-            }
-            else if (std::isspace(*c))
-            {
-                if (type == "signed" || type == "unsigned")
-                {
-                    type += *c;
-                    continue;
-                }
-                if (!type.empty())
-                {
-                    types.push_back(std::move(type));
-                }
-                typeOpened = false;
-                continue;
-            }
-            else if (*c == '*' || *c == '&' || *c == ')')
-            {
-                if (!type.empty())
-                {
-                    types.push_back(std::move(type));
-                }
-                typeOpened = false;
-                continue;
-            }
-        }
-
-        if (typeOpened)
-        {
-            type += *c;
-        }
+        set.insert(headerFiles[headerFileIndex].m_name);
     }
-    return types;
+    return set;
 }
 
-std::set<std::string> CreateHeaderFileSet(const HeaderFiles &headerFiles, const Function &function)
+IndexSet CreateHeaderFileSet(const Functions &functions, const Class &classType)
 {
-    std::set<std::string> set;
+    IndexSet set;
 
-    for (const FunctionVariant &variant : function.m_variants)
+    for (index_t functionIndex : classType.m_functionIndices)
     {
-        for (const FunctionInstruction &instruction : variant.m_instructions)
-        {
-            if (instruction.headerFileIndex != InvalidIndex)
-            {
-                set.insert(headerFiles[instruction.headerFileIndex].m_name);
-            }
-        }
+        set.UnionWith(functions[functionIndex].m_headerFileIndices);
     }
     return set;
 }
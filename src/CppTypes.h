@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstdint>
+#include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <tcb/span.hpp>
 #include <unordered_map>
 #include <vector>
@@ -10,20 +12,55 @@
 using index_t = uint32_t;
 constexpr index_t InvalidIndex = index_t(~0);
 
+// Set of indices, stored as a sorted array without duplicates. Set operations are linear merges.
+class IndexSet
+{
+public:
+    using const_iterator = std::vector<index_t>::const_iterator;
+
+public:
+    // Inserting in ascending order appends.
+    void Insert(index_t index);
+    bool Contains(index_t index) const;
+    void UnionWith(const IndexSet &other);
+    void IntersectWith(const IndexSet &other);
+
+    static IndexSet Union(const IndexSet &set1, const IndexSet &set2);
+    static IndexSet Intersection(const IndexSet &set1, const IndexSet &set2);
+    static size_t IntersectionSize(const IndexSet &set1, const IndexSet &set2);
+    static bool IsSubset(const IndexSet &subset, const IndexSet &set);
+
+    bool operator==(const IndexSet &other) const { return m_indices == other.m_indices; }
+    bool operator!=(const IndexSet &other) const { return m_indices != other.m_indices; }
+
+    bool Empty() const { return m_indices.empty(); }
+    size_t Size() const { return m_indices.size(); }
+    index_t operator[](size_t i) const { return m_indices[i]; }
+    const_iterator begin() const { return m_indices.begin(); }
+    const_iterator end() const { return m_indices.end(); }
+
+private:
+    std::vector<index_t> m_indices;
+};
+
 struct Namespace;
 struct Function;
+struct Type;
+struct EnumValue;
 struct Enum;
 struct Variable;
 struct BaseClass;
+struct ClassMember;
 struct VTableEntry;
 struct VTable;
 struct Class;
 struct NonVirtualThunk;
-struct FunctionInstruction;
+struct FunctionParameter;
 struct FunctionVariant;
 struct Function;
 struct HeaderFile;
 struct SourceFile;
+class IncludeTable;
 
 struct Namespace
 {
@@ -37,14 +74,48 @@ struct Namespace
     std::vector<index_t> m_enumIndices; // Direct enums in this namespace (not contained in classes).
 };
 
+struct Type // Type from STABS type information.
+{
+    enum class Kind : uint8_t
+    {
+        Unresolved, // Type is referenced but was not defined (yet).
+        Builtin, // int, char, void...
+        Pointer,
+        Reference,
+        Const,
+        Volatile,
+        Array,
+        Function,
+        MemberPointer,
+        Class,
+        Enum,
+        Typedef,
+    };
+
+    std::string m_name; // Name of builtin or typedef.
+    Kind m_kind = Kind::Unresolved;
+    uint32_t m_size = 0; // Size in bytes, if known.
+    uint32_t m_count = 0; // Element count of array.
+    index_t m_targetTypeIndex = InvalidIndex; // Pointee, element, return or aliased type.
+    index_t m_classIndex = InvalidIndex; // Class of class type.
+    index_t m_enumIndex = InvalidIndex; // Enum of enum type.
+};
+
+struct EnumValue
+{
+    std::string m_name;
+    int64_t m_value = 0;
+};
+
 struct Enum
 {
     std::string m_name;
+    index_t m_typeIndex = InvalidIndex;
+    uint32_t m_size = 0; // Size in bytes. Known with STABS type information.
+    std::vector<EnumValue> m_values; // Known with STABS type information.
     index_t m_parentNamespaceIndex = InvalidIndex; // Enum is contained in namespace.
     index_t m_parentClassIndex = InvalidIndex; // Enum is contained in class.
     index_t m_parentFunctionIndex = InvalidIndex; // Enum is contained in function.
-
-    // TODO: Add properties: type, values(?)...
 };
 
 struct Variable // Static or global data variable.
@@ -57,11 +128,15 @@ struct Variable // Static or global data variable.
     };
 
     std::string m_name;
-    uint64_t m_address = 0;
+    std::string m_mangledName;
+    uint64_t m_address = 0; // Global variables get their address from the external symbol.
+    uint32_t m_size = 0; // Size in bytes from the STABS type, if known.
     uint16_t m_description = 0; // ???
     uint8_t m_section = 0 /*NO_SECT*/; // TODO: fix this.
     Type m_type = Type::Global;
+    index_t m_typeIndex = InvalidIndex;
 
+    index_t m_sourceFileIndex = InvalidIndex;
     index_t m_parentNamespaceIndex = InvalidIndex; // Variable is contained in namespace.
     index_t m_parentClassIndex = InvalidIndex; // Variable is contained in class.
     index_t m_parentFunctionIndex = InvalidIndex; // Variable is contained in function.
@@ -76,29 +151,46 @@ enum class BaseClassVisibility : uint8_t
     Public, // Public.
 };
 
+// Packed vtable entry. The name is not stored, because it is the name of the function or thunk. Pure virtual functions
+// get a name id in post process.
 struct VTableEntry
 {
-    bool IsFirstDeclaration() const { return !m_isOverride && !m_isImplicit; }
+    enum Flags : uint16_t
+    {
+        Flag_None = 0,
+        Flag_Dtor = 1 << 0, // Virtual function is destructor.
+        Flag_PureVirtual = 1 << 1, // Virtual function is pure (= 0).
+        Flag_Override = 1 << 2, // Virtual function overrides a virtual function of a base class.
+        Flag_Implicit = 1 << 3, // Virtual function implicitly inherits a virtual function of a base class.
+        Flag_Thunk = 1 << 4, // m_index refers to a thunk instead of a function.
+    };
 
-    std::string m_name;
-    index_t m_functionIndex = InvalidIndex;
-    index_t m_thunkIndex = InvalidIndex;
+    bool IsFirstDeclaration() const { return (m_flags & (Flag_Override | Flag_Implicit)) == 0; }
+    bool IsDtor() const { return (m_flags & Flag_Dtor) != 0; }
+    bool IsPureVirtual() const { return (m_flags & Flag_PureVirtual) != 0; }
+    bool IsOverride() const { return (m_flags & Flag_Override) != 0; }
+    bool IsImplicit() const { return (m_flags & Flag_Implicit) != 0; }
+    index_t GetFunctionIndex() const { return (m_flags & Flag_Thunk) ? InvalidIndex : m_index; }
+    index_t GetThunkIndex() const { return (m_flags & Flag_Thunk) ? m_index : InvalidIndex; }
+
+    index_t m_index = InvalidIndex; // Function or thunk index. Invalid for pure virtual functions.
 
     // The most bottom base class that this virtual function overrides.
     // Index refers to Class::m_allBaseClasses.
     index_t m_allBaseClassIndex = InvalidIndex;
 
-    bool m_isDtor = false; // Virtual function is destructor.
-    bool m_isPureVirtual = false; // Virtual function is pure (= 0).
-    bool m_isOverride = false; // Virtual function overrides a virtual function of a base class.
-    bool m_isImplicit = false; // Virtual function implicitly inherits a virtual function of a base class.
+    index_t m_nameId = InvalidIndex; // Name of a pure virtual function, once known.
+    uint16_t m_flags = Flag_None;
 };
 
-struct VTable
+static_assert(sizeof(VTableEntry) <= 16, "VTableEntry is expected to be packed");
+
+struct VTable // Range of Class::m_vtableEntries.
 {
-    uint16_t Size() const;
+    uint16_t Size() const { return m_entryCount; }
 
-    std::vector<VTableEntry> m_entries;
+    uint32_t m_entryBegin = 0;
+    uint16_t m_entryCount = 0;
     uint16_t m_offset = 0; // Offset in bytes, corresponding to BaseClass::baseOffset.
 };
 
@@ -110,14 +202,27 @@ struct BaseClass
     bool m_isVirtual = false; // Virtual inheritance.
 };
 
+struct ClassMember // Data member.
+{
+    std::string m_name;
+    index_t m_typeIndex = InvalidIndex;
+    uint32_t m_bitOffset = 0;
+    uint32_t m_bitSize = 0;
+    bool m_isStatic = false; // Static members have no offset and size.
+};
+
 struct Class // Alias Struct
 {
     const BaseClass *GetBaseClass(uint16_t baseOffset) const;
+    tcb::span<VTableEntry> GetVTableEntries(const VTable &vtable);
+    tcb::span<const VTableEntry> GetVTableEntries(const VTable &vtable) const;
 
     std::string m_name;
     std::string m_className; // a::b::c becomes c.
     uint16_t m_size = 0; // Size of this class.
+    index_t m_typeIndex = InvalidIndex;
     std::vector<VTable> m_vtables; // Primary vtable at 0, secondary vtables with thunks to base classes with offsets at >=1.
+    std::vector<VTableEntry> m_vtableEntries; // Entries of all vtables, in vtable order.
     index_t m_parentNamespaceIndex = InvalidIndex; // Class is contained in namespace.
     index_t m_parentClassIndex = InvalidIndex; // Class is contained in another class.
     std::vector<BaseClass> m_directBaseClasses; // Direct base classes. First to last.
@@ -127,6 +232,7 @@ struct Class // Alias Struct
     std::vector<index_t> m_functionIndices; // Functions inside this class.
     std::vector<index_t> m_variableIndices; // Variables inside this class (statics).
     std::vector<index_t> m_enumIndices; // Enums inside this class.
+    std::vector<ClassMember> m_members; // Data members. Known with STABS type information.
 };
 
 struct NonVirtualThunk
@@ -136,11 +242,11 @@ struct NonVirtualThunk
     bool m_isDtor = false;
 };
 
-struct FunctionInstruction
+struct FunctionParameter
 {
-    uint64_t m_address = 0;
-    index_t headerFileIndex = InvalidIndex;
-    index_t sourceFileIndex = InvalidIndex;
+    std::string m_name;
+    index_t m_typeIndex = InvalidIndex;
+    int32_t m_frameOffset = 0; // Offset from the frame pointer. The first stack argument is at 8.
 };
 
 struct FunctionVariant
@@ -150,7 +256,8 @@ struct FunctionVariant
     uint32_t m_size = 0;
     uint16_t m_sourceLine = 0;
     uint8_t m_section = 0 /*NO_SECT*/; // TODO: fix this.
-    std::vector<FunctionInstruction> m_instructions;
+    index_t m_includeSequenceIndex = InvalidIndex; // N_SOL file transitions. Refers to IncludeTable sequence.
+    index_t m_lineRangeIndex = InvalidIndex; // N_SLINE lines. Refers to LineTable range.
 };
 
 struct Function
@@ -161,8 +268,6 @@ struct Function
     uint16_t GetSourceLine(size_t variantIndex) const;
     bool IsClassMemberFunction() const;
 
-    static std::vector<std::string> GetParameterTypes(const std::string &functionParameters);
-
     std::string m_name;
 
     std::string m_functionBaseName; // The base name. Does not include trailing template arguments.
@@ -170,7 +275,9 @@ struct Function
     std::string m_functionName; // The entire name.
     std::string m_functionParameters;
     std::string m_functionReturnType;
-    std::vector<std::string> m_functionParameterTypes;
+    std::vector<index_t> m_functionParameterTypeIds; // Interned parameter types from the demangler.
+    std::vector<index_t> m_functionParameterBaseTypeIds; // Same without pointers, references, cv and arrays.
+    std::vector<FunctionParameter> m_parameters; // Known with STABS type information (N_PSYM).
 
     bool m_isCtorOrDtor = false;
     bool m_isLocalFunction = false; // :f  Local non-global function, lives in cpp, static
@@ -184,6 +291,7 @@ struct Function
     std::vector<index_t> m_classIndices; // Classes inside this function. Most likely empty.
     std::vector<index_t> m_variableIndices; // Variables inside this function.
     std::vector<index_t> m_enumIndices; // Enums inside this function. Most likely empty.
+    IndexSet m_headerFileIndices; // Header files that code of any variant comes from (N_SOL).
 
     std::vector<FunctionVariant> m_variants;
 };
@@ -191,7 +299,7 @@ struct Function
 struct HeaderFile // .h
 {
     std::string m_name;
-    // std::vector<index_t> m_functionIndices;
+    IndexSet m_functionIndices; // Functions with code from this header file (N_SOL).
     // std::vector<index_t> m_variableIndices;
     // std::vector<index_t> m_enumIndices;
 };
@@ -201,13 +309,14 @@ struct SourceFile // .cpp
     std::string m_name;
     uint64_t m_addressBegin = 0; // Begin address.
     uint64_t m_addressEnd = 0; // End address.
-    std::vector<index_t> m_headerFileIndices;
+    IndexSet m_headerFileIndices; // Header files that code of any function comes from (N_SOL).
     std::vector<index_t> m_functionIndices;
     std::vector<index_t> m_variableIndices;
     std::vector<index_t> m_enumIndices;
 };
 
 using Namespaces = std::vector<Namespace>;
+using Types = std::vector<Type>;
 using Enums = std::vector<Enum>;
 using Variables = std::vector<Variable>;
 using Classes = std::vector<Class>;
@@ -217,7 +326,26 @@ using HeaderFiles = std::vector<HeaderFile>;
 using SourceFiles = std::vector<SourceFile>;
 
 using StringToIndexMap = std::unordered_map<std::string, index_t>;
+using StringViewToIndexMap = std::unordered_map<std::string_view, index_t>;
 using AddressToIndexMap = std::unordered_map<uint64_t, index_t>;
+using HashToIndexMap = std::unordered_map<uint64_t, index_t>;
 using StringToIndexMultiMap = std::unordered_multimap<std::string, index_t>;
 
+// Orders (kind, name) keys of named types. Transparent, so that lookups with a string_view name do not allocate.
+struct NamedTypeKeyLess
+{
+    using is_transparent = void;
+
+    template<typename Key1, typename Key2>
+    bool operator()(const Key1 &key1, const Key2 &key2) const
+    {
+        if (key1.first != key2.first)
+            return key1.first < key2.first;
+        return std::string_view(key1.second) < std::string_view(key2.second);
+    }
+};
+using NamedTypeToIndexMap = std::map<std::pair<Type::Kind, std::string>, index_t, NamedTypeKeyLess>;
+
 std::set<std::string> CreateHeaderFileSet(const HeaderFiles &headerFiles, const Function &function);
+// Header files that code of any function of the class comes from.
+IndexSet CreateHeaderFileSet(const Functions &functions, const Class &classType);
@@ -0,0 +1,157 @@
+#include "DataAddressIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace
+{
+constexpr size_t InvalidInterval = ~size_t(0);
+}
+
+bool DataAddressIndex::IsIndexedSection(const std::string &sectionName)
+{
+    return sectionName == "__data" || sectionName == "__bss" || sectionName == "__common" || sectionName == "__const";
+}
+
+void DataAddressIndex::AddSection(std::string name, uint64_t address, uint64_t size)
+{
+    Section section;
+    section.m_name = std::move(name);
+    section.m_address = address;
+    section.m_size = size;
+    m_sections.push_back(std::move(section));
+}
+
+void DataAddressIndex::AddVariable(uint64_t address, uint32_t size, index_t variableIndex)
+{
+    m_begins.push_back(address);
+    m_sizes.push_back(size);
+    m_variableIndices.push_back(variableIndex);
+}
+
+void DataAddressIndex::Finalize()
+{
+    std::sort(m_sections.begin(), m_sections.end(), [](const Section &a, const Section &b) {
+        return a.m_address < b.m_address;
+    });
+
+    // Order by address. Variables at the same address keep the order in which they were added.
+    std::vector<size_t> order(m_begins.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return m_begins[a] < m_begins[b]; });
+
+    std::vector<uint64_t> begins;
+    std::vector<uint32_t> sizes;
+    std::vector<index_t> variableIndices;
+    begins.reserve(order.size());
+    sizes.reserve(order.size());
+    variableIndices.reserve(order.size());
+
+    for (size_t i : order)
+    {
+        if (FindSection(m_begins[i]) == nullptr)
+            continue;
+        if (!begins.empty() && begins.back() == m_begins[i])
+            continue;
+
+        begins.push_back(m_begins[i]);
+        sizes.push_back(m_sizes[i]);
+        variableIndices.push_back(m_variableIndices[i]);
+    }
+
+    // Intervals must not overlap, so that a lookup only needs to look at one interval.
+    const size_t count = begins.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Section *section = FindSection(begins[i]);
+        assert(section != nullptr);
+        uint64_t end = section->m_address + section->m_size;
+        if (i + 1 < count)
+        {
+            end = std::min(end, begins[i + 1]);
+        }
+        const uint64_t maxSize = std::min<uint64_t>(end - begins[i], 0xffffffffu);
+        if (sizes[i] == 0 || sizes[i] > maxSize)
+        {
+            sizes[i] = static_cast<uint32_t>(maxSize);
+        }
+    }
+
+    m_begins = std::move(begins);
+    m_sizes = std::move(sizes);
+    m_variableIndices = std::move(variableIndices);
+}
+
+index_t DataAddressIndex::FindVariable(uint64_t address) const
+{
+    return GetVariableIndex(FindInterval(address, 0), address);
+}
+
+void DataAddressIndex::FindVariables(const uint64_t *addresses, index_t *variableIndices, size_t count) const
+{
+    size_t interval = InvalidInterval;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const uint64_t address = addresses[i];
+        if (interval == InvalidInterval || address < m_begins[interval])
+        {
+            interval = FindInterval(address, 0);
+        }
+        else
+        {
+            interval = FindInterval(address, interval);
+        }
+        variableIndices[i] = GetVariableIndex(interval, address);
+    }
+}
+
+size_t DataAddressIndex::GetMemoryUsage() const
+{
+    return m_sections.capacity() * sizeof(Section) + m_begins.capacity() * sizeof(uint64_t)
+        + m_sizes.capacity() * sizeof(uint32_t) + m_variableIndices.capacity() * sizeof(index_t);
+}
+
+size_t DataAddressIndex::FindInterval(uint64_t address, size_t firstInterval) const
+{
+    const size_t count = m_begins.size();
+    if (firstInterval >= count || address < m_begins[firstInterval])
+        return InvalidInterval;
+
+    // Gallop forward from the first interval, then search the bracketed range.
+    size_t low = firstInterval;
+    size_t step = 1;
+    while (low + step < count && m_begins[low + step] <= address)
+    {
+        low += step;
+        step *= 2;
+    }
+    const size_t high = std::min(low + step, count);
+    const auto it = std::upper_bound(m_begins.begin() + low, m_begins.begin() + high, address);
+    return static_cast<size_t>(it - m_begins.begin()) - 1;
+}
+
+index_t DataAddressIndex::GetVariableIndex(size_t interval, uint64_t address) const
+{
+    if (interval == InvalidInterval)
+        return InvalidIndex;
+    if (address - m_begins[interval] >= m_sizes[interval])
+        return InvalidIndex;
+
+    return m_variableIndices[interval];
+}
+
+const DataAddressIndex::Section *DataAddressIndex::FindSection(uint64_t address) const
+{
+    auto it = std::upper_bound(m_sections.begin(), m_sections.end(), address, [](uint64_t a, const Section &section) {
+        return a < section.m_address;
+    });
+    if (it == m_sections.begin())
+        return nullptr;
+
+    --it;
+    if (address >= it->m_address + it->m_size)
+        return nullptr;
+
+    return &*it;
+}
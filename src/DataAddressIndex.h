@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sorted interval index from data addresses to variables. Covers the __data, __bss, __common and __const sections.
+// Intervals are stored as packed parallel arrays, so that a lookup is one binary search over the begin addresses.
+// Variables without a known size extend to the next variable or the end of their section.
+class DataAddressIndex
+{
+public:
+    struct Section
+    {
+        std::string m_name; // "__DATA,__data"...
+        uint64_t m_address = 0;
+        uint64_t m_size = 0;
+    };
+
+public:
+    static bool IsIndexedSection(const std::string &sectionName);
+
+    // Build interface. Sections and variables may be added in any order.
+    void AddSection(std::string name, uint64_t address, uint64_t size);
+    // Variables outside of the added sections are ignored. Size may be 0 if unknown.
+    void AddVariable(uint64_t address, uint32_t size, index_t variableIndex);
+
+    // Sorts the intervals and fills unknown sizes. Call once after all sections and variables are added.
+    void Finalize();
+
+    // Finds the variable that contains the given address, if any. Requires Finalize.
+    index_t FindVariable(uint64_t address) const;
+    // Finds the variables of many addresses at once. Ascending addresses are found with a forward scan.
+    void FindVariables(const uint64_t *addresses, index_t *variableIndices, size_t count) const;
+
+    size_t GetIntervalCount() const { return m_begins.size(); }
+    const std::vector<Section> &GetSections() const { return m_sections; }
+    size_t GetMemoryUsage() const;
+
+private:
+    // Returns the last interval that begins at or before the address, searching forward from the first interval.
+    size_t FindInterval(uint64_t address, size_t firstInterval) const;
+    index_t GetVariableIndex(size_t interval, uint64_t address) const;
+    const Section *FindSection(uint64_t address) const;
+
+private:
+    std::vector<Section> m_sections;
+    std::vector<uint64_t> m_begins; // Interval begin addresses in ascending order.
+    std::vector<uint32_t> m_sizes;
+    std::vector<index_t> m_variableIndices;
+};
@@ -0,0 +1,234 @@
+#include "DebugMap.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+
+#include <mach-o/nlist.h>
+#include <mach-o/stab.h>
+
+bool DebugMap::Load(const SymbolEntries &binarySymbols, ThreadPool &threadPool)
+{
+    CollectObjects(binarySymbols, m_objects);
+    if (m_objects.empty())
+        return false;
+
+    // Final addresses of external symbols. The debug map does not list the addresses of global variables.
+    NameToAddressMap globalAddresses;
+    for (const SymbolEntry &symbol : binarySymbols)
+    {
+        if ((symbol.m_type & N_STAB) == 0 && (symbol.m_type & N_TYPE) == N_SECT && (symbol.m_type & N_EXT) != 0)
+        {
+            globalAddresses.emplace(symbol.m_name, symbol.m_value);
+        }
+    }
+
+    threadPool.ParallelFor(m_objects.size(), [&](size_t index) {
+        Object &object = m_objects[index];
+        object.m_isLoaded = LoadObject(binarySymbols, globalAddresses, object);
+    });
+
+    // Merge sequentially in N_OSO order.
+    size_t symbolCount = binarySymbols.size();
+    for (const Object &object : m_objects)
+    {
+        symbolCount += object.m_symbols.size();
+    }
+    m_symbols.reserve(symbolCount);
+
+    size_t nextSymbol = 0;
+    for (const Object &object : m_objects)
+    {
+        if (!object.m_isLoaded)
+            continue;
+
+        assert(object.m_symbolBegin >= nextSymbol);
+        m_symbols.insert(m_symbols.end(), binarySymbols.begin() + nextSymbol, binarySymbols.begin() + object.m_symbolBegin);
+        m_symbols.insert(m_symbols.end(), object.m_symbols.begin(), object.m_symbols.end());
+        nextSymbol = object.m_symbolEnd;
+    }
+    m_symbols.insert(m_symbols.end(), binarySymbols.begin() + nextSymbol, binarySymbols.end());
+
+    return true;
+}
+
+size_t DebugMap::GetLoadedObjectCount() const
+{
+    return std::count_if(m_objects.begin(), m_objects.end(), [](const Object &object) { return object.m_isLoaded; });
+}
+
+void DebugMap::CollectObjects(const SymbolEntries &binarySymbols, std::vector<Object> &objects)
+{
+    bool inUnit = false;
+    size_t unitBegin = 0;
+    Object *openObject = nullptr; // Object of the compile unit that is not closed yet.
+
+    const size_t count = binarySymbols.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const SymbolEntry &symbol = binarySymbols[i];
+        if (symbol.m_type == N_SO)
+        {
+            if (!symbol.m_name.empty())
+            {
+                if (!inUnit)
+                {
+                    // Directory or file name. Opens the compile unit.
+                    inUnit = true;
+                    unitBegin = i;
+                }
+            }
+            else
+            {
+                // Closes the compile unit.
+                if (openObject != nullptr)
+                {
+                    openObject->m_symbolEnd = i + 1;
+                    openObject = nullptr;
+                }
+                inUnit = false;
+            }
+        }
+        else if (symbol.m_type == N_OSO)
+        {
+            Object object;
+            object.m_path = symbol.m_name;
+            // A compile unit is replaced by one object file only.
+            object.m_symbolBegin = inUnit && openObject == nullptr ? unitBegin : i;
+            object.m_symbolEnd = i + 1;
+            objects.push_back(std::move(object));
+            openObject = &objects.back();
+        }
+    }
+}
+
+bool DebugMap::LoadObject(const SymbolEntries &binarySymbols, const NameToAddressMap &globalAddresses, Object &object)
+{
+    // Archive members, such as "libfoo.a(bar.o)", are not supported.
+    if (!object.m_file.Load(std::string(object.m_path)))
+        return false;
+
+    SymbolEntries objectSymbols;
+    if (!object.m_file.ReadSymbols(objectSymbols))
+    {
+        object.m_file.Unload();
+        return false;
+    }
+
+    // Final addresses of the functions and static variables of this compile unit, by linker symbol name.
+    NameToAddressMap unitAddresses;
+    uint64_t unitBeginAddress = 0;
+    uint64_t unitEndAddress = 0;
+    for (size_t i = object.m_symbolBegin; i < object.m_symbolEnd; ++i)
+    {
+        const SymbolEntry &symbol = binarySymbols[i];
+        switch (symbol.m_type)
+        {
+            case N_FUN:
+            case N_STSYM:
+            case N_GSYM:
+                if (!symbol.m_name.empty() && symbol.m_value != 0)
+                {
+                    unitAddresses.emplace(symbol.m_name, symbol.m_value);
+                }
+                break;
+            case N_SO:
+                if (!symbol.m_name.empty())
+                    unitBeginAddress = symbol.m_value;
+                else
+                    unitEndAddress = symbol.m_value;
+                break;
+        }
+    }
+
+    // Relocations from the section symbols of the object file, ordered by object address.
+    std::vector<Relocation> relocations;
+    for (const SymbolEntry &symbol : objectSymbols)
+    {
+        if ((symbol.m_type & N_STAB) != 0 || (symbol.m_type & N_TYPE) != N_SECT)
+            continue;
+
+        Relocation relocation;
+        relocation.m_objectAddress = symbol.m_value;
+
+        NameToAddressMap::const_iterator it = unitAddresses.find(symbol.m_name);
+        if (it == unitAddresses.end())
+        {
+            it = globalAddresses.find(symbol.m_name);
+            if (it == globalAddresses.end())
+            {
+                relocations.push_back(relocation);
+                continue;
+            }
+        }
+        relocation.m_delta = static_cast<int64_t>(it->second - symbol.m_value);
+        relocation.m_isLinked = true;
+        relocations.push_back(relocation);
+    }
+    std::sort(relocations.begin(), relocations.end(), [](const Relocation &a, const Relocation &b) {
+        if (a.m_objectAddress != b.m_objectAddress)
+            return a.m_objectAddress < b.m_objectAddress;
+        return a.m_isLinked > b.m_isLinked;
+    });
+    relocations.erase(
+        std::unique(
+            relocations.begin(),
+            relocations.end(),
+            [](const Relocation &a, const Relocation &b) { return a.m_objectAddress == b.m_objectAddress; }),
+        relocations.end());
+
+    // Relocate the stabs. Functions that were dead stripped are dropped together with their lines and files.
+    // Type information is kept, because later symbols may refer to its type numbers.
+    bool skipFunction = false;
+    for (const SymbolEntry &symbol : objectSymbols)
+    {
+        if ((symbol.m_type & N_STAB) == 0)
+            continue;
+
+        SymbolEntry relocated = symbol;
+        if (symbol.m_type == N_SO)
+        {
+            relocated.m_value = symbol.m_name.empty() ? unitEndAddress : unitBeginAddress;
+        }
+        else if (symbol.m_type == N_FUN && symbol.m_name.empty())
+        {
+            // Function end. The value is the function size.
+            if (skipFunction)
+            {
+                skipFunction = false;
+                continue;
+            }
+        }
+        else if (symbol.m_section != NO_SECT)
+        {
+            const Relocation *relocation = FindRelocation(relocations, symbol.m_value);
+            const bool isLinked = relocation != nullptr && relocation->m_isLinked;
+            if (symbol.m_type == N_FUN)
+            {
+                // Function begin.
+                skipFunction = !isLinked || relocation->m_objectAddress != symbol.m_value;
+            }
+            if (!isLinked || skipFunction)
+                continue;
+
+            relocated.m_value = symbol.m_value + static_cast<uint64_t>(relocation->m_delta);
+        }
+        object.m_symbols.push_back(relocated);
+    }
+
+    return true;
+}
+
+const DebugMap::Relocation *DebugMap::FindRelocation(const std::vector<Relocation> &relocations, uint64_t objectAddress)
+{
+    auto it = std::upper_bound(
+        relocations.begin(),
+        relocations.end(),
+        objectAddress,
+        [](uint64_t address, const Relocation &relocation) { return address < relocation.m_objectAddress; });
+    if (it == relocations.begin())
+        return nullptr;
+
+    return &*(it - 1);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ObjectFile.h"
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+// Follows the N_OSO entries of a binary that was linked with a debug map, where the full stabs are kept in the
+// object files. Every compile unit of the debug map (N_SO ... N_OSO ... N_SO) only lists the final addresses of its
+// functions and variables. Object files are mapped into memory and read in parallel. Their stabs are relocated with
+// the debug map addresses and merged in N_OSO order, so that the result does not depend on the thread count.
+class DebugMap
+{
+public:
+    // Returns false if the binary has no N_OSO entries.
+    bool Load(const SymbolEntries &binarySymbols, ThreadPool &threadPool);
+
+    // Symbols of the binary in which every compile unit of the debug map is replaced by the relocated stabs of its
+    // object file. Compile units of object files that could not be read are kept as is.
+    const SymbolEntries &GetSymbols() const { return m_symbols; }
+
+    size_t GetObjectCount() const { return m_objects.size(); }
+    size_t GetLoadedObjectCount() const;
+
+private:
+    struct Object
+    {
+        std::string_view m_path; // N_OSO name.
+        size_t m_symbolBegin = 0; // First symbol of the compile unit in the binary.
+        size_t m_symbolEnd = 0; // One past the last symbol of the compile unit in the binary.
+        ObjectFile m_file;
+        SymbolEntries m_symbols; // Relocated stabs of the object file.
+        bool m_isLoaded = false;
+    };
+
+    struct Relocation
+    {
+        uint64_t m_objectAddress = 0;
+        int64_t m_delta = 0; // Binary address minus object address.
+        bool m_isLinked = false; // False if the symbol was dead stripped.
+    };
+
+    using NameToAddressMap = std::unordered_map<std::string_view, uint64_t>;
+
+    static void CollectObjects(const SymbolEntries &binarySymbols, std::vector<Object> &objects);
+    // Reads the object file and relocates its stabs. Runs on a worker thread.
+    static bool LoadObject(const SymbolEntries &binarySymbols, const NameToAddressMap &globalAddresses, Object &object);
+    static const Relocation *FindRelocation(const std::vector<Relocation> &relocations, uint64_t objectAddress);
+
+private:
+    std::vector<Object> m_objects;
+    SymbolEntries m_symbols;
+};
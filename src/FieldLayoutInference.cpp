@@ -0,0 +1,295 @@
+#include "FieldLayoutInference.h"
+
+#include "FunctionCode.h"
+#include "ThreadPool.h"
+#include "VTableAddressIndex.h"
+#include "X86ValueTracker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace
+{
+constexpr uint32_t MaxFieldOffset = std::numeric_limits<uint16_t>::max(); // Class::m_size is 16 bits.
+
+struct FieldAccess
+{
+    uint32_t m_offset = 0;
+    uint8_t m_size = 0;
+    uint8_t m_flags = FieldLayoutInference::Access_None;
+};
+
+struct ClassFieldAccess
+{
+    uint32_t m_offset = 0;
+    uint32_t m_functionOrdinal = 0; // Position of the function among the member functions of the class.
+    uint8_t m_size = 0;
+    uint8_t m_flags = FieldLayoutInference::Access_None;
+};
+
+uint8_t GetSizeMaskBit(uint8_t size)
+{
+    switch (size)
+    {
+        case 1:
+            return 1 << 0;
+        case 2:
+            return 1 << 1;
+        case 4:
+            return 1 << 2;
+        case 8:
+            return 1 << 3;
+        case 16:
+            return 1 << 4;
+        case 10:
+            return 1 << 7;
+    }
+    return 0;
+}
+
+uint8_t GetAccessFlags(const X86Instruction &instruction)
+{
+    if (instruction.m_opcode == 0x8d) // lea
+        return FieldLayoutInference::Access_AddressTaken;
+
+    uint8_t flags = FieldLayoutInference::Access_None;
+    const uint8_t memoryAccess = instruction.GetMemoryAccess();
+    if (memoryAccess & X86Instruction::MemoryAccess_Read)
+        flags |= FieldLayoutInference::Access_Read;
+    if (memoryAccess & X86Instruction::MemoryAccess_Write)
+        flags |= FieldLayoutInference::Access_Write;
+    return flags;
+}
+
+// Decodes the variant and appends the this relative accesses.
+void AnalyzeVariant(
+    const FunctionCode::Variant &variant,
+    int32_t thisOffset,
+    const VTableAddressIndex &vtableAddressIndex,
+    std::vector<FieldAccess> &accesses)
+{
+    X86ValueTracker tracker;
+    tracker.Reset(true, thisOffset);
+    uint32_t offset = 0;
+    while (offset < variant.m_size)
+    {
+        X86Instruction instruction;
+        const uint64_t address = variant.m_address + offset;
+        if (!X86Decoder::Decode(variant.m_data + offset, variant.m_size - offset, instruction))
+        {
+            // Data in code or an unknown instruction. Nothing is known about the registers after it.
+            tracker.ClearRegisters();
+            ++offset;
+            continue;
+        }
+
+        if (instruction.HasBaseDisplacementOperand()
+            && tracker.GetRegister(instruction.m_baseRegister).m_kind == X86Value::This
+            && instruction.m_displacement >= 0 && static_cast<uint32_t>(instruction.m_displacement) <= MaxFieldOffset)
+        {
+            FieldAccess access;
+            access.m_offset = static_cast<uint32_t>(instruction.m_displacement);
+            access.m_size = instruction.GetMemoryOperandSize();
+            access.m_flags = GetAccessFlags(instruction);
+
+            const X86Value storedValue = tracker.GetStoredValue(instruction);
+            uint64_t vtableAddress;
+            if (storedValue.m_kind == X86Value::Constant
+                && vtableAddressIndex.FindVTable(storedValue.m_value, vtableAddress))
+            {
+                access.m_flags |= FieldLayoutInference::Access_VTablePointer;
+            }
+
+            accesses.push_back(access);
+        }
+
+        tracker.Track(instruction, address);
+        offset += instruction.m_length;
+    }
+}
+
+void MergeAccesses(std::vector<FieldAccess> &accesses)
+{
+    std::sort(accesses.begin(), accesses.end(), [](const FieldAccess &access1, const FieldAccess &access2) {
+        if (access1.m_offset != access2.m_offset)
+            return access1.m_offset < access2.m_offset;
+        return access1.m_size < access2.m_size;
+    });
+
+    size_t count = 0;
+    for (const FieldAccess &access : accesses)
+    {
+        if (count != 0 && accesses[count - 1].m_offset == access.m_offset && accesses[count - 1].m_size == access.m_size)
+            accesses[count - 1].m_flags |= access.m_flags;
+        else
+            accesses[count++] = access;
+    }
+    accesses.resize(count);
+}
+
+uint8_t GetFieldSize(uint8_t sizeMask, uint32_t offset, uint32_t nextOffset)
+{
+    static constexpr uint8_t Sizes[] = {16, 10, 8, 4, 2, 1}; // Largest first.
+    uint8_t smallestSize = 0;
+    for (uint8_t size : Sizes)
+    {
+        if ((sizeMask & GetSizeMaskBit(size)) == 0)
+            continue;
+        if (offset + size <= nextOffset)
+            return size;
+        smallestSize = size;
+    }
+    return smallestSize;
+}
+} // namespace
+
+void FieldLayoutInference::Build(
+    const FunctionCode &functionCode,
+    const VTableAddressIndex &vtableAddressIndex,
+    const Functions &functions,
+    index_t classCount,
+    ThreadPool &threadPool)
+{
+    // Member functions with a recorded this parameter and code. Static member functions have no this parameter.
+    std::vector<index_t> memberFunctionIndices;
+    std::vector<int32_t> memberThisOffsets;
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const Function &function = functions[functionIndex];
+        if (function.m_parentClassIndex == InvalidIndex)
+            continue;
+        if (function.m_parameters.empty() || function.m_parameters.front().m_name != "this")
+            continue;
+        if (functionCode.GetVariants(functionIndex).size() == 0)
+            continue;
+
+        // this is the first argument, or the second after the hidden pointer of a class returned by value. The frame
+        // offset is relative to ebp after push ebp, which is 4 bytes above esp at entry.
+        const int32_t thisOffset = function.m_parameters.front().m_frameOffset - 4;
+        if (thisOffset != 4 && thisOffset != 8)
+            continue;
+
+        memberFunctionIndices.push_back(functionIndex);
+        memberThisOffsets.push_back(thisOffset);
+    }
+    m_analyzedFunctionCount = static_cast<uint32_t>(memberFunctionIndices.size());
+
+    // Member functions of every class, in function order.
+    std::vector<uint32_t> classFunctionOffsets(classCount + 1, 0);
+    for (index_t functionIndex : memberFunctionIndices)
+    {
+        assert(functions[functionIndex].m_parentClassIndex < classCount);
+        ++classFunctionOffsets[functions[functionIndex].m_parentClassIndex + 1];
+    }
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        classFunctionOffsets[classIndex + 1] += classFunctionOffsets[classIndex];
+    }
+    std::vector<uint32_t> classFunctions(memberFunctionIndices.size());
+    {
+        std::vector<uint32_t> cursors(classFunctionOffsets.begin(), classFunctionOffsets.end() - 1);
+        for (uint32_t memberIndex = 0; memberIndex < memberFunctionIndices.size(); ++memberIndex)
+        {
+            const index_t classIndex = functions[memberFunctionIndices[memberIndex]].m_parentClassIndex;
+            classFunctions[cursors[classIndex]++] = memberIndex;
+        }
+    }
+
+    std::vector<std::vector<FieldAccess>> functionAccesses(memberFunctionIndices.size());
+    std::vector<std::vector<Field>> classFields(classCount);
+    {
+        threadPool.ParallelFor(memberFunctionIndices.size(), [&](size_t memberIndex) {
+            std::vector<FieldAccess> &accesses = functionAccesses[memberIndex];
+            for (const FunctionCode::Variant &variant : functionCode.GetVariants(memberFunctionIndices[memberIndex]))
+            {
+                AnalyzeVariant(variant, memberThisOffsets[memberIndex], vtableAddressIndex, accesses);
+            }
+            MergeAccesses(accesses);
+        });
+
+        threadPool.ParallelFor(classCount, [&](size_t classIndex) {
+            const uint32_t functionBegin = classFunctionOffsets[classIndex];
+            const uint32_t functionEnd = classFunctionOffsets[classIndex + 1];
+            if (functionBegin == functionEnd)
+                return;
+
+            thread_local std::vector<ClassFieldAccess> accesses;
+            accesses.clear();
+            for (uint32_t i = functionBegin; i < functionEnd; ++i)
+            {
+                for (const FieldAccess &access : functionAccesses[classFunctions[i]])
+                {
+                    accesses.push_back({access.m_offset, i - functionBegin, access.m_size, access.m_flags});
+                }
+            }
+            std::sort(
+                accesses.begin(),
+                accesses.end(),
+                [](const ClassFieldAccess &access1, const ClassFieldAccess &access2) {
+                    if (access1.m_offset != access2.m_offset)
+                        return access1.m_offset < access2.m_offset;
+                    return access1.m_functionOrdinal < access2.m_functionOrdinal;
+                });
+
+            std::vector<Field> &fields = classFields[classIndex];
+            for (size_t i = 0; i < accesses.size(); ++i)
+            {
+                const ClassFieldAccess &access = accesses[i];
+                if (fields.empty() || fields.back().m_offset != access.m_offset)
+                {
+                    fields.emplace_back();
+                    fields.back().m_offset = access.m_offset;
+                }
+
+                Field &field = fields.back();
+                field.m_sizeMask |= GetSizeMaskBit(access.m_size);
+                field.m_flags |= access.m_flags;
+                const bool newFunction = i == 0 || accesses[i - 1].m_offset != access.m_offset
+                    || accesses[i - 1].m_functionOrdinal != access.m_functionOrdinal;
+                if (newFunction && field.m_functionCount < std::numeric_limits<uint16_t>::max())
+                    ++field.m_functionCount;
+            }
+
+            for (size_t i = 0; i < fields.size(); ++i)
+            {
+                const uint32_t nextOffset =
+                    i + 1 < fields.size() ? fields[i + 1].m_offset : std::numeric_limits<uint32_t>::max();
+                fields[i].m_size = GetFieldSize(fields[i].m_sizeMask, fields[i].m_offset, nextOffset);
+            }
+        });
+    }
+
+    m_fieldOffsets.assign(classCount + 1, 0);
+    m_fields.clear();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        m_fields.insert(m_fields.end(), classFields[classIndex].begin(), classFields[classIndex].end());
+        m_fieldOffsets[classIndex + 1] = static_cast<uint32_t>(m_fields.size());
+    }
+}
+
+tcb::span<const FieldLayoutInference::Field> FieldLayoutInference::GetFields(index_t classIndex) const
+{
+    if (classIndex + 1 >= m_fieldOffsets.size())
+        return {};
+
+    const uint32_t begin = m_fieldOffsets[classIndex];
+    return tcb::span<const Field>(m_fields.data() + begin, m_fieldOffsets[classIndex + 1] - begin);
+}
+
+uint32_t FieldLayoutInference::GetMinimumSize(index_t classIndex) const
+{
+    uint32_t size = 0;
+    for (const Field &field : GetFields(classIndex))
+    {
+        size = std::max(size, field.m_offset + field.m_size);
+    }
+    return size;
+}
+
+size_t FieldLayoutInference::GetMemoryUsage() const
+{
+    return m_fieldOffsets.capacity() * sizeof(uint32_t) + m_fields.capacity() * sizeof(Field);
+}
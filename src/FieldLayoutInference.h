@@ -0,0 +1,62 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+class FunctionCode;
+class ThreadPool;
+class VTableAddressIndex;
+
+// Infers the data member layout of classes from the code of their member functions. Only functions with a this
+// parameter in the stabs are analyzed, and its frame offset gives the i386 cdecl stack slot of this: [esp+4], or
+// [esp+8] if the function returns a class through a hidden pointer. Every variant is decoded linearly by
+// X86ValueTracker, which follows the this pointer from that slot into registers and spilled stack slots. Loads and
+// stores at constant offsets from a register that holds this become field accesses. Stores of vtable addresses mark
+// vtable pointers. Functions are analyzed in parallel, and the accesses of all member functions of a class are merged
+// in function order, so the result does not depend on the thread count.
+class FieldLayoutInference
+{
+public:
+    enum AccessFlags : uint8_t
+    {
+        Access_None = 0,
+        Access_Read = 1 << 0,
+        Access_Write = 1 << 1,
+        Access_AddressTaken = 1 << 2, // lea of the field, such as for member objects and out parameters.
+        Access_VTablePointer = 1 << 3, // A vtable address was stored.
+    };
+
+    struct Field
+    {
+        uint32_t m_offset = 0;
+        uint8_t m_size = 0; // Largest access size that does not overlap the next field. 0 if only the address is taken.
+        uint8_t m_sizeMask = 0; // Bit n is set if a 2^n byte access was seen. Bit 7 for 10 byte x87 accesses.
+        uint8_t m_flags = Access_None;
+        uint16_t m_functionCount = 0; // Member functions that access the field.
+    };
+
+public:
+    void Build(
+        const FunctionCode &functionCode,
+        const VTableAddressIndex &vtableAddressIndex,
+        const Functions &functions,
+        index_t classCount,
+        ThreadPool &threadPool);
+
+    // Inferred fields of the class, by ascending offset.
+    tcb::span<const Field> GetFields(index_t classIndex) const;
+    // End of the last inferred field, a lower bound of the class size.
+    uint32_t GetMinimumSize(index_t classIndex) const;
+    // Member functions in which this was followed.
+    uint32_t GetAnalyzedFunctionCount() const { return m_analyzedFunctionCount; }
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint32_t> m_fieldOffsets = {0}; // Offsets into m_fields, one more than classes.
+    std::vector<Field> m_fields;
+    uint32_t m_analyzedFunctionCount = 0;
+};
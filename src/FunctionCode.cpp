@@ -0,0 +1,55 @@
+#include "FunctionCode.h"
+
+#include <LIEF/MachO.hpp>
+
+#include <cassert>
+
+void FunctionCode::Build(const LIEF::MachO::Binary &binary, const Functions &functions)
+{
+    m_variantOffsets.assign(1, 0);
+    m_variantOffsets.reserve(functions.size() + 1);
+    m_variants.clear();
+
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const Function &function = functions[functionIndex];
+        const uint32_t variantCount = function.m_variants.size();
+        for (uint32_t variantIndex = 0; variantIndex < variantCount; ++variantIndex)
+        {
+            const FunctionVariant &variant = function.m_variants[variantIndex];
+            if (variant.m_size == 0)
+                continue;
+
+            auto data = binary.get_content_from_virtual_address(variant.m_address, variant.m_size);
+            if (data.size() != variant.m_size)
+                continue; // Not in a mapped segment.
+
+            Variant codeVariant;
+            codeVariant.m_functionIndex = functionIndex;
+            codeVariant.m_variantIndex = variantIndex;
+            codeVariant.m_address = variant.m_address;
+            codeVariant.m_data = data.data();
+            codeVariant.m_size = variant.m_size;
+            m_variants.push_back(codeVariant);
+        }
+        m_variantOffsets.push_back(static_cast<uint32_t>(m_variants.size()));
+    }
+}
+
+tcb::span<const FunctionCode::Variant> FunctionCode::GetVariants() const
+{
+    return tcb::span<const Variant>(m_variants.data(), m_variants.size());
+}
+
+tcb::span<const FunctionCode::Variant> FunctionCode::GetVariants(index_t functionIndex) const
+{
+    assert(functionIndex + 1 < m_variantOffsets.size());
+    const uint32_t begin = m_variantOffsets[functionIndex];
+    return tcb::span<const Variant>(m_variants.data() + begin, m_variantOffsets[functionIndex + 1] - begin);
+}
+
+size_t FunctionCode::GetMemoryUsage() const
+{
+    return m_variantOffsets.capacity() * sizeof(uint32_t) + m_variants.capacity() * sizeof(Variant);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <cstring>
+#include <tcb/span.hpp>
+#include <vector>
+
+namespace LIEF::MachO
+{
+class Binary;
+} // namespace LIEF::MachO
+
+// Code bytes of all function variants that lie in mapped segments. The binary is read once and sequentially, and the
+// code analyses scan the collected variants in parallel. The bytes are views into the binary.
+class FunctionCode
+{
+public:
+    struct Variant
+    {
+        index_t m_functionIndex = InvalidIndex;
+        uint32_t m_variantIndex = 0; // Index in Function::m_variants.
+        uint64_t m_address = 0;
+        const uint8_t *m_data = nullptr;
+        uint32_t m_size = 0;
+    };
+
+public:
+    // Skips variants without a size and variants that are not in a mapped segment.
+    void Build(const LIEF::MachO::Binary &binary, const Functions &functions);
+
+    // Variants of all functions, in function and variant order.
+    tcb::span<const Variant> GetVariants() const;
+    tcb::span<const Variant> GetVariants(index_t functionIndex) const;
+
+    // Reads an unaligned 32-bit immediate or displacement.
+    static uint32_t ReadUInt32(const uint8_t *data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<uint32_t> m_variantOffsets = {0}; // Offsets into m_variants, one more than functions.
+    std::vector<Variant> m_variants;
+};
@@ -0,0 +1,262 @@
+#include "FunctionMatcher.h"
+
+#include "FunctionCode.h"
+#include "FunctionMatcherImage.h"
+#include "ThreadPool.h"
+#include "X86Decoder.h"
+#include "utility.h"
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+bool IsRelativeBranch(uint16_t opcode)
+{
+    return (opcode >= 0x70 && opcode <= 0x7f) || (opcode >= 0xe0 && opcode <= 0xe3) || opcode == 0xe8
+        || opcode == 0xe9 || opcode == 0xeb || (opcode >= 0x0f80 && opcode <= 0x0f8f);
+}
+
+// Smallest (vtable name, slot) pair that points to a function. The vtable order of the image does not matter.
+struct VTableSlot
+{
+    bool IsLess(std::string_view name, uint32_t slot) const
+    {
+        return m_count == 0 || name < m_name || (name == m_name && slot < m_slot);
+    }
+
+    std::string_view m_name;
+    uint32_t m_slot = 0;
+    uint32_t m_count = 0;
+};
+} // namespace
+
+void FunctionMatcher::ComputeFingerprints(
+    const FunctionMatcherImage &image,
+    ThreadPool &threadPool,
+    FunctionFingerprints &fingerprints)
+{
+    const size_t functionCount = image.m_functionStarts.size();
+    fingerprints.assign(functionCount, FunctionFingerprint());
+
+    std::vector<VTableSlot> vtableSlots(functionCount);
+    for (const FunctionMatcherImage::VTable &vtable : image.m_vtables)
+    {
+        const uint32_t slotCount = vtable.m_size / 4;
+        for (uint32_t slot = 0; slot < slotCount; ++slot)
+        {
+            const index_t functionIndex = image.FindFunctionStart(FunctionCode::ReadUInt32(vtable.m_data + slot * 4));
+            if (functionIndex == InvalidIndex)
+                continue;
+
+            VTableSlot &vtableSlot = vtableSlots[functionIndex];
+            if (vtableSlot.IsLess(vtable.m_name, slot))
+            {
+                vtableSlot.m_name = vtable.m_name;
+                vtableSlot.m_slot = slot;
+            }
+            ++vtableSlot.m_count;
+        }
+    }
+
+    auto isInImage = [&image](uint64_t value) { return value >= image.m_imageBegin && value < image.m_imageEnd; };
+    auto addTypeInfo = [&image](FunctionFingerprint &fingerprint, uint32_t address) {
+        const uint64_t nameHash = image.FindTypeInfo(address);
+        if (nameHash != 0)
+            fingerprint.m_typeInfoHash = hash_combine(fingerprint.m_typeInfoHash, nameHash);
+    };
+
+    threadPool.ParallelFor(functionCount, [&](size_t functionIndex) {
+        const FunctionMatcherImage::FunctionStart &functionStart = image.m_functionStarts[functionIndex];
+        FunctionFingerprint &fingerprint = fingerprints[functionIndex];
+        fingerprint.m_size = functionStart.m_size;
+
+        const VTableSlot &vtableSlot = vtableSlots[functionIndex];
+        if (vtableSlot.m_count != 0)
+        {
+            fingerprint.m_vtableCount =
+                static_cast<uint16_t>(std::min<uint32_t>(vtableSlot.m_count, std::numeric_limits<uint16_t>::max()));
+            fingerprint.m_vtableSlotHash = hash_combine(
+                XXH3_64bits(vtableSlot.m_name.data(), vtableSlot.m_name.size()),
+                vtableSlot.m_slot + 1);
+        }
+
+        // Every instruction contributes its encoding. Values that are addresses in the image are masked, because they
+        // change between builds. Branches inside the function keep their displacement.
+        thread_local std::vector<uint32_t> normalizedCode;
+        normalizedCode.clear();
+
+        const uint8_t *code = functionStart.m_data;
+        const uint32_t size = functionStart.m_size;
+        uint32_t offset = 0;
+        X86Instruction instruction;
+        while (offset < size)
+        {
+            if (!X86Decoder::Decode(code + offset, size - offset, instruction))
+                break;
+
+            normalizedCode.push_back(
+                instruction.m_opcode | static_cast<uint32_t>(instruction.m_prefixes) << 16
+                | static_cast<uint32_t>(instruction.m_length) << 24);
+            if (instruction.m_hasModRM)
+            {
+                normalizedCode.push_back(
+                    instruction.m_mod << 6 | instruction.m_reg << 3 | instruction.m_rm
+                    | static_cast<uint32_t>(instruction.m_baseRegister) << 8
+                    | static_cast<uint32_t>(instruction.m_indexRegister) << 16
+                    | static_cast<uint32_t>(instruction.m_scale) << 24);
+            }
+
+            uint32_t displacement = static_cast<uint32_t>(instruction.m_displacement);
+            if (IsRelativeBranch(instruction.m_opcode))
+            {
+                const uint64_t target = functionStart.m_address + offset + instruction.m_length
+                    + static_cast<int64_t>(instruction.m_displacement);
+                if (instruction.m_opcode == 0xe8 && image.FindFunctionStart(target) != InvalidIndex)
+                {
+                    if (fingerprint.m_callCount < std::numeric_limits<uint16_t>::max())
+                        ++fingerprint.m_callCount;
+                }
+                if (target < functionStart.m_address || target >= functionStart.m_address + size)
+                    displacement = 0;
+            }
+            else if (isInImage(displacement))
+            {
+                addTypeInfo(fingerprint, displacement);
+                displacement = 0;
+            }
+            normalizedCode.push_back(displacement);
+
+            if (instruction.m_hasImmediate)
+            {
+                uint32_t immediate = instruction.m_immediate;
+                if (isInImage(immediate))
+                {
+                    addTypeInfo(fingerprint, immediate);
+                    immediate = 0;
+                }
+                normalizedCode.push_back(immediate);
+            }
+            offset += instruction.m_length;
+        }
+
+        uint64_t codeHash = XXH3_64bits(normalizedCode.data(), normalizedCode.size() * sizeof(uint32_t));
+        if (offset < size)
+            codeHash = hash_combine(codeHash, XXH3_64bits(code + offset, size - offset));
+        fingerprint.m_codeHash = codeHash;
+    });
+}
+
+void FunctionMatcher::MatchFunctions(
+    const FunctionFingerprints &fingerprints1,
+    const FunctionFingerprints &fingerprints2,
+    Matches &matches)
+{
+    matches.clear();
+    std::vector<index_t> matched1(fingerprints1.size(), InvalidIndex);
+    std::vector<index_t> matched2(fingerprints2.size(), InvalidIndex);
+
+    MatchRound(
+        fingerprints1,
+        fingerprints2,
+        matched1,
+        matched2,
+        MatchKind::Exact,
+        [](const FunctionFingerprint &fingerprint) {
+            uint64_t key = hash_combine(fingerprint.m_codeHash, fingerprint.m_size);
+            key = hash_combine(key, fingerprint.m_typeInfoHash);
+            key = hash_combine(key, fingerprint.m_callCount);
+            key = hash_combine(key, fingerprint.m_vtableCount);
+            return hash_combine(key, fingerprint.m_vtableSlotHash);
+        },
+        matches);
+
+    MatchRound(
+        fingerprints1,
+        fingerprints2,
+        matched1,
+        matched2,
+        MatchKind::Code,
+        [](const FunctionFingerprint &fingerprint) { return hash_combine(fingerprint.m_codeHash, fingerprint.m_size); },
+        matches);
+
+    MatchRound(
+        fingerprints1,
+        fingerprints2,
+        matched1,
+        matched2,
+        MatchKind::Structure,
+        [](const FunctionFingerprint &fingerprint) {
+            uint64_t key = hash_combine(fingerprint.m_size, fingerprint.m_typeInfoHash);
+            key = hash_combine(key, fingerprint.m_callCount);
+            key = hash_combine(key, fingerprint.m_vtableCount);
+            return hash_combine(key, fingerprint.m_vtableSlotHash);
+        },
+        matches);
+}
+
+template<typename GetKey>
+void FunctionMatcher::MatchRound(
+    const FunctionFingerprints &fingerprints1,
+    const FunctionFingerprints &fingerprints2,
+    std::vector<index_t> &matched1,
+    std::vector<index_t> &matched2,
+    MatchKind kind,
+    GetKey &&getKey,
+    Matches &matches)
+{
+    struct Bucket
+    {
+        uint32_t m_count1 = 0;
+        uint32_t m_count2 = 0;
+        index_t m_functionIndex1 = InvalidIndex;
+        index_t m_functionIndex2 = InvalidIndex;
+    };
+
+    std::unordered_map<uint64_t, Bucket> buckets;
+    buckets.reserve(fingerprints1.size() + fingerprints2.size());
+
+    const index_t functionCount1 = fingerprints1.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount1; ++functionIndex)
+    {
+        if (matched1[functionIndex] != InvalidIndex || fingerprints1[functionIndex].m_size == 0)
+            continue;
+        Bucket &bucket = buckets[getKey(fingerprints1[functionIndex])];
+        ++bucket.m_count1;
+        bucket.m_functionIndex1 = functionIndex;
+    }
+
+    const index_t functionCount2 = fingerprints2.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount2; ++functionIndex)
+    {
+        if (matched2[functionIndex] != InvalidIndex || fingerprints2[functionIndex].m_size == 0)
+            continue;
+        Bucket &bucket = buckets[getKey(fingerprints2[functionIndex])];
+        ++bucket.m_count2;
+        bucket.m_functionIndex2 = functionIndex;
+    }
+
+    // Iterate the first build to keep the match order deterministic.
+    for (index_t functionIndex = 0; functionIndex < functionCount1; ++functionIndex)
+    {
+        if (matched1[functionIndex] != InvalidIndex || fingerprints1[functionIndex].m_size == 0)
+            continue;
+
+        const Bucket &bucket = buckets[getKey(fingerprints1[functionIndex])];
+        if (bucket.m_count1 != 1 || bucket.m_count2 != 1)
+            continue;
+
+        Match match;
+        match.m_functionIndex1 = bucket.m_functionIndex1;
+        match.m_functionIndex2 = bucket.m_functionIndex2;
+        match.m_kind = kind;
+        matches.push_back(match);
+        matched1[match.m_functionIndex1] = match.m_functionIndex2;
+        matched2[match.m_functionIndex2] = match.m_functionIndex1;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+struct FunctionMatcherImage;
+
+// Build independent properties of a function start.
+struct FunctionFingerprint
+{
+    uint64_t m_codeHash = 0; // Hash of the decoded instructions with branch targets outside and image addresses masked.
+    uint64_t m_typeInfoHash = 0; // Hash of the mangled names of the referenced typeinfo objects, in order.
+    uint64_t m_vtableSlotHash = 0; // Hash of the smallest (vtable name, slot) that points to the function, or 0.
+    uint32_t m_size = 0;
+    uint16_t m_callCount = 0; // Direct calls to function starts.
+    uint16_t m_vtableCount = 0; // Number of vtable slots that point to the function.
+};
+
+using FunctionFingerprints = std::vector<FunctionFingerprint>;
+
+// Matches functions between two builds by fingerprints. Every round joins the unmatched functions of both builds in
+// one hash table keyed by a subset of the fingerprint, from strictest to weakest, and accepts keys that are unique in
+// both builds. No pair of functions is compared directly. Functions are the function starts of the image, so stripped
+// builds are matched as well. Function indices refer to FunctionMatcherImage::m_functionStarts.
+class FunctionMatcher
+{
+public:
+    enum class MatchKind : uint8_t
+    {
+        Exact, // All fingerprint fields are equal.
+        Code, // Code hash and size are equal.
+        Structure, // Size, calls, vtable slots and typeinfo are equal.
+    };
+
+    struct Match
+    {
+        index_t m_functionIndex1 = InvalidIndex;
+        index_t m_functionIndex2 = InvalidIndex;
+        MatchKind m_kind = MatchKind::Exact;
+    };
+
+    using Matches = std::vector<Match>;
+
+public:
+    // Computes the fingerprints of all function starts in parallel. Functions that do not decode are hashed from the
+    // first undecodable byte on.
+    static void ComputeFingerprints(
+        const FunctionMatcherImage &image,
+        ThreadPool &threadPool,
+        FunctionFingerprints &fingerprints);
+
+    // Matches the functions of two builds. Every function is matched at most once.
+    static void MatchFunctions(
+        const FunctionFingerprints &fingerprints1,
+        const FunctionFingerprints &fingerprints2,
+        Matches &matches);
+
+private:
+    template<typename GetKey>
+    static void MatchRound(
+        const FunctionFingerprints &fingerprints1,
+        const FunctionFingerprints &fingerprints2,
+        std::vector<index_t> &matched1,
+        std::vector<index_t> &matched2,
+        MatchKind kind,
+        GetKey &&getKey,
+        Matches &matches);
+};
@@ -0,0 +1,193 @@
+#include "FunctionMatcherImage.h"
+
+#include "utility.h"
+
+#include <LIEF/MachO.hpp>
+#include <mach-o/nlist.h>
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <limits>
+
+namespace
+{
+struct CodeSection
+{
+    uint64_t m_begin = 0;
+    uint64_t m_end = 0;
+    const uint8_t *m_data = nullptr;
+};
+
+bool IsCodeSection(const LIEF::MachO::Section &section)
+{
+    return section.name() == "__text" || section.name() == "__textcoal_nt";
+}
+} // namespace
+
+bool FunctionMatcherImage::Read(const LIEF::MachO::Binary &binary, const Functions &functions)
+{
+    m_imageBegin = std::numeric_limits<uint64_t>::max();
+    m_imageEnd = 0;
+    m_functionStarts.clear();
+    m_vtables.clear();
+    m_typeInfos.clear();
+
+    std::vector<CodeSection> codeSections;
+    for (const LIEF::MachO::Section &section : binary.sections())
+    {
+        if (section.size() == 0)
+            continue;
+        m_imageBegin = std::min(m_imageBegin, section.address());
+        m_imageEnd = std::max(m_imageEnd, section.address() + section.size());
+
+        if (IsCodeSection(section) && section.content().size() == section.size())
+        {
+            CodeSection codeSection;
+            codeSection.m_begin = section.address();
+            codeSection.m_end = section.address() + section.size();
+            codeSection.m_data = section.content().data();
+            codeSections.push_back(codeSection);
+        }
+    }
+    if (codeSections.empty())
+        return false;
+
+    std::sort(codeSections.begin(), codeSections.end(), [](const CodeSection &a, const CodeSection &b) {
+        return a.m_begin < b.m_begin;
+    });
+
+    auto findCodeSection = [&codeSections](uint64_t address) -> const CodeSection * {
+        auto it = std::upper_bound(
+            codeSections.begin(),
+            codeSections.end(),
+            address,
+            [](uint64_t value, const CodeSection &codeSection) { return value < codeSection.m_begin; });
+        if (it == codeSections.begin() || address >= (it - 1)->m_end)
+            return nullptr;
+        return &*(it - 1);
+    };
+
+    auto addFunctionStart = [&](uint64_t address, std::string_view name) {
+        if (findCodeSection(address) == nullptr)
+            return;
+        FunctionStart functionStart;
+        functionStart.m_address = address;
+        functionStart.m_name = name;
+        m_functionStarts.push_back(functionStart);
+    };
+
+    // Symbols are added first, so their names win over the unnamed starts of LC_FUNCTION_STARTS.
+    std::vector<uint64_t> symbolAddresses;
+    std::vector<uint64_t> vtableAddresses;
+    for (const LIEF::MachO::Symbol &symbol : binary.symbols())
+    {
+        const uint8_t type = symbol.raw_type();
+        if ((type & N_STAB) != 0 || (type & N_TYPE) != N_SECT)
+            continue;
+
+        const std::string &name = symbol.name();
+        const uint64_t address = symbol.value();
+        symbolAddresses.push_back(address);
+
+        // External symbol names have a leading underscore.
+        std::string_view mangledName = name;
+        if (starts_with(mangledName, "_"))
+            mangledName.remove_prefix(1);
+        addFunctionStart(address, mangledName);
+
+        if (starts_with(name, "__ZTI"))
+        {
+            TypeInfo typeInfo;
+            typeInfo.m_address = address;
+            typeInfo.m_nameHash = XXH3_64bits(name.data(), name.size());
+            m_typeInfos.push_back(typeInfo);
+        }
+        else if (starts_with(name, "__ZTV"))
+        {
+            VTable vtable;
+            vtable.m_name = mangledName;
+            m_vtables.push_back(vtable);
+            vtableAddresses.push_back(address);
+        }
+    }
+
+    for (const Function &function : functions)
+    {
+        for (const FunctionVariant &variant : function.m_variants)
+        {
+            if (variant.m_size != 0)
+                addFunctionStart(variant.m_address, variant.m_mangledName);
+        }
+    }
+
+    if (binary.has_function_starts())
+    {
+        const LIEF::MachO::SegmentCommand *textSegment = binary.get_segment("__TEXT");
+        if (textSegment != nullptr)
+        {
+            for (uint64_t offset : binary.function_starts()->functions())
+            {
+                addFunctionStart(textSegment->virtual_address() + offset, std::string_view());
+            }
+        }
+    }
+
+    // Keep the first name of every address.
+    std::stable_sort(
+        m_functionStarts.begin(),
+        m_functionStarts.end(),
+        [](const FunctionStart &a, const FunctionStart &b) { return a.m_address < b.m_address; });
+    size_t uniqueCount = 0;
+    for (const FunctionStart &functionStart : m_functionStarts)
+    {
+        if (uniqueCount != 0 && m_functionStarts[uniqueCount - 1].m_address == functionStart.m_address)
+        {
+            if (m_functionStarts[uniqueCount - 1].m_name.empty())
+                m_functionStarts[uniqueCount - 1].m_name = functionStart.m_name;
+            continue;
+        }
+        m_functionStarts[uniqueCount++] = functionStart;
+    }
+    m_functionStarts.resize(uniqueCount);
+
+    // A function ends at the next function start or at the end of its section.
+    for (size_t index = 0; index < uniqueCount; ++index)
+    {
+        FunctionStart &functionStart = m_functionStarts[index];
+        const CodeSection *codeSection = findCodeSection(functionStart.m_address);
+        uint64_t end = codeSection->m_end;
+        if (index + 1 < uniqueCount)
+            end = std::min(end, m_functionStarts[index + 1].m_address);
+        functionStart.m_data = codeSection->m_data + (functionStart.m_address - codeSection->m_begin);
+        functionStart.m_size = static_cast<uint32_t>(end - functionStart.m_address);
+    }
+
+    // A vtable ends at the next symbol or at the end of its section.
+    std::sort(symbolAddresses.begin(), symbolAddresses.end());
+    for (size_t index = 0; index < m_vtables.size(); ++index)
+    {
+        const uint64_t address = vtableAddresses[index];
+        const LIEF::MachO::Section *section = binary.section_from_virtual_address(address);
+        if (section == nullptr || section->content().size() != section->size())
+            continue;
+
+        uint64_t end = section->address() + section->size();
+        auto it = std::upper_bound(symbolAddresses.begin(), symbolAddresses.end(), address);
+        if (it != symbolAddresses.end())
+            end = std::min(end, *it);
+        m_vtables[index].m_data = section->content().data() + (address - section->address());
+        m_vtables[index].m_size = static_cast<uint32_t>(end - address);
+    }
+
+    std::sort(m_typeInfos.begin(), m_typeInfos.end(), [](const TypeInfo &a, const TypeInfo &b) {
+        return a.m_address < b.m_address;
+    });
+    m_typeInfos.erase(
+        std::unique(
+            m_typeInfos.begin(),
+            m_typeInfos.end(),
+            [](const TypeInfo &a, const TypeInfo &b) { return a.m_address == b.m_address; }),
+        m_typeInfos.end());
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LIEF::MachO
+{
+class Binary;
+} // namespace LIEF::MachO
+
+// The parts of a binary that the function matcher reads. Functions are all known function starts: symbols in code
+// sections, LC_FUNCTION_STARTS and the stabs. Stripped builds still have their function starts. The bytes and names
+// are views into the binary and the functions.
+struct FunctionMatcherImage
+{
+    struct FunctionStart
+    {
+        uint64_t m_address = 0;
+        const uint8_t *m_data = nullptr;
+        uint32_t m_size = 0; // Up to the next function start or the end of the section.
+        std::string_view m_name; // Mangled name without the leading underscore of symbols. Empty if unknown.
+    };
+
+    struct VTable
+    {
+        std::string_view m_name; // Mangled name, which does not change between builds.
+        const uint8_t *m_data = nullptr;
+        uint32_t m_size = 0; // Up to the next symbol or the end of the section.
+    };
+
+    struct TypeInfo
+    {
+        uint64_t m_address = 0;
+        uint64_t m_nameHash = 0; // Hash of the mangled name.
+    };
+
+    // Reads the function starts, vtables and typeinfo objects. Returns false if the binary has no code section.
+    bool Read(const LIEF::MachO::Binary &binary, const Functions &functions);
+
+    // Returns the index of the function that starts at the address, or InvalidIndex.
+    index_t FindFunctionStart(uint64_t address) const;
+    // Returns the name hash of the typeinfo object at the address, or 0.
+    uint64_t FindTypeInfo(uint64_t address) const;
+
+    uint64_t m_imageBegin = 0; // Values in the image are treated as addresses, because they change between builds.
+    uint64_t m_imageEnd = 0;
+    std::vector<FunctionStart> m_functionStarts; // Sorted by address, unique.
+    std::vector<VTable> m_vtables;
+    std::vector<TypeInfo> m_typeInfos; // Sorted by address, unique.
+};
+
+inline index_t FunctionMatcherImage::FindFunctionStart(uint64_t address) const
+{
+    auto it = std::lower_bound(
+        m_functionStarts.begin(),
+        m_functionStarts.end(),
+        address,
+        [](const FunctionStart &functionStart, uint64_t value) { return functionStart.m_address < value; });
+    if (it == m_functionStarts.end() || it->m_address != address)
+        return InvalidIndex;
+    return static_cast<index_t>(it - m_functionStarts.begin());
+}
+
+inline uint64_t FunctionMatcherImage::FindTypeInfo(uint64_t address) const
+{
+    auto it = std::lower_bound(
+        m_typeInfos.begin(),
+        m_typeInfos.end(),
+        address,
+        [](const TypeInfo &typeInfo, uint64_t value) { return typeInfo.m_address < value; });
+    if (it == m_typeInfos.end() || it->m_address != address)
+        return 0;
+    return it->m_nameHash;
+}
@@ -0,0 +1,150 @@
+#include "IdenticalCodeIndex.h"
+
+#include "FunctionCode.h"
+#include "IncludeTable.h"
+#include "ThreadPool.h"
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+void IdenticalCodeIndex::Build(
+    const FunctionCode &functionCode,
+    const Functions &functions,
+    const IncludeTable &includeTable,
+    index_t headerFileCount,
+    ThreadPool &threadPool)
+{
+    std::vector<HashedVariant> variants;
+    variants.reserve(functionCode.GetVariants().size());
+    for (const FunctionCode::Variant &codeVariant : functionCode.GetVariants())
+    {
+        HashedVariant hashedVariant;
+        hashedVariant.m_variant.m_functionIndex = codeVariant.m_functionIndex;
+        hashedVariant.m_variant.m_variantIndex = codeVariant.m_variantIndex;
+        hashedVariant.m_data = codeVariant.m_data;
+        hashedVariant.m_size = codeVariant.m_size;
+        variants.push_back(hashedVariant);
+    }
+
+    threadPool.ParallelFor(variants.size(), [&variants](size_t index) {
+        HashedVariant &variant = variants[index];
+        variant.m_hash = XXH3_64bits(variant.m_data, variant.m_size);
+    });
+
+    BuildClusters(variants);
+
+    m_duplicateBytes = 0;
+    m_functionDuplicateBytes.assign(functions.size(), 0);
+    m_headerFileDuplicateBytes.assign(headerFileCount, 0);
+    for (const Cluster &cluster : m_clusters)
+    {
+        for (uint32_t i = 1; i < cluster.m_variantCount; ++i)
+        {
+            AddDuplicate(functions, includeTable, m_clusterVariants[cluster.m_variantBegin + i]);
+        }
+    }
+}
+
+tcb::span<const IdenticalCodeIndex::VariantRef> IdenticalCodeIndex::GetClusterVariants(index_t clusterIndex) const
+{
+    const Cluster &cluster = m_clusters[clusterIndex];
+    return tcb::span<const VariantRef>(m_clusterVariants.data() + cluster.m_variantBegin, cluster.m_variantCount);
+}
+
+uint64_t IdenticalCodeIndex::GetHeaderFileDuplicateBytes(index_t headerFileIndex) const
+{
+    return m_headerFileDuplicateBytes[headerFileIndex];
+}
+
+void IdenticalCodeIndex::BuildClusters(std::vector<HashedVariant> &variants)
+{
+    m_clusters.clear();
+    m_clusterVariants.clear();
+
+    // Equal hashes become neighbors. Variants keep their function order within equal hashes.
+    std::sort(variants.begin(), variants.end(), [](const HashedVariant &variant1, const HashedVariant &variant2) {
+        if (variant1.m_hash != variant2.m_hash)
+            return variant1.m_hash < variant2.m_hash;
+        if (variant1.m_size != variant2.m_size)
+            return variant1.m_size < variant2.m_size;
+        if (variant1.m_variant.m_functionIndex != variant2.m_variant.m_functionIndex)
+            return variant1.m_variant.m_functionIndex < variant2.m_variant.m_functionIndex;
+        return variant1.m_variant.m_variantIndex < variant2.m_variant.m_variantIndex;
+    });
+
+    std::vector<bool> clustered;
+    const size_t variantCount = variants.size();
+    size_t groupBegin = 0;
+    while (groupBegin < variantCount)
+    {
+        size_t groupEnd = groupBegin + 1;
+        while (groupEnd < variantCount && variants[groupEnd].m_hash == variants[groupBegin].m_hash
+               && variants[groupEnd].m_size == variants[groupBegin].m_size)
+        {
+            ++groupEnd;
+        }
+
+        // Compare the bytes, because different code can have the same hash.
+        clustered.assign(groupEnd - groupBegin, false);
+        for (size_t first = groupBegin; first < groupEnd; ++first)
+        {
+            if (clustered[first - groupBegin])
+                continue;
+
+            Cluster cluster;
+            cluster.m_hash = variants[first].m_hash;
+            cluster.m_size = variants[first].m_size;
+            cluster.m_variantBegin = static_cast<uint32_t>(m_clusterVariants.size());
+            m_clusterVariants.push_back(variants[first].m_variant);
+
+            for (size_t other = first + 1; other < groupEnd; ++other)
+            {
+                if (!clustered[other - groupBegin]
+                    && std::memcmp(variants[first].m_data, variants[other].m_data, cluster.m_size) == 0)
+                {
+                    clustered[other - groupBegin] = true;
+                    m_clusterVariants.push_back(variants[other].m_variant);
+                }
+            }
+
+            cluster.m_variantCount = static_cast<uint32_t>(m_clusterVariants.size()) - cluster.m_variantBegin;
+            if (cluster.m_variantCount > 1)
+            {
+                m_clusters.push_back(cluster);
+            }
+            else
+            {
+                m_clusterVariants.pop_back();
+            }
+        }
+
+        groupBegin = groupEnd;
+    }
+}
+
+void IdenticalCodeIndex::AddDuplicate(
+    const Functions &functions,
+    const IncludeTable &includeTable,
+    const VariantRef &variantRef)
+{
+    const FunctionVariant &variant = functions[variantRef.m_functionIndex].m_variants[variantRef.m_variantIndex];
+    m_duplicateBytes += variant.m_size;
+    m_functionDuplicateBytes[variantRef.m_functionIndex] += variant.m_size;
+
+    if (variant.m_includeSequenceIndex == InvalidIndex)
+        return;
+
+    includeTable.ForEachFileRange(
+        variant.m_includeSequenceIndex,
+        [this](const IncludeTableRow &row, uint64_t addressEnd) {
+            if (row.m_headerFileIndex != InvalidIndex)
+            {
+                assert(row.m_headerFileIndex < m_headerFileDuplicateBytes.size());
+                m_headerFileDuplicateBytes[row.m_headerFileIndex] += addressEnd - row.m_address;
+            }
+        });
+}
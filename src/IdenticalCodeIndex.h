@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+class FunctionCode;
+class ThreadPool;
+
+// Finds function variants with byte-identical code, such as copies of the same inline or template function that were
+// emitted into several translation units. Variant bytes are hashed in parallel, and clusters of equal hashes are
+// verified byte by byte. In every cluster the first variant is kept and all other variants count as duplicate bytes.
+class IdenticalCodeIndex
+{
+public:
+    struct VariantRef
+    {
+        index_t m_functionIndex = InvalidIndex;
+        uint32_t m_variantIndex = 0;
+    };
+
+    struct Cluster
+    {
+        uint64_t m_hash = 0;
+        uint32_t m_size = 0; // Size of one variant in bytes.
+        uint32_t m_variantBegin = 0;
+        uint32_t m_variantCount = 0; // At least 2.
+    };
+
+public:
+    void Build(
+        const FunctionCode &functionCode,
+        const Functions &functions,
+        const IncludeTable &includeTable,
+        index_t headerFileCount,
+        ThreadPool &threadPool);
+
+    index_t GetClusterCount() const { return static_cast<index_t>(m_clusters.size()); }
+    const Cluster &GetCluster(index_t clusterIndex) const { return m_clusters[clusterIndex]; }
+    tcb::span<const VariantRef> GetClusterVariants(index_t clusterIndex) const;
+
+    // Bytes of all variants that are identical to a kept variant.
+    uint64_t GetDuplicateBytes() const { return m_duplicateBytes; }
+    uint64_t GetFunctionDuplicateBytes(index_t functionIndex) const { return m_functionDuplicateBytes[functionIndex]; }
+    // Duplicate bytes that come from the header file, by the N_SOL ranges of the duplicate variants.
+    uint64_t GetHeaderFileDuplicateBytes(index_t headerFileIndex) const;
+
+private:
+    struct HashedVariant
+    {
+        VariantRef m_variant;
+        const uint8_t *m_data = nullptr;
+        uint32_t m_size = 0;
+        uint64_t m_hash = 0;
+    };
+
+    void BuildClusters(std::vector<HashedVariant> &variants);
+    void AddDuplicate(const Functions &functions, const IncludeTable &includeTable, const VariantRef &variant);
+
+private:
+    std::vector<Cluster> m_clusters;
+    std::vector<VariantRef> m_clusterVariants;
+
+    uint64_t m_duplicateBytes = 0;
+    std::vector<uint64_t> m_functionDuplicateBytes;
+    std::vector<uint64_t> m_headerFileDuplicateBytes;
+};
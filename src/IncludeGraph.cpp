@@ -0,0 +1,203 @@
+#include "IncludeGraph.h"
+
+#include "IncludeTable.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+void IncludeGraph::Build(
+    const SourceFiles &sourceFiles,
+    const HeaderFiles &headerFiles,
+    const Functions &functions,
+    const IncludeTable &includeTable,
+    ThreadPool &threadPool)
+{
+    const index_t sourceFileCount = sourceFiles.size();
+    const index_t headerFileCount = headerFiles.size();
+
+    std::vector<std::vector<Edge>> sourceEdges(sourceFileCount);
+    threadPool.ParallelFor(sourceFileCount, [&](size_t sourceFileIndex) {
+        CollectEdges(sourceFiles[sourceFileIndex], functions, includeTable, sourceEdges[sourceFileIndex]);
+    });
+
+    // Source file rows.
+    size_t edgeCount = 0;
+    for (const std::vector<Edge> &edges : sourceEdges)
+    {
+        edgeCount += edges.size();
+    }
+
+    m_sourceOffsets.clear();
+    m_sourceOffsets.reserve(sourceFileCount + 1);
+    m_sourceHeaders.clear();
+    m_sourceHeaders.reserve(edgeCount);
+    m_sourceHeaderBytes.clear();
+    m_sourceHeaderBytes.reserve(edgeCount);
+
+    std::vector<uint32_t> headerEdgeCounts(headerFileCount, 0);
+    m_headerCodeSizes.assign(headerFileCount, 0);
+
+    for (const std::vector<Edge> &edges : sourceEdges)
+    {
+        m_sourceOffsets.push_back(static_cast<uint32_t>(m_sourceHeaders.size()));
+        for (const Edge &edge : edges)
+        {
+            assert(edge.m_headerFileIndex < headerFileCount);
+            m_sourceHeaders.push_back(edge.m_headerFileIndex);
+            m_sourceHeaderBytes.push_back(edge.m_bytes);
+            ++headerEdgeCounts[edge.m_headerFileIndex];
+            m_headerCodeSizes[edge.m_headerFileIndex] += edge.m_bytes;
+        }
+    }
+    m_sourceOffsets.push_back(static_cast<uint32_t>(m_sourceHeaders.size()));
+
+    // Header file rows, transposed. Sources are visited in ascending order, so every row is sorted.
+    m_headerOffsets.assign(headerFileCount + 1, 0);
+    for (index_t headerFileIndex = 0; headerFileIndex < headerFileCount; ++headerFileIndex)
+    {
+        m_headerOffsets[headerFileIndex + 1] = m_headerOffsets[headerFileIndex] + headerEdgeCounts[headerFileIndex];
+    }
+
+    m_headerSources.resize(edgeCount);
+    m_headerSourceBytes.resize(edgeCount);
+    std::vector<uint32_t> nextEdge(m_headerOffsets.begin(), m_headerOffsets.end() - 1);
+    for (index_t sourceFileIndex = 0; sourceFileIndex < sourceFileCount; ++sourceFileIndex)
+    {
+        for (uint32_t i = m_sourceOffsets[sourceFileIndex]; i < m_sourceOffsets[sourceFileIndex + 1]; ++i)
+        {
+            const uint32_t edgeIndex = nextEdge[m_sourceHeaders[i]]++;
+            m_headerSources[edgeIndex] = sourceFileIndex;
+            m_headerSourceBytes[edgeIndex] = m_sourceHeaderBytes[i];
+        }
+    }
+}
+
+void IncludeGraph::CollectEdges(
+    const SourceFile &sourceFile,
+    const Functions &functions,
+    const IncludeTable &includeTable,
+    std::vector<Edge> &edges)
+{
+    for (index_t functionIndex : sourceFile.m_functionIndices)
+    {
+        for (const FunctionVariant &variant : functions[functionIndex].m_variants)
+        {
+            if (variant.m_includeSequenceIndex == InvalidIndex)
+                continue;
+
+            includeTable.ForEachFileRange(
+                variant.m_includeSequenceIndex,
+                [&edges](const IncludeTableRow &row, uint64_t addressEnd) {
+                    if (row.m_headerFileIndex != InvalidIndex)
+                    {
+                        edges.push_back({row.m_headerFileIndex, addressEnd - row.m_address});
+                    }
+                });
+        }
+    }
+
+    // Merge the edges of the same header.
+    std::sort(edges.begin(), edges.end(), [](const Edge &edge1, const Edge &edge2) {
+        return edge1.m_headerFileIndex < edge2.m_headerFileIndex;
+    });
+
+    size_t edgeCount = 0;
+    for (const Edge &edge : edges)
+    {
+        if (edgeCount != 0 && edges[edgeCount - 1].m_headerFileIndex == edge.m_headerFileIndex)
+        {
+            edges[edgeCount - 1].m_bytes += edge.m_bytes;
+        }
+        else
+        {
+            edges[edgeCount++] = edge;
+        }
+    }
+    edges.resize(edgeCount);
+}
+
+tcb::span<const index_t> IncludeGraph::GetHeaderFiles(index_t sourceFileIndex) const
+{
+    assert(sourceFileIndex < GetSourceFileCount());
+    const uint32_t begin = m_sourceOffsets[sourceFileIndex];
+    return tcb::span<const index_t>(m_sourceHeaders.data() + begin, m_sourceOffsets[sourceFileIndex + 1] - begin);
+}
+
+tcb::span<const uint64_t> IncludeGraph::GetHeaderFileBytes(index_t sourceFileIndex) const
+{
+    assert(sourceFileIndex < GetSourceFileCount());
+    const uint32_t begin = m_sourceOffsets[sourceFileIndex];
+    return tcb::span<const uint64_t>(m_sourceHeaderBytes.data() + begin, m_sourceOffsets[sourceFileIndex + 1] - begin);
+}
+
+tcb::span<const index_t> IncludeGraph::GetSourceFiles(index_t headerFileIndex) const
+{
+    assert(headerFileIndex < GetHeaderFileCount());
+    const uint32_t begin = m_headerOffsets[headerFileIndex];
+    return tcb::span<const index_t>(m_headerSources.data() + begin, m_headerOffsets[headerFileIndex + 1] - begin);
+}
+
+tcb::span<const uint64_t> IncludeGraph::GetSourceFileBytes(index_t headerFileIndex) const
+{
+    assert(headerFileIndex < GetHeaderFileCount());
+    const uint32_t begin = m_headerOffsets[headerFileIndex];
+    return tcb::span<const uint64_t>(m_headerSourceBytes.data() + begin, m_headerOffsets[headerFileIndex + 1] - begin);
+}
+
+index_t IncludeGraph::GetTranslationUnitCount(index_t headerFileIndex) const
+{
+    assert(headerFileIndex < GetHeaderFileCount());
+    return m_headerOffsets[headerFileIndex + 1] - m_headerOffsets[headerFileIndex];
+}
+
+std::vector<index_t> IncludeGraph::GetHeaderFilesByTranslationUnitCount(size_t count) const
+{
+    return GetTopHeaderFiles(count, [this](index_t headerFileIndex1, index_t headerFileIndex2) {
+        return GetTranslationUnitCount(headerFileIndex1) > GetTranslationUnitCount(headerFileIndex2);
+    });
+}
+
+std::vector<index_t> IncludeGraph::GetHeaderFilesByCodeSize(size_t count) const
+{
+    return GetTopHeaderFiles(count, [this](index_t headerFileIndex1, index_t headerFileIndex2) {
+        return m_headerCodeSizes[headerFileIndex1] > m_headerCodeSizes[headerFileIndex2];
+    });
+}
+
+template<typename Less>
+std::vector<index_t> IncludeGraph::GetTopHeaderFiles(size_t count, Less &&less) const
+{
+    const index_t headerFileCount = GetHeaderFileCount();
+    std::vector<index_t> headerFileIndices(headerFileCount);
+    for (index_t headerFileIndex = 0; headerFileIndex < headerFileCount; ++headerFileIndex)
+    {
+        headerFileIndices[headerFileIndex] = headerFileIndex;
+    }
+
+    // Ties keep the header file order.
+    auto stableLess = [&less](index_t headerFileIndex1, index_t headerFileIndex2) {
+        if (less(headerFileIndex1, headerFileIndex2))
+            return true;
+        if (less(headerFileIndex2, headerFileIndex1))
+            return false;
+        return headerFileIndex1 < headerFileIndex2;
+    };
+
+    count = std::min<size_t>(count, headerFileCount);
+    std::partial_sort(
+        headerFileIndices.begin(),
+        headerFileIndices.begin() + count,
+        headerFileIndices.end(),
+        stableLess);
+    headerFileIndices.resize(count);
+    return headerFileIndices;
+}
+
+size_t IncludeGraph::GetMemoryUsage() const
+{
+    return m_sourceOffsets.capacity() * sizeof(uint32_t) + m_sourceHeaders.capacity() * sizeof(index_t)
+        + m_sourceHeaderBytes.capacity() * sizeof(uint64_t) + m_headerOffsets.capacity() * sizeof(uint32_t)
+        + m_headerSources.capacity() * sizeof(index_t) + m_headerSourceBytes.capacity() * sizeof(uint64_t)
+        + m_headerCodeSizes.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+class ThreadPool;
+
+// Dependency graph between source files and the header files that contributed code to them, derived from the N_SOL
+// transitions of the include table. Edges are stored in compressed sparse row form in both directions, and every edge
+// carries the number of code bytes that come from the header.
+class IncludeGraph
+{
+public:
+    // Builds the graph from all function variants. Source files are processed in parallel.
+    void Build(
+        const SourceFiles &sourceFiles,
+        const HeaderFiles &headerFiles,
+        const Functions &functions,
+        const IncludeTable &includeTable,
+        ThreadPool &threadPool);
+
+    index_t GetSourceFileCount() const { return static_cast<index_t>(m_sourceOffsets.size()) - 1; }
+    index_t GetHeaderFileCount() const { return static_cast<index_t>(m_headerOffsets.size()) - 1; }
+
+    // Header files of a source file, ascending, and their code bytes.
+    tcb::span<const index_t> GetHeaderFiles(index_t sourceFileIndex) const;
+    tcb::span<const uint64_t> GetHeaderFileBytes(index_t sourceFileIndex) const;
+    // Source files of a header file, ascending, and their code bytes.
+    tcb::span<const index_t> GetSourceFiles(index_t headerFileIndex) const;
+    tcb::span<const uint64_t> GetSourceFileBytes(index_t headerFileIndex) const;
+
+    // Number of translation units that the header contributed code to.
+    index_t GetTranslationUnitCount(index_t headerFileIndex) const;
+    // Code bytes of the header over all translation units.
+    uint64_t GetCodeSize(index_t headerFileIndex) const { return m_headerCodeSizes[headerFileIndex]; }
+
+    // Gets up to count header files, ordered by translation unit count, descending.
+    std::vector<index_t> GetHeaderFilesByTranslationUnitCount(size_t count) const;
+    // Gets up to count header files, ordered by code size, descending.
+    std::vector<index_t> GetHeaderFilesByCodeSize(size_t count) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    struct Edge
+    {
+        index_t m_headerFileIndex;
+        uint64_t m_bytes;
+    };
+
+    static void CollectEdges(
+        const SourceFile &sourceFile,
+        const Functions &functions,
+        const IncludeTable &includeTable,
+        std::vector<Edge> &edges);
+
+    template<typename Less>
+    std::vector<index_t> GetTopHeaderFiles(size_t count, Less &&less) const;
+
+private:
+    // Source file to header files.
+    std::vector<uint32_t> m_sourceOffsets = {0};
+    std::vector<index_t> m_sourceHeaders;
+    std::vector<uint64_t> m_sourceHeaderBytes;
+
+    // Header file to source files.
+    std::vector<uint32_t> m_headerOffsets = {0};
+    std::vector<index_t> m_headerSources;
+    std::vector<uint64_t> m_headerSourceBytes;
+
+    std::vector<uint64_t> m_headerCodeSizes;
+};
@@ -0,0 +1,203 @@
+#include "IncludeTable.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+void WriteVarUInt(std::vector<uint8_t> &data, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t ReadVarUInt(const uint8_t *&data)
+{
+    uint64_t value = 0;
+    for (uint32_t shift = 0;; shift += 7)
+    {
+        const uint8_t byte = *data++;
+        value |= uint64_t(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+    return value;
+}
+
+uint64_t ZigZagEncode(int64_t value)
+{
+    return (uint64_t(value) << 1) ^ uint64_t(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value)
+{
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+} // namespace
+
+IncludeTable::Decoder::Decoder(const IncludeTable &table, index_t sequenceIndex)
+{
+    const Sequence &sequence = table.m_sequences[sequenceIndex];
+    m_data = table.m_data.data() + sequence.m_dataOffset;
+    m_rowsLeft = sequence.m_rowCount;
+    m_address = sequence.m_address;
+    m_fileId = 0;
+}
+
+bool IncludeTable::Decoder::Next(IncludeTableRow &row)
+{
+    if (m_rowsLeft == 0)
+        return false;
+
+    --m_rowsLeft;
+    m_address += ReadVarUInt(m_data);
+    m_fileId = static_cast<uint32_t>(int64_t(m_fileId) + ZigZagDecode(ReadVarUInt(m_data)));
+
+    row.m_address = m_address;
+    SplitFileId(m_fileId, row.m_headerFileIndex, row.m_sourceFileIndex);
+    return true;
+}
+
+uint32_t IncludeTable::MakeFileId(index_t headerFileIndex, index_t sourceFileIndex)
+{
+    if (headerFileIndex != InvalidIndex)
+        return (headerFileIndex << 1) | 1u;
+    assert(sourceFileIndex != InvalidIndex);
+    return sourceFileIndex << 1;
+}
+
+void IncludeTable::SplitFileId(uint32_t fileId, index_t &headerFileIndex, index_t &sourceFileIndex)
+{
+    if (fileId & 1u)
+    {
+        headerFileIndex = fileId >> 1;
+        sourceFileIndex = InvalidIndex;
+    }
+    else
+    {
+        headerFileIndex = InvalidIndex;
+        sourceFileIndex = fileId >> 1;
+    }
+}
+
+index_t IncludeTable::BeginSequence(uint64_t address, uint32_t size)
+{
+    assert(m_openSequenceIndex == InvalidIndex);
+
+    Sequence sequence;
+    sequence.m_address = address;
+    sequence.m_size = size;
+    sequence.m_dataOffset = static_cast<uint32_t>(m_data.size());
+    m_sequences.push_back(sequence);
+
+    m_openSequenceIndex = static_cast<index_t>(m_sequences.size() - 1);
+    m_lastAddress = address;
+    m_lastFileId = 0;
+    return m_openSequenceIndex;
+}
+
+void IncludeTable::AddRow(uint64_t address, index_t headerFileIndex, index_t sourceFileIndex)
+{
+    assert(m_openSequenceIndex != InvalidIndex);
+    assert(address >= m_lastAddress);
+
+    Sequence &sequence = m_sequences[m_openSequenceIndex];
+    const uint32_t fileId = MakeFileId(headerFileIndex, sourceFileIndex);
+    if (sequence.m_rowCount != 0 && fileId == m_lastFileId)
+        return; // File did not change.
+
+    WriteVarUInt(m_data, address - m_lastAddress);
+    WriteVarUInt(m_data, ZigZagEncode(int64_t(fileId) - int64_t(m_lastFileId)));
+    ++sequence.m_rowCount;
+    m_lastAddress = address;
+    m_lastFileId = fileId;
+}
+
+void IncludeTable::EndSequence()
+{
+    assert(m_openSequenceIndex != InvalidIndex);
+    m_openSequenceIndex = InvalidIndex;
+}
+
+void IncludeTable::Finalize()
+{
+    assert(m_openSequenceIndex == InvalidIndex);
+
+    const index_t count = GetSequenceCount();
+    m_sortedSequenceIndices.resize(count);
+    for (index_t i = 0; i < count; ++i)
+    {
+        m_sortedSequenceIndices[i] = i;
+    }
+    std::stable_sort(m_sortedSequenceIndices.begin(), m_sortedSequenceIndices.end(), [this](index_t a, index_t b) {
+        return m_sequences[a].m_address < m_sequences[b].m_address;
+    });
+
+    m_data.shrink_to_fit();
+    m_sequences.shrink_to_fit();
+}
+
+void IncludeTable::GetRows(index_t sequenceIndex, std::vector<IncludeTableRow> &rows) const
+{
+    Decoder decoder(*this, sequenceIndex);
+    IncludeTableRow row;
+    while (decoder.Next(row))
+    {
+        rows.push_back(row);
+    }
+}
+
+bool IncludeTable::FindRow(index_t sequenceIndex, uint64_t address, IncludeTableRow &row) const
+{
+    Decoder decoder(*this, sequenceIndex);
+    IncludeTableRow nextRow;
+    bool found = false;
+    while (decoder.Next(nextRow))
+    {
+        if (nextRow.m_address > address)
+            break;
+        row = nextRow;
+        found = true;
+    }
+    return found;
+}
+
+index_t IncludeTable::FindSequence(uint64_t address) const
+{
+    const size_t i = FindFirstSortedSequence(address);
+    if (i < m_sortedSequenceIndices.size())
+    {
+        const Sequence &sequence = m_sequences[m_sortedSequenceIndices[i]];
+        if (address >= sequence.m_address && address < sequence.m_address + sequence.m_size)
+            return m_sortedSequenceIndices[i];
+    }
+    return InvalidIndex;
+}
+
+size_t IncludeTable::GetMemoryUsage() const
+{
+    return m_data.capacity() * sizeof(uint8_t) + m_sequences.capacity() * sizeof(Sequence)
+        + m_sortedSequenceIndices.capacity() * sizeof(index_t);
+}
+
+size_t IncludeTable::FindFirstSortedSequence(uint64_t address) const
+{
+    // First sequence that ends after the address.
+    auto it = std::upper_bound(
+        m_sortedSequenceIndices.begin(),
+        m_sortedSequenceIndices.end(),
+        address,
+        [this](uint64_t value, index_t sequenceIndex) { return value < m_sequences[sequenceIndex].m_address; });
+
+    if (it != m_sortedSequenceIndices.begin())
+    {
+        const Sequence &previous = m_sequences[*(it - 1)];
+        if (address < previous.m_address + previous.m_size)
+            --it;
+    }
+    return static_cast<size_t>(it - m_sortedSequenceIndices.begin());
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+struct IncludeTableRow
+{
+    uint64_t m_address = 0; // Address at which the file becomes active.
+    index_t m_headerFileIndex = InvalidIndex; // Set if the code at this address comes from a header file.
+    index_t m_sourceFileIndex = InvalidIndex; // Set if the code at this address comes from the source file.
+};
+
+// Compact table of all N_SOL file transitions, in the spirit of DWARF line programs.
+// Every function variant owns one sequence of rows. A row is encoded as two varints:
+// the address delta to the previous row (the first row is relative to the function begin address)
+// and the zigzag encoded delta of the file id to the previous row. Rows that do not change the file are dropped.
+class IncludeTable
+{
+public:
+    struct Sequence
+    {
+        uint64_t m_address = 0; // Function variant begin address.
+        uint32_t m_size = 0; // Function variant size in bytes.
+        uint32_t m_dataOffset = 0; // Offset of the first row in the encoded data.
+        uint32_t m_rowCount = 0;
+    };
+
+    // Decodes the rows of a single sequence front to back.
+    class Decoder
+    {
+    public:
+        Decoder(const IncludeTable &table, index_t sequenceIndex);
+
+        bool Next(IncludeTableRow &row);
+
+    private:
+        const uint8_t *m_data;
+        uint32_t m_rowsLeft;
+        uint64_t m_address;
+        uint32_t m_fileId;
+    };
+
+public:
+    // File ids interleave source files (even) and header files (odd).
+    static uint32_t MakeFileId(index_t headerFileIndex, index_t sourceFileIndex);
+    static void SplitFileId(uint32_t fileId, index_t &headerFileIndex, index_t &sourceFileIndex);
+
+    // Streaming build interface. Rows must be added in ascending address order.
+    index_t BeginSequence(uint64_t address, uint32_t size);
+    void AddRow(uint64_t address, index_t headerFileIndex, index_t sourceFileIndex);
+    void EndSequence();
+
+    // Builds the address ordered sequence index. Call once after all sequences are added.
+    void Finalize();
+
+    index_t GetSequenceCount() const { return static_cast<index_t>(m_sequences.size()); }
+    const Sequence &GetSequence(index_t sequenceIndex) const { return m_sequences[sequenceIndex]; }
+    void GetRows(index_t sequenceIndex, std::vector<IncludeTableRow> &rows) const;
+
+    // Finds the row that is active at the given address, if any.
+    bool FindRow(index_t sequenceIndex, uint64_t address, IncludeTableRow &row) const;
+
+    // Finds the sequence that contains the given address, if any. Requires Finalize.
+    index_t FindSequence(uint64_t address) const;
+
+    // Calls callback(row, addressEnd) for every row of the sequence, where addressEnd is the address of the next row or
+    // the end of the sequence.
+    template<typename Callback>
+    void ForEachFileRange(index_t sequenceIndex, Callback &&callback) const;
+
+    const std::vector<uint8_t> &GetData() const { return m_data; }
+    size_t GetMemoryUsage() const;
+
+private:
+    size_t FindFirstSortedSequence(uint64_t address) const;
+
+private:
+    std::vector<uint8_t> m_data;
+    std::vector<Sequence> m_sequences;
+    std::vector<index_t> m_sortedSequenceIndices; // Sequence indices ordered by address.
+    index_t m_openSequenceIndex = InvalidIndex;
+    uint64_t m_lastAddress = 0;
+    uint32_t m_lastFileId = 0;
+};
+
+template<typename Callback>
+void IncludeTable::ForEachFileRange(index_t sequenceIndex, Callback &&callback) const
+{
+    Decoder decoder(*this, sequenceIndex);
+    IncludeTableRow row;
+    if (!decoder.Next(row))
+        return;
+
+    IncludeTableRow nextRow;
+    while (decoder.Next(nextRow))
+    {
+        callback(row, nextRow.m_address);
+        row = nextRow;
+    }
+
+    const Sequence &sequence = m_sequences[sequenceIndex];
+    const uint64_t sequenceEnd = sequence.m_address + sequence.m_size;
+    if (sequenceEnd > row.m_address)
+    {
+        callback(row, sequenceEnd);
+    }
+}
@@ -0,0 +1,182 @@
+#include "LineTable.h"
+#include "IncludeTable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+namespace
+{
+constexpr uint32_t InvalidFileId = ~uint32_t(0);
+}
+
+index_t LineTable::BeginRange(uint64_t address, index_t functionIndex)
+{
+    assert(m_openRangeIndex == InvalidIndex);
+
+    Range range;
+    range.m_address = address;
+    range.m_rowBegin = static_cast<uint32_t>(m_rowOffsets.size());
+    range.m_functionIndex = functionIndex;
+    m_ranges.push_back(range);
+
+    m_openRangeIndex = static_cast<index_t>(m_ranges.size() - 1);
+    return m_openRangeIndex;
+}
+
+void LineTable::AddRow(uint64_t address, uint16_t line)
+{
+    assert(m_openRangeIndex != InvalidIndex);
+
+    Range &range = m_ranges[m_openRangeIndex];
+    assert(address >= range.m_address);
+    assert(address - range.m_address <= 0xffffffffu);
+
+    m_rowOffsets.push_back(static_cast<uint32_t>(address - range.m_address));
+    m_rowLines.push_back(line);
+    m_rowFileIds.push_back(InvalidFileId);
+    ++range.m_rowCount;
+}
+
+void LineTable::EndRange(uint32_t size, const IncludeTable &includeTable, index_t includeSequenceIndex)
+{
+    assert(m_openRangeIndex != InvalidIndex);
+
+    Range &range = m_ranges[m_openRangeIndex];
+    range.m_size = size;
+    m_openRangeIndex = InvalidIndex;
+
+    const uint32_t rowBegin = range.m_rowBegin;
+    const uint32_t rowEnd = rowBegin + range.m_rowCount;
+
+    if (!std::is_sorted(m_rowOffsets.begin() + rowBegin, m_rowOffsets.begin() + rowEnd))
+    {
+        // Rarely needed. Reorder the rows of this range by offset, keeping the emission order of equal offsets.
+        std::vector<uint32_t> order(range.m_rowCount);
+        std::iota(order.begin(), order.end(), rowBegin);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+            return m_rowOffsets[a] < m_rowOffsets[b];
+        });
+
+        std::vector<uint32_t> offsets(range.m_rowCount);
+        std::vector<uint16_t> lines(range.m_rowCount);
+        for (uint32_t i = 0; i < range.m_rowCount; ++i)
+        {
+            offsets[i] = m_rowOffsets[order[i]];
+            lines[i] = m_rowLines[order[i]];
+        }
+        std::copy(offsets.begin(), offsets.end(), m_rowOffsets.begin() + rowBegin);
+        std::copy(lines.begin(), lines.end(), m_rowLines.begin() + rowBegin);
+    }
+
+    if (includeSequenceIndex == InvalidIndex)
+        return;
+
+    // Walk the rows and the include sequence side by side. Both are in ascending address order.
+    IncludeTable::Decoder decoder(includeTable, includeSequenceIndex);
+    IncludeTableRow includeRow;
+    IncludeTableRow nextIncludeRow;
+    bool hasIncludeRow = false;
+    bool hasNextIncludeRow = decoder.Next(nextIncludeRow);
+
+    for (uint32_t row = rowBegin; row < rowEnd; ++row)
+    {
+        const uint64_t address = range.m_address + m_rowOffsets[row];
+        while (hasNextIncludeRow && nextIncludeRow.m_address <= address)
+        {
+            includeRow = nextIncludeRow;
+            hasIncludeRow = true;
+            hasNextIncludeRow = decoder.Next(nextIncludeRow);
+        }
+        if (hasIncludeRow)
+        {
+            m_rowFileIds[row] = IncludeTable::MakeFileId(includeRow.m_headerFileIndex, includeRow.m_sourceFileIndex);
+        }
+    }
+}
+
+void LineTable::Finalize()
+{
+    assert(m_openRangeIndex == InvalidIndex);
+
+    const index_t count = GetRangeCount();
+    m_sortedRangeIndices.resize(count);
+    std::iota(m_sortedRangeIndices.begin(), m_sortedRangeIndices.end(), index_t(0));
+    std::stable_sort(m_sortedRangeIndices.begin(), m_sortedRangeIndices.end(), [this](index_t a, index_t b) {
+        return m_ranges[a].m_address < m_ranges[b].m_address;
+    });
+
+    m_sortedRangeAddresses.resize(count);
+    for (index_t i = 0; i < count; ++i)
+    {
+        m_sortedRangeAddresses[i] = m_ranges[m_sortedRangeIndices[i]].m_address;
+    }
+
+    m_ranges.shrink_to_fit();
+    m_rowOffsets.shrink_to_fit();
+    m_rowLines.shrink_to_fit();
+    m_rowFileIds.shrink_to_fit();
+}
+
+LineTableRow LineTable::GetRow(index_t rangeIndex, uint32_t rowIndex) const
+{
+    const Range &range = m_ranges[rangeIndex];
+    assert(rowIndex < range.m_rowCount);
+
+    const uint32_t row = range.m_rowBegin + rowIndex;
+    LineTableRow lineRow;
+    lineRow.m_address = range.m_address + m_rowOffsets[row];
+    lineRow.m_line = m_rowLines[row];
+    if (m_rowFileIds[row] != InvalidFileId)
+    {
+        IncludeTable::SplitFileId(m_rowFileIds[row], lineRow.m_headerFileIndex, lineRow.m_sourceFileIndex);
+    }
+    return lineRow;
+}
+
+index_t LineTable::FindRange(uint64_t address) const
+{
+    auto it = std::upper_bound(m_sortedRangeAddresses.begin(), m_sortedRangeAddresses.end(), address);
+    if (it == m_sortedRangeAddresses.begin())
+        return InvalidIndex;
+
+    const index_t rangeIndex = m_sortedRangeIndices[(it - m_sortedRangeAddresses.begin()) - 1];
+    const Range &range = m_ranges[rangeIndex];
+    if (address >= range.m_address + range.m_size)
+        return InvalidIndex;
+
+    return rangeIndex;
+}
+
+bool LineTable::FindLine(uint64_t address, LineTableRow &row) const
+{
+    const index_t rangeIndex = FindRange(address);
+    if (rangeIndex == InvalidIndex)
+        return false;
+
+    return FindLine(rangeIndex, address, row);
+}
+
+bool LineTable::FindLine(index_t rangeIndex, uint64_t address, LineTableRow &row) const
+{
+    const Range &range = m_ranges[rangeIndex];
+    if (address < range.m_address)
+        return false;
+
+    const uint64_t offset = address - range.m_address;
+    const auto begin = m_rowOffsets.begin() + range.m_rowBegin;
+    const auto end = begin + range.m_rowCount;
+    const auto it = std::upper_bound(begin, end, offset);
+    if (it == begin)
+        return false;
+
+    row = GetRow(rangeIndex, static_cast<uint32_t>((it - begin) - 1));
+    return true;
+}
+
+size_t LineTable::GetMemoryUsage() const
+{
+    return m_ranges.capacity() * sizeof(Range) + m_sortedRangeAddresses.capacity() * sizeof(uint64_t)
+        + m_sortedRangeIndices.capacity() * sizeof(index_t) + m_rowOffsets.capacity() * sizeof(uint32_t)
+        + m_rowLines.capacity() * sizeof(uint16_t) + m_rowFileIds.capacity() * sizeof(uint32_t);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <vector>
+
+class IncludeTable;
+
+struct LineTableRow
+{
+    uint64_t m_address = 0;
+    uint16_t m_line = 0; // Source line from N_SLINE description.
+    index_t m_headerFileIndex = InvalidIndex; // Set if the line belongs to a header file.
+    index_t m_sourceFileIndex = InvalidIndex; // Set if the line belongs to the source file.
+};
+
+// Table of all N_SLINE entries. Every function variant owns one address range with rows sorted by address.
+// Rows are stored as packed parallel arrays, so that address to line lookups are two binary searches:
+// one over the sorted range begin addresses and one over the row offsets of the found range.
+class LineTable
+{
+public:
+    struct Range
+    {
+        uint64_t m_address = 0; // Function variant begin address.
+        uint32_t m_size = 0; // Function variant size in bytes.
+        uint32_t m_rowBegin = 0; // First row in the packed arrays.
+        uint32_t m_rowCount = 0;
+        index_t m_functionIndex = InvalidIndex;
+    };
+
+public:
+    // Streaming build interface. Rows may be added in any address order.
+    index_t BeginRange(uint64_t address, index_t functionIndex);
+    void AddRow(uint64_t address, uint16_t line);
+    // Sorts the rows of the open range and assigns their files from the matching include table sequence.
+    void EndRange(uint32_t size, const IncludeTable &includeTable, index_t includeSequenceIndex);
+
+    // Builds the address ordered range index. Call once after all ranges are added.
+    void Finalize();
+
+    index_t GetRangeCount() const { return static_cast<index_t>(m_ranges.size()); }
+    const Range &GetRange(index_t rangeIndex) const { return m_ranges[rangeIndex]; }
+    LineTableRow GetRow(index_t rangeIndex, uint32_t rowIndex) const;
+
+    // Finds the range that contains the given address, if any. Requires Finalize.
+    index_t FindRange(uint64_t address) const;
+    // Finds the line that covers the given address, if any. Requires Finalize.
+    bool FindLine(uint64_t address, LineTableRow &row) const;
+    bool FindLine(index_t rangeIndex, uint64_t address, LineTableRow &row) const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    std::vector<Range> m_ranges;
+    std::vector<uint64_t> m_sortedRangeAddresses; // Range begin addresses in ascending order.
+    std::vector<index_t> m_sortedRangeIndices; // Range indices in the order of m_sortedRangeAddresses.
+
+    // Packed rows. Offsets are relative to the range begin address.
+    std::vector<uint32_t> m_rowOffsets;
+    std::vector<uint16_t> m_rowLines;
+    std::vector<uint32_t> m_rowFileIds; // See IncludeTable::MakeFileId.
+
+    index_t m_openRangeIndex = InvalidIndex;
+};
@@ -1,10 +1,14 @@
 #include "MachOReader.h"
+#include "DebugMap.h"
+#include "ThreadPool.h"
 #include "rtti.h"
 #include "utility.h"
 
 #include <LIEF/LIEF.hpp>
 #include <LIEF/MachO.hpp>
 
+#include <fmt/core.h>
+
 #include "llvm/demangle.h"
 #include <llvm/Demangle/Demangle.h>
 
@@ -12,7 +16,8 @@
 #include <mach-o/reloc.h>
 #include <mach-o/stab.h>
 
-MachOReader::MachOReader()
+MachOReader::MachOReader(const MachOReaderOptions &options)
+    : m_options(options), m_threadPool(std::make_unique<ThreadPool>(options.m_threadCount))
 {
 }
 
@@ -108,6 +113,38 @@ std::string MakeFunctionNameWithNewClassName(std::string_view functionName, std:
     return std::string(newClassName).append("::").append(func);
 }
 
+// Gets a key that is equal for the complete, base and allocating constructor and destructor variants of a function,
+// without demangling. Only the source names of a nested name are skipped, so variants of constructors in templates or
+// substituted scopes keep their own keys.
+std::string GetFunctionVariantKey(std::string_view mangled)
+{
+    std::string key(mangled);
+    if (!starts_with(mangled, "_ZN"))
+        return key;
+
+    size_t pos = 3;
+    while (pos < key.size() && (key[pos] == 'r' || key[pos] == 'V' || key[pos] == 'K'))
+        ++pos;
+
+    while (pos < key.size() && key[pos] >= '1' && key[pos] <= '9')
+    {
+        size_t length = 0;
+        while (pos < key.size() && key[pos] >= '0' && key[pos] <= '9')
+            length = length * 10 + (key[pos++] - '0');
+        pos += length;
+    }
+
+    if (pos + 1 < key.size())
+    {
+        char &variant = key[pos + 1];
+        if (key[pos] == 'C' && variant >= '1' && variant <= '3')
+            variant = '1';
+        else if (key[pos] == 'D' && variant >= '0' && variant <= '2')
+            variant = '1';
+    }
+    return key;
+}
+
 void MachOReader::Patch(LIEF::MachO::Binary &binary)
 {
     uint32_t symbolId = 0;
@@ -158,20 +195,218 @@ void MachOReader::Patch(LIEF::MachO::Binary &binary)
 }
 
 bool MachOReader::Parse(const LIEF::MachO::Binary &binary)
+{
+    LIEF::MachO::Binary::it_const_symbols symbols = binary.symbols();
+
+    // Symbol entries reference the names owned by the binary.
+    SymbolEntries symbolEntries;
+    symbolEntries.reserve(symbols.size());
+    for (const LIEF::MachO::Symbol &symbol : symbols)
+    {
+        SymbolEntry entry;
+        entry.m_name = symbol.name();
+        entry.m_value = symbol.value();
+        entry.m_description = symbol.description();
+        entry.m_type = symbol.raw_type();
+        entry.m_section = symbol.numberof_sections();
+        symbolEntries.push_back(entry);
+    }
+
+    DebugMap debugMap;
+    if (m_options.m_followObjectFiles && debugMap.Load(symbolEntries, *m_threadPool))
+    {
+        ParseSymbols(debugMap.GetSymbols());
+    }
+    else
+    {
+        ParseSymbols(symbolEntries);
+    }
+
+    ResolveGlobalVariableAddresses(symbolEntries);
+
+    m_includeTable.Finalize();
+    m_lineTable.Finalize();
+    m_functionCode.Build(binary, m_functions);
+
+    if (m_options.m_findIdenticalCode)
+    {
+        m_identicalCodeIndex.Build(m_functionCode, m_functions, m_includeTable, m_headerFiles.size(), *m_threadPool);
+    }
+
+    BuildDataAddressIndex(binary);
+
+    if (m_options.m_lazyDemangling)
+    {
+        m_functionDemangled = std::make_unique<std::atomic<bool>[]>(m_functions.size());
+    }
+    else
+    {
+        EnsureClassModel();
+    }
+
+    return true;
+}
+
+const Function &MachOReader::GetFunction(index_t functionIndex)
+{
+    EnsureFunctionDemangled(functionIndex);
+    return m_functions[functionIndex];
+}
+
+const Functions &MachOReader::GetFunctions()
+{
+    DemangleAllFunctions();
+    EnsureClassModel();
+    return m_functions;
+}
+
+index_t MachOReader::FindFunctionByAddress(uint64_t address) const
+{
+    const index_t rangeIndex = m_lineTable.FindRange(address);
+    if (rangeIndex == InvalidIndex)
+        return InvalidIndex;
+
+    return m_lineTable.GetRange(rangeIndex).m_functionIndex;
+}
+
+const Namespaces &MachOReader::GetNamespaces()
+{
+    EnsureClassModel();
+    return m_namespaces;
+}
+
+const Classes &MachOReader::GetClasses()
+{
+    EnsureClassModel();
+    return m_classes;
+}
+
+const ScopeTrie &MachOReader::GetScopeTrie()
+{
+    EnsureClassModel();
+    return m_scopeTrie;
+}
+
+const ClassHierarchy &MachOReader::GetClassHierarchy()
+{
+    EnsureClassModel();
+    return m_classHierarchy;
+}
+
+const VirtualOverrideIndex &MachOReader::GetVirtualOverrideIndex()
+{
+    EnsureClassModel();
+    return m_virtualOverrideIndex;
+}
+
+const TemplateIndex &MachOReader::GetTemplateIndex()
+{
+    EnsureClassModel();
+    std::call_once(m_templateIndexOnce, [this]() { m_templateIndex.Build(m_classes, m_functions); });
+    return m_templateIndex;
+}
+
+const NameSearchIndex &MachOReader::GetNameSearchIndex()
+{
+    DemangleAllFunctions();
+    EnsureClassModel();
+    std::call_once(m_nameSearchIndexOnce, [this]() {
+        m_nameSearchIndex.Build(m_functions, m_classes, m_namespaces, *m_threadPool);
+    });
+    return m_nameSearchIndex;
+}
+
+const CallGraph &MachOReader::GetCallGraph()
+{
+    std::call_once(m_callGraphOnce, [this]() {
+        m_callGraph.Build(*m_binary, m_functionCode, GetFunctionCount(), m_thunks, m_lineTable, *m_threadPool);
+    });
+    return m_callGraph;
+}
+
+const FieldLayoutInference &MachOReader::GetFieldLayoutInference()
+{
+    EnsureClassModel();
+    std::call_once(m_fieldLayoutInferenceOnce, [this]() {
+        m_fieldLayoutInference.Build(
+            m_functionCode, m_vtableAddressIndex, m_functions, m_classes.size(), *m_threadPool);
+    });
+    return m_fieldLayoutInference;
+}
+
+const ConstructorAnalysis &MachOReader::GetConstructorAnalysis()
+{
+    EnsureClassModel();
+    std::call_once(m_constructorAnalysisOnce, [this]() {
+        m_constructorAnalysis.Build(
+            *m_binary, m_functionCode, m_vtableAddressIndex, m_functions, m_classes.size(), *m_threadPool);
+    });
+    return m_constructorAnalysis;
+}
+
+const IncludeGraph &MachOReader::GetIncludeGraph()
+{
+    std::call_once(m_includeGraphOnce, [this]() {
+        m_includeGraph.Build(m_sourceFiles, m_headerFiles, m_functions, m_includeTable, *m_threadPool);
+    });
+    return m_includeGraph;
+}
+
+std::string_view MachOReader::GetVTableEntryName(const VTableEntry &entry) const
+{
+    if (entry.GetThunkIndex() != InvalidIndex)
+        return m_thunks[entry.GetThunkIndex()].m_name;
+    if (entry.GetFunctionIndex() != InvalidIndex)
+        return m_functions[entry.GetFunctionIndex()].m_name;
+    if (entry.m_nameId != InvalidIndex)
+        return m_pureVirtualNames[entry.m_nameId];
+    return std::string_view();
+}
+
+const Variables &MachOReader::GetVariables()
+{
+    // Variables are attached to classes and namespaces with the class model.
+    EnsureClassModel();
+    return m_variables;
+}
+
+const Types &MachOReader::GetTypes()
+{
+    // Class types can be added with the class model.
+    EnsureClassModel();
+    return m_types;
+}
+
+const Enums &MachOReader::GetEnums()
+{
+    EnsureClassModel();
+    return m_enums;
+}
+
+const std::vector<std::string_view> &MachOReader::GetTypeNames()
+{
+    DemangleAllFunctions();
+    EnsureClassModel();
+    return m_typeNames;
+}
+
+void MachOReader::ParseSymbols(const SymbolEntries &symbols)
 {
     index_t functionIndex = InvalidIndex;
     bool SO_InBlock = false;
     std::string SO_Prefix;
+    // Header file names by N_SOL name. Keys reference symbol names owned by the binary or object files.
+    StringViewToIndexMap SOL_headerFileCache;
 
-    LIEF::MachO::Binary::it_const_symbols symbols = binary.symbols();
-    auto SOL_begin = symbols.end();
-    auto SOL_end = symbols.end();
+    const size_t symbolCount = symbols.size();
+    size_t SOL_begin = symbolCount;
+    size_t SOL_end = symbolCount;
 
-    for (auto it = symbols.begin(); it != symbols.end(); ++it)
+    for (size_t i = 0; i < symbolCount; ++i)
     {
-        const LIEF::MachO::Symbol &symbol = *it;
+        const SymbolEntry &symbol = symbols[i];
 
-        switch (symbol.raw_type())
+        switch (symbol.m_type)
         {
             case N_PEXT | N_SECT: {
                 Parse_PEXT_thunks(symbol);
@@ -183,32 +418,66 @@ bool MachOReader::Parse(const LIEF::MachO::Binary &binary)
             }
             case N_FUN: /* procedure: name,,n_sect,linenumber,address */ {
                 Parse_FUN(symbol, functionIndex);
-                // Parse SOL range after function has been parsed.
-                if (symbol.name().empty())
+                if (!symbol.m_name.empty())
+                {
+                    // Collect SLINE entries until the end of the function.
+                    if (functionIndex != InvalidIndex)
+                    {
+                        FunctionVariant &variant = m_functions[functionIndex].m_variants.back();
+                        variant.m_lineRangeIndex = m_lineTable.BeginRange(variant.m_address, functionIndex);
+                    }
+                }
+                else
                 {
+                    // Parse SOL range after function has been parsed.
                     if (functionIndex != InvalidIndex)
                     {
-                        for (auto SOL_it = SOL_begin; SOL_it != SOL_end; ++SOL_it)
+                        FunctionVariant &variant = m_functions[functionIndex].m_variants.back();
+                        variant.m_includeSequenceIndex = m_includeTable.BeginSequence(variant.m_address, variant.m_size);
+                        for (size_t SOL_i = SOL_begin; SOL_i < SOL_end; ++SOL_i)
                         {
-                            const LIEF::MachO::Symbol &SOL_symbol = *SOL_it;
-                            if (SOL_symbol.raw_type() == N_SOL)
+                            const SymbolEntry &SOL_symbol = symbols[SOL_i];
+                            if (SOL_symbol.m_type == N_SOL)
                             {
-                                Parse_SOL(SOL_symbol, SO_Prefix, functionIndex);
+                                Parse_SOL(SOL_symbol, SO_Prefix, functionIndex, SOL_headerFileCache);
                             }
                         }
+                        m_includeTable.EndSequence();
+                        m_lineTable.EndRange(variant.m_size, m_includeTable, variant.m_includeSequenceIndex);
                     }
-                    SOL_begin = symbols.end();
-                    SOL_end = symbols.end();
+                    SOL_begin = symbolCount;
+                    SOL_end = symbolCount;
                     functionIndex = InvalidIndex;
                 }
                 break;
             }
+            case N_LSYM: /* local sym: name,,NO_SECT,type,offset */
+            case N_SSYM: /* structure elt: name,,NO_SECT,type,struct_offset */ {
+                Parse_LSYM(symbol);
+                break;
+            }
+            case N_PSYM: /* parameter: name,,NO_SECT,type,offset */ {
+                Parse_PSYM(symbol, functionIndex);
+                break;
+            }
+            case N_BINCL: /* include file beginning: name,,NO_SECT,0,sum */ {
+                Parse_BINCL(symbol);
+                break;
+            }
+            case N_EXCL: /* deleted include file: name,,NO_SECT,0,sum */ {
+                Parse_EXCL(symbol);
+                break;
+            }
+            case N_SLINE: /* src line: 0,,n_sect,linenumber,address */ {
+                Parse_SLINE(symbol, functionIndex);
+                break;
+            }
             case N_STSYM: /* static symbol: name,,n_sect,type,address */ {
-                Parse_STSYM(symbol);
+                Parse_STSYM(symbol, functionIndex);
                 break;
             }
             case N_LCSYM: /* .lcomm symbol: name,,n_sect,type,address */ {
-                Parse_LCSYM(symbol);
+                Parse_LCSYM(symbol, functionIndex);
                 break;
             }
             case N_SO: /* source file name: name,,n_sect,0,address */ {
@@ -216,9 +485,9 @@ bool MachOReader::Parse(const LIEF::MachO::Binary &binary)
                 break;
             }
             case N_SOL: /* #included file name: name,,n_sect,0,address */ {
-                if (SOL_begin == symbols.end())
-                    SOL_begin = it;
-                SOL_end = it + 1;
+                if (SOL_begin == symbolCount)
+                    SOL_begin = i;
+                SOL_end = i + 1;
                 break;
             }
             case N_OPT: /* emitted with gcc2_compiled and in gcc source */
@@ -226,51 +495,27 @@ bool MachOReader::Parse(const LIEF::MachO::Binary &binary)
                 break;
         }
     }
-
-    for (auto it = symbols.begin(); it != symbols.end(); ++it)
-    {
-        const LIEF::MachO::Symbol &symbol = *it;
-
-        switch (symbol.raw_type())
-        {
-            case N_PEXT | N_SECT: {
-                Parse_PEXT_typeinfo(binary, symbol);
-                Parse_PEXT_vtable(binary, symbol);
-                break;
-            }
-        }
-    }
-
-    // Generate classes from functions because not all classes have RTTI.
-    GenerateClassesFromFunctions();
-
-    // Additional base class links need to be build before processing vtables.
-    BuildBaseClassLinks();
-
-    ProcessVtables();
-
-    return true;
 }
 
-void MachOReader::Parse_PEXT_thunks(const LIEF::MachO::Symbol &symbol)
+void MachOReader::Parse_PEXT_thunks(const SymbolEntry &symbol)
 {
-    if (starts_with(symbol.name(), "__ZThn")) // non-virtual thunk to ...
+    if (starts_with(symbol.m_name, "__ZThn")) // non-virtual thunk to ...
     {
         // Cannot use llvm::ItaniumPartialDemangler to get function details.
-        std::string thunkName = llvm::itaniumDemangle(symbol.name().c_str(), nullptr, nullptr, nullptr);
+        std::string thunkName = llvm::itaniumDemangle(std::string(symbol.m_name).c_str(), nullptr, nullptr, nullptr);
         thunkName.erase(0, 21); // Erase "non-virtual thunk to "
 
-        AddressToIndexMap::iterator it = m_addressToThunkIndex.find(symbol.value());
+        AddressToIndexMap::iterator it = m_addressToThunkIndex.find(symbol.m_value);
         assert(it == m_addressToThunkIndex.end());
 
         NonVirtualThunk thunk;
         thunk.m_name = std::move(thunkName);
-        thunk.m_address = symbol.value();
+        thunk.m_address = symbol.m_value;
         thunk.m_isDtor = thunk.m_name.find('~') != std::string::npos;
 
         m_thunks.push_back(std::move(thunk));
         const index_t index = m_thunks.size() - 1;
-        m_addressToThunkIndex.emplace(symbol.value(), index);
+        m_addressToThunkIndex.emplace(symbol.m_value, index);
     }
 }
 
@@ -347,6 +592,9 @@ void MachOReader::Parse_PEXT_typeinfo(const LIEF::MachO::Binary &binary, const L
                 }
                 break;
             }
+            case RelocatedSymbol::cxa_pure_virtual: {
+                break; // Only vtable slots refer to it.
+            }
         }
     }
 }
@@ -355,114 +603,125 @@ void MachOReader::Parse_PEXT_vtable(const LIEF::MachO::Binary &binary, const LIE
 {
     if (starts_with(symbol.name(), "__ZTV")) // vtable for ...
     {
-        // A Vtable has 2 destructors, generated by the compiler:
-        // 1. Non-deleting destructor
-        // 2. Deleting destructor (calls operator delete)
-
         std::string className = llvm::itaniumDemangle(symbol.name().c_str(), nullptr, nullptr, nullptr);
         className.erase(0, 11); // Erase "vtable for "
-        const uint64_t symbolAddress = symbol.value();
-        LIEF::span<const uint8_t> mem = binary.get_content_from_virtual_address(symbolAddress, sizeof(__vtable_info));
-        auto vtable_info = (__vtable_info *)mem.data();
-
-        const index_t classIndex = FindOrCreateClassByName(className);
-        const LIEF::MachO::Section *vtableSection = binary.section_from_virtual_address(symbolAddress);
-        const uint64_t vtableSectionEnd = vtableSection->virtual_address() + vtableSection->size();
-
-        int vtableCount = 1;
-        assert(vtable_info->offset_to_this == 0);
-        m_classes[classIndex].m_vtables.emplace_back();
-        VTable *vtable = &m_classes[classIndex].m_vtables.back();
+        ParseVtable(binary, symbol.value(), FindOrCreateClassByName(className));
+    }
+}
 
-        for (int i = 0, o = 0;; ++i, ++o)
+void MachOReader::ParseVtable(const LIEF::MachO::Binary &binary, uint64_t symbolAddress, index_t classIndex)
+{
+    // A Vtable has 2 destructors, generated by the compiler:
+    // 1. Non-deleting destructor
+    // 2. Deleting destructor (calls operator delete)
+
+    m_vtableAddressToClassIndex.emplace(symbolAddress, classIndex);
+    LIEF::span<const uint8_t> mem = binary.get_content_from_virtual_address(symbolAddress, sizeof(__vtable_info));
+    auto vtable_info = (__vtable_info *)mem.data();
+
+    const LIEF::MachO::Section *vtableSection = binary.section_from_virtual_address(symbolAddress);
+    const uint64_t vtableSectionEnd = vtableSection->virtual_address() + vtableSection->size();
+
+    // All vtables of the class are appended to one slab of entries.
+    Class &classType = m_classes[classIndex];
+    int vtableCount = 1;
+    assert(vtable_info->offset_to_this == 0);
+    classType.m_vtables.emplace_back();
+    VTable *vtable = &classType.m_vtables.back();
+    vtable->m_entryBegin = static_cast<uint32_t>(classType.m_vtableEntries.size());
+
+    for (int i = 0, o = 0;; ++i, ++o)
+    {
+        VTableEntry vtableEntry;
+        uint32_t functionAddress = vtable_info->function_address[i];
+        const uint32_t curVtableOffset =
+            symbolAddress + sizeof(__vtable_info) * vtableCount + sizeof(uint32_t) * (o - 1);
+        if (curVtableOffset >= vtableSectionEnd)
+            break; // End of vtable section.
+        if (functionAddress == 0)
+            break; // End of whole vtable.
+        if (vtable_info->function_address[i + 1] == vtable_info->type_info)
         {
-            VTableEntry vtableEntry;
-            uint32_t functionAddress = vtable_info->function_address[i];
-            const uint32_t curVtableOffset =
-                symbolAddress + sizeof(__vtable_info) * vtableCount + sizeof(uint32_t) * (o - 1);
-            if (curVtableOffset >= vtableSectionEnd)
-                break; // End of vtable section.
-            if (functionAddress == 0)
-                break; // End of whole vtable.
-            if (vtable_info->function_address[i + 1] == vtable_info->type_info)
-            {
-                vtable_info = (__vtable_info *)&vtable_info->function_address[i];
-                vtableCount += 1;
-                i = -1;
-                o -= 1;
-                m_classes[classIndex].m_vtables.emplace_back();
-                vtable = &m_classes[classIndex].m_vtables.back();
-                assert(-vtable_info->offset_to_this < 0xffff);
-                vtable->m_offset = static_cast<uint16_t>(-vtable_info->offset_to_this);
-                continue; // End of primary vtable, begin of secondary vtable.
-            }
-
-            if (vtableCount >= 2)
-            {
-                // Secondary vtable, contains non-virtual chunks among others.
-                AddressToIndexMap::iterator it = m_addressToThunkIndex.find(functionAddress);
-                if (it != m_addressToThunkIndex.end())
-                {
-                    vtableEntry.m_functionIndex = InvalidIndex;
-                    vtableEntry.m_thunkIndex = it->second;
-                    vtableEntry.m_name = m_thunks[it->second].m_name;
-                    vtableEntry.m_isDtor = m_thunks[it->second].m_isDtor;
-                    vtable->m_entries.push_back(std::move(vtableEntry));
-                    continue;
-                }
-            }
+            vtable_info = (__vtable_info *)&vtable_info->function_address[i];
+            vtableCount += 1;
+            i = -1;
+            o -= 1;
+            classType.m_vtables.emplace_back();
+            vtable = &classType.m_vtables.back();
+            vtable->m_entryBegin = static_cast<uint32_t>(classType.m_vtableEntries.size());
+            assert(-vtable_info->offset_to_this < 0xffff);
+            vtable->m_offset = static_cast<uint16_t>(-vtable_info->offset_to_this);
+            continue; // End of primary vtable, begin of secondary vtable.
+        }
 
-            if (static_cast<RelocatedSymbol>(functionAddress) == RelocatedSymbol::cxa_pure_virtual)
+        if (vtableCount >= 2)
+        {
+            // Secondary vtable, contains non-virtual chunks among others.
+            AddressToIndexMap::iterator it = m_addressToThunkIndex.find(functionAddress);
+            if (it != m_addressToThunkIndex.end())
             {
-                // Is not a function pointer. Is pure virtual function.
-                vtableEntry.m_functionIndex = InvalidIndex;
-                vtableEntry.m_thunkIndex = InvalidIndex;
-                vtableEntry.m_isPureVirtual = true;
-                // Function name needs to be set in post process.
-                vtable->m_entries.push_back(std::move(vtableEntry));
+                vtableEntry.m_index = it->second;
+                vtableEntry.m_flags = VTableEntry::Flag_Thunk;
+                if (m_thunks[it->second].m_isDtor)
+                    vtableEntry.m_flags |= VTableEntry::Flag_Dtor;
+                classType.m_vtableEntries.push_back(vtableEntry);
+                ++vtable->m_entryCount;
                 continue;
             }
+        }
 
-            const LIEF::MachO::Section *functionSection = binary.section_from_virtual_address(functionAddress);
-            if (functionSection == nullptr)
-                break; // Unknown entity.
-            if (!(functionSection->name() == "__textcoal_nt" || functionSection->name() == "__text"))
-                break; // Address does not belong to function.
-
-            AddressToIndexMap::iterator it = m_addressToFunctionIndex.find(functionAddress);
-            assert(it != m_addressToFunctionIndex.end());
-            vtableEntry.m_functionIndex = it->second;
-            vtableEntry.m_thunkIndex = InvalidIndex;
-            vtableEntry.m_name = m_functions[it->second].m_name;
-            vtableEntry.m_isDtor = m_functions[it->second].m_isCtorOrDtor;
-            vtable->m_entries.push_back(std::move(vtableEntry));
+        if (static_cast<RelocatedSymbol>(functionAddress) == RelocatedSymbol::cxa_pure_virtual)
+        {
+            // Is not a function pointer. Is pure virtual function.
+            vtableEntry.m_flags = VTableEntry::Flag_PureVirtual;
+            // Function name needs to be set in post process.
+            classType.m_vtableEntries.push_back(vtableEntry);
+            ++vtable->m_entryCount;
+            continue;
         }
+
+        const LIEF::MachO::Section *functionSection = binary.section_from_virtual_address(functionAddress);
+        if (functionSection == nullptr)
+            break; // Unknown entity.
+        if (!(functionSection->name() == "__textcoal_nt" || functionSection->name() == "__text"))
+            break; // Address does not belong to function.
+
+        AddressToIndexMap::iterator it = m_addressToFunctionIndex.find(functionAddress);
+        if (it == m_addressToFunctionIndex.end())
+            break; // Function without stabs, such as in vtables that are not private externals.
+        vtableEntry.m_index = it->second;
+        if (m_functions[it->second].m_isCtorOrDtor)
+            vtableEntry.m_flags = VTableEntry::Flag_Dtor;
+        classType.m_vtableEntries.push_back(vtableEntry);
+        ++vtable->m_entryCount;
     }
 }
 
-void MachOReader::Parse_SO(const LIEF::MachO::Symbol &symbol, bool &SO_InBlock, std::string &SO_Prefix)
+void MachOReader::Parse_SO(const SymbolEntry &symbol, bool &SO_InBlock, std::string &SO_Prefix)
 {
-    if (!symbol.name().empty())
+    if (!symbol.m_name.empty())
     {
         if (!SO_InBlock)
         {
             // Step 1/3
             SO_InBlock = true;
-            SO_Prefix = symbol.name();
+            SO_Prefix = symbol.m_name;
 
             m_sourceFiles.emplace_back();
             SourceFile &sourceFile = m_sourceFiles.back();
-            sourceFile.m_addressBegin = symbol.value();
+            sourceFile.m_addressBegin = symbol.m_value;
+
+            BeginStabsTypeTables();
         }
         else
         {
             // Step 2/3
             SourceFile &sourceFile = m_sourceFiles.back();
 
-            assert(strstr(symbol.name().c_str(), SO_Prefix.c_str()) == symbol.name().c_str());
-            assert(sourceFile.m_addressBegin == symbol.value());
+            assert(starts_with(symbol.m_name, SO_Prefix));
+            assert(sourceFile.m_addressBegin == symbol.m_value);
 
-            sourceFile.m_name = symbol.name().substr(SO_Prefix.size());
+            sourceFile.m_name = symbol.m_name.substr(SO_Prefix.size());
 
             index_t index = m_sourceFiles.size() - 1;
             [[maybe_unused]] auto result = m_nameToSourceFileIndex.try_emplace(sourceFile.m_name, index);
@@ -476,89 +735,120 @@ void MachOReader::Parse_SO(const LIEF::MachO::Symbol &symbol, bool &SO_InBlock,
         assert(SO_InBlock);
         assert(sourceFile.m_addressBegin != 0);
 
-        sourceFile.m_addressEnd = symbol.value();
+        sourceFile.m_addressEnd = symbol.m_value;
         SO_InBlock = false;
         SO_Prefix.clear();
     }
 }
 
-void MachOReader::Parse_SOL(const LIEF::MachO::Symbol &symbol, const std::string &SO_Prefix, index_t functionIndex)
+void MachOReader::Parse_SOL(
+    const SymbolEntry &symbol,
+    const std::string &SO_Prefix,
+    index_t functionIndex,
+    StringViewToIndexMap &headerFileCache)
 {
-    Function &function = m_functions[functionIndex];
-    const uint64_t address = symbol.value();
-    const std::string &name = symbol.name();
+    const Function &function = m_functions[functionIndex];
+    const uint64_t address = symbol.m_value;
+    const std::string_view name = symbol.m_name;
 
-    const size_t variantIndex = function.m_variants.size() - 1;
+    [[maybe_unused]] const size_t variantIndex = function.m_variants.size() - 1;
     assert(address >= function.GetVirtualAddressBegin(variantIndex));
     assert(address < function.GetVirtualAddressEnd(variantIndex));
 
-    std::string sanitizedName;
+    std::string_view sanitizedName = name;
     if (starts_with(name, SO_Prefix))
     {
-        sanitizedName = {name.data() + SO_Prefix.size(), name.size() - SO_Prefix.size()};
-    }
-    else
-    {
-        sanitizedName = name;
+        sanitizedName.remove_prefix(SO_Prefix.size());
     }
 
     if (sanitizedName == m_sourceFiles.back().m_name)
     {
         // The .cpp file (N_SO)
-        FunctionInstruction instruction;
-        instruction.m_address = address;
-        instruction.sourceFileIndex = m_sourceFiles.size() - 1;
-        function.m_variants.back().m_instructions.push_back(instruction);
+        m_includeTable.AddRow(address, InvalidIndex, m_sourceFiles.size() - 1);
     }
     else
     {
         // A header file
-        index_t headerFileIndex = FindOrCreateHeaderFileByName(sanitizedName);
+        index_t headerFileIndex;
+        StringViewToIndexMap::iterator it = headerFileCache.find(sanitizedName);
+        if (it != headerFileCache.end())
+        {
+            headerFileIndex = it->second;
+        }
+        else
+        {
+            headerFileIndex = FindOrCreateHeaderFileByName(std::string(sanitizedName));
+            headerFileCache.emplace(sanitizedName, headerFileIndex);
+        }
 
         assert(!ends_with(sanitizedName, ".cp"));
         assert(!ends_with(sanitizedName, ".cpp"));
         assert(headerFileIndex != InvalidIndex);
 
-        FunctionInstruction instruction;
-        instruction.m_address = address;
-        instruction.headerFileIndex = headerFileIndex;
-        function.m_variants.back().m_instructions.push_back(instruction);
+        m_includeTable.AddRow(address, headerFileIndex, InvalidIndex);
+
+        // Functions and header files are mostly visited in ascending order, so these inserts mostly append.
+        m_functions[functionIndex].m_headerFileIndices.Insert(headerFileIndex);
+        m_sourceFiles.back().m_headerFileIndices.Insert(headerFileIndex);
+        m_headerFiles[headerFileIndex].m_functionIndices.Insert(functionIndex);
     }
 }
 
-void MachOReader::Parse_FUN(const LIEF::MachO::Symbol &symbol, index_t &functionIndex)
+void MachOReader::Parse_FUN(const SymbolEntry &symbol, index_t &functionIndex)
 {
-    if (!symbol.name().empty())
+    if (!symbol.m_name.empty())
     {
         // Step 1/2
+        bool isLocal = ends_with(symbol.m_name, ":f");
+        bool isGlobal = ends_with(symbol.m_name, ":F");
+
+        std::string mangled;
+        if (isGlobal || isLocal)
+        {
+            mangled.assign(symbol.m_name.data(), symbol.m_name.size() - 2);
+        }
+        else if (starts_with(symbol.m_name, "_"))
+        {
+            // Debug map entry of an object file that was not read. It has the linker name, such as "__Z3foov", and
+            // no stab descriptor, so the linkage is unknown. Drops the underscore prefix of linker names.
+            mangled.assign(symbol.m_name.data() + 1, symbol.m_name.size() - 1);
+        }
+        else
+        {
+            functionIndex = InvalidIndex;
+            return;
+        }
+
         // Skip compiler generated symbols.
-        if (starts_with(symbol.name(), "_GLOBAL__"))
+        if (starts_with(mangled, "_GLOBAL__"))
         {
             functionIndex = InvalidIndex;
             return;
         }
-        if (starts_with(symbol.name(), "_Z41")) // _Z41__static_initialization_and_destruction_0ii:f
+        if (starts_with(mangled, "_Z41")) // _Z41__static_initialization_and_destruction_0ii:f
         {
             functionIndex = InvalidIndex;
             return;
         }
 
-        bool isLocal = ends_with(symbol.name(), ":f");
-        bool isGlobal = ends_with(symbol.name(), ":F");
-        assert(isGlobal || isLocal);
-
-        std::string mangled = {symbol.name().data(), symbol.name().size() - 2};
-        std::string demangled = mangled;
+        std::string demangled;
         bool isMangled = false;
 
-        llvm::ItaniumPartialDemangler demangler;
-        if (!demangler.partialDemangle(mangled.c_str())) // returns true on error, false otherwise.
+        // Parts are views into a per-thread buffer and are copied into the function record below.
+        itanium_function_parts parts;
+        if (m_options.m_lazyDemangling)
+        {
+            // Variants are grouped by key. The name is filled when the function is first accessed.
+            demangled = GetFunctionVariantKey(mangled);
+        }
+        else if (itanium_demangle_function(mangled, parts))
         {
             isMangled = true;
-            const char *buffer = demangler.finishDemangle(nullptr, nullptr);
-            assert(buffer != nullptr);
-            demangled = buffer;
-            std::free((void *)buffer);
+            demangled = parts.name;
+        }
+        else
+        {
+            demangled = mangled;
         }
 
         bool createNewRecord = true;
@@ -579,58 +869,29 @@ void MachOReader::Parse_FUN(const LIEF::MachO::Symbol &symbol, index_t &function
             m_functions.emplace_back();
             functionIndex = m_functions.size() - 1;
             Function &function = m_functions.back();
-            function.m_name = std::move(demangled);
             function.m_isLocalFunction = isLocal;
-            function.m_isConst = ends_with(function.m_name, "const");
             function.m_headerFileIndex = InvalidIndex; // ???
             function.m_sourceFileIndex = m_sourceFiles.size() - 1;
             {
                 FunctionVariant variant;
                 variant.m_mangledName = std::move(mangled);
-                variant.m_address = symbol.value();
-                variant.m_sourceLine = symbol.description();
-                variant.m_section = symbol.numberof_sections();
+                variant.m_address = symbol.m_value;
+                variant.m_sourceLine = symbol.m_description;
+                variant.m_section = symbol.m_section;
                 function.m_variants.push_back(std::move(variant));
             }
 
             if (isMangled)
             {
-                if (const char *buffer = demangler.getFunctionBaseName(nullptr, nullptr))
-                {
-                    function.m_functionBaseName = buffer;
-                    std::free((void *)buffer);
-                }
-
-                if (const char *buffer = demangler.getFunctionDeclContextName(nullptr, nullptr))
-                {
-                    function.m_functionDeclContextName = buffer;
-                    std::free((void *)buffer);
-                }
-
-                if (const char *buffer = demangler.getFunctionName(nullptr, nullptr))
-                {
-                    function.m_functionName = buffer;
-                    std::free((void *)buffer);
-                }
-
-                if (const char *buffer = demangler.getFunctionParameters(nullptr, nullptr))
-                {
-                    function.m_functionParameters = buffer;
-                    std::free((void *)buffer);
-                }
-
-                if (const char *buffer = demangler.getFunctionReturnType(nullptr, nullptr))
-                {
-                    function.m_functionReturnType = buffer;
-                    std::free((void *)buffer);
-                }
-
-                function.m_isCtorOrDtor = demangler.isCtorOrDtor();
-                function.m_functionParameterTypes = Function::GetParameterTypes(function.m_functionParameters);
+                SetDemangledParts(function, parts);
+            }
+            else if (!m_options.m_lazyDemangling)
+            {
+                function.m_name = demangled;
             }
 
             m_sourceFiles.back().m_functionIndices.push_back(functionIndex);
-            m_nameToFunctionIndex.emplace(function.m_name, functionIndex);
+            m_nameToFunctionIndex.emplace(std::move(demangled), functionIndex);
             m_mangledToFunctionIndex.emplace(function.m_variants.back().m_mangledName, functionIndex);
             m_addressToFunctionIndex.emplace(function.m_variants.back().m_address, functionIndex);
         }
@@ -643,9 +904,9 @@ void MachOReader::Parse_FUN(const LIEF::MachO::Symbol &symbol, index_t &function
             {
                 FunctionVariant variant;
                 variant.m_mangledName = std::move(mangled);
-                variant.m_address = symbol.value();
-                variant.m_sourceLine = symbol.description();
-                variant.m_section = symbol.numberof_sections();
+                variant.m_address = symbol.m_value;
+                variant.m_sourceLine = symbol.m_description;
+                variant.m_section = symbol.m_section;
                 function.m_variants.push_back(std::move(variant));
             }
 
@@ -662,137 +923,813 @@ void MachOReader::Parse_FUN(const LIEF::MachO::Symbol &symbol, index_t &function
         if (functionIndex != InvalidIndex)
         {
             Function &function = m_functions[functionIndex];
-            function.m_variants.back().m_size = symbol.value();
+            function.m_variants.back().m_size = symbol.m_value;
         }
     }
 }
 
-void MachOReader::Parse_GSYM(const LIEF::MachO::Symbol &symbol) // TODO
+void MachOReader::SetDemangledParts(Function &function, const itanium_function_parts &parts)
 {
-    // assert(ends_with(symbol.name(), ":G"));
-    // std::string mangled = std::string{symbol.name().data(), symbol.name().size() - 2};
-    // std::string demangled = itanium_demangle(mangled);
-
-    // m_variables.emplace_back();
-    // Variable &variable = m_variables.back();
-    // variable.m_name = demangled;
-    // variable.m_description = symbol.description();
-    // variable.m_type = Variable::Type::Global;
-
-    // return;
+    function.m_name = parts.name;
+    function.m_functionParameters = parts.parameters;
+    function.m_functionReturnType = parts.return_type;
+    function.m_functionParameterTypeIds.reserve(parts.parameter_types.size());
+    for (std::string_view type : parts.parameter_types)
+    {
+        function.m_functionParameterTypeIds.push_back(FindOrCreateTypeNameId(type));
+    }
+    // The class model may be in use, so the parts that it already set are not written again.
+    if (!m_functionScopesDemangled)
+    {
+        SetDemangledScopeParts(function, parts);
+    }
 }
 
-void MachOReader::Parse_STSYM(const LIEF::MachO::Symbol &symbol) // TODO
+void MachOReader::SetDemangledScopeParts(Function &function, const itanium_function_parts &parts)
 {
-    // assert(ends_with(symbol.name(), ":S") || ends_with(symbol.name(), ":V"));
-    // std::string mangled = std::string{symbol.name().data(), symbol.name().size() - 2};
-    // std::string demangled = itanium_demangle(mangled);
-
-    // m_variables.emplace_back();
-    // Variable &variable = m_variables.back();
-    // variable.m_name = demangled;
-    // variable.m_address = symbol.value();
-    // variable.m_description = symbol.description();
-    // variable.m_section = symbol.numberof_sections();
-    // variable.m_type = Variable::Type::Static;
-
-    // return;
+    function.m_functionBaseName = parts.base_name;
+    function.m_functionDeclContextName = parts.decl_context_name;
+    function.m_functionName = parts.function_name;
+    function.m_isCtorOrDtor = parts.is_ctor_or_dtor;
+    function.m_isConst = parts.is_const;
+    function.m_functionParameterBaseTypeIds.clear();
+    function.m_functionParameterBaseTypeIds.reserve(parts.parameter_base_types.size());
+    for (std::string_view type : parts.parameter_base_types)
+    {
+        function.m_functionParameterBaseTypeIds.push_back(FindOrCreateTypeNameId(type));
+    }
 }
 
-void MachOReader::Parse_LCSYM(const LIEF::MachO::Symbol &symbol) // TODO
+void MachOReader::EnsureFunctionDemangled(index_t functionIndex)
 {
-    // const bool s = ends_with(symbol.name(), ":S");
-    // const bool v = ends_with(symbol.name(), ":V");
-    // assert(s || v);
-
-    // std::string mangled = std::string{symbol.name().data(), symbol.name().size() - 2};
-    // std::string demangled = itanium_demangle(mangled);
-
-    // index_t variableIndex;
+    assert(functionIndex < m_functions.size());
 
-    // AddressToIndexMap::iterator it = m_addressToVariableIndex.find(symbol.value());
-    // if (it == m_addressToVariableIndex.end())
-    //{
-    //    // Create new
+    if (m_functionDemangled == nullptr)
+        return; // Demangled during Parse.
 
-    //    m_variables.emplace_back();
-    //    Variable &variable = m_variables.back();
-    //    variable.m_name = demangled;
-    //    variable.m_address = symbol.value();
-    //    variable.m_description = symbol.description();
-    //    variable.m_section = symbol.numberof_sections();
-    //    variable.m_type = Variable::Type::Local;
-
-    //    variableIndex = m_variables.size() - 1;
-    //    m_addressToVariableIndex.emplace(symbol.value(), variableIndex);
+    std::atomic<bool> &demangled = m_functionDemangled[functionIndex];
+    if (demangled.load(std::memory_order_acquire))
+        return;
 
-    //    if (s)
-    //    {
+    // Demangle outside of the lock. Only the mangled name is read, which is not written after Parse.
+    Function &function = m_functions[functionIndex];
+    const std::string &mangled = function.m_variants.front().m_mangledName;
+    itanium_function_parts parts;
+    const bool isMangled = itanium_demangle_function(mangled, parts);
 
-    //    }
-    //    else if (v)
-    //    {
-    //        m_functions.back().m_variableIndices.push_back(variableIndex);
-    //    }
-    //}
-    // else
-    //{
-    //    // Verify existing
+    // Type names are interned in shared tables.
+    std::lock_guard<std::mutex> lock(m_demangleMutex);
+    if (demangled.load(std::memory_order_relaxed))
+        return;
 
-    //    variableIndex = it->second;
-    //    Variable &variable = m_variables[variableIndex];
-    //    assert(variable.m_name == demangled);
-    //    assert(variable.m_description == symbol.description());
-    //    assert(variable.m_section == symbol.numberof_sections());
-    //}
+    if (isMangled)
+    {
+        SetDemangledParts(function, parts);
+    }
+    else
+    {
+        function.m_name = mangled;
+    }
+    demangled.store(true, std::memory_order_release);
 }
 
-index_t MachOReader::FindOrCreateHeaderFileByName(const std::string &name)
+void MachOReader::DemangleAllFunctions()
 {
-    StringToIndexMap::iterator it = m_nameToHeaderFileIndex.find(name);
-    if (it != m_nameToHeaderFileIndex.end())
-        return it->second;
+    if (m_functionDemangled == nullptr)
+        return;
 
-    HeaderFile headerFile;
-    headerFile.m_name = name;
-    m_headerFiles.push_back(std::move(headerFile));
-    const index_t index = m_headerFiles.size() - 1;
-    m_nameToHeaderFileIndex.emplace(name, index);
-    return index;
+    std::call_once(m_allFunctionsDemangledOnce, [this]() {
+        m_threadPool->ParallelFor(m_functions.size(), [this](size_t functionIndex) {
+            EnsureFunctionDemangled(static_cast<index_t>(functionIndex));
+        });
+    });
 }
 
-index_t MachOReader::FindOrCreateNamespaceByName(const std::string &name)
+void MachOReader::DemangleAllFunctionScopes()
 {
-    StringToIndexMap::iterator it = m_nameToNamespaceIndex.find(name);
-    if (it != m_nameToNamespaceIndex.end())
-        return it->second;
+    if (m_functionDemangled == nullptr)
+        return;
 
-    Namespace namespaceType;
-    namespaceType.m_name = name;
-    m_namespaces.push_back(std::move(namespaceType));
-    const index_t index = m_namespaces.size() - 1;
-    m_nameToNamespaceIndex.emplace(name, index);
+    m_threadPool->ParallelFor(m_functions.size(), [this](size_t functionIndex) {
+        // Functions that are demangled already have their scope parts.
+        if (m_functionDemangled[functionIndex].load(std::memory_order_acquire))
+            return;
 
-    const size_t pos = name.rfind("::");
-    if (pos != std::string::npos)
-    {
-        m_namespaces[index].m_namespaceName = name.substr(pos + 2);
-        const std::string parentName = name.substr(0, pos);
-        index_t parentNamespaceIndex = FindOrCreateNamespaceByName(parentName);
-        m_namespaces[index].m_parentNamespaceIndex = parentNamespaceIndex;
-        m_namespaces[parentNamespaceIndex].m_childNamespaceIndices.push_back(index);
-    }
-    else
-    {
-        m_namespaces[index].m_namespaceName = name;
-    }
+        Function &function = m_functions[functionIndex];
+        itanium_function_parts parts;
+        if (!itanium_demangle_function_scope(function.m_variants.front().m_mangledName, parts))
+            return;
 
-    return index;
+        std::lock_guard<std::mutex> lock(m_demangleMutex);
+        // The function may have been demangled since the check above, which set the scope parts already.
+        if (m_functionDemangled[functionIndex].load(std::memory_order_relaxed))
+            return;
+
+        SetDemangledScopeParts(function, parts);
+    });
+
+    std::lock_guard<std::mutex> lock(m_demangleMutex);
+    m_functionScopesDemangled = true;
 }
 
-index_t MachOReader::FindOrCreateEnumByName(const std::string &name)
+void MachOReader::DemangleVtableFunctions()
 {
-    StringToIndexMap::iterator it = m_nameToEnumIndex.find(name);
+    if (m_functionDemangled == nullptr)
+        return;
+
+    std::vector<index_t> functionIndices;
+    for (const Class &classType : m_classes)
+    {
+        for (const VTableEntry &entry : classType.m_vtableEntries)
+        {
+            if (entry.GetFunctionIndex() != InvalidIndex)
+            {
+                functionIndices.push_back(entry.GetFunctionIndex());
+            }
+        }
+    }
+
+    m_threadPool->ParallelFor(functionIndices.size(), [this, &functionIndices](size_t index) {
+        EnsureFunctionDemangled(functionIndices[index]);
+    });
+}
+
+void MachOReader::Parse_SLINE(const SymbolEntry &symbol, index_t functionIndex)
+{
+    if (functionIndex == InvalidIndex)
+        return;
+
+    const FunctionVariant &variant = m_functions[functionIndex].m_variants.back();
+    uint64_t address = symbol.m_value;
+    if (address < variant.m_address)
+    {
+        // Function relative address.
+        address += variant.m_address;
+    }
+    m_lineTable.AddRow(address, symbol.m_description);
+}
+
+void MachOReader::Parse_LSYM(const SymbolEntry &symbol)
+{
+    if (!ParseStabsString(symbol))
+        return;
+
+    const StabsSymbol &stabsSymbol = m_stabsParser.GetSymbol();
+    if (stabsSymbol.m_type == InvalidStabsNode)
+        return;
+
+    // Tags and typedefs name the type they define. Anonymous types are named " ".
+    std::string_view name;
+    if ((stabsSymbol.m_isTag || stabsSymbol.m_isTypedef) && stabsSymbol.m_name != " ")
+    {
+        name = stabsSymbol.m_name;
+    }
+
+    const index_t typeIndex = ResolveStabsType(stabsSymbol.m_type, name);
+
+    if (stabsSymbol.m_isTypedef && !name.empty() && typeIndex != InvalidIndex
+        && !IsStabsTypeNamedBySymbol(stabsSymbol.m_type))
+    {
+        // Typedef of another type, for example "size_t:t(0,5)=(0,3)".
+        const Type &targetType = m_types[typeIndex];
+        if (targetType.m_kind == Type::Kind::Class && m_classes[targetType.m_classIndex].m_name == name)
+            return;
+
+        const index_t typedefIndex = FindOrCreateNamedType(Type::Kind::Typedef, name, targetType.m_size);
+        if (m_types[typedefIndex].m_targetTypeIndex == InvalidIndex)
+        {
+            m_types[typedefIndex].m_targetTypeIndex = typeIndex;
+        }
+
+        const StabsType &type = m_stabsParser.GetType(stabsSymbol.m_type);
+        if (type.m_isDefinition)
+        {
+            DefineStabsType(type.m_number, typedefIndex);
+        }
+    }
+}
+
+void MachOReader::Parse_PSYM(const SymbolEntry &symbol, index_t functionIndex)
+{
+    if (!ParseStabsString(symbol))
+        return;
+
+    const StabsSymbol &stabsSymbol = m_stabsParser.GetSymbol();
+    if (stabsSymbol.m_type == InvalidStabsNode)
+        return;
+
+    const index_t typeIndex = ResolveStabsType(stabsSymbol.m_type, {});
+
+    if (functionIndex == InvalidIndex)
+        return;
+
+    // Parameters are taken from the first variant that lists them. All variants share the same signature.
+    Function &function = m_functions[functionIndex];
+    const uint32_t variantIndex = static_cast<uint32_t>(function.m_variants.size() - 1);
+    if (function.m_parameters.empty())
+    {
+        m_parameterFunctionIndex = functionIndex;
+        m_parameterVariantIndex = variantIndex;
+    }
+    else if (m_parameterFunctionIndex != functionIndex || m_parameterVariantIndex != variantIndex)
+    {
+        return;
+    }
+
+    FunctionParameter parameter;
+    parameter.m_name = stabsSymbol.m_name;
+    parameter.m_typeIndex = typeIndex;
+    parameter.m_frameOffset = static_cast<int32_t>(symbol.m_value);
+    function.m_parameters.push_back(std::move(parameter));
+}
+
+void MachOReader::Parse_BINCL(const SymbolEntry &symbol)
+{
+    // Header types get the next file number. Same headers share one type table across source files.
+    std::string key = fmt::format("{}@{}", symbol.m_name, symbol.m_value);
+    auto [it, inserted] = m_stabsHeaderToTypeTable.try_emplace(std::move(key), index_t(m_stabsTypeTables.size()));
+    if (inserted)
+    {
+        m_stabsTypeTables.emplace_back();
+    }
+    m_stabsFileTypeTables.push_back(it->second);
+}
+
+void MachOReader::Parse_EXCL(const SymbolEntry &symbol)
+{
+    // Excluded header refers to the types of a header that was included before, with the same name and checksum.
+    Parse_BINCL(symbol);
+}
+
+void MachOReader::Parse_GSYM(const SymbolEntry &symbol)
+{
+    Parse_Variable(symbol, Variable::Type::Global, InvalidIndex);
+}
+
+void MachOReader::Parse_STSYM(const SymbolEntry &symbol, index_t functionIndex)
+{
+    Parse_Variable(symbol, Variable::Type::Static, functionIndex);
+}
+
+void MachOReader::Parse_LCSYM(const SymbolEntry &symbol, index_t functionIndex)
+{
+    Parse_Variable(symbol, Variable::Type::Local, functionIndex);
+}
+
+void MachOReader::Parse_Variable(const SymbolEntry &symbol, Variable::Type type, index_t functionIndex)
+{
+    if (!ParseStabsString(symbol))
+        return;
+
+    // G: global, S: file static, V: function static.
+    const StabsSymbol &stabsSymbol = m_stabsParser.GetSymbol();
+    const char descriptor = stabsSymbol.m_descriptor;
+    if (descriptor != 'G' && descriptor != 'S' && descriptor != 'V')
+        return;
+
+    const index_t typeIndex = ResolveStabsType(stabsSymbol.m_type, {});
+
+    std::string mangled(stabsSymbol.m_name);
+
+    if (type == Variable::Type::Global)
+    {
+        if (m_mangledToVariableIndex.find(mangled) != m_mangledToVariableIndex.end())
+            return;
+    }
+    else
+    {
+        AddressToIndexMap::iterator it = m_addressToVariableIndex.find(symbol.m_value);
+        if (it != m_addressToVariableIndex.end())
+        {
+            // Verify existing
+            assert(m_variables[it->second].m_mangledName == mangled);
+            return;
+        }
+    }
+
+    m_variables.emplace_back();
+    const index_t variableIndex = m_variables.size() - 1;
+    Variable &variable = m_variables.back();
+    variable.m_name = itanium_demangle(mangled);
+    variable.m_mangledName = std::move(mangled);
+    variable.m_address = type == Variable::Type::Global ? 0 : symbol.m_value;
+    variable.m_size = typeIndex != InvalidIndex ? m_types[typeIndex].m_size : 0;
+    variable.m_description = symbol.m_description;
+    variable.m_section = symbol.m_section;
+    variable.m_type = type;
+    variable.m_typeIndex = typeIndex;
+    variable.m_sourceFileIndex = m_sourceFiles.empty() ? InvalidIndex : index_t(m_sourceFiles.size() - 1);
+
+    if (descriptor == 'V' && functionIndex != InvalidIndex)
+    {
+        variable.m_parentFunctionIndex = functionIndex;
+        m_functions[functionIndex].m_variableIndices.push_back(variableIndex);
+    }
+
+    if (variable.m_sourceFileIndex != InvalidIndex)
+    {
+        m_sourceFiles[variable.m_sourceFileIndex].m_variableIndices.push_back(variableIndex);
+    }
+
+    if (type == Variable::Type::Global)
+    {
+        m_mangledToVariableIndex.emplace(variable.m_mangledName, variableIndex);
+    }
+    else
+    {
+        m_addressToVariableIndex.emplace(variable.m_address, variableIndex);
+    }
+}
+
+bool MachOReader::ParseStabsString(const SymbolEntry &symbol)
+{
+    std::string_view string = symbol.m_name;
+    if (ends_with(string, "\\"))
+    {
+        // String continues in the next symbol.
+        m_stabsContinuation.append(string.data(), string.size() - 1);
+        return false;
+    }
+
+    if (!m_stabsContinuation.empty())
+    {
+        m_stabsString.assign(m_stabsContinuation).append(string);
+        m_stabsContinuation.clear();
+        string = m_stabsString;
+    }
+
+    return m_stabsParser.Parse(string);
+}
+
+void MachOReader::BeginStabsTypeTables()
+{
+    // File number 0 is the source file.
+    m_stabsFileTypeTables.clear();
+    m_stabsFileTypeTables.push_back(index_t(m_stabsTypeTables.size()));
+    m_stabsTypeTables.emplace_back();
+}
+
+index_t &MachOReader::GetStabsTypeSlot(StabsTypeNumber number)
+{
+    assert(number.m_number >= 0);
+
+    if (m_stabsFileTypeTables.empty())
+    {
+        BeginStabsTypeTables();
+    }
+
+    const size_t file = number.m_file >= 0 ? size_t(number.m_file) : 0;
+    while (file >= m_stabsFileTypeTables.size())
+    {
+        // Unknown file number.
+        m_stabsFileTypeTables.push_back(index_t(m_stabsTypeTables.size()));
+        m_stabsTypeTables.emplace_back();
+    }
+
+    std::vector<index_t> &table = m_stabsTypeTables[m_stabsFileTypeTables[file]];
+    const size_t typeNumber = size_t(number.m_number);
+    if (typeNumber >= table.size())
+    {
+        table.resize(typeNumber + 1, InvalidIndex);
+    }
+    return table[typeNumber];
+}
+
+void MachOReader::DefineStabsType(StabsTypeNumber number, index_t typeIndex)
+{
+    if (number.m_number < 0)
+        return;
+
+    index_t &slot = GetStabsTypeSlot(number);
+    if (slot != InvalidIndex && slot != typeIndex && m_types[slot].m_kind == Type::Kind::Unresolved)
+    {
+        // Fill the placeholder of a forward reference.
+        m_types[slot] = m_types[typeIndex];
+    }
+    slot = typeIndex;
+}
+
+index_t MachOReader::ResolveStabsType(uint32_t node, std::string_view name)
+{
+    const StabsType &type = m_stabsParser.GetType(node);
+    index_t typeIndex = InvalidIndex;
+
+    switch (type.m_kind)
+    {
+        case StabsTypeKind::Number: {
+            if (type.m_number.m_number < 0)
+            {
+                std::string_view builtinName;
+                uint32_t size;
+                if (!StabsParser::GetBuiltinType(type.m_number.m_number, builtinName, size))
+                    return InvalidIndex;
+                return FindOrCreateNamedType(Type::Kind::Builtin, builtinName, size);
+            }
+
+            typeIndex = GetStabsTypeSlot(type.m_number);
+            if (typeIndex == InvalidIndex)
+            {
+                // Forward reference. Placeholder is filled when the type number is defined.
+                m_types.emplace_back();
+                typeIndex = m_types.size() - 1;
+                GetStabsTypeSlot(type.m_number) = typeIndex;
+            }
+            return typeIndex;
+        }
+        case StabsTypeKind::Alias: {
+            const index_t targetTypeIndex = ResolveStabsType(type.m_target, {});
+            if (!name.empty() && IsStabsTypeNamedBySymbol(node) && targetTypeIndex != InvalidIndex)
+            {
+                // Builtin with a predefined type number, for example "bool:t(0,20)=@s8;-16;".
+                const uint32_t size = type.m_size != 0 ? type.m_size : m_types[targetTypeIndex].m_size;
+                typeIndex = FindOrCreateNamedType(Type::Kind::Builtin, name, size);
+            }
+            else
+            {
+                typeIndex = targetTypeIndex;
+            }
+            break;
+        }
+        case StabsTypeKind::Void: {
+            typeIndex = FindOrCreateNamedType(Type::Kind::Builtin, name.empty() ? "void" : name, 0);
+            break;
+        }
+        case StabsTypeKind::Range: {
+            if (!name.empty())
+            {
+                typeIndex = FindOrCreateNamedType(Type::Kind::Builtin, name, type.m_size);
+            }
+            else
+            {
+                m_types.emplace_back();
+                m_types.back().m_kind = Type::Kind::Builtin;
+                m_types.back().m_size = type.m_size;
+                typeIndex = m_types.size() - 1;
+            }
+            break;
+        }
+        case StabsTypeKind::Pointer:
+        case StabsTypeKind::LValueReference:
+        case StabsTypeKind::Const:
+        case StabsTypeKind::Volatile:
+        case StabsTypeKind::Function:
+        case StabsTypeKind::Method:
+        case StabsTypeKind::MemberPointer: {
+            for (uint32_t argument : m_stabsParser.GetArguments(type))
+            {
+                ResolveStabsType(argument, {});
+            }
+            const index_t targetTypeIndex = ResolveStabsType(type.m_target, {});
+
+            Type::Kind kind;
+            switch (type.m_kind)
+            {
+                case StabsTypeKind::Pointer:
+                    kind = Type::Kind::Pointer;
+                    break;
+                case StabsTypeKind::LValueReference:
+                    kind = Type::Kind::Reference;
+                    break;
+                case StabsTypeKind::Const:
+                    kind = Type::Kind::Const;
+                    break;
+                case StabsTypeKind::Volatile:
+                    kind = Type::Kind::Volatile;
+                    break;
+                case StabsTypeKind::MemberPointer:
+                    kind = Type::Kind::MemberPointer;
+                    break;
+                default:
+                    kind = Type::Kind::Function;
+                    break;
+            }
+            typeIndex = FindOrCreateDerivedType(kind, targetTypeIndex, 0);
+            break;
+        }
+        case StabsTypeKind::Array: {
+            const index_t elementTypeIndex = ResolveStabsType(type.m_target, {});
+            const uint32_t count = type.m_high >= type.m_low ? static_cast<uint32_t>(type.m_high - type.m_low + 1) : 0;
+            typeIndex = FindOrCreateDerivedType(Type::Kind::Array, elementTypeIndex, count);
+            break;
+        }
+        case StabsTypeKind::Struct:
+        case StabsTypeKind::Union: {
+            typeIndex = ResolveStabsClassType(node, name);
+            break;
+        }
+        case StabsTypeKind::Enum: {
+            typeIndex = ResolveStabsEnumType(node, name);
+            break;
+        }
+        case StabsTypeKind::CrossReference: {
+            if (type.m_crossReferenceKind == 'e')
+            {
+                typeIndex = FindOrCreateEnumType(FindOrCreateEnumByName(std::string(type.m_name)));
+            }
+            else
+            {
+                typeIndex = FindOrCreateClassType(FindOrCreateClassByName(type.m_name));
+            }
+            break;
+        }
+        case StabsTypeKind::Unknown: {
+            m_types.emplace_back();
+            typeIndex = m_types.size() - 1;
+            break;
+        }
+    }
+
+    if (type.m_isDefinition && typeIndex != InvalidIndex)
+    {
+        DefineStabsType(type.m_number, typeIndex);
+    }
+    return typeIndex;
+}
+
+index_t MachOReader::ResolveStabsClassType(uint32_t node, std::string_view name)
+{
+    const StabsType &type = m_stabsParser.GetType(node);
+
+    index_t classIndex = InvalidIndex;
+    index_t typeIndex;
+    if (name.empty())
+    {
+        // Anonymous struct or union. Has no class.
+        m_types.emplace_back();
+        m_types.back().m_kind = Type::Kind::Class;
+        m_types.back().m_size = type.m_size;
+        typeIndex = m_types.size() - 1;
+    }
+    else
+    {
+        classIndex = FindOrCreateClassByName(name);
+        typeIndex = FindOrCreateClassType(classIndex);
+
+        Class &classType = m_classes[classIndex];
+        if (classType.m_size == 0 && type.m_size <= 0xffffu)
+        {
+            classType.m_size = static_cast<uint16_t>(type.m_size);
+            m_types[typeIndex].m_size = type.m_size;
+        }
+    }
+
+    // Define before the members are resolved, because members can refer to this type.
+    if (type.m_isDefinition)
+    {
+        DefineStabsType(type.m_number, typeIndex);
+    }
+
+    for (const StabsBaseClass &baseClass : m_stabsParser.GetBaseClasses(type))
+    {
+        ResolveStabsType(baseClass.m_type, {});
+    }
+
+    // The same class is defined in every source file that includes it. Members are taken from the first definition.
+    const bool addMembers = classIndex != InvalidIndex && m_classes[classIndex].m_members.empty();
+
+    for (const StabsField &field : m_stabsParser.GetFields(type))
+    {
+        const index_t memberTypeIndex = ResolveStabsType(field.m_type, {});
+        if (addMembers)
+        {
+            ClassMember member;
+            member.m_name = field.m_name;
+            member.m_typeIndex = memberTypeIndex;
+            member.m_bitOffset = field.m_bitOffset;
+            member.m_bitSize = field.m_bitSize;
+            member.m_isStatic = field.m_isStatic;
+            m_classes[classIndex].m_members.push_back(std::move(member));
+        }
+    }
+
+    return typeIndex;
+}
+
+index_t MachOReader::ResolveStabsEnumType(uint32_t node, std::string_view name)
+{
+    const StabsType &type = m_stabsParser.GetType(node);
+    const uint32_t size = type.m_size != 0 ? type.m_size : 4;
+
+    if (name.empty())
+    {
+        // Anonymous enum. Has no enum.
+        m_types.emplace_back();
+        m_types.back().m_kind = Type::Kind::Enum;
+        m_types.back().m_size = size;
+        return m_types.size() - 1;
+    }
+
+    const index_t enumIndex = FindOrCreateEnumByName(std::string(name));
+    const index_t typeIndex = FindOrCreateEnumType(enumIndex);
+
+    Enum &enumType = m_enums[enumIndex];
+    if (enumType.m_size == 0)
+    {
+        enumType.m_size = size;
+        m_types[typeIndex].m_size = size;
+    }
+    if (enumType.m_values.empty())
+    {
+        for (const StabsEnumerator &enumerator : m_stabsParser.GetEnumerators(type))
+        {
+            EnumValue value;
+            value.m_name = enumerator.m_name;
+            value.m_value = enumerator.m_value;
+            enumType.m_values.push_back(std::move(value));
+        }
+    }
+
+    return typeIndex;
+}
+
+bool MachOReader::IsStabsTypeNamedBySymbol(uint32_t node) const
+{
+    const StabsType &type = m_stabsParser.GetType(node);
+    switch (type.m_kind)
+    {
+        case StabsTypeKind::Void:
+        case StabsTypeKind::Range:
+        case StabsTypeKind::Struct:
+        case StabsTypeKind::Union:
+        case StabsTypeKind::Enum:
+            return true;
+        case StabsTypeKind::Alias: {
+            const StabsType &targetType = m_stabsParser.GetType(type.m_target);
+            return targetType.m_kind == StabsTypeKind::Number && targetType.m_number.m_number < 0;
+        }
+        default:
+            return false;
+    }
+}
+
+index_t MachOReader::FindOrCreateNamedType(Type::Kind kind, std::string_view name, uint32_t size)
+{
+    const std::pair<Type::Kind, std::string_view> key(kind, name);
+    NamedTypeToIndexMap::iterator it = m_nameToTypeIndex.lower_bound(key);
+    if (it != m_nameToTypeIndex.end() && !m_nameToTypeIndex.key_comp()(key, it->first))
+        return it->second;
+
+    Type type;
+    type.m_name = name;
+    type.m_kind = kind;
+    type.m_size = size;
+    m_types.push_back(std::move(type));
+    const index_t index = m_types.size() - 1;
+    m_nameToTypeIndex.emplace_hint(it, std::make_pair(kind, std::string(name)), index);
+    return index;
+}
+
+index_t MachOReader::FindOrCreateDerivedType(Type::Kind kind, index_t targetTypeIndex, uint32_t count)
+{
+    // Key: kind in bits 56..63, count in bits 32..55, target type in bits 0..31.
+    const bool canIntern = count <= 0xffffffu;
+    const uint64_t key = (uint64_t(kind) << 56) | (uint64_t(count) << 32) | uint64_t(targetTypeIndex);
+    if (canIntern)
+    {
+        HashToIndexMap::iterator it = m_keyToDerivedTypeIndex.find(key);
+        if (it != m_keyToDerivedTypeIndex.end())
+            return it->second;
+    }
+
+    Type type;
+    type.m_kind = kind;
+    type.m_count = count;
+    type.m_targetTypeIndex = targetTypeIndex;
+    const uint32_t targetSize = targetTypeIndex != InvalidIndex ? m_types[targetTypeIndex].m_size : 0;
+    switch (kind)
+    {
+        case Type::Kind::Pointer:
+        case Type::Kind::Reference:
+        case Type::Kind::MemberPointer:
+            type.m_size = sizeof(uint32_t);
+            break;
+        case Type::Kind::Const:
+        case Type::Kind::Volatile:
+            type.m_size = targetSize;
+            break;
+        case Type::Kind::Array:
+            type.m_size = targetSize * count;
+            break;
+        default:
+            break;
+    }
+    m_types.push_back(std::move(type));
+    const index_t index = m_types.size() - 1;
+    if (canIntern)
+    {
+        m_keyToDerivedTypeIndex.emplace(key, index);
+    }
+    return index;
+}
+
+index_t MachOReader::FindOrCreateClassType(index_t classIndex)
+{
+    if (m_classes[classIndex].m_typeIndex != InvalidIndex)
+        return m_classes[classIndex].m_typeIndex;
+
+    Type type;
+    type.m_kind = Type::Kind::Class;
+    type.m_size = m_classes[classIndex].m_size;
+    type.m_classIndex = classIndex;
+    m_types.push_back(std::move(type));
+    const index_t index = m_types.size() - 1;
+    m_classes[classIndex].m_typeIndex = index;
+    return index;
+}
+
+index_t MachOReader::FindOrCreateEnumType(index_t enumIndex)
+{
+    if (m_enums[enumIndex].m_typeIndex != InvalidIndex)
+        return m_enums[enumIndex].m_typeIndex;
+
+    Type type;
+    type.m_kind = Type::Kind::Enum;
+    type.m_size = m_enums[enumIndex].m_size;
+    type.m_enumIndex = enumIndex;
+    m_types.push_back(std::move(type));
+    const index_t index = m_types.size() - 1;
+    m_enums[enumIndex].m_typeIndex = index;
+    return index;
+}
+
+index_t MachOReader::FindOrCreateTypeNameId(std::string_view name)
+{
+    std::string typeName(name);
+    StringToIndexMap::iterator it = m_typeNameToId.find(typeName);
+    if (it != m_typeNameToId.end())
+        return it->second;
+
+    const index_t id = m_typeNames.size();
+    it = m_typeNameToId.emplace(std::move(typeName), id).first;
+    m_typeNames.push_back(it->first);
+    return id;
+}
+
+index_t MachOReader::FindTypeNameId(std::string_view name) const
+{
+    // Functions that are demangled lazily may add type names concurrently.
+    std::lock_guard<std::mutex> lock(m_demangleMutex);
+    StringToIndexMap::const_iterator it = m_typeNameToId.find(std::string(name));
+    if (it == m_typeNameToId.end())
+        return InvalidIndex;
+
+    return it->second;
+}
+
+index_t MachOReader::FindOrCreateHeaderFileByName(const std::string &name)
+{
+    StringToIndexMap::iterator it = m_nameToHeaderFileIndex.find(name);
+    if (it != m_nameToHeaderFileIndex.end())
+        return it->second;
+
+    HeaderFile headerFile;
+    headerFile.m_name = name;
+    m_headerFiles.push_back(std::move(headerFile));
+    const index_t index = m_headerFiles.size() - 1;
+    m_nameToHeaderFileIndex.emplace(name, index);
+    return index;
+}
+
+index_t MachOReader::FindOrCreateNamespaceByName(std::string_view name)
+{
+    assert(!name.empty());
+    m_scopeTrie.FindOrCreatePath(name, m_scopePath);
+    return FindOrCreateNamespace(name, m_scopePath, m_scopePath.size() - 1);
+}
+
+index_t MachOReader::FindOrCreateNamespace(std::string_view name, const ScopeTrie::Path &path, size_t level)
+{
+    // Namespaces are only contained in namespaces. Find the deepest existing one and create the rest downwards.
+    size_t firstLevel = level + 1;
+    while (firstLevel > 0 && m_scopeTrie.GetNode(path[firstLevel - 1].m_nodeIndex).m_namespaceIndex == InvalidIndex)
+    {
+        --firstLevel;
+    }
+
+    for (size_t i = firstLevel; i <= level; ++i)
+    {
+        const index_t nodeIndex = path[i].m_nodeIndex;
+        Namespace namespaceType;
+        namespaceType.m_name = name.substr(0, path[i].m_nameEnd);
+        namespaceType.m_namespaceName = m_scopeTrie.GetComponent(nodeIndex);
+        m_namespaces.push_back(std::move(namespaceType));
+        const index_t index = m_namespaces.size() - 1;
+        m_scopeTrie.SetNamespaceIndex(nodeIndex, index);
+
+        if (i > 0)
+        {
+            const index_t parentNamespaceIndex = m_scopeTrie.GetNode(path[i - 1].m_nodeIndex).m_namespaceIndex;
+            m_namespaces[index].m_parentNamespaceIndex = parentNamespaceIndex;
+            m_namespaces[parentNamespaceIndex].m_childNamespaceIndices.push_back(index);
+        }
+    }
+
+    return m_scopeTrie.GetNode(path[level].m_nodeIndex).m_namespaceIndex;
+}
+
+index_t MachOReader::FindOrCreateEnumByName(const std::string &name)
+{
+    StringToIndexMap::iterator it = m_nameToEnumIndex.find(name);
     if (it != m_nameToEnumIndex.end())
         return it->second;
 
@@ -804,66 +1741,70 @@ index_t MachOReader::FindOrCreateEnumByName(const std::string &name)
     return index;
 }
 
-index_t MachOReader::FindOrCreateClassByName(const std::string &name)
+index_t MachOReader::FindOrCreateClassByName(std::string_view name)
 {
-    StringToIndexMap::iterator it = m_nameToClassIndex.find(name);
-    if (it != m_nameToClassIndex.end())
-        return it->second;
+    assert(!name.empty());
+    m_scopeTrie.FindOrCreatePath(name, m_scopePath);
+    return FindOrCreateClass(name, m_scopePath, m_scopePath.size() - 1);
+}
+
+index_t MachOReader::FindOrCreateClass(std::string_view name, const ScopeTrie::Path &path, size_t level)
+{
+    const index_t nodeIndex = path[level].m_nodeIndex;
+    if (m_scopeTrie.GetNode(nodeIndex).m_classIndex != InvalidIndex)
+        return m_scopeTrie.GetNode(nodeIndex).m_classIndex;
 
     Class classType;
-    classType.m_name = name;
+    classType.m_name = name.substr(0, path[level].m_nameEnd);
+    classType.m_className = m_scopeTrie.GetComponent(nodeIndex);
     m_classes.push_back(std::move(classType));
     const index_t index = m_classes.size() - 1;
-    m_nameToClassIndex.emplace(name, index);
+    m_scopeTrie.SetClassIndex(nodeIndex, index);
 
-    const size_t pos = FindClassNameBeginPos(name);
-    if (pos != std::string::npos)
+    if (level > 0)
     {
-        m_classes[index].m_className = name.substr(pos);
-        const std::string parentName = name.substr(0, pos - 2);
-        StringToIndexMap::iterator itParentClass = m_nameToClassIndex.find(parentName);
-        if (itParentClass != m_nameToClassIndex.end())
+        const index_t parentNodeIndex = path[level - 1].m_nodeIndex;
+        const index_t parentClassIndex = m_scopeTrie.GetNode(parentNodeIndex).m_classIndex;
+        if (parentClassIndex != InvalidIndex)
         {
-            m_classes[index].m_parentClassIndex = itParentClass->second;
-            m_classes[itParentClass->second].m_childClassIndices.push_back(index);
+            m_classes[index].m_parentClassIndex = parentClassIndex;
+            m_classes[parentClassIndex].m_childClassIndices.push_back(index);
         }
         else
         {
-            if (IsExpectedClass(parentName))
+            if (IsExpectedClass(name.substr(0, path[level - 1].m_nameEnd)))
             {
-                const index_t parentClassIndex = FindOrCreateClassByName(parentName);
-                m_classes[index].m_parentClassIndex = parentClassIndex;
-                m_classes[parentClassIndex].m_childClassIndices.push_back(index);
+                const index_t newParentClassIndex = FindOrCreateClass(name, path, level - 1);
+                m_classes[index].m_parentClassIndex = newParentClassIndex;
+                m_classes[newParentClassIndex].m_childClassIndices.push_back(index);
             }
             else
             {
-                const index_t namespaceIndex = FindOrCreateNamespaceByName(parentName);
+                const index_t namespaceIndex = FindOrCreateNamespace(name, path, level - 1);
                 m_classes[index].m_parentNamespaceIndex = namespaceIndex;
                 m_namespaces[namespaceIndex].m_classIndices.push_back(index);
             }
         }
     }
-    else
-    {
-        m_classes[index].m_className = name;
-    }
 
     return index;
 }
 
-bool MachOReader::IsKnownNamespace(const std::string &name) const
+bool MachOReader::IsKnownNamespace(std::string_view name) const
 {
-    return m_nameToNamespaceIndex.find(name) != m_nameToNamespaceIndex.end();
+    const index_t nodeIndex = m_scopeTrie.FindNode(name);
+    return nodeIndex != InvalidIndex && m_scopeTrie.GetNode(nodeIndex).m_namespaceIndex != InvalidIndex;
 }
 
-bool MachOReader::IsKnownClass(const std::string &name) const
+bool MachOReader::IsKnownClass(std::string_view name) const
 {
-    return m_nameToClassIndex.find(name) != m_nameToClassIndex.end();
+    const index_t nodeIndex = m_scopeTrie.FindNode(name);
+    return nodeIndex != InvalidIndex && m_scopeTrie.GetNode(nodeIndex).m_classIndex != InvalidIndex;
 }
 
-bool MachOReader::IsExpectedClass(const std::string &name) const
+bool MachOReader::IsExpectedClass(std::string_view name) const
 {
-    if (name.find("<") != std::string::npos)
+    if (name.find("<") != std::string_view::npos)
         return true; // Has template syntax.
 
     if (HasCtorOrDtor(name))
@@ -880,7 +1821,7 @@ bool MachOReader::IsExpectedClass(const std::string &name) const
     return false;
 }
 
-bool MachOReader::HasCtorOrDtor(const std::string &name) const
+bool MachOReader::HasCtorOrDtor(std::string_view name) const
 {
     for (const Function &function : m_functions)
     {
@@ -892,19 +1833,65 @@ bool MachOReader::HasCtorOrDtor(const std::string &name) const
     return false;
 }
 
-bool MachOReader::IsFunctionArgument(const std::string &name) const
+bool MachOReader::IsFunctionArgument(std::string_view name) const
 {
+    const index_t typeNameId = FindTypeNameId(name);
+    if (typeNameId == InvalidIndex)
+        return false;
+
     for (const Function &function : m_functions)
     {
-        for (const std::string &type : function.m_functionParameterTypes)
+        for (index_t baseTypeId : function.m_functionParameterBaseTypeIds)
         {
-            if (type == name)
+            if (baseTypeId == typeNameId)
                 return true;
         }
     }
     return false;
 }
 
+void MachOReader::EnsureClassModel()
+{
+    std::call_once(m_classModelOnce, [this]() {
+        // Class generation reads the scopes and parameter types of all functions.
+        DemangleAllFunctionScopes();
+        BuildClassModel(*m_binary);
+    });
+}
+
+void MachOReader::BuildClassModel(const LIEF::MachO::Binary &binary)
+{
+    LIEF::MachO::Binary::it_const_symbols symbols = binary.symbols();
+
+    for (auto it = symbols.begin(); it != symbols.end(); ++it)
+    {
+        const LIEF::MachO::Symbol &symbol = *it;
+
+        switch (symbol.raw_type())
+        {
+            case N_PEXT | N_SECT: {
+                Parse_PEXT_typeinfo(binary, symbol);
+                Parse_PEXT_vtable(binary, symbol);
+                break;
+            }
+        }
+    }
+
+    // Generate classes from functions because not all classes have RTTI.
+    GenerateClassesFromFunctions();
+
+    // Code analyses map stored address points to their vtables.
+    m_vtableAddressIndex.Build(binary);
+
+    AttachVariablesToScopes();
+
+    // Additional base class links need to be build before processing vtables.
+    BuildBaseClassLinks();
+    m_classHierarchy.Build(m_classes);
+
+    ProcessVtables();
+}
+
 void MachOReader::GenerateClassesFromFunctions()
 {
     const index_t functionCount = m_functions.size();
@@ -916,7 +1903,14 @@ void MachOReader::GenerateClassesFromFunctions()
         {
             const bool isNamespace = IsKnownNamespace(function.m_functionDeclContextName);
             const bool isClass = IsKnownClass(function.m_functionDeclContextName);
-            if (!isClass && !isNamespace)
+            if (isClass)
+            {
+                // Classes from RTTI need their member functions for field layouts and constructor analysis.
+                index_t classIndex = FindOrCreateClassByName(function.m_functionDeclContextName);
+                function.m_parentClassIndex = classIndex;
+                m_classes[classIndex].m_functionIndices.push_back(functionIndex);
+            }
+            else if (!isNamespace)
             {
                 if (function.m_isCtorOrDtor || IsExpectedClass(function.m_functionDeclContextName))
                 {
@@ -935,6 +1929,83 @@ void MachOReader::GenerateClassesFromFunctions()
     }
 }
 
+void MachOReader::ResolveGlobalVariableAddresses(const SymbolEntries &symbols)
+{
+    for (const SymbolEntry &symbol : symbols)
+    {
+        if ((symbol.m_type & N_STAB) != 0 || (symbol.m_type & N_TYPE) != N_SECT || (symbol.m_type & N_EXT) == 0)
+            continue;
+
+        // External symbol names have a leading underscore.
+        if (!starts_with(symbol.m_name, "_"))
+            continue;
+
+        StringToIndexMap::iterator it = m_mangledToVariableIndex.find(std::string(symbol.m_name.substr(1)));
+        if (it == m_mangledToVariableIndex.end())
+            continue;
+
+        Variable &variable = m_variables[it->second];
+        variable.m_address = symbol.m_value;
+        variable.m_section = symbol.m_section;
+    }
+}
+
+void MachOReader::AttachVariablesToScopes()
+{
+    const index_t variableCount = m_variables.size();
+    for (index_t variableIndex = 0; variableIndex < variableCount; ++variableIndex)
+    {
+        Variable &variable = m_variables[variableIndex];
+        // Function statics (_ZZ) belong to their function, even if the function is not known.
+        if (variable.m_parentFunctionIndex != InvalidIndex || starts_with(variable.m_mangledName, "_ZZ"))
+            continue;
+
+        const size_t pos = FindClassNameBeginPos(variable.m_name);
+        if (pos == std::string::npos || pos < 2)
+            continue;
+
+        const std::string_view contextName = std::string_view(variable.m_name).substr(0, pos - 2);
+        if (IsKnownClass(contextName) || (!IsKnownNamespace(contextName) && IsExpectedClass(contextName)))
+        {
+            const index_t classIndex = FindOrCreateClassByName(contextName);
+            variable.m_parentClassIndex = classIndex;
+            m_classes[classIndex].m_variableIndices.push_back(variableIndex);
+        }
+        else
+        {
+            const index_t namespaceIndex = FindOrCreateNamespaceByName(contextName);
+            variable.m_parentNamespaceIndex = namespaceIndex;
+            m_namespaces[namespaceIndex].m_variableIndices.push_back(variableIndex);
+        }
+    }
+}
+
+void MachOReader::BuildDataAddressIndex(const LIEF::MachO::Binary &binary)
+{
+    for (const LIEF::MachO::Section &section : binary.sections())
+    {
+        if (DataAddressIndex::IsIndexedSection(section.name()))
+        {
+            m_dataAddressIndex.AddSection(
+                section.segment_name() + "," + section.name(),
+                section.address(),
+                section.size());
+        }
+    }
+
+    const index_t variableCount = m_variables.size();
+    for (index_t variableIndex = 0; variableIndex < variableCount; ++variableIndex)
+    {
+        const Variable &variable = m_variables[variableIndex];
+        if (variable.m_address != 0)
+        {
+            m_dataAddressIndex.AddVariable(variable.m_address, variable.m_size, variableIndex);
+        }
+    }
+
+    m_dataAddressIndex.Finalize();
+}
+
 void MachOReader::BuildBaseClassLinks()
 {
     for (Class &classType : m_classes)
@@ -988,6 +2059,9 @@ bool MachOReader::VerifyBaseClassLinks(const Class &classType)
 
 void MachOReader::ProcessVtables()
 {
+    // Overrides are matched by the full names of the vtable functions.
+    DemangleVtableFunctions();
+
     // Pure virtual names need to be built before all overrides
     // and base class relationships can be populated.
     for (Class &classType : m_classes)
@@ -1000,10 +2074,14 @@ void MachOReader::ProcessVtables()
         ProcessPrimaryVtableOverrides(classType);
     }
 
-    for (Class &classType : m_classes)
+    std::vector<VirtualOverrideIndex::Record> records;
+    const index_t classCount = m_classes.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
     {
-        ProcessPrimaryVtableBaseClassRelationship(classType);
+        ProcessPrimaryVtableBaseClassRelationship(classIndex, records);
     }
+
+    m_virtualOverrideIndex.Build(m_classes, records);
 }
 
 void MachOReader::ProcessVtableOverridesAndPureVirtuals(Class &classType)
@@ -1013,7 +2091,7 @@ void MachOReader::ProcessVtableOverridesAndPureVirtuals(Class &classType)
     if (classType.m_vtables.empty())
         return;
 
-    for (VTable &vtable : classType.m_vtables)
+    for (const VTable &vtable : classType.m_vtables)
     {
         const BaseClass *baseClass = classType.GetBaseClass(vtable.m_offset);
         if (baseClass == nullptr)
@@ -1023,17 +2101,18 @@ void MachOReader::ProcessVtableOverridesAndPureVirtuals(Class &classType)
         if (baseClassType.m_vtables.empty())
             continue;
 
-        VTable &baseVtable = baseClassType.m_vtables.front();
+        const tcb::span<VTableEntry> entries = classType.GetVTableEntries(vtable);
+        const tcb::span<VTableEntry> baseEntries = baseClassType.GetVTableEntries(baseClassType.m_vtables.front());
         const uint16_t vtableCount = vtable.Size();
-        const uint16_t baseVtableCount = baseVtable.Size();
+        const uint16_t baseVtableCount = static_cast<uint16_t>(baseEntries.size());
         assert(vtable.m_offset != 0 || vtableCount >= baseVtableCount);
         assert(vtable.m_offset == 0 || vtableCount == baseVtableCount);
 
         for (uint16_t vtableIndex = 0; vtableIndex < baseVtableCount; ++vtableIndex)
         {
-            VTableEntry &entry = vtable.m_entries[vtableIndex];
-            VTableEntry &baseEntry = baseVtable.m_entries[vtableIndex];
-            assert(entry.m_isDtor == baseEntry.m_isDtor);
+            VTableEntry &entry = entries[vtableIndex];
+            VTableEntry &baseEntry = baseEntries[vtableIndex];
+            assert(entry.IsDtor() == baseEntry.IsDtor());
 
             ProcessVtableEntryOverride(classType, entry);
             ProcessVtableEntryPureVirtual(baseClassType, baseEntry, entry);
@@ -1043,32 +2122,37 @@ void MachOReader::ProcessVtableOverridesAndPureVirtuals(Class &classType)
     }
 }
 
-void MachOReader::ProcessVtableEntryOverride(const Class &classType, VTableEntry &entry)
+void MachOReader::ProcessVtableEntryOverride(const Class &classType, VTableEntry &entry) const
 {
-    if (!entry.m_isPureVirtual && starts_with(entry.m_name, classType.m_name))
+    if (!entry.IsPureVirtual() && starts_with(GetVTableEntryName(entry), classType.m_name))
     {
-        assert(!entry.m_isImplicit);
-        entry.m_isOverride = true;
+        assert(!entry.IsImplicit());
+        entry.m_flags |= VTableEntry::Flag_Override;
     }
     else
     {
-        assert(!entry.m_isOverride);
-        entry.m_isImplicit = true;
+        assert(!entry.IsOverride());
+        entry.m_flags |= VTableEntry::Flag_Implicit;
     }
 }
 
 void MachOReader::ProcessVtableEntryPureVirtual(const Class &baseClassType, VTableEntry &baseEntry, const VTableEntry &entry)
 {
-    if (!entry.m_name.empty() && baseEntry.m_isPureVirtual)
+    if (!baseEntry.IsPureVirtual())
+        return;
+
+    const std::string_view name = GetVTableEntryName(entry);
+    if (name.empty())
+        return;
+
+    if (baseEntry.m_nameId == InvalidIndex)
     {
-        if (baseEntry.m_name.empty())
-        {
-            baseEntry.m_name = MakeFunctionNameWithNewClassName(entry.m_name, baseClassType.m_name);
-        }
-        else
-        {
-            assert(baseEntry.m_name == MakeFunctionNameWithNewClassName(entry.m_name, baseClassType.m_name));
-        }
+        baseEntry.m_nameId = static_cast<index_t>(m_pureVirtualNames.size());
+        m_pureVirtualNames.push_back(MakeFunctionNameWithNewClassName(name, baseClassType.m_name));
+    }
+    else
+    {
+        assert(m_pureVirtualNames[baseEntry.m_nameId] == MakeFunctionNameWithNewClassName(name, baseClassType.m_name));
     }
 }
 
@@ -1079,19 +2163,21 @@ void MachOReader::ProcessPrimaryVtableOverrides(Class &classType)
     if (classType.m_vtables.empty())
         return;
 
-    VTable &vtable = classType.m_vtables.front();
+    const VTable &vtable = classType.m_vtables.front();
     assert(vtable.m_offset == 0);
+    const tcb::span<VTableEntry> entries = classType.GetVTableEntries(vtable);
     uint16_t vtableIndex = 0;
 
-    for (BaseClass &baseClass : classType.m_directBaseClasses)
+    for (const BaseClass &baseClass : classType.m_directBaseClasses)
     {
-        Class &baseClassType = m_classes[baseClass.m_classIndex];
+        const Class &baseClassType = m_classes[baseClass.m_classIndex];
         if (baseClassType.m_vtables.empty())
             return;
 
-        VTable &baseVtable = baseClassType.m_vtables.front();
+        const tcb::span<const VTableEntry> baseEntries =
+            baseClassType.GetVTableEntries(baseClassType.m_vtables.front());
         const uint16_t vtableCount = vtable.Size();
-        const uint16_t baseVtableCount = baseVtable.Size();
+        const uint16_t baseVtableCount = static_cast<uint16_t>(baseEntries.size());
 
         for (uint16_t baseVtableIndex = 0; vtableIndex < vtableCount && baseVtableIndex < baseVtableCount;)
         {
@@ -1100,12 +2186,12 @@ void MachOReader::ProcessPrimaryVtableOverrides(Class &classType)
 
             const uint16_t vtableIndexCopy = vtableIndex;
             const uint16_t baseVtableIndexCopy = baseVtableIndex;
-            if (ProcessPrimaryVtableEntries1(classType, vtable, baseVtable, vtableIndex, baseVtableIndex))
+            if (ProcessPrimaryVtableEntries1(classType, entries, baseEntries, vtableIndex, baseVtableIndex))
                 continue;
 
             vtableIndex = vtableIndexCopy;
             baseVtableIndex = baseVtableIndexCopy + 1;
-            if (ProcessPrimaryVtableEntries2(classType, vtable, baseVtable, vtableIndex, baseVtableIndex))
+            if (ProcessPrimaryVtableEntries2(classType, entries, baseEntries, vtableIndex, baseVtableIndex))
                 continue;
 
             vtableIndex = vtableIndexCopy + 1;
@@ -1116,16 +2202,16 @@ void MachOReader::ProcessPrimaryVtableOverrides(Class &classType)
 
 bool MachOReader::ProcessPrimaryVtableEntries1(
     const Class &classType,
-    VTable &vtable,
-    VTable &baseVtable,
+    tcb::span<VTableEntry> entries,
+    tcb::span<const VTableEntry> baseEntries,
     uint16_t &vtableIndex,
-    uint16_t &baseVtableIndex)
+    uint16_t &baseVtableIndex) const
 {
-    const uint16_t vtableCount = vtable.Size();
+    const uint16_t vtableCount = static_cast<uint16_t>(entries.size());
     while (vtableIndex < vtableCount)
     {
-        VTableEntry &entry = vtable.m_entries[vtableIndex];
-        VTableEntry &baseEntry = baseVtable.m_entries[baseVtableIndex];
+        VTableEntry &entry = entries[vtableIndex];
+        const VTableEntry &baseEntry = baseEntries[baseVtableIndex];
         if (VtableEntryIsOverride(entry, baseEntry))
         {
             ProcessVtableEntryOverride(classType, entry);
@@ -1143,16 +2229,16 @@ bool MachOReader::ProcessPrimaryVtableEntries1(
 
 bool MachOReader::ProcessPrimaryVtableEntries2(
     const Class &classType,
-    VTable &vtable,
-    VTable &baseVtable,
+    tcb::span<VTableEntry> entries,
+    tcb::span<const VTableEntry> baseEntries,
     uint16_t &vtableIndex,
-    uint16_t &baseVtableIndex)
+    uint16_t &baseVtableIndex) const
 {
-    const uint16_t baseVtableCount = baseVtable.Size();
+    const uint16_t baseVtableCount = static_cast<uint16_t>(baseEntries.size());
     while (baseVtableIndex < baseVtableCount)
     {
-        VTableEntry &entry = vtable.m_entries[vtableIndex];
-        VTableEntry &baseEntry = baseVtable.m_entries[baseVtableIndex];
+        VTableEntry &entry = entries[vtableIndex];
+        const VTableEntry &baseEntry = baseEntries[baseVtableIndex];
         if (VtableEntryIsOverride(entry, baseEntry))
         {
             ProcessVtableEntryOverride(classType, entry);
@@ -1168,12 +2254,15 @@ bool MachOReader::ProcessPrimaryVtableEntries2(
     return false;
 }
 
-bool MachOReader::VtableEntryIsOverride(const VTableEntry &entry1, const VTableEntry &entry2)
+bool MachOReader::VtableEntryIsOverride(const VTableEntry &entry1, const VTableEntry &entry2) const
 {
-    const std::string_view entry1FunctionName = GetFunctionNameWithoutClassName(entry1.m_name);
-    const std::string_view entry2FunctionName = GetFunctionNameWithoutClassName(entry2.m_name);
+    if (entry1.IsDtor() && entry2.IsDtor())
+        return true;
+
+    const std::string_view entry1FunctionName = GetFunctionNameWithoutClassName(GetVTableEntryName(entry1));
+    const std::string_view entry2FunctionName = GetFunctionNameWithoutClassName(GetVTableEntryName(entry2));
 
-    if ((entry1.m_isDtor && entry2.m_isDtor) || (entry1FunctionName == entry2FunctionName))
+    if (entry1FunctionName == entry2FunctionName)
     {
         return true;
     }
@@ -1181,8 +2270,11 @@ bool MachOReader::VtableEntryIsOverride(const VTableEntry &entry1, const VTableE
 }
 
 // Note: This function is likely more expensive than it needs to be.
-void MachOReader::ProcessPrimaryVtableBaseClassRelationship(Class &classType)
+void MachOReader::ProcessPrimaryVtableBaseClassRelationship(
+    index_t classIndex,
+    std::vector<VirtualOverrideIndex::Record> &records)
 {
+    Class &classType = m_classes[classIndex];
     if (classType.m_directBaseClasses.empty())
         return;
     if (classType.m_vtables.empty())
@@ -1196,24 +2288,39 @@ void MachOReader::ProcessPrimaryVtableBaseClassRelationship(Class &classType)
         if (baseClassType.m_vtables.empty())
             continue;
 
-        VTable &vtable = classType.m_vtables.front();
-        const VTable &baseVtable = baseClassType.m_vtables.front();
+        const tcb::span<VTableEntry> entries = classType.GetVTableEntries(classType.m_vtables.front());
+        const tcb::span<const VTableEntry> baseEntries =
+            baseClassType.GetVTableEntries(baseClassType.m_vtables.front());
+        const uint16_t vtableCount = static_cast<uint16_t>(entries.size());
+        const uint16_t baseVtableCount = static_cast<uint16_t>(baseEntries.size());
 
-        for (VTableEntry &entry : vtable.m_entries)
+        for (uint16_t vtableIndex = 0; vtableIndex < vtableCount; ++vtableIndex)
         {
+            VTableEntry &entry = entries[vtableIndex];
             if (entry.m_allBaseClassIndex != InvalidIndex)
                 continue;
             if (entry.IsFirstDeclaration())
                 continue;
 
-            for (const VTableEntry &baseEntry : baseVtable.m_entries)
+            for (uint16_t baseVtableIndex = 0; baseVtableIndex < baseVtableCount; ++baseVtableIndex)
             {
+                const VTableEntry &baseEntry = baseEntries[baseVtableIndex];
                 if (!baseEntry.IsFirstDeclaration())
                     continue;
                 if (!VtableEntryIsOverride(entry, baseEntry))
                     continue;
 
                 entry.m_allBaseClassIndex = baseClassIndex;
+
+                VirtualOverrideIndex::Record record;
+                record.m_declaringClassIndex = baseClass.m_classIndex;
+                record.m_declaringEntryIndex = baseVtableIndex;
+                record.m_entryIndex = vtableIndex;
+                record.m_isImplicit = entry.IsImplicit();
+                record.m_override.m_classIndex = classIndex;
+                record.m_override.m_functionIndex = entry.GetFunctionIndex();
+                record.m_override.m_thunkIndex = entry.GetThunkIndex();
+                records.push_back(record);
                 break;
             }
         }
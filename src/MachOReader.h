@@ -1,12 +1,32 @@
 #pragma once
 
+#include "CallGraph.h"
+#include "ClassHierarchy.h"
+#include "ConstructorAnalysis.h"
 #include "CppTypes.h"
+#include "DataAddressIndex.h"
+#include "FieldLayoutInference.h"
+#include "FunctionCode.h"
+#include "IdenticalCodeIndex.h"
+#include "IncludeGraph.h"
+#include "IncludeTable.h"
+#include "LineTable.h"
+#include "NameSearchIndex.h"
+#include "ObjectFile.h"
+#include "ScopeTrie.h"
+#include "StabsParser.h"
+#include "TemplateIndex.h"
+#include "VTableAddressIndex.h"
+#include "VirtualOverrideIndex.h"
+#include "llvm/demangle.h"
 
 #include "LIEF/config.h"
 
 #include <LIEF/MachO/Header.hpp>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string_view>
 
 namespace LIEF::MachO
@@ -15,41 +35,162 @@ class Binary;
 class Symbol;
 } // namespace LIEF::MachO
 
+class ThreadPool;
+
+struct MachOReaderOptions
+{
+    // Reads the stabs from the object files referenced by N_OSO entries, if the binary was linked with a debug map.
+    bool m_followObjectFiles = false;
+    // Number of threads of the thread pool of the reader, which runs all parallel work. 0 uses one thread per hardware
+    // thread.
+    size_t m_threadCount = 0;
+    // Keeps only mangled function names during Load. Functions are demangled when first accessed, and classes are
+    // built when first queried. The class model demangles only the scopes and parameter base types of all functions,
+    // and the full names of the functions in vtables.
+    bool m_lazyDemangling = false;
+    // Hashes the code of all function variants to find identical copies.
+    bool m_findIdenticalCode = false;
+};
+
 class MachOReader
 {
 public:
-    MachOReader();
+    explicit MachOReader(const MachOReaderOptions &options = MachOReaderOptions());
     ~MachOReader();
 
     bool Load(const std::string &filepath, LIEF::MachO::Header::CPU_TYPE cpuType);
 
+    const LIEF::MachO::Binary &GetBinary() const { return *m_binary; }
+
+    index_t GetFunctionCount() const { return static_cast<index_t>(m_functions.size()); }
+    // Demangles all functions first in lazy demangling mode.
+    const Functions &GetFunctions();
+    // Can be called from multiple threads, but not while the class model is built.
+    const Function &GetFunction(index_t functionIndex);
+    // Finds the function that contains the given code address, if any.
+    index_t FindFunctionByAddress(uint64_t address) const;
+    // Finds the source line that covers the given code address, if any.
+    bool FindLine(uint64_t address, LineTableRow &row) const { return m_lineTable.FindLine(address, row); }
+    // Source lines of all function variants, by FunctionVariant::m_lineRangeIndex.
+    const LineTable &GetLineTable() const { return m_lineTable; }
+
+    const HeaderFiles &GetHeaderFiles() const { return m_headerFiles; }
+    const SourceFiles &GetSourceFiles() const { return m_sourceFiles; }
+    const Namespaces &GetNamespaces();
+    const Classes &GetClasses();
+    const Variables &GetVariables();
+    const Types &GetTypes();
+    const Enums &GetEnums();
+    const NonVirtualThunks &GetThunks() const { return m_thunks; }
+    // Demangled parameter type names, by Function::m_functionParameterTypeIds. Demangles all functions first.
+    const std::vector<std::string_view> &GetTypeNames();
+    // Subtype queries over all classes.
+    const ClassHierarchy &GetClassHierarchy();
+    // Overriding functions per virtual function of a base class.
+    const VirtualOverrideIndex &GetVirtualOverrideIndex();
+    // Namespaces and classes by qualified name, with parent and child scopes.
+    const ScopeTrie &GetScopeTrie();
+    // Class and function template instantiations grouped by template. Built on first use.
+    const TemplateIndex &GetTemplateIndex();
+    // Substring and fuzzy search over function, class and namespace names. Built on first use.
+    const NameSearchIndex &GetNameSearchIndex();
+    // Direct calls between functions, scanned from the code. Built on first use.
+    const CallGraph &GetCallGraph();
+    // Data member offsets and sizes of classes, inferred from this relative accesses in member functions. Built on
+    // first use.
+    const FieldLayoutInference &GetFieldLayoutInference();
+    // Vtables stored by constructors and allocation sizes passed to operator new, per class. Built on first use. The
+    // class model does not wait for it, so sizes and vtables of classes without RTTI are only known from here.
+    const ConstructorAnalysis &GetConstructorAnalysis();
+    // Name of the function or thunk of a vtable entry, or of the pure virtual function. Empty if unknown.
+    std::string_view GetVTableEntryName(const VTableEntry &entry) const;
+    // Header files that contributed code to source files, and the reverse. Built on first use.
+    const IncludeGraph &GetIncludeGraph();
+    // Function variants with identical code. Empty unless enabled in the options.
+    const IdenticalCodeIndex &GetIdenticalCodeIndex() const { return m_identicalCodeIndex; }
+    // Maps data addresses to global and static variables.
+    const DataAddressIndex &GetDataAddressIndex() const { return m_dataAddressIndex; }
+    // Code bytes of all function variants.
+    const FunctionCode &GetFunctionCode() const { return m_functionCode; }
+    // Runs the parallel work of the reader. Must not be used from its own jobs.
+    ThreadPool &GetThreadPool() { return *m_threadPool; }
+
 private:
     void Patch(LIEF::MachO::Binary &binary);
     bool Parse(const LIEF::MachO::Binary &binary);
-    void Parse_PEXT_thunks(const LIEF::MachO::Symbol &symbol);
+    // Parses stabs and thunks.
+    void ParseSymbols(const SymbolEntries &symbols);
+    void Parse_PEXT_thunks(const SymbolEntry &symbol);
     void Parse_PEXT_typeinfo(const LIEF::MachO::Binary &binary, const LIEF::MachO::Symbol &symbol);
     void Parse_PEXT_vtable(const LIEF::MachO::Binary &binary, const LIEF::MachO::Symbol &symbol);
-    void Parse_SO(const LIEF::MachO::Symbol &symbol, bool &SO_InBlock, std::string &SO_Prefix);
-    void Parse_SOL(const LIEF::MachO::Symbol &symbol, const std::string &SO_Prefix, index_t functionIndex);
-    void Parse_FUN(const LIEF::MachO::Symbol &symbol, index_t &functionIndex);
-    void Parse_GSYM(const LIEF::MachO::Symbol &symbol);
-    void Parse_STSYM(const LIEF::MachO::Symbol &symbol);
-    void Parse_LCSYM(const LIEF::MachO::Symbol &symbol);
+    void ParseVtable(const LIEF::MachO::Binary &binary, uint64_t symbolAddress, index_t classIndex);
+    void Parse_SO(const SymbolEntry &symbol, bool &SO_InBlock, std::string &SO_Prefix);
+    void Parse_SOL(
+        const SymbolEntry &symbol,
+        const std::string &SO_Prefix,
+        index_t functionIndex,
+        StringViewToIndexMap &headerFileCache);
+    void Parse_FUN(const SymbolEntry &symbol, index_t &functionIndex);
+    void SetDemangledParts(Function &function, const itanium_function_parts &parts);
+    void SetDemangledScopeParts(Function &function, const itanium_function_parts &parts);
+    void EnsureFunctionDemangled(index_t functionIndex);
+    void DemangleAllFunctions();
+    void DemangleAllFunctionScopes();
+    void DemangleVtableFunctions();
+    void Parse_SLINE(const SymbolEntry &symbol, index_t functionIndex);
+    void Parse_LSYM(const SymbolEntry &symbol);
+    void Parse_PSYM(const SymbolEntry &symbol, index_t functionIndex);
+    void Parse_BINCL(const SymbolEntry &symbol);
+    void Parse_EXCL(const SymbolEntry &symbol);
+    void Parse_GSYM(const SymbolEntry &symbol);
+    void Parse_STSYM(const SymbolEntry &symbol, index_t functionIndex);
+    void Parse_LCSYM(const SymbolEntry &symbol, index_t functionIndex);
+    void Parse_Variable(const SymbolEntry &symbol, Variable::Type type, index_t functionIndex);
 
 private:
+    // Parses the stab string of the symbol. Returns false if the string is not understood or continues in the next
+    // symbol.
+    bool ParseStabsString(const SymbolEntry &symbol);
+    void BeginStabsTypeTables();
+    index_t &GetStabsTypeSlot(StabsTypeNumber number);
+    void DefineStabsType(StabsTypeNumber number, index_t typeIndex);
+    // Converts a parsed stab type to the type model. The name is used for types defined by tags and typedefs.
+    index_t ResolveStabsType(uint32_t node, std::string_view name);
+    index_t ResolveStabsClassType(uint32_t node, std::string_view name);
+    index_t ResolveStabsEnumType(uint32_t node, std::string_view name);
+    bool IsStabsTypeNamedBySymbol(uint32_t node) const;
+
+    index_t FindOrCreateNamedType(Type::Kind kind, std::string_view name, uint32_t size);
+    index_t FindOrCreateDerivedType(Type::Kind kind, index_t targetTypeIndex, uint32_t count);
+    index_t FindOrCreateClassType(index_t classIndex);
+    index_t FindOrCreateEnumType(index_t enumIndex);
+
+    index_t FindOrCreateTypeNameId(std::string_view name);
+    index_t FindTypeNameId(std::string_view name) const;
+
     index_t FindOrCreateHeaderFileByName(const std::string &name);
-    index_t FindOrCreateNamespaceByName(const std::string &name);
+    index_t FindOrCreateNamespaceByName(std::string_view name);
     index_t FindOrCreateEnumByName(const std::string &name);
-    index_t FindOrCreateClassByName(const std::string &name);
+    index_t FindOrCreateClassByName(std::string_view name);
+    // Creates the namespace or class of the scope at the given level of the walked name, and its parents.
+    index_t FindOrCreateNamespace(std::string_view name, const ScopeTrie::Path &path, size_t level);
+    index_t FindOrCreateClass(std::string_view name, const ScopeTrie::Path &path, size_t level);
 
-    bool IsKnownNamespace(const std::string &name) const;
-    bool IsKnownClass(const std::string &name) const;
+    bool IsKnownNamespace(std::string_view name) const;
+    bool IsKnownClass(std::string_view name) const;
 
-    bool IsExpectedClass(const std::string &name) const;
-    bool HasCtorOrDtor(const std::string &name) const;
-    bool IsFunctionArgument(const std::string &name) const;
+    bool IsExpectedClass(std::string_view name) const;
+    bool HasCtorOrDtor(std::string_view name) const;
+    bool IsFunctionArgument(std::string_view name) const;
 
+    // Builds classes, namespaces and vtables from RTTI and function names. Runs once.
+    void EnsureClassModel();
+    void BuildClassModel(const LIEF::MachO::Binary &binary);
     void GenerateClassesFromFunctions();
+    // Global variable stabs have no address. Takes it from the external symbols.
+    void ResolveGlobalVariableAddresses(const SymbolEntries &symbols);
+    void AttachVariablesToScopes();
+    void BuildDataAddressIndex(const LIEF::MachO::Binary &binary);
     void BuildBaseClassLinks();
     void BuildBaseClassLinksRecursive(
         const Class &classType,
@@ -61,47 +202,97 @@ private:
     // Goes through primary and secondary vtables and fills names for all pure virtual functions that are overridden.
     // Not all vtable entries in primary vtables are visited.
     void ProcessVtableOverridesAndPureVirtuals(Class &classType);
-    static void ProcessVtableEntryOverride(const Class &classType, VTableEntry &entry);
-    static void ProcessVtableEntryPureVirtual(const Class &baseClassType, VTableEntry &baseEntry, const VTableEntry &entry);
+    void ProcessVtableEntryOverride(const Class &classType, VTableEntry &entry) const;
+    void ProcessVtableEntryPureVirtual(const Class &baseClassType, VTableEntry &baseEntry, const VTableEntry &entry);
     // Goes through the whole primary vtable and determines overrides.
     void ProcessPrimaryVtableOverrides(Class &classType);
-    static bool ProcessPrimaryVtableEntries1(
+    bool ProcessPrimaryVtableEntries1(
         const Class &classType,
-        VTable &vtable,
-        VTable &baseVtable,
+        tcb::span<VTableEntry> entries,
+        tcb::span<const VTableEntry> baseEntries,
         uint16_t &vtableIndex,
-        uint16_t &baseVtableIndex);
-    static bool ProcessPrimaryVtableEntries2(
+        uint16_t &baseVtableIndex) const;
+    bool ProcessPrimaryVtableEntries2(
         const Class &classType,
-        VTable &vtable,
-        VTable &baseVtable,
+        tcb::span<VTableEntry> entries,
+        tcb::span<const VTableEntry> baseEntries,
         uint16_t &vtableIndex,
-        uint16_t &baseVtableIndex);
-    static bool VtableEntryIsOverride(const VTableEntry &entry1, const VTableEntry &entry2);
-    // Goes through the whole primary vtable and builds relationships with bottom base classes.
-    void ProcessPrimaryVtableBaseClassRelationship(Class &classType);
+        uint16_t &baseVtableIndex) const;
+    bool VtableEntryIsOverride(const VTableEntry &entry1, const VTableEntry &entry2) const;
+    // Goes through the whole primary vtable and builds relationships with bottom base classes. Adds a record for every
+    // resolved entry.
+    void ProcessPrimaryVtableBaseClassRelationship(
+        index_t classIndex,
+        std::vector<VirtualOverrideIndex::Record> &records);
 
 private:
+    MachOReaderOptions m_options;
     std::unique_ptr<LIEF::MachO::Binary> m_binary;
+    std::unique_ptr<ThreadPool> m_threadPool;
 
     Namespaces m_namespaces;
+    Types m_types;
     Enums m_enums;
     Variables m_variables;
     Classes m_classes;
     NonVirtualThunks m_thunks;
+    std::vector<std::string> m_pureVirtualNames; // By VTableEntry::m_nameId.
     Functions m_functions;
     HeaderFiles m_headerFiles;
     SourceFiles m_sourceFiles;
+    IncludeTable m_includeTable;
+    FunctionCode m_functionCode;
+    IdenticalCodeIndex m_identicalCodeIndex;
+    LineTable m_lineTable;
+    DataAddressIndex m_dataAddressIndex;
+    ScopeTrie m_scopeTrie; // Namespaces and classes.
+    ScopeTrie::Path m_scopePath;
+    ClassHierarchy m_classHierarchy;
+    VirtualOverrideIndex m_virtualOverrideIndex;
+    VTableAddressIndex m_vtableAddressIndex;
 
-    StringToIndexMap m_nameToNamespaceIndex;
+    std::vector<std::string_view> m_typeNames; // Demangled type names by id. Views into the keys of m_typeNameToId.
+    StringToIndexMap m_typeNameToId;
+
+    NamedTypeToIndexMap m_nameToTypeIndex; // Builtin and typedef types, by kind and name.
+    HashToIndexMap m_keyToDerivedTypeIndex; // Pointer, reference, array... types.
     StringToIndexMap m_nameToEnumIndex;
-    // StringToIndexMap m_nameToVariableIndex;
-    AddressToIndexMap m_addressToVariableIndex;
-    StringToIndexMap m_nameToClassIndex;
+    StringToIndexMap m_mangledToVariableIndex; // Global variables.
+    AddressToIndexMap m_addressToVariableIndex; // Static variables.
     AddressToIndexMap m_addressToThunkIndex;
-    StringToIndexMultiMap m_nameToFunctionIndex;
+    StringToIndexMultiMap m_nameToFunctionIndex; // Demangled name, or variant key in lazy demangling mode.
     StringToIndexMultiMap m_mangledToFunctionIndex;
     AddressToIndexMap m_addressToFunctionIndex;
+    AddressToIndexMap m_vtableAddressToClassIndex; // Parsed vtables.
     StringToIndexMap m_nameToHeaderFileIndex;
     StringToIndexMap m_nameToSourceFileIndex;
+
+    // Lazy demangling state.
+    std::unique_ptr<std::atomic<bool>[]> m_functionDemangled; // Per function. Only allocated in lazy demangling mode.
+    mutable std::mutex m_demangleMutex;
+    bool m_functionScopesDemangled = false; // Guarded by m_demangleMutex.
+    std::once_flag m_allFunctionsDemangledOnce;
+    std::once_flag m_classModelOnce;
+    NameSearchIndex m_nameSearchIndex;
+    std::once_flag m_nameSearchIndexOnce;
+    CallGraph m_callGraph;
+    std::once_flag m_callGraphOnce;
+    FieldLayoutInference m_fieldLayoutInference;
+    std::once_flag m_fieldLayoutInferenceOnce;
+    ConstructorAnalysis m_constructorAnalysis;
+    std::once_flag m_constructorAnalysisOnce;
+    IncludeGraph m_includeGraph;
+    std::once_flag m_includeGraphOnce;
+    TemplateIndex m_templateIndex;
+    std::once_flag m_templateIndexOnce;
+
+    // STABS type parse state.
+    StabsParser m_stabsParser;
+    std::string m_stabsString; // Stab string assembled from continued symbols.
+    std::string m_stabsContinuation; // Stab string parts that end with a backslash.
+    std::vector<std::vector<index_t>> m_stabsTypeTables; // Type number to type index, per source and header file.
+    std::vector<index_t> m_stabsFileTypeTables; // File number in current source file to type table index.
+    StringToIndexMap m_stabsHeaderToTypeTable; // N_BINCL name and checksum to type table index.
+    index_t m_parameterFunctionIndex = InvalidIndex; // Function and variant whose N_PSYM entries are recorded.
+    uint32_t m_parameterVariantIndex = 0;
 };
@@ -0,0 +1,343 @@
+#include "ModelDiff.h"
+
+#include "MachOReader.h"
+#include "utility.h"
+
+#include <fmt/core.h>
+
+#define XXH_INLINE_ALL
+#include <xxhash.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+namespace
+{
+uint64_t HashString(std::string_view str)
+{
+    return XXH3_64bits(str.data(), str.size());
+}
+
+uint64_t GetCodeSize(const Function &function)
+{
+    uint64_t size = 0;
+    for (const FunctionVariant &variant : function.m_variants)
+    {
+        size += variant.m_size;
+    }
+    return size;
+}
+
+const char *GetEntityKindName(ModelDiff::EntityKind kind)
+{
+    switch (kind)
+    {
+        case ModelDiff::EntityKind::Class:
+            return "class";
+        case ModelDiff::EntityKind::Function:
+            return "function";
+    }
+    return "";
+}
+} // namespace
+
+void ModelDiff::ComputeSignatures(MachOReader &reader, ModelSignatures &signatures)
+{
+    const Classes &classes = reader.GetClasses();
+    const Functions &functions = reader.GetFunctions();
+    const HeaderFiles &headerFiles = reader.GetHeaderFiles();
+    const SourceFiles &sourceFiles = reader.GetSourceFiles();
+
+    signatures.m_classKeys.resize(classes.size());
+    signatures.m_classSignatures.resize(classes.size());
+    const index_t classCount = classes.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const Class &classType = classes[classIndex];
+        uint64_t signature = classType.m_size;
+        signature = hash_combine(signature, ComputeBaseClassesHash(classes, classType));
+        signature = hash_combine(signature, ComputeVTablesHash(reader, classType));
+        signature = hash_combine(signature, ComputeMembersHash(classType));
+        signatures.m_classKeys[classIndex] = HashString(classType.m_name);
+        signatures.m_classSignatures[classIndex] = signature;
+    }
+
+    signatures.m_functionKeys.resize(functions.size());
+    signatures.m_functionSignatures.resize(functions.size());
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const Function &function = functions[functionIndex];
+        uint64_t key = HashString(function.m_name);
+        if (function.m_sourceFileIndex != InvalidIndex)
+        {
+            // Local functions of different source files can have the same name.
+            key = hash_combine(key, HashString(sourceFiles[function.m_sourceFileIndex].m_name));
+        }
+
+        uint64_t signature = function.m_variants.size();
+        signature = hash_combine(signature, GetCodeSize(function));
+        signature = hash_combine(signature, ComputeSourceLinesHash(function));
+        signature = hash_combine(signature, ComputeHeaderFilesHash(headerFiles, function));
+        signatures.m_functionKeys[functionIndex] = key;
+        signatures.m_functionSignatures[functionIndex] = signature;
+    }
+}
+
+void ModelDiff::Compare(
+    MachOReader &reader1,
+    const ModelSignatures &signatures1,
+    MachOReader &reader2,
+    const ModelSignatures &signatures2)
+{
+    m_entries.clear();
+
+    CompareEntities(
+        EntityKind::Class,
+        reader1.GetClasses(),
+        signatures1.m_classKeys,
+        signatures1.m_classSignatures,
+        reader2.GetClasses(),
+        signatures2.m_classKeys,
+        signatures2.m_classSignatures,
+        [](const Class &classType) { return classType.m_name; },
+        [&](const Class &classType1, const Class &classType2) {
+            return CompareClasses(reader1, classType1, reader2, classType2);
+        });
+
+    CompareEntities(
+        EntityKind::Function,
+        reader1.GetFunctions(),
+        signatures1.m_functionKeys,
+        signatures1.m_functionSignatures,
+        reader2.GetFunctions(),
+        signatures2.m_functionKeys,
+        signatures2.m_functionSignatures,
+        [](const Function &function) { return function.m_name; },
+        [&](const Function &function1, const Function &function2) {
+            return CompareFunctions(reader1, function1, reader2, function2);
+        });
+}
+
+void ModelDiff::Print() const
+{
+    static const char *const s_changeFlagNames[] = {
+        "size",
+        "bases",
+        "vtables",
+        "members",
+        "variants",
+        "code size",
+        "source lines",
+        "headers",
+    };
+
+    for (const Entry &entry : m_entries)
+    {
+        const char *kindName = GetEntityKindName(entry.m_entityKind);
+        switch (entry.m_changeKind)
+        {
+            case ChangeKind::Added:
+                fmt::print("+ {} {}\n", kindName, entry.m_name);
+                break;
+            case ChangeKind::Removed:
+                fmt::print("- {} {}\n", kindName, entry.m_name);
+                break;
+            case ChangeKind::Changed: {
+                std::string flags;
+                for (size_t i = 0; i < std::size(s_changeFlagNames); ++i)
+                {
+                    if (entry.m_changeFlags & (1u << i))
+                    {
+                        if (!flags.empty())
+                            flags += ", ";
+                        flags += s_changeFlagNames[i];
+                    }
+                }
+                fmt::print("~ {} {} ({})\n", kindName, entry.m_name, flags);
+                break;
+            }
+        }
+    }
+}
+
+template<typename Entities, typename GetName, typename CompareFields>
+void ModelDiff::CompareEntities(
+    EntityKind entityKind,
+    const Entities &entities1,
+    const std::vector<uint64_t> &keys1,
+    const std::vector<uint64_t> &signatures1,
+    const Entities &entities2,
+    const std::vector<uint64_t> &keys2,
+    const std::vector<uint64_t> &signatures2,
+    GetName &&getName,
+    CompareFields &&compareFields)
+{
+    // Entities with equal keys, like static functions with the same name in one source file, are matched in order.
+    const index_t count1 = keys1.size();
+    std::vector<index_t> sortedIndices1(count1);
+    for (index_t index1 = 0; index1 < count1; ++index1)
+    {
+        sortedIndices1[index1] = index1;
+    }
+    std::stable_sort(sortedIndices1.begin(), sortedIndices1.end(), [&keys1](index_t left, index_t right) {
+        return keys1[left] < keys1[right];
+    });
+
+    // Range of the unmatched entities of a key in sortedIndices1.
+    std::unordered_map<uint64_t, std::pair<index_t, index_t>> keyToRange1;
+    keyToRange1.reserve(count1);
+    for (index_t begin = 0; begin < count1;)
+    {
+        const uint64_t key = keys1[sortedIndices1[begin]];
+        index_t end = begin + 1;
+        while (end < count1 && keys1[sortedIndices1[end]] == key)
+        {
+            ++end;
+        }
+        keyToRange1.emplace(key, std::make_pair(begin, end));
+        begin = end;
+    }
+
+    std::vector<bool> matched1(count1, false);
+    const index_t count2 = keys2.size();
+    for (index_t index2 = 0; index2 < count2; ++index2)
+    {
+        Entry entry;
+        entry.m_entityKind = entityKind;
+        entry.m_index2 = index2;
+
+        auto it = keyToRange1.find(keys2[index2]);
+        if (it == keyToRange1.end() || it->second.first == it->second.second)
+        {
+            entry.m_changeKind = ChangeKind::Added;
+            entry.m_name = getName(entities2[index2]);
+            m_entries.push_back(std::move(entry));
+            continue;
+        }
+
+        const index_t index1 = sortedIndices1[it->second.first++];
+        matched1[index1] = true;
+        if (signatures1[index1] == signatures2[index2])
+            continue;
+
+        entry.m_changeKind = ChangeKind::Changed;
+        entry.m_changeFlags = compareFields(entities1[index1], entities2[index2]);
+        entry.m_index1 = index1;
+        entry.m_name = getName(entities2[index2]);
+        m_entries.push_back(std::move(entry));
+    }
+
+    for (index_t index1 = 0; index1 < count1; ++index1)
+    {
+        if (matched1[index1])
+            continue;
+
+        Entry entry;
+        entry.m_entityKind = entityKind;
+        entry.m_changeKind = ChangeKind::Removed;
+        entry.m_index1 = index1;
+        entry.m_name = getName(entities1[index1]);
+        m_entries.push_back(std::move(entry));
+    }
+}
+
+uint32_t ModelDiff::CompareClasses(
+    MachOReader &reader1,
+    const Class &classType1,
+    MachOReader &reader2,
+    const Class &classType2)
+{
+    uint32_t flags = ChangeFlag_None;
+    if (classType1.m_size != classType2.m_size)
+        flags |= ChangeFlag_Size;
+    if (ComputeBaseClassesHash(reader1.GetClasses(), classType1)
+        != ComputeBaseClassesHash(reader2.GetClasses(), classType2))
+        flags |= ChangeFlag_BaseClasses;
+    if (ComputeVTablesHash(reader1, classType1) != ComputeVTablesHash(reader2, classType2))
+        flags |= ChangeFlag_VTables;
+    if (ComputeMembersHash(classType1) != ComputeMembersHash(classType2))
+        flags |= ChangeFlag_Members;
+    return flags;
+}
+
+uint32_t ModelDiff::CompareFunctions(
+    MachOReader &reader1,
+    const Function &function1,
+    MachOReader &reader2,
+    const Function &function2)
+{
+    uint32_t flags = ChangeFlag_None;
+    if (function1.m_variants.size() != function2.m_variants.size())
+        flags |= ChangeFlag_Variants;
+    if (GetCodeSize(function1) != GetCodeSize(function2))
+        flags |= ChangeFlag_CodeSize;
+    if (ComputeSourceLinesHash(function1) != ComputeSourceLinesHash(function2))
+        flags |= ChangeFlag_SourceLines;
+    if (ComputeHeaderFilesHash(reader1.GetHeaderFiles(), function1)
+        != ComputeHeaderFilesHash(reader2.GetHeaderFiles(), function2))
+        flags |= ChangeFlag_HeaderFiles;
+    return flags;
+}
+
+uint64_t ModelDiff::ComputeBaseClassesHash(const Classes &classes, const Class &classType)
+{
+    uint64_t hash = classType.m_directBaseClasses.size();
+    for (const BaseClass &baseClass : classType.m_directBaseClasses)
+    {
+        hash = hash_combine(hash, HashString(classes[baseClass.m_classIndex].m_name));
+        hash = hash_combine(hash, baseClass.m_baseOffset);
+        hash = hash_combine(hash, baseClass.m_isVirtual);
+    }
+    return hash;
+}
+
+uint64_t ModelDiff::ComputeVTablesHash(const MachOReader &reader, const Class &classType)
+{
+    uint64_t hash = classType.m_vtables.size();
+    for (const VTable &vtable : classType.m_vtables)
+    {
+        hash = hash_combine(hash, vtable.m_offset);
+        hash = hash_combine(hash, vtable.Size());
+        for (const VTableEntry &entry : classType.GetVTableEntries(vtable))
+        {
+            hash = hash_combine(hash, HashString(reader.GetVTableEntryName(entry)));
+            hash = hash_combine(hash, (uint32_t(entry.IsDtor()) << 1) | uint32_t(entry.IsPureVirtual()));
+        }
+    }
+    return hash;
+}
+
+uint64_t ModelDiff::ComputeMembersHash(const Class &classType)
+{
+    uint64_t hash = classType.m_members.size();
+    for (const ClassMember &member : classType.m_members)
+    {
+        hash = hash_combine(hash, HashString(member.m_name));
+        hash = hash_combine(hash, member.m_bitOffset);
+        hash = hash_combine(hash, member.m_bitSize);
+    }
+    return hash;
+}
+
+uint64_t ModelDiff::ComputeSourceLinesHash(const Function &function)
+{
+    uint64_t hash = 0;
+    for (const FunctionVariant &variant : function.m_variants)
+    {
+        hash = hash_combine(hash, variant.m_sourceLine);
+    }
+    return hash;
+}
+
+uint64_t ModelDiff::ComputeHeaderFilesHash(const HeaderFiles &headerFiles, const Function &function)
+{
+    // Header indices differ between builds. The sum of the name hashes does not depend on the order.
+    uint64_t hash = function.m_headerFileIndices.Size();
+    for (index_t headerFileIndex : function.m_headerFileIndices)
+    {
+        hash += HashString(headerFiles[headerFileIndex].m_name);
+    }
+    return hash;
+}
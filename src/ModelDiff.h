@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MachOReader;
+
+// Differences between the models of two builds. Every class and function gets a 64-bit signature of its structure,
+// built from names and not from indices, so signatures are comparable between builds. Only entities with different
+// signatures are compared field by field.
+class ModelDiff
+{
+public:
+    enum class EntityKind : uint8_t
+    {
+        Class,
+        Function,
+    };
+
+    enum class ChangeKind : uint8_t
+    {
+        Added,
+        Removed,
+        Changed,
+    };
+
+    enum ChangeFlags : uint32_t
+    {
+        ChangeFlag_None = 0,
+        // Class
+        ChangeFlag_Size = 1 << 0,
+        ChangeFlag_BaseClasses = 1 << 1,
+        ChangeFlag_VTables = 1 << 2,
+        ChangeFlag_Members = 1 << 3,
+        // Function
+        ChangeFlag_Variants = 1 << 4,
+        ChangeFlag_CodeSize = 1 << 5,
+        ChangeFlag_SourceLines = 1 << 6,
+        ChangeFlag_HeaderFiles = 1 << 7,
+    };
+
+    struct Entry
+    {
+        EntityKind m_entityKind = EntityKind::Class;
+        ChangeKind m_changeKind = ChangeKind::Added;
+        uint32_t m_changeFlags = ChangeFlag_None; // Set for changed entities.
+        index_t m_index1 = InvalidIndex; // Index in the first model. Invalid if added.
+        index_t m_index2 = InvalidIndex; // Index in the second model. Invalid if removed.
+        std::string m_name;
+    };
+
+    struct ModelSignatures
+    {
+        std::vector<uint64_t> m_classKeys; // Hash of the name.
+        std::vector<uint64_t> m_classSignatures;
+        std::vector<uint64_t> m_functionKeys; // Hash of the name and the source file name.
+        std::vector<uint64_t> m_functionSignatures;
+    };
+
+public:
+    // Computes the signatures of one model. Can run for several models in parallel.
+    static void ComputeSignatures(MachOReader &reader, ModelSignatures &signatures);
+
+    void Compare(
+        MachOReader &reader1,
+        const ModelSignatures &signatures1,
+        MachOReader &reader2,
+        const ModelSignatures &signatures2);
+
+    const std::vector<Entry> &GetEntries() const { return m_entries; }
+
+    // Prints one line per entry, such as "~ class Foo (size, vtables)".
+    void Print() const;
+
+private:
+    template<typename Entities, typename GetName, typename CompareFields>
+    void CompareEntities(
+        EntityKind entityKind,
+        const Entities &entities1,
+        const std::vector<uint64_t> &keys1,
+        const std::vector<uint64_t> &signatures1,
+        const Entities &entities2,
+        const std::vector<uint64_t> &keys2,
+        const std::vector<uint64_t> &signatures2,
+        GetName &&getName,
+        CompareFields &&compareFields);
+
+    static uint32_t CompareClasses(
+        MachOReader &reader1,
+        const Class &classType1,
+        MachOReader &reader2,
+        const Class &classType2);
+    static uint32_t CompareFunctions(
+        MachOReader &reader1,
+        const Function &function1,
+        MachOReader &reader2,
+        const Function &function2);
+
+    static uint64_t ComputeBaseClassesHash(const Classes &classes, const Class &classType);
+    static uint64_t ComputeVTablesHash(const MachOReader &reader, const Class &classType);
+    static uint64_t ComputeMembersHash(const Class &classType);
+    static uint64_t ComputeSourceLinesHash(const Function &function);
+    static uint64_t ComputeHeaderFilesHash(const HeaderFiles &headerFiles, const Function &function);
+
+private:
+    std::vector<Entry> m_entries;
+};
@@ -0,0 +1,1033 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+// Binary model file, for tools that need the parsed model without LIEF. The file is meant to be memory mapped and
+// queried in place: every section is a flat table of fixed size records, strings are offsets into one string blob, and
+// references between entities are table indices. This header is the whole reader and has no other dependencies.
+//
+// File:    FileHeader, SectionHeader directory, sections. All integers are little endian.
+// Section: Table of SectionHeader::m_count records, SectionHeader::m_stride bytes apart, 8 byte aligned in the file.
+// String:  StringRef into the Strings section, which is a blob of bytes. Every string is followed by a 0 byte. The
+//          blob begins with the empty string.
+// Range:   Consecutive records of another section, such as the vtables of a class. Lists of entity indices are ranges
+//          of the Indices section, which is a table of uint32.
+// Index:   Index into the table of the referenced entity. InvalidIndex if there is none.
+//
+// Versioning: readers accept files of their major version. A minor version may append fields to records, which
+// older readers skip through the stride, and may add sections, which older readers ignore. Any other change
+// increments the major version.
+//
+// The records mirror the entities of CppTypes.h. Function variants refer to their source lines in the LineRows
+// section, and the AddressIndex section lists all function variants by address.
+//
+// The file also stores the indices that are computed from machine code, which it does not contain: the call graph, the
+// clusters of identical code, and the inferred field layouts and constructor results of classes. It stores the
+// NameSearchIndex too, which needs the model types to be rebuilt. The scope trie, the template index, the class
+// hierarchy and the virtual override index are not stored, because they follow from the namespace, class, function and
+// vtable records.
+namespace ModelFormat
+{
+constexpr uint32_t Magic = 0x4d47434d; // "MCGM"
+constexpr uint16_t MajorVersion = 1;
+constexpr uint16_t MinorVersion = 0;
+constexpr uint32_t InvalidIndex = ~uint32_t(0);
+constexpr size_t SectionAlignment = 8;
+
+enum SectionId : uint32_t
+{
+    SectionId_Strings = 0, // Bytes.
+    SectionId_Indices, // uint32.
+    SectionId_Namespaces,
+    SectionId_Types,
+    SectionId_TypeNames, // StringRef. Interned demangled parameter type names.
+    SectionId_Enums,
+    SectionId_EnumValues,
+    SectionId_Variables,
+    SectionId_Classes,
+    SectionId_VTables,
+    SectionId_VTableEntries,
+    SectionId_BaseClasses,
+    SectionId_ClassMembers,
+    SectionId_Thunks,
+    SectionId_Functions,
+    SectionId_FunctionParameters,
+    SectionId_FunctionVariants,
+    SectionId_LineRows,
+    SectionId_HeaderFiles,
+    SectionId_SourceFiles,
+    SectionId_AddressIndex,
+    SectionId_FunctionCalls,
+    SectionId_CodeClusters,
+    SectionId_CodeClusterVariants,
+    SectionId_ClassLayouts,
+    SectionId_InferredFields,
+    SectionId_VTableStores,
+    SectionId_NameSearchIndex, // Bytes written by NameSearchIndex::Save.
+
+    SectionId_Count,
+};
+
+struct FileHeader
+{
+    uint32_t m_magic = Magic;
+    uint16_t m_majorVersion = MajorVersion;
+    uint16_t m_minorVersion = MinorVersion;
+    uint64_t m_fileSize = 0;
+    uint32_t m_sectionCount = 0; // SectionHeaders that follow the file header.
+    uint32_t m_reserved = 0;
+};
+
+struct SectionHeader
+{
+    uint64_t m_offset = 0; // From the begin of the file.
+    uint32_t m_id = 0; // SectionId. Unknown ids are skipped.
+    uint32_t m_stride = 0; // Record size in this file. At least the record size of the reader.
+    uint32_t m_count = 0; // Records.
+    uint32_t m_reserved = 0;
+};
+
+struct StringRef
+{
+    uint32_t m_offset = 0;
+    uint32_t m_size = 0; // Without the trailing 0 byte.
+};
+
+struct Range
+{
+    uint32_t m_begin = 0;
+    uint32_t m_count = 0;
+};
+
+enum class TypeKind : uint8_t
+{
+    Unresolved,
+    Builtin,
+    Pointer,
+    Reference,
+    Const,
+    Volatile,
+    Array,
+    Function,
+    MemberPointer,
+    Class,
+    Enum,
+    Typedef,
+};
+
+enum class VariableKind : uint8_t
+{
+    Global,
+    Static,
+    Local,
+};
+
+enum class BaseClassVisibility : uint8_t
+{
+    Unknown,
+    Private_Or_Protected,
+    Public,
+};
+
+enum VTableEntryFlags : uint16_t
+{
+    VTableEntryFlag_None = 0,
+    VTableEntryFlag_Dtor = 1 << 0,
+    VTableEntryFlag_PureVirtual = 1 << 1,
+    VTableEntryFlag_Override = 1 << 2,
+    VTableEntryFlag_Implicit = 1 << 3,
+    VTableEntryFlag_Thunk = 1 << 4, // m_index refers to a thunk instead of a function.
+};
+
+enum InferredFieldFlags : uint8_t
+{
+    InferredFieldFlag_None = 0,
+    InferredFieldFlag_Read = 1 << 0,
+    InferredFieldFlag_Write = 1 << 1,
+    InferredFieldFlag_AddressTaken = 1 << 2,
+    InferredFieldFlag_VTablePointer = 1 << 3,
+};
+
+struct Namespace
+{
+    static constexpr SectionId Id = SectionId_Namespaces;
+
+    StringRef m_name;
+    StringRef m_namespaceName;
+    uint32_t m_parentNamespaceIndex = InvalidIndex;
+    Range m_childNamespaceIndices; // Indices.
+    Range m_classIndices; // Indices.
+    Range m_functionIndices; // Indices.
+    Range m_variableIndices; // Indices.
+    Range m_enumIndices; // Indices.
+};
+
+struct Type
+{
+    static constexpr SectionId Id = SectionId_Types;
+
+    StringRef m_name;
+    TypeKind m_kind = TypeKind::Unresolved;
+    uint8_t m_reserved[3] = {};
+    uint32_t m_size = 0;
+    uint32_t m_count = 0;
+    uint32_t m_targetTypeIndex = InvalidIndex;
+    uint32_t m_classIndex = InvalidIndex;
+    uint32_t m_enumIndex = InvalidIndex;
+};
+
+struct TypeName
+{
+    static constexpr SectionId Id = SectionId_TypeNames;
+
+    StringRef m_name;
+};
+
+struct EnumValue
+{
+    static constexpr SectionId Id = SectionId_EnumValues;
+
+    StringRef m_name;
+    int64_t m_value = 0;
+};
+
+struct Enum
+{
+    static constexpr SectionId Id = SectionId_Enums;
+
+    StringRef m_name;
+    uint32_t m_typeIndex = InvalidIndex;
+    uint32_t m_size = 0;
+    Range m_values; // EnumValues.
+    uint32_t m_parentNamespaceIndex = InvalidIndex;
+    uint32_t m_parentClassIndex = InvalidIndex;
+    uint32_t m_parentFunctionIndex = InvalidIndex;
+    uint32_t m_reserved = 0;
+};
+
+struct Variable
+{
+    static constexpr SectionId Id = SectionId_Variables;
+
+    StringRef m_name;
+    StringRef m_mangledName;
+    uint64_t m_address = 0;
+    uint32_t m_size = 0;
+    uint16_t m_description = 0;
+    uint8_t m_section = 0;
+    VariableKind m_kind = VariableKind::Global;
+    uint32_t m_typeIndex = InvalidIndex;
+    uint32_t m_sourceFileIndex = InvalidIndex;
+    uint32_t m_parentNamespaceIndex = InvalidIndex;
+    uint32_t m_parentClassIndex = InvalidIndex;
+    uint32_t m_parentFunctionIndex = InvalidIndex;
+    uint32_t m_reserved = 0;
+};
+
+struct Class
+{
+    static constexpr SectionId Id = SectionId_Classes;
+
+    StringRef m_name;
+    StringRef m_className;
+    uint32_t m_size = 0;
+    uint32_t m_typeIndex = InvalidIndex;
+    uint32_t m_parentNamespaceIndex = InvalidIndex;
+    uint32_t m_parentClassIndex = InvalidIndex;
+    Range m_vtables; // VTables.
+    Range m_vtableEntries; // VTableEntries.
+    Range m_directBaseClasses; // BaseClasses.
+    Range m_allBaseClasses; // BaseClasses.
+    Range m_childClassIndices; // Indices.
+    Range m_functionIndices; // Indices.
+    Range m_variableIndices; // Indices.
+    Range m_enumIndices; // Indices.
+    Range m_members; // ClassMembers.
+};
+
+struct VTable
+{
+    static constexpr SectionId Id = SectionId_VTables;
+
+    uint32_t m_entryBegin = 0; // Relative to Class::m_vtableEntries.
+    uint16_t m_entryCount = 0;
+    uint16_t m_offset = 0;
+};
+
+struct VTableEntry
+{
+    static constexpr SectionId Id = SectionId_VTableEntries;
+
+    uint32_t m_index = InvalidIndex; // Function or thunk. Invalid for pure virtual functions.
+    uint32_t m_allBaseClassIndex = InvalidIndex; // Relative to Class::m_allBaseClasses.
+    StringRef m_pureVirtualName; // Name of a pure virtual function, if known.
+    uint16_t m_flags = VTableEntryFlag_None;
+    uint16_t m_reserved = 0;
+};
+
+struct BaseClass
+{
+    static constexpr SectionId Id = SectionId_BaseClasses;
+
+    uint32_t m_classIndex = InvalidIndex;
+    uint16_t m_baseOffset = 0;
+    BaseClassVisibility m_visibility = BaseClassVisibility::Unknown;
+    uint8_t m_isVirtual = 0;
+};
+
+struct ClassMember
+{
+    static constexpr SectionId Id = SectionId_ClassMembers;
+
+    StringRef m_name;
+    uint32_t m_typeIndex = InvalidIndex;
+    uint32_t m_bitOffset = 0;
+    uint32_t m_bitSize = 0;
+    uint8_t m_isStatic = 0;
+    uint8_t m_reserved[3] = {};
+};
+
+struct Thunk
+{
+    static constexpr SectionId Id = SectionId_Thunks;
+
+    StringRef m_name;
+    uint64_t m_address = 0;
+    uint8_t m_isDtor = 0;
+    uint8_t m_reserved[7] = {};
+};
+
+struct Function
+{
+    static constexpr SectionId Id = SectionId_Functions;
+
+    StringRef m_name;
+    StringRef m_mangledName; // Of the first variant.
+    StringRef m_functionBaseName;
+    StringRef m_functionDeclContextName;
+    StringRef m_functionName;
+    StringRef m_functionParameters;
+    StringRef m_functionReturnType;
+    Range m_functionParameterTypeIds; // Indices into TypeNames.
+    Range m_functionParameterBaseTypeIds; // Indices into TypeNames.
+    Range m_parameters; // FunctionParameters.
+    Range m_variants; // FunctionVariants.
+    uint8_t m_isCtorOrDtor = 0;
+    uint8_t m_isLocalFunction = 0;
+    uint8_t m_isConst = 0;
+    uint8_t m_reserved = 0;
+    uint32_t m_headerFileIndex = InvalidIndex;
+    uint32_t m_sourceFileIndex = InvalidIndex;
+    uint32_t m_parentNamespaceIndex = InvalidIndex;
+    uint32_t m_parentClassIndex = InvalidIndex;
+    Range m_classIndices; // Indices.
+    Range m_variableIndices; // Indices.
+    Range m_enumIndices; // Indices.
+    Range m_headerFileIndices; // Indices.
+};
+
+struct FunctionParameter
+{
+    static constexpr SectionId Id = SectionId_FunctionParameters;
+
+    StringRef m_name;
+    uint32_t m_typeIndex = InvalidIndex;
+};
+
+struct FunctionVariant
+{
+    static constexpr SectionId Id = SectionId_FunctionVariants;
+
+    StringRef m_mangledName;
+    uint64_t m_address = 0;
+    uint32_t m_size = 0;
+    uint16_t m_sourceLine = 0;
+    uint8_t m_section = 0;
+    uint8_t m_reserved = 0;
+    Range m_lineRows; // LineRows, by ascending address.
+};
+
+struct LineRow
+{
+    static constexpr SectionId Id = SectionId_LineRows;
+
+    uint32_t m_addressOffset = 0; // Relative to FunctionVariant::m_address.
+    uint16_t m_line = 0;
+    uint16_t m_reserved = 0;
+    uint32_t m_fileId = InvalidIndex; // Header file index * 2 + 1, or source file index * 2.
+};
+
+struct HeaderFile
+{
+    static constexpr SectionId Id = SectionId_HeaderFiles;
+
+    StringRef m_name;
+    Range m_functionIndices; // Indices.
+};
+
+struct SourceFile
+{
+    static constexpr SectionId Id = SectionId_SourceFiles;
+
+    StringRef m_name;
+    uint64_t m_addressBegin = 0;
+    uint64_t m_addressEnd = 0;
+    Range m_headerFileIndices; // Indices.
+    Range m_functionIndices; // Indices.
+    Range m_variableIndices; // Indices.
+    Range m_enumIndices; // Indices.
+};
+
+struct AddressRecord
+{
+    static constexpr SectionId Id = SectionId_AddressIndex;
+
+    uint64_t m_address = 0; // Ascending.
+    uint32_t m_functionIndex = InvalidIndex;
+    uint32_t m_variantIndex = 0; // Relative to Function::m_variants.
+};
+
+// Direct calls of one function. One record per function, or none if the call graph was not written.
+struct FunctionCalls
+{
+    static constexpr SectionId Id = SectionId_FunctionCalls;
+
+    Range m_calleeIndices; // Indices, ascending.
+    Range m_callerIndices; // Indices, ascending.
+};
+
+// Function variants with byte identical code. Empty if the reader did not look for identical code.
+struct CodeCluster
+{
+    static constexpr SectionId Id = SectionId_CodeClusters;
+
+    uint64_t m_hash = 0;
+    uint32_t m_size = 0; // Size of one variant in bytes.
+    uint32_t m_reserved = 0;
+    Range m_variants; // CodeClusterVariants. The first variant is kept, the others are duplicates.
+};
+
+struct CodeClusterVariant
+{
+    static constexpr SectionId Id = SectionId_CodeClusterVariants;
+
+    uint32_t m_functionIndex = InvalidIndex;
+    uint32_t m_variantIndex = 0; // Relative to Function::m_variants.
+};
+
+// What the code of the member functions and of new expressions tells about one class. One record per class.
+struct ClassLayout
+{
+    static constexpr SectionId Id = SectionId_ClassLayouts;
+
+    uint32_t m_allocationSize = 0; // Passed to operator new before a constructor call. 0 if unknown.
+    uint32_t m_vtableFunctionIndex = InvalidIndex; // Constructor or destructor that stores the vtables.
+    Range m_fields; // InferredFields, by ascending offset.
+    Range m_vtableStores; // VTableStores, by ascending object offset.
+};
+
+struct InferredField
+{
+    static constexpr SectionId Id = SectionId_InferredFields;
+
+    uint32_t m_offset = 0;
+    uint16_t m_functionCount = 0; // Member functions that access the field.
+    uint8_t m_size = 0; // 0 if only the address is taken.
+    uint8_t m_sizeMask = 0; // Bit n is set if a 2^n byte access was seen. Bit 7 for 10 byte x87 accesses.
+    uint8_t m_flags = InferredFieldFlag_None;
+    uint8_t m_reserved[3] = {};
+};
+
+struct VTableStore
+{
+    static constexpr SectionId Id = SectionId_VTableStores;
+
+    uint32_t m_objectOffset = 0; // Offset of the vtable pointer in the object.
+    uint32_t m_addressPointOffset = 0; // Offset of the stored address point from the vtable symbol.
+    uint64_t m_vtableAddress = 0; // Address of the __ZTV symbol.
+};
+
+// The record sizes are part of the format. Changing one requires a new version.
+static_assert(sizeof(FileHeader) == 24 && sizeof(SectionHeader) == 24, "Unexpected header size");
+static_assert(sizeof(Namespace) == 60 && sizeof(Type) == 32 && sizeof(TypeName) == 8, "Unexpected record size");
+static_assert(sizeof(EnumValue) == 16 && sizeof(Enum) == 40 && sizeof(Variable) == 56, "Unexpected record size");
+static_assert(sizeof(Class) == 104 && sizeof(VTable) == 8 && sizeof(VTableEntry) == 20, "Unexpected record size");
+static_assert(sizeof(BaseClass) == 8 && sizeof(ClassMember) == 24 && sizeof(Thunk) == 24, "Unexpected record size");
+static_assert(sizeof(Function) == 140 && sizeof(FunctionParameter) == 12, "Unexpected record size");
+static_assert(sizeof(FunctionVariant) == 32 && sizeof(LineRow) == 12, "Unexpected record size");
+static_assert(sizeof(HeaderFile) == 16 && sizeof(SourceFile) == 56, "Unexpected record size");
+static_assert(sizeof(AddressRecord) == 16, "Unexpected record size");
+static_assert(sizeof(FunctionCalls) == 16 && sizeof(CodeCluster) == 24, "Unexpected record size");
+static_assert(sizeof(CodeClusterVariant) == 8 && sizeof(ClassLayout) == 24, "Unexpected record size");
+static_assert(sizeof(InferredField) == 12 && sizeof(VTableStore) == 16, "Unexpected record size");
+
+// Size and alignment of the records of every section, as written by this version.
+struct RecordLayout
+{
+    uint32_t m_size;
+    uint32_t m_alignment;
+    bool m_isArray; // Bytes or uint32 that are addressed without the stride. The stride must equal the size.
+};
+
+constexpr RecordLayout RecordLayouts[SectionId_Count] = {
+    {1, 1, true},
+    {sizeof(uint32_t), alignof(uint32_t), true},
+    {sizeof(Namespace), alignof(Namespace), false},
+    {sizeof(Type), alignof(Type), false},
+    {sizeof(TypeName), alignof(TypeName), false},
+    {sizeof(Enum), alignof(Enum), false},
+    {sizeof(EnumValue), alignof(EnumValue), false},
+    {sizeof(Variable), alignof(Variable), false},
+    {sizeof(Class), alignof(Class), false},
+    {sizeof(VTable), alignof(VTable), false},
+    {sizeof(VTableEntry), alignof(VTableEntry), false},
+    {sizeof(BaseClass), alignof(BaseClass), false},
+    {sizeof(ClassMember), alignof(ClassMember), false},
+    {sizeof(Thunk), alignof(Thunk), false},
+    {sizeof(Function), alignof(Function), false},
+    {sizeof(FunctionParameter), alignof(FunctionParameter), false},
+    {sizeof(FunctionVariant), alignof(FunctionVariant), false},
+    {sizeof(LineRow), alignof(LineRow), false},
+    {sizeof(HeaderFile), alignof(HeaderFile), false},
+    {sizeof(SourceFile), alignof(SourceFile), false},
+    {sizeof(AddressRecord), alignof(AddressRecord), false},
+    {sizeof(FunctionCalls), alignof(FunctionCalls), false},
+    {sizeof(CodeCluster), alignof(CodeCluster), false},
+    {sizeof(CodeClusterVariant), alignof(CodeClusterVariant), false},
+    {sizeof(ClassLayout), alignof(ClassLayout), false},
+    {sizeof(InferredField), alignof(InferredField), false},
+    {sizeof(VTableStore), alignof(VTableStore), false},
+    {1, 1, true},
+};
+
+// Records of one section, or a range of them. Refers to the mapped file.
+template<typename T>
+class Table
+{
+public:
+    Table() = default;
+    Table(const uint8_t *data, uint32_t count, uint32_t stride) : m_data(data), m_count(count), m_stride(stride) {}
+
+    uint32_t Size() const { return m_count; }
+    bool Empty() const { return m_count == 0; }
+    const T &operator[](uint32_t index) const
+    {
+        assert(index < m_count);
+        return *reinterpret_cast<const T *>(m_data + size_t(index) * m_stride);
+    }
+
+    // Records of the range. Empty if the range is out of bounds.
+    Table Slice(const Range &range) const
+    {
+        if (uint64_t(range.m_begin) + range.m_count > m_count)
+            return Table();
+        return Table(m_data + size_t(range.m_begin) * m_stride, range.m_count, m_stride);
+    }
+
+private:
+    const uint8_t *m_data = nullptr;
+    uint32_t m_count = 0;
+    uint32_t m_stride = sizeof(T);
+};
+
+// Queries a model file in place. The data must stay mapped while the reader is used.
+class Reader
+{
+public:
+    // Checks the header and the section directory. Records are only checked by Validate.
+    bool Open(const void *data, size_t size, std::string &error);
+
+    uint16_t GetMinorVersion() const { return m_minorVersion; }
+    uint32_t GetCount(SectionId id) const { return m_sections[id].m_count; }
+
+    template<typename T>
+    Table<T> GetTable() const
+    {
+        const Section &section = m_sections[T::Id];
+        return Table<T>(section.m_data, section.m_count, section.m_stride);
+    }
+    template<typename T>
+    Table<T> GetTable(const Range &range) const
+    {
+        return GetTable<T>().Slice(range);
+    }
+    Table<uint32_t> GetIndices(const Range &range) const;
+    std::string_view GetString(const StringRef &string) const;
+    // Data for NameSearchIndex::Load. Empty if the file has no name search index.
+    std::string_view GetNameSearchIndexData() const;
+
+    // Finds the function variant that contains the address. Returns false if there is none.
+    bool FindFunctionByAddress(uint64_t address, uint32_t &functionIndex, uint32_t &variantIndex) const;
+
+    // Checks every string, range and index of every record. Returns false with a description of the first problem.
+    bool Validate(std::string &error) const;
+
+private:
+    struct Section
+    {
+        const uint8_t *m_data = nullptr;
+        uint32_t m_count = 0;
+        uint32_t m_stride = 0;
+    };
+
+    bool ValidateString(const StringRef &string) const;
+    bool ValidateRange(const Range &range, SectionId id) const;
+    bool ValidateIndex(uint32_t index, SectionId id) const;
+    bool ValidateIndexList(const Range &range, SectionId id) const;
+
+private:
+    Section m_sections[SectionId_Count];
+    uint16_t m_minorVersion = 0;
+};
+
+inline bool Reader::Open(const void *data, size_t size, std::string &error)
+{
+    *this = Reader();
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    if (reinterpret_cast<uintptr_t>(bytes) % SectionAlignment != 0)
+    {
+        error = "Data is not 8 byte aligned";
+        return false;
+    }
+
+    FileHeader header;
+    if (size < sizeof(header))
+    {
+        error = "File is too small";
+        return false;
+    }
+    std::memcpy(&header, bytes, sizeof(header));
+    if (header.m_magic != Magic)
+    {
+        error = "Not a model file, or not little endian";
+        return false;
+    }
+    if (header.m_majorVersion != MajorVersion)
+    {
+        error = "Unsupported major version " + std::to_string(header.m_majorVersion);
+        return false;
+    }
+    if (header.m_fileSize != size)
+    {
+        error = "File size does not match the header";
+        return false;
+    }
+    if (uint64_t(header.m_sectionCount) * sizeof(SectionHeader) > size - sizeof(header))
+    {
+        error = "Section directory is out of bounds";
+        return false;
+    }
+
+    Section sections[SectionId_Count];
+    const SectionHeader *sectionHeaders = reinterpret_cast<const SectionHeader *>(bytes + sizeof(header));
+    for (uint32_t i = 0; i < header.m_sectionCount; ++i)
+    {
+        const SectionHeader &sectionHeader = sectionHeaders[i];
+        if (sectionHeader.m_id >= SectionId_Count)
+            continue; // Section of a newer minor version.
+
+        const RecordLayout &layout = RecordLayouts[sectionHeader.m_id];
+        const std::string name = "Section " + std::to_string(sectionHeader.m_id);
+        if (sections[sectionHeader.m_id].m_data != nullptr)
+        {
+            error = name + " is duplicated";
+            return false;
+        }
+        if (sectionHeader.m_stride < layout.m_size || sectionHeader.m_stride % layout.m_alignment != 0
+            || (layout.m_isArray && sectionHeader.m_stride != layout.m_size))
+        {
+            error = name + " has an invalid stride";
+            return false;
+        }
+        if (sectionHeader.m_offset % SectionAlignment != 0 || sectionHeader.m_offset > size
+            || uint64_t(sectionHeader.m_count) * sectionHeader.m_stride > size - sectionHeader.m_offset)
+        {
+            error = name + " is out of bounds";
+            return false;
+        }
+
+        Section &section = sections[sectionHeader.m_id];
+        section.m_data = bytes + sectionHeader.m_offset;
+        section.m_count = sectionHeader.m_count;
+        section.m_stride = sectionHeader.m_stride;
+    }
+
+    for (uint32_t id = 0; id < SectionId_Count; ++id)
+    {
+        if (sections[id].m_data == nullptr)
+        {
+            error = "Section " + std::to_string(id) + " is missing";
+            return false;
+        }
+    }
+
+    std::copy(std::begin(sections), std::end(sections), std::begin(m_sections));
+    m_minorVersion = header.m_minorVersion;
+    return true;
+}
+
+inline Table<uint32_t> Reader::GetIndices(const Range &range) const
+{
+    const Section &section = m_sections[SectionId_Indices];
+    return Table<uint32_t>(section.m_data, section.m_count, section.m_stride).Slice(range);
+}
+
+inline std::string_view Reader::GetString(const StringRef &string) const
+{
+    const Section &section = m_sections[SectionId_Strings];
+    if (uint64_t(string.m_offset) + string.m_size > section.m_count)
+        return std::string_view();
+    return std::string_view(reinterpret_cast<const char *>(section.m_data) + string.m_offset, string.m_size);
+}
+
+inline std::string_view Reader::GetNameSearchIndexData() const
+{
+    const Section &section = m_sections[SectionId_NameSearchIndex];
+    return std::string_view(reinterpret_cast<const char *>(section.m_data), section.m_count);
+}
+
+inline bool Reader::FindFunctionByAddress(uint64_t address, uint32_t &functionIndex, uint32_t &variantIndex) const
+{
+    const Table<AddressRecord> records = GetTable<AddressRecord>();
+    uint32_t begin = 0;
+    uint32_t end = records.Size();
+    while (begin < end)
+    {
+        const uint32_t middle = begin + (end - begin) / 2;
+        if (records[middle].m_address <= address)
+            begin = middle + 1;
+        else
+            end = middle;
+    }
+    if (begin == 0)
+        return false;
+
+    const AddressRecord &record = records[begin - 1];
+    const Function &function = GetTable<Function>()[record.m_functionIndex];
+    const FunctionVariant &variant = GetTable<FunctionVariant>(function.m_variants)[record.m_variantIndex];
+    if (address >= variant.m_address + variant.m_size)
+        return false;
+
+    functionIndex = record.m_functionIndex;
+    variantIndex = record.m_variantIndex;
+    return true;
+}
+
+inline bool Reader::ValidateString(const StringRef &string) const
+{
+    const Section &section = m_sections[SectionId_Strings];
+    return uint64_t(string.m_offset) + string.m_size < section.m_count
+        && section.m_data[string.m_offset + string.m_size] == 0;
+}
+
+inline bool Reader::ValidateRange(const Range &range, SectionId id) const
+{
+    return uint64_t(range.m_begin) + range.m_count <= m_sections[id].m_count;
+}
+
+inline bool Reader::ValidateIndex(uint32_t index, SectionId id) const
+{
+    return index == InvalidIndex || index < m_sections[id].m_count;
+}
+
+inline bool Reader::ValidateIndexList(const Range &range, SectionId id) const
+{
+    if (!ValidateRange(range, SectionId_Indices))
+        return false;
+
+    const Table<uint32_t> indices = GetIndices(range);
+    for (uint32_t i = 0; i < indices.Size(); ++i)
+    {
+        if (indices[i] >= m_sections[id].m_count)
+            return false;
+    }
+    return true;
+}
+
+inline bool Reader::Validate(std::string &error) const
+{
+    auto fail = [&error](const char *table, uint32_t index, const char *field) {
+        error = std::string(table) + " " + std::to_string(index) + ": invalid " + field;
+        return false;
+    };
+
+    const Table<Namespace> namespaces = GetTable<Namespace>();
+    for (uint32_t i = 0; i < namespaces.Size(); ++i)
+    {
+        const Namespace &record = namespaces[i];
+        if (!ValidateString(record.m_name) || !ValidateString(record.m_namespaceName))
+            return fail("Namespace", i, "name");
+        if (!ValidateIndex(record.m_parentNamespaceIndex, SectionId_Namespaces)
+            || !ValidateIndexList(record.m_childNamespaceIndices, SectionId_Namespaces)
+            || !ValidateIndexList(record.m_classIndices, SectionId_Classes)
+            || !ValidateIndexList(record.m_functionIndices, SectionId_Functions)
+            || !ValidateIndexList(record.m_variableIndices, SectionId_Variables)
+            || !ValidateIndexList(record.m_enumIndices, SectionId_Enums))
+            return fail("Namespace", i, "index");
+    }
+
+    const Table<Type> types = GetTable<Type>();
+    for (uint32_t i = 0; i < types.Size(); ++i)
+    {
+        const Type &record = types[i];
+        if (!ValidateString(record.m_name))
+            return fail("Type", i, "name");
+        if (record.m_kind > TypeKind::Typedef)
+            return fail("Type", i, "kind");
+        if (!ValidateIndex(record.m_targetTypeIndex, SectionId_Types)
+            || !ValidateIndex(record.m_classIndex, SectionId_Classes)
+            || !ValidateIndex(record.m_enumIndex, SectionId_Enums))
+            return fail("Type", i, "index");
+    }
+
+    const Table<TypeName> typeNames = GetTable<TypeName>();
+    for (uint32_t i = 0; i < typeNames.Size(); ++i)
+    {
+        if (!ValidateString(typeNames[i].m_name))
+            return fail("TypeName", i, "name");
+    }
+
+    const Table<EnumValue> enumValues = GetTable<EnumValue>();
+    for (uint32_t i = 0; i < enumValues.Size(); ++i)
+    {
+        if (!ValidateString(enumValues[i].m_name))
+            return fail("EnumValue", i, "name");
+    }
+
+    const Table<Enum> enums = GetTable<Enum>();
+    for (uint32_t i = 0; i < enums.Size(); ++i)
+    {
+        const Enum &record = enums[i];
+        if (!ValidateString(record.m_name))
+            return fail("Enum", i, "name");
+        if (!ValidateRange(record.m_values, SectionId_EnumValues))
+            return fail("Enum", i, "values");
+        if (!ValidateIndex(record.m_typeIndex, SectionId_Types)
+            || !ValidateIndex(record.m_parentNamespaceIndex, SectionId_Namespaces)
+            || !ValidateIndex(record.m_parentClassIndex, SectionId_Classes)
+            || !ValidateIndex(record.m_parentFunctionIndex, SectionId_Functions))
+            return fail("Enum", i, "index");
+    }
+
+    const Table<Variable> variables = GetTable<Variable>();
+    for (uint32_t i = 0; i < variables.Size(); ++i)
+    {
+        const Variable &record = variables[i];
+        if (!ValidateString(record.m_name) || !ValidateString(record.m_mangledName))
+            return fail("Variable", i, "name");
+        if (record.m_kind > VariableKind::Local)
+            return fail("Variable", i, "kind");
+        if (!ValidateIndex(record.m_typeIndex, SectionId_Types)
+            || !ValidateIndex(record.m_sourceFileIndex, SectionId_SourceFiles)
+            || !ValidateIndex(record.m_parentNamespaceIndex, SectionId_Namespaces)
+            || !ValidateIndex(record.m_parentClassIndex, SectionId_Classes)
+            || !ValidateIndex(record.m_parentFunctionIndex, SectionId_Functions))
+            return fail("Variable", i, "index");
+    }
+
+    const Table<Class> classes = GetTable<Class>();
+    for (uint32_t i = 0; i < classes.Size(); ++i)
+    {
+        const Class &record = classes[i];
+        if (!ValidateString(record.m_name) || !ValidateString(record.m_className))
+            return fail("Class", i, "name");
+        if (!ValidateRange(record.m_vtables, SectionId_VTables)
+            || !ValidateRange(record.m_vtableEntries, SectionId_VTableEntries)
+            || !ValidateRange(record.m_directBaseClasses, SectionId_BaseClasses)
+            || !ValidateRange(record.m_allBaseClasses, SectionId_BaseClasses)
+            || !ValidateRange(record.m_members, SectionId_ClassMembers))
+            return fail("Class", i, "range");
+        if (!ValidateIndex(record.m_typeIndex, SectionId_Types)
+            || !ValidateIndex(record.m_parentNamespaceIndex, SectionId_Namespaces)
+            || !ValidateIndex(record.m_parentClassIndex, SectionId_Classes)
+            || !ValidateIndexList(record.m_childClassIndices, SectionId_Classes)
+            || !ValidateIndexList(record.m_functionIndices, SectionId_Functions)
+            || !ValidateIndexList(record.m_variableIndices, SectionId_Variables)
+            || !ValidateIndexList(record.m_enumIndices, SectionId_Enums))
+            return fail("Class", i, "index");
+
+        const Table<VTable> vtables = GetTable<VTable>(record.m_vtables);
+        for (uint32_t v = 0; v < vtables.Size(); ++v)
+        {
+            if (uint64_t(vtables[v].m_entryBegin) + vtables[v].m_entryCount > record.m_vtableEntries.m_count)
+                return fail("Class", i, "vtable");
+        }
+
+        const Table<VTableEntry> entries = GetTable<VTableEntry>(record.m_vtableEntries);
+        for (uint32_t e = 0; e < entries.Size(); ++e)
+        {
+            const VTableEntry &entry = entries[e];
+            const SectionId target = (entry.m_flags & VTableEntryFlag_Thunk) ? SectionId_Thunks : SectionId_Functions;
+            if (!ValidateIndex(entry.m_index, target)
+                || (entry.m_allBaseClassIndex != InvalidIndex
+                    && entry.m_allBaseClassIndex >= record.m_allBaseClasses.m_count)
+                || !ValidateString(entry.m_pureVirtualName))
+                return fail("Class", i, "vtable entry");
+        }
+
+        for (const Range &range : {record.m_directBaseClasses, record.m_allBaseClasses})
+        {
+            const Table<BaseClass> baseClasses = GetTable<BaseClass>(range);
+            for (uint32_t b = 0; b < baseClasses.Size(); ++b)
+            {
+                if (baseClasses[b].m_classIndex >= classes.Size()
+                    || baseClasses[b].m_visibility > BaseClassVisibility::Public)
+                    return fail("Class", i, "base class");
+            }
+        }
+
+        const Table<ClassMember> members = GetTable<ClassMember>(record.m_members);
+        for (uint32_t m = 0; m < members.Size(); ++m)
+        {
+            if (!ValidateString(members[m].m_name) || !ValidateIndex(members[m].m_typeIndex, SectionId_Types))
+                return fail("Class", i, "member");
+        }
+    }
+
+    const Table<Thunk> thunks = GetTable<Thunk>();
+    for (uint32_t i = 0; i < thunks.Size(); ++i)
+    {
+        if (!ValidateString(thunks[i].m_name))
+            return fail("Thunk", i, "name");
+    }
+
+    const Table<LineRow> lineRows = GetTable<LineRow>();
+    const uint32_t fileIdCount = 2 * std::max(GetCount(SectionId_SourceFiles), GetCount(SectionId_HeaderFiles));
+    for (uint32_t i = 0; i < lineRows.Size(); ++i)
+    {
+        const uint32_t fileId = lineRows[i].m_fileId;
+        if (fileId != InvalidIndex
+            && (fileId >= fileIdCount
+                || !ValidateIndex(fileId >> 1, (fileId & 1) ? SectionId_HeaderFiles : SectionId_SourceFiles)))
+            return fail("LineRow", i, "file");
+    }
+
+    const Table<Function> functions = GetTable<Function>();
+    for (uint32_t i = 0; i < functions.Size(); ++i)
+    {
+        const Function &record = functions[i];
+        if (!ValidateString(record.m_name) || !ValidateString(record.m_mangledName)
+            || !ValidateString(record.m_functionBaseName) || !ValidateString(record.m_functionDeclContextName)
+            || !ValidateString(record.m_functionName) || !ValidateString(record.m_functionParameters)
+            || !ValidateString(record.m_functionReturnType))
+            return fail("Function", i, "name");
+        if (!ValidateRange(record.m_parameters, SectionId_FunctionParameters)
+            || !ValidateRange(record.m_variants, SectionId_FunctionVariants))
+            return fail("Function", i, "range");
+        if (!ValidateIndexList(record.m_functionParameterTypeIds, SectionId_TypeNames)
+            || !ValidateIndexList(record.m_functionParameterBaseTypeIds, SectionId_TypeNames)
+            || !ValidateIndex(record.m_headerFileIndex, SectionId_HeaderFiles)
+            || !ValidateIndex(record.m_sourceFileIndex, SectionId_SourceFiles)
+            || !ValidateIndex(record.m_parentNamespaceIndex, SectionId_Namespaces)
+            || !ValidateIndex(record.m_parentClassIndex, SectionId_Classes)
+            || !ValidateIndexList(record.m_classIndices, SectionId_Classes)
+            || !ValidateIndexList(record.m_variableIndices, SectionId_Variables)
+            || !ValidateIndexList(record.m_enumIndices, SectionId_Enums)
+            || !ValidateIndexList(record.m_headerFileIndices, SectionId_HeaderFiles))
+            return fail("Function", i, "index");
+
+        const Table<FunctionParameter> parameters = GetTable<FunctionParameter>(record.m_parameters);
+        for (uint32_t p = 0; p < parameters.Size(); ++p)
+        {
+            if (!ValidateString(parameters[p].m_name) || !ValidateIndex(parameters[p].m_typeIndex, SectionId_Types))
+                return fail("Function", i, "parameter");
+        }
+
+        const Table<FunctionVariant> variants = GetTable<FunctionVariant>(record.m_variants);
+        for (uint32_t v = 0; v < variants.Size(); ++v)
+        {
+            const FunctionVariant &variant = variants[v];
+            if (!ValidateString(variant.m_mangledName) || !ValidateRange(variant.m_lineRows, SectionId_LineRows))
+                return fail("Function", i, "variant");
+
+            const Table<LineRow> rows = GetTable<LineRow>(variant.m_lineRows);
+            for (uint32_t r = 1; r < rows.Size(); ++r)
+            {
+                if (rows[r].m_addressOffset < rows[r - 1].m_addressOffset)
+                    return fail("Function", i, "line row order");
+            }
+        }
+    }
+
+    const Table<HeaderFile> headerFiles = GetTable<HeaderFile>();
+    for (uint32_t i = 0; i < headerFiles.Size(); ++i)
+    {
+        if (!ValidateString(headerFiles[i].m_name))
+            return fail("HeaderFile", i, "name");
+        if (!ValidateIndexList(headerFiles[i].m_functionIndices, SectionId_Functions))
+            return fail("HeaderFile", i, "index");
+    }
+
+    const Table<SourceFile> sourceFiles = GetTable<SourceFile>();
+    for (uint32_t i = 0; i < sourceFiles.Size(); ++i)
+    {
+        const SourceFile &record = sourceFiles[i];
+        if (!ValidateString(record.m_name))
+            return fail("SourceFile", i, "name");
+        if (!ValidateIndexList(record.m_headerFileIndices, SectionId_HeaderFiles)
+            || !ValidateIndexList(record.m_functionIndices, SectionId_Functions)
+            || !ValidateIndexList(record.m_variableIndices, SectionId_Variables)
+            || !ValidateIndexList(record.m_enumIndices, SectionId_Enums))
+            return fail("SourceFile", i, "index");
+    }
+
+    const Table<AddressRecord> addresses = GetTable<AddressRecord>();
+    for (uint32_t i = 0; i < addresses.Size(); ++i)
+    {
+        const AddressRecord &record = addresses[i];
+        if (i != 0 && record.m_address < addresses[i - 1].m_address)
+            return fail("AddressRecord", i, "order");
+        if (record.m_functionIndex >= functions.Size()
+            || record.m_variantIndex >= functions[record.m_functionIndex].m_variants.m_count
+            || GetTable<FunctionVariant>(functions[record.m_functionIndex].m_variants)[record.m_variantIndex].m_address
+                != record.m_address)
+            return fail("AddressRecord", i, "function");
+    }
+
+    const Table<FunctionCalls> calls = GetTable<FunctionCalls>();
+    if (!calls.Empty() && calls.Size() != functions.Size())
+        return fail("FunctionCalls", calls.Size(), "count");
+    for (uint32_t i = 0; i < calls.Size(); ++i)
+    {
+        if (!ValidateIndexList(calls[i].m_calleeIndices, SectionId_Functions)
+            || !ValidateIndexList(calls[i].m_callerIndices, SectionId_Functions))
+            return fail("FunctionCalls", i, "index");
+    }
+
+    const Table<CodeCluster> clusters = GetTable<CodeCluster>();
+    for (uint32_t i = 0; i < clusters.Size(); ++i)
+    {
+        if (!ValidateRange(clusters[i].m_variants, SectionId_CodeClusterVariants))
+            return fail("CodeCluster", i, "variants");
+
+        const Table<CodeClusterVariant> variants = GetTable<CodeClusterVariant>(clusters[i].m_variants);
+        for (uint32_t v = 0; v < variants.Size(); ++v)
+        {
+            if (variants[v].m_functionIndex >= functions.Size()
+                || variants[v].m_variantIndex >= functions[variants[v].m_functionIndex].m_variants.m_count)
+                return fail("CodeCluster", i, "variant");
+        }
+    }
+
+    const Table<ClassLayout> layouts = GetTable<ClassLayout>();
+    if (!layouts.Empty() && layouts.Size() != classes.Size())
+        return fail("ClassLayout", layouts.Size(), "count");
+    for (uint32_t i = 0; i < layouts.Size(); ++i)
+    {
+        const ClassLayout &record = layouts[i];
+        if (!ValidateIndex(record.m_vtableFunctionIndex, SectionId_Functions)
+            || !ValidateRange(record.m_fields, SectionId_InferredFields)
+            || !ValidateRange(record.m_vtableStores, SectionId_VTableStores))
+            return fail("ClassLayout", i, "index");
+    }
+
+    return true;
+}
+} // namespace ModelFormat
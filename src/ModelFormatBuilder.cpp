@@ -0,0 +1,71 @@
+#include "ModelFormatBuilder.h"
+
+ModelFormatBuilder::ModelFormatBuilder()
+{
+    Clear();
+}
+
+void ModelFormatBuilder::Clear()
+{
+    for (std::vector<uint8_t> &section : m_sections)
+        section.clear();
+    m_stringRefs.clear();
+    AddString(std::string_view());
+}
+
+ModelFormat::StringRef ModelFormatBuilder::AddString(std::string_view string)
+{
+    auto it = m_stringRefs.find(string);
+    if (it != m_stringRefs.end())
+        return it->second;
+
+    std::vector<uint8_t> &section = m_sections[ModelFormat::SectionId_Strings];
+    ModelFormat::StringRef stringRef;
+    stringRef.m_offset = static_cast<uint32_t>(section.size());
+    stringRef.m_size = static_cast<uint32_t>(string.size());
+    section.insert(section.end(), string.begin(), string.end());
+    section.push_back(0);
+    m_stringRefs.emplace(string, stringRef);
+    return stringRef;
+}
+
+void ModelFormatBuilder::SetBytes(ModelFormat::SectionId id, std::string_view bytes)
+{
+    m_sections[id].assign(bytes.begin(), bytes.end());
+}
+
+void ModelFormatBuilder::WriteFile(std::ostream &stream) const
+{
+    auto align = [](uint64_t offset) {
+        return (offset + ModelFormat::SectionAlignment - 1) & ~uint64_t(ModelFormat::SectionAlignment - 1);
+    };
+
+    ModelFormat::FileHeader header;
+    header.m_sectionCount = ModelFormat::SectionId_Count;
+    ModelFormat::SectionHeader sectionHeaders[ModelFormat::SectionId_Count];
+    uint64_t offset = sizeof(header) + sizeof(sectionHeaders);
+    for (uint32_t id = 0; id < ModelFormat::SectionId_Count; ++id)
+    {
+        const uint32_t stride = ModelFormat::RecordLayouts[id].m_size;
+        offset = align(offset);
+        sectionHeaders[id].m_offset = offset;
+        sectionHeaders[id].m_id = id;
+        sectionHeaders[id].m_stride = stride;
+        sectionHeaders[id].m_count = static_cast<uint32_t>(m_sections[id].size() / stride);
+        offset += m_sections[id].size();
+    }
+    header.m_fileSize = offset;
+
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char *>(sectionHeaders), sizeof(sectionHeaders));
+    uint64_t position = sizeof(header) + sizeof(sectionHeaders);
+    for (uint32_t id = 0; id < ModelFormat::SectionId_Count; ++id)
+    {
+        static const char padding[ModelFormat::SectionAlignment] = {};
+        stream.write(padding, static_cast<std::streamsize>(sectionHeaders[id].m_offset - position));
+        stream.write(
+            reinterpret_cast<const char *>(m_sections[id].data()),
+            static_cast<std::streamsize>(m_sections[id].size()));
+        position = sectionHeaders[id].m_offset + m_sections[id].size();
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "ModelFormat.h"
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Assembles a ModelFormat file from records. Records are appended to per section buffers in host layout, identical
+// strings are stored once, and the file is written front to back with the section directory first, because all section
+// sizes are known by then. Does not depend on the model, so it can write any set of records.
+class ModelFormatBuilder
+{
+public:
+    ModelFormatBuilder();
+
+    // Removes all records. Keeps the empty string, which zero initialized string references refer to.
+    void Clear();
+
+    template<typename T>
+    void Append(const T &record);
+    template<typename T>
+    uint32_t GetCount() const;
+    // Range from the given begin to the current end of the section of T.
+    template<typename T>
+    ModelFormat::Range MakeRange(uint32_t begin) const;
+    template<typename Container>
+    ModelFormat::Range AddIndices(const Container &indices);
+    // The string must stay alive until the file is written.
+    ModelFormat::StringRef AddString(std::string_view string);
+    // Replaces the contents of a section of bytes.
+    void SetBytes(ModelFormat::SectionId id, std::string_view bytes);
+
+    void WriteFile(std::ostream &stream) const;
+
+private:
+    std::vector<uint8_t> m_sections[ModelFormat::SectionId_Count];
+    std::unordered_map<std::string_view, ModelFormat::StringRef> m_stringRefs;
+};
+
+template<typename T>
+void ModelFormatBuilder::Append(const T &record)
+{
+    std::vector<uint8_t> &section = m_sections[T::Id];
+    const size_t size = section.size();
+    section.resize(size + sizeof(T));
+    std::memcpy(section.data() + size, &record, sizeof(T));
+}
+
+template<typename T>
+uint32_t ModelFormatBuilder::GetCount() const
+{
+    return static_cast<uint32_t>(m_sections[T::Id].size() / sizeof(T));
+}
+
+template<typename T>
+ModelFormat::Range ModelFormatBuilder::MakeRange(uint32_t begin) const
+{
+    ModelFormat::Range range;
+    range.m_begin = begin;
+    range.m_count = GetCount<T>() - begin;
+    return range;
+}
+
+template<typename Container>
+ModelFormat::Range ModelFormatBuilder::AddIndices(const Container &indices)
+{
+    std::vector<uint8_t> &section = m_sections[ModelFormat::SectionId_Indices];
+    ModelFormat::Range range;
+    range.m_begin = static_cast<uint32_t>(section.size() / sizeof(uint32_t));
+    for (const auto index : indices)
+    {
+        const uint32_t value = index;
+        const size_t size = section.size();
+        section.resize(size + sizeof(value));
+        std::memcpy(section.data() + size, &value, sizeof(value));
+        ++range.m_count;
+    }
+    return range;
+}
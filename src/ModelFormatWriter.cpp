@@ -0,0 +1,415 @@
+#include "ModelFormatWriter.h"
+
+#include "IncludeTable.h"
+#include "LineTable.h"
+#include "MachOReader.h"
+
+#include <algorithm>
+#include <sstream>
+
+// The format has its own copies of the enums, so that readers do not depend on the model headers.
+static_assert(uint8_t(Type::Kind::Typedef) == uint8_t(ModelFormat::TypeKind::Typedef), "Type kinds differ");
+static_assert(uint8_t(Variable::Type::Local) == uint8_t(ModelFormat::VariableKind::Local), "Variable types differ");
+static_assert(
+    uint8_t(BaseClassVisibility::Public) == uint8_t(ModelFormat::BaseClassVisibility::Public),
+    "Base class visibilities differ");
+static_assert(
+    uint16_t(VTableEntry::Flag_Thunk) == uint16_t(ModelFormat::VTableEntryFlag_Thunk),
+    "VTable entry flags differ");
+static_assert(
+    uint8_t(FieldLayoutInference::Access_VTablePointer) == uint8_t(ModelFormat::InferredFieldFlag_VTablePointer),
+    "Field access flags differ");
+static_assert(InvalidIndex == ModelFormat::InvalidIndex, "Invalid indices differ");
+
+bool ModelFormatWriter::Write(MachOReader &reader, std::ostream &stream)
+{
+    // Records are written in host layout. The format is little endian.
+    const uint16_t endianProbe = 1;
+    if (*reinterpret_cast<const uint8_t *>(&endianProbe) != 1)
+        return false;
+
+    m_builder.Clear();
+
+    AddNamespaces(reader);
+    AddTypes(reader);
+    AddEnums(reader);
+    AddVariables(reader);
+    AddClasses(reader);
+    AddThunks(reader);
+    AddFunctions(reader);
+    AddFiles(reader);
+    AddCodeIndices(reader);
+    AddNameSearchIndex(reader);
+
+    m_builder.WriteFile(stream);
+    stream.flush();
+    return stream.good();
+}
+
+void ModelFormatWriter::AddNamespaces(MachOReader &reader)
+{
+    for (const Namespace &namespaceType : reader.GetNamespaces())
+    {
+        ModelFormat::Namespace record;
+        record.m_name = m_builder.AddString(namespaceType.m_name);
+        record.m_namespaceName = m_builder.AddString(namespaceType.m_namespaceName);
+        record.m_parentNamespaceIndex = namespaceType.m_parentNamespaceIndex;
+        record.m_childNamespaceIndices = m_builder.AddIndices(namespaceType.m_childNamespaceIndices);
+        record.m_classIndices = m_builder.AddIndices(namespaceType.m_classIndices);
+        record.m_functionIndices = m_builder.AddIndices(namespaceType.m_functionIndices);
+        record.m_variableIndices = m_builder.AddIndices(namespaceType.m_variableIndices);
+        record.m_enumIndices = m_builder.AddIndices(namespaceType.m_enumIndices);
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddTypes(MachOReader &reader)
+{
+    for (const Type &type : reader.GetTypes())
+    {
+        ModelFormat::Type record;
+        record.m_name = m_builder.AddString(type.m_name);
+        record.m_kind = static_cast<ModelFormat::TypeKind>(type.m_kind);
+        record.m_size = type.m_size;
+        record.m_count = type.m_count;
+        record.m_targetTypeIndex = type.m_targetTypeIndex;
+        record.m_classIndex = type.m_classIndex;
+        record.m_enumIndex = type.m_enumIndex;
+        m_builder.Append(record);
+    }
+
+    for (std::string_view typeName : reader.GetTypeNames())
+    {
+        ModelFormat::TypeName record;
+        record.m_name = m_builder.AddString(typeName);
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddEnums(MachOReader &reader)
+{
+    for (const Enum &enumType : reader.GetEnums())
+    {
+        const uint32_t valueBegin = m_builder.GetCount<ModelFormat::EnumValue>();
+        for (const EnumValue &value : enumType.m_values)
+        {
+            ModelFormat::EnumValue valueRecord;
+            valueRecord.m_name = m_builder.AddString(value.m_name);
+            valueRecord.m_value = value.m_value;
+            m_builder.Append(valueRecord);
+        }
+
+        ModelFormat::Enum record;
+        record.m_name = m_builder.AddString(enumType.m_name);
+        record.m_typeIndex = enumType.m_typeIndex;
+        record.m_size = enumType.m_size;
+        record.m_values = m_builder.MakeRange<ModelFormat::EnumValue>(valueBegin);
+        record.m_parentNamespaceIndex = enumType.m_parentNamespaceIndex;
+        record.m_parentClassIndex = enumType.m_parentClassIndex;
+        record.m_parentFunctionIndex = enumType.m_parentFunctionIndex;
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddVariables(MachOReader &reader)
+{
+    for (const Variable &variable : reader.GetVariables())
+    {
+        ModelFormat::Variable record;
+        record.m_name = m_builder.AddString(variable.m_name);
+        record.m_mangledName = m_builder.AddString(variable.m_mangledName);
+        record.m_address = variable.m_address;
+        record.m_size = variable.m_size;
+        record.m_description = variable.m_description;
+        record.m_section = variable.m_section;
+        record.m_kind = static_cast<ModelFormat::VariableKind>(variable.m_type);
+        record.m_typeIndex = variable.m_typeIndex;
+        record.m_sourceFileIndex = variable.m_sourceFileIndex;
+        record.m_parentNamespaceIndex = variable.m_parentNamespaceIndex;
+        record.m_parentClassIndex = variable.m_parentClassIndex;
+        record.m_parentFunctionIndex = variable.m_parentFunctionIndex;
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddClasses(MachOReader &reader)
+{
+    auto addBaseClasses = [this](const std::vector<BaseClass> &baseClasses) {
+        const uint32_t begin = m_builder.GetCount<ModelFormat::BaseClass>();
+        for (const BaseClass &baseClass : baseClasses)
+        {
+            ModelFormat::BaseClass record;
+            record.m_classIndex = baseClass.m_classIndex;
+            record.m_baseOffset = baseClass.m_baseOffset;
+            record.m_visibility = static_cast<ModelFormat::BaseClassVisibility>(baseClass.m_visibility);
+            record.m_isVirtual = baseClass.m_isVirtual ? 1 : 0;
+            m_builder.Append(record);
+        }
+        return m_builder.MakeRange<ModelFormat::BaseClass>(begin);
+    };
+
+    for (const Class &classType : reader.GetClasses())
+    {
+        ModelFormat::Class record;
+        record.m_name = m_builder.AddString(classType.m_name);
+        record.m_className = m_builder.AddString(classType.m_className);
+        record.m_size = classType.m_size;
+        record.m_typeIndex = classType.m_typeIndex;
+        record.m_parentNamespaceIndex = classType.m_parentNamespaceIndex;
+        record.m_parentClassIndex = classType.m_parentClassIndex;
+
+        const uint32_t vtableBegin = m_builder.GetCount<ModelFormat::VTable>();
+        for (const VTable &vtable : classType.m_vtables)
+        {
+            ModelFormat::VTable vtableRecord;
+            vtableRecord.m_entryBegin = vtable.m_entryBegin;
+            vtableRecord.m_entryCount = vtable.m_entryCount;
+            vtableRecord.m_offset = vtable.m_offset;
+            m_builder.Append(vtableRecord);
+        }
+        record.m_vtables = m_builder.MakeRange<ModelFormat::VTable>(vtableBegin);
+
+        const uint32_t entryBegin = m_builder.GetCount<ModelFormat::VTableEntry>();
+        for (const VTableEntry &entry : classType.m_vtableEntries)
+        {
+            ModelFormat::VTableEntry entryRecord;
+            entryRecord.m_index = entry.m_index;
+            entryRecord.m_allBaseClassIndex = entry.m_allBaseClassIndex;
+            if (entry.GetFunctionIndex() == InvalidIndex && entry.GetThunkIndex() == InvalidIndex)
+                entryRecord.m_pureVirtualName = m_builder.AddString(reader.GetVTableEntryName(entry));
+            else
+                entryRecord.m_pureVirtualName = m_builder.AddString(std::string_view());
+            entryRecord.m_flags = entry.m_flags;
+            m_builder.Append(entryRecord);
+        }
+        record.m_vtableEntries = m_builder.MakeRange<ModelFormat::VTableEntry>(entryBegin);
+
+        record.m_directBaseClasses = addBaseClasses(classType.m_directBaseClasses);
+        record.m_allBaseClasses = addBaseClasses(classType.m_allBaseClasses);
+        record.m_childClassIndices = m_builder.AddIndices(classType.m_childClassIndices);
+        record.m_functionIndices = m_builder.AddIndices(classType.m_functionIndices);
+        record.m_variableIndices = m_builder.AddIndices(classType.m_variableIndices);
+        record.m_enumIndices = m_builder.AddIndices(classType.m_enumIndices);
+
+        const uint32_t memberBegin = m_builder.GetCount<ModelFormat::ClassMember>();
+        for (const ClassMember &member : classType.m_members)
+        {
+            ModelFormat::ClassMember memberRecord;
+            memberRecord.m_name = m_builder.AddString(member.m_name);
+            memberRecord.m_typeIndex = member.m_typeIndex;
+            memberRecord.m_bitOffset = member.m_bitOffset;
+            memberRecord.m_bitSize = member.m_bitSize;
+            memberRecord.m_isStatic = member.m_isStatic ? 1 : 0;
+            m_builder.Append(memberRecord);
+        }
+        record.m_members = m_builder.MakeRange<ModelFormat::ClassMember>(memberBegin);
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddThunks(const MachOReader &reader)
+{
+    for (const NonVirtualThunk &thunk : reader.GetThunks())
+    {
+        ModelFormat::Thunk record;
+        record.m_name = m_builder.AddString(thunk.m_name);
+        record.m_address = thunk.m_address;
+        record.m_isDtor = thunk.m_isDtor ? 1 : 0;
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddFunctions(MachOReader &reader)
+{
+    const Functions &functions = reader.GetFunctions();
+    const LineTable &lineTable = reader.GetLineTable();
+    std::vector<ModelFormat::AddressRecord> addressRecords;
+
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const Function &function = functions[functionIndex];
+        ModelFormat::Function record;
+        record.m_name = m_builder.AddString(function.m_name);
+        record.m_mangledName =
+            m_builder.AddString(function.m_variants.empty() ? std::string_view() : function.GetMangledName(0));
+        record.m_functionBaseName = m_builder.AddString(function.m_functionBaseName);
+        record.m_functionDeclContextName = m_builder.AddString(function.m_functionDeclContextName);
+        record.m_functionName = m_builder.AddString(function.m_functionName);
+        record.m_functionParameters = m_builder.AddString(function.m_functionParameters);
+        record.m_functionReturnType = m_builder.AddString(function.m_functionReturnType);
+        record.m_functionParameterTypeIds = m_builder.AddIndices(function.m_functionParameterTypeIds);
+        record.m_functionParameterBaseTypeIds = m_builder.AddIndices(function.m_functionParameterBaseTypeIds);
+
+        const uint32_t parameterBegin = m_builder.GetCount<ModelFormat::FunctionParameter>();
+        for (const FunctionParameter &parameter : function.m_parameters)
+        {
+            ModelFormat::FunctionParameter parameterRecord;
+            parameterRecord.m_name = m_builder.AddString(parameter.m_name);
+            parameterRecord.m_typeIndex = parameter.m_typeIndex;
+            m_builder.Append(parameterRecord);
+        }
+        record.m_parameters = m_builder.MakeRange<ModelFormat::FunctionParameter>(parameterBegin);
+
+        const uint32_t variantBegin = m_builder.GetCount<ModelFormat::FunctionVariant>();
+        const uint32_t variantCount = static_cast<uint32_t>(function.m_variants.size());
+        for (uint32_t variantIndex = 0; variantIndex < variantCount; ++variantIndex)
+        {
+            const FunctionVariant &variant = function.m_variants[variantIndex];
+            ModelFormat::FunctionVariant variantRecord;
+            variantRecord.m_mangledName = m_builder.AddString(variant.m_mangledName);
+            variantRecord.m_address = variant.m_address;
+            variantRecord.m_size = variant.m_size;
+            variantRecord.m_sourceLine = variant.m_sourceLine;
+            variantRecord.m_section = variant.m_section;
+
+            const uint32_t rowBegin = m_builder.GetCount<ModelFormat::LineRow>();
+            if (variant.m_lineRangeIndex != InvalidIndex)
+            {
+                const LineTable::Range &range = lineTable.GetRange(variant.m_lineRangeIndex);
+                for (uint32_t rowIndex = 0; rowIndex < range.m_rowCount; ++rowIndex)
+                {
+                    const LineTableRow row = lineTable.GetRow(variant.m_lineRangeIndex, rowIndex);
+                    ModelFormat::LineRow rowRecord;
+                    rowRecord.m_addressOffset = static_cast<uint32_t>(row.m_address - variant.m_address);
+                    rowRecord.m_line = row.m_line;
+                    if (row.m_headerFileIndex != InvalidIndex || row.m_sourceFileIndex != InvalidIndex)
+                        rowRecord.m_fileId = IncludeTable::MakeFileId(row.m_headerFileIndex, row.m_sourceFileIndex);
+                    m_builder.Append(rowRecord);
+                }
+            }
+            variantRecord.m_lineRows = m_builder.MakeRange<ModelFormat::LineRow>(rowBegin);
+            m_builder.Append(variantRecord);
+
+            if (variant.m_size != 0)
+                addressRecords.push_back({variant.m_address, functionIndex, variantIndex});
+        }
+        record.m_variants = m_builder.MakeRange<ModelFormat::FunctionVariant>(variantBegin);
+
+        record.m_isCtorOrDtor = function.m_isCtorOrDtor ? 1 : 0;
+        record.m_isLocalFunction = function.m_isLocalFunction ? 1 : 0;
+        record.m_isConst = function.m_isConst ? 1 : 0;
+        record.m_headerFileIndex = function.m_headerFileIndex;
+        record.m_sourceFileIndex = function.m_sourceFileIndex;
+        record.m_parentNamespaceIndex = function.m_parentNamespaceIndex;
+        record.m_parentClassIndex = function.m_parentClassIndex;
+        record.m_classIndices = m_builder.AddIndices(function.m_classIndices);
+        record.m_variableIndices = m_builder.AddIndices(function.m_variableIndices);
+        record.m_enumIndices = m_builder.AddIndices(function.m_enumIndices);
+        record.m_headerFileIndices = m_builder.AddIndices(function.m_headerFileIndices);
+        m_builder.Append(record);
+    }
+
+    std::stable_sort(
+        addressRecords.begin(),
+        addressRecords.end(),
+        [](const ModelFormat::AddressRecord &record1, const ModelFormat::AddressRecord &record2) {
+            return record1.m_address < record2.m_address;
+        });
+    for (const ModelFormat::AddressRecord &record : addressRecords)
+        m_builder.Append(record);
+}
+
+void ModelFormatWriter::AddFiles(const MachOReader &reader)
+{
+    for (const HeaderFile &headerFile : reader.GetHeaderFiles())
+    {
+        ModelFormat::HeaderFile record;
+        record.m_name = m_builder.AddString(headerFile.m_name);
+        record.m_functionIndices = m_builder.AddIndices(headerFile.m_functionIndices);
+        m_builder.Append(record);
+    }
+
+    for (const SourceFile &sourceFile : reader.GetSourceFiles())
+    {
+        ModelFormat::SourceFile record;
+        record.m_name = m_builder.AddString(sourceFile.m_name);
+        record.m_addressBegin = sourceFile.m_addressBegin;
+        record.m_addressEnd = sourceFile.m_addressEnd;
+        record.m_headerFileIndices = m_builder.AddIndices(sourceFile.m_headerFileIndices);
+        record.m_functionIndices = m_builder.AddIndices(sourceFile.m_functionIndices);
+        record.m_variableIndices = m_builder.AddIndices(sourceFile.m_variableIndices);
+        record.m_enumIndices = m_builder.AddIndices(sourceFile.m_enumIndices);
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddCodeIndices(MachOReader &reader)
+{
+    const CallGraph &callGraph = reader.GetCallGraph();
+    const index_t functionCount = callGraph.GetFunctionCount();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        ModelFormat::FunctionCalls record;
+        record.m_calleeIndices = m_builder.AddIndices(callGraph.GetCallees(functionIndex));
+        record.m_callerIndices = m_builder.AddIndices(callGraph.GetCallers(functionIndex));
+        m_builder.Append(record);
+    }
+
+    const IdenticalCodeIndex &identicalCodeIndex = reader.GetIdenticalCodeIndex();
+    const index_t clusterCount = identicalCodeIndex.GetClusterCount();
+    for (index_t clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex)
+    {
+        const IdenticalCodeIndex::Cluster &cluster = identicalCodeIndex.GetCluster(clusterIndex);
+        ModelFormat::CodeCluster record;
+        record.m_hash = cluster.m_hash;
+        record.m_size = cluster.m_size;
+
+        const uint32_t variantBegin = m_builder.GetCount<ModelFormat::CodeClusterVariant>();
+        for (const IdenticalCodeIndex::VariantRef &variant : identicalCodeIndex.GetClusterVariants(clusterIndex))
+        {
+            ModelFormat::CodeClusterVariant variantRecord;
+            variantRecord.m_functionIndex = variant.m_functionIndex;
+            variantRecord.m_variantIndex = variant.m_variantIndex;
+            m_builder.Append(variantRecord);
+        }
+        record.m_variants = m_builder.MakeRange<ModelFormat::CodeClusterVariant>(variantBegin);
+        m_builder.Append(record);
+    }
+
+    const FieldLayoutInference &fieldLayoutInference = reader.GetFieldLayoutInference();
+    const ConstructorAnalysis &constructorAnalysis = reader.GetConstructorAnalysis();
+    const index_t classCount = reader.GetClasses().size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        ModelFormat::ClassLayout record;
+
+        const uint32_t fieldBegin = m_builder.GetCount<ModelFormat::InferredField>();
+        for (const FieldLayoutInference::Field &field : fieldLayoutInference.GetFields(classIndex))
+        {
+            ModelFormat::InferredField fieldRecord;
+            fieldRecord.m_offset = field.m_offset;
+            fieldRecord.m_functionCount = field.m_functionCount;
+            fieldRecord.m_size = field.m_size;
+            fieldRecord.m_sizeMask = field.m_sizeMask;
+            fieldRecord.m_flags = field.m_flags;
+            m_builder.Append(fieldRecord);
+        }
+        record.m_fields = m_builder.MakeRange<ModelFormat::InferredField>(fieldBegin);
+
+        const uint32_t storeBegin = m_builder.GetCount<ModelFormat::VTableStore>();
+        if (classIndex < constructorAnalysis.GetClassCount())
+        {
+            record.m_allocationSize = constructorAnalysis.GetAllocationSize(classIndex);
+            record.m_vtableFunctionIndex = constructorAnalysis.GetVTableFunctionIndex(classIndex);
+            for (const ConstructorAnalysis::VTableStore &store : constructorAnalysis.GetVTableStores(classIndex))
+            {
+                ModelFormat::VTableStore storeRecord;
+                storeRecord.m_objectOffset = store.m_objectOffset;
+                storeRecord.m_addressPointOffset = store.m_addressPointOffset;
+                storeRecord.m_vtableAddress = store.m_vtableAddress;
+                m_builder.Append(storeRecord);
+            }
+        }
+        record.m_vtableStores = m_builder.MakeRange<ModelFormat::VTableStore>(storeBegin);
+        m_builder.Append(record);
+    }
+}
+
+void ModelFormatWriter::AddNameSearchIndex(MachOReader &reader)
+{
+    std::ostringstream stream;
+    reader.GetNameSearchIndex().Save(stream);
+    const std::string data = stream.str();
+    m_builder.SetBytes(ModelFormat::SectionId_NameSearchIndex, data);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ModelFormatBuilder.h"
+
+#include <ostream>
+
+class MachOReader;
+
+// Writes the model of a MachOReader as a ModelFormat file. One pass over the entities appends the records of all
+// sections to a ModelFormatBuilder, which then writes the file. The call graph, the field layouts and the name search
+// index are built if the reader has not built them yet.
+class ModelFormatWriter
+{
+public:
+    // Builds the class model first. Returns false if the stream failed.
+    bool Write(MachOReader &reader, std::ostream &stream);
+
+private:
+    void AddNamespaces(MachOReader &reader);
+    void AddTypes(MachOReader &reader);
+    void AddEnums(MachOReader &reader);
+    void AddVariables(MachOReader &reader);
+    void AddClasses(MachOReader &reader);
+    void AddThunks(const MachOReader &reader);
+    void AddFunctions(MachOReader &reader);
+    void AddFiles(const MachOReader &reader);
+    void AddCodeIndices(MachOReader &reader);
+    void AddNameSearchIndex(MachOReader &reader);
+
+private:
+    ModelFormatBuilder m_builder; // Strings are views into the model.
+};
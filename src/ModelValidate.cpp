@@ -0,0 +1,81 @@
+#include "MappedFile.h"
+#include "ModelFormat.h"
+
+#include <fmt/core.h>
+
+#include <string>
+
+namespace
+{
+const char *const SectionNames[ModelFormat::SectionId_Count] = {
+    "Strings",
+    "Indices",
+    "Namespaces",
+    "Types",
+    "TypeNames",
+    "Enums",
+    "EnumValues",
+    "Variables",
+    "Classes",
+    "VTables",
+    "VTableEntries",
+    "BaseClasses",
+    "ClassMembers",
+    "Thunks",
+    "Functions",
+    "FunctionParameters",
+    "FunctionVariants",
+    "LineRows",
+    "HeaderFiles",
+    "SourceFiles",
+    "AddressIndex",
+    "FunctionCalls",
+    "CodeClusters",
+    "CodeClusterVariants",
+    "ClassLayouts",
+    "InferredFields",
+    "VTableStores",
+    "NameSearchIndex",
+};
+
+bool Validate(const std::string &filepath)
+{
+    MappedFile file;
+    if (!file.Open(filepath))
+    {
+        fmt::print(stderr, "{}: cannot open\n", filepath);
+        return false;
+    }
+
+    ModelFormat::Reader reader;
+    std::string error;
+    if (!reader.Open(file.GetData(), file.GetSize(), error) || !reader.Validate(error))
+    {
+        fmt::print(stderr, "{}: {}\n", filepath, error);
+        return false;
+    }
+
+    fmt::print("{}: valid, version {}.{}\n", filepath, ModelFormat::MajorVersion, reader.GetMinorVersion());
+    for (uint32_t id = 0; id < ModelFormat::SectionId_Count; ++id)
+    {
+        fmt::print("  {:<20}{}\n", SectionNames[id], reader.GetCount(static_cast<ModelFormat::SectionId>(id)));
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fmt::print(stderr, "Usage: ModelValidate <model>...\n");
+        return 1;
+    }
+
+    bool valid = true;
+    for (int i = 1; i < argc; ++i)
+    {
+        valid &= Validate(argv[i]);
+    }
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,470 @@
+#include "NameSearchIndex.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+
+namespace
+{
+constexpr uint32_t FileMagic = 0x3149534e; // "NSI1"
+
+template<typename T>
+void WriteValue(std::ostream &stream, const T &value)
+{
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template<typename T>
+bool ReadValue(std::istream &stream, T &value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+template<typename Container>
+void WriteArray(std::ostream &stream, const Container &container)
+{
+    WriteValue(stream, static_cast<uint64_t>(container.size()));
+    stream.write(reinterpret_cast<const char *>(container.data()), container.size() * sizeof(container[0]));
+}
+
+template<typename Container>
+bool ReadArray(std::istream &stream, Container &container)
+{
+    uint64_t size;
+    if (!ReadValue(stream, size) || size > std::numeric_limits<uint32_t>::max())
+        return false;
+
+    container.resize(static_cast<size_t>(size));
+    if (size == 0)
+        return true;
+    return static_cast<bool>(stream.read(reinterpret_cast<char *>(&container[0]), size * sizeof(container[0])));
+}
+
+char ToLowerAscii(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+} // namespace
+
+void NameSearchIndex::Build(
+    const Functions &functions,
+    const Classes &classes,
+    const Namespaces &namespaces,
+    ThreadPool &threadPool)
+{
+    AddNames(functions, classes, namespaces);
+
+    // Every chunk collects sorted (trigram, name) pairs of a contiguous name range.
+    const index_t nameCount = GetNameCount();
+    m_nameTrigramCounts.assign(nameCount, 0);
+    std::vector<std::vector<uint64_t>> chunkPairs;
+    {
+        const size_t chunkCount = std::max<size_t>(std::min<size_t>(threadPool.GetThreadCount() * 4, nameCount), 1);
+        const size_t chunkSize = (nameCount + chunkCount - 1) / chunkCount;
+        chunkPairs.resize(chunkCount);
+        threadPool.ParallelFor(chunkCount, [&](size_t chunkIndex) {
+            const index_t nameBegin = static_cast<index_t>(std::min<size_t>(chunkIndex * chunkSize, nameCount));
+            const index_t nameEnd = static_cast<index_t>(std::min<size_t>(nameBegin + chunkSize, nameCount));
+            std::vector<uint64_t> &pairs = chunkPairs[chunkIndex];
+
+            thread_local std::vector<Trigram> trigrams;
+            for (index_t nameIndex = nameBegin; nameIndex < nameEnd; ++nameIndex)
+            {
+                CollectTrigrams(GetLowerName(nameIndex), trigrams);
+                m_nameTrigramCounts[nameIndex] =
+                    static_cast<uint16_t>(std::min<size_t>(trigrams.size(), std::numeric_limits<uint16_t>::max()));
+                for (Trigram trigram : trigrams)
+                {
+                    pairs.push_back((uint64_t(trigram) << 32) | nameIndex);
+                }
+            }
+            std::sort(pairs.begin(), pairs.end());
+        });
+    }
+
+    m_trigrams.clear();
+    for (const std::vector<uint64_t> &pairs : chunkPairs)
+    {
+        for (uint64_t pair : pairs)
+        {
+            const Trigram trigram = static_cast<Trigram>(pair >> 32);
+            if (m_trigrams.empty() || m_trigrams.back() != trigram)
+                m_trigrams.push_back(trigram);
+        }
+    }
+    std::sort(m_trigrams.begin(), m_trigrams.end());
+    m_trigrams.erase(std::unique(m_trigrams.begin(), m_trigrams.end()), m_trigrams.end());
+
+    // Chunks cover ascending name ranges, so scattering them in order keeps every posting list sorted.
+    m_postingOffsets.assign(m_trigrams.size() + 1, 0);
+    for (const std::vector<uint64_t> &pairs : chunkPairs)
+    {
+        size_t trigramIndex = 0;
+        for (uint64_t pair : pairs)
+        {
+            const Trigram trigram = static_cast<Trigram>(pair >> 32);
+            while (m_trigrams[trigramIndex] != trigram)
+                ++trigramIndex;
+            ++m_postingOffsets[trigramIndex + 1];
+        }
+    }
+    for (size_t trigramIndex = 0; trigramIndex < m_trigrams.size(); ++trigramIndex)
+    {
+        m_postingOffsets[trigramIndex + 1] += m_postingOffsets[trigramIndex];
+    }
+
+    m_postings.resize(m_postingOffsets.back());
+    std::vector<uint32_t> cursors(m_postingOffsets.begin(), m_postingOffsets.end() - 1);
+    for (const std::vector<uint64_t> &pairs : chunkPairs)
+    {
+        size_t trigramIndex = 0;
+        for (uint64_t pair : pairs)
+        {
+            const Trigram trigram = static_cast<Trigram>(pair >> 32);
+            while (m_trigrams[trigramIndex] != trigram)
+                ++trigramIndex;
+            m_postings[cursors[trigramIndex]++] = static_cast<index_t>(pair);
+        }
+    }
+}
+
+void NameSearchIndex::FindSubstring(std::string_view query, size_t maxResults, std::vector<Result> &results) const
+{
+    results.clear();
+    const std::string lowerQuery = ToLower(query);
+    if (lowerQuery.empty())
+        return;
+
+    // Candidates contain all trigrams of the query. Short queries have none and check every name.
+    std::vector<index_t> candidates;
+    std::vector<Trigram> trigrams;
+    CollectTrigrams(lowerQuery, trigrams);
+    if (trigrams.empty())
+    {
+        candidates.resize(GetNameCount());
+        for (index_t nameIndex = 0; nameIndex < GetNameCount(); ++nameIndex)
+        {
+            candidates[nameIndex] = nameIndex;
+        }
+    }
+    else
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;
+        for (Trigram trigram : trigrams)
+        {
+            uint32_t begin;
+            uint32_t end;
+            FindPostings(trigram, begin, end);
+            if (begin == end)
+                return;
+            ranges.emplace_back(begin, end);
+        }
+
+        // Intersect from the shortest posting list.
+        std::sort(ranges.begin(), ranges.end(), [](const auto &range1, const auto &range2) {
+            return range1.second - range1.first < range2.second - range2.first;
+        });
+        candidates.assign(m_postings.begin() + ranges[0].first, m_postings.begin() + ranges[0].second);
+        std::vector<index_t> intersection;
+        for (size_t rangeIndex = 1; rangeIndex < ranges.size() && !candidates.empty(); ++rangeIndex)
+        {
+            intersection.clear();
+            std::set_intersection(
+                candidates.begin(),
+                candidates.end(),
+                m_postings.begin() + ranges[rangeIndex].first,
+                m_postings.begin() + ranges[rangeIndex].second,
+                std::back_inserter(intersection));
+            candidates.swap(intersection);
+        }
+    }
+
+    for (index_t nameIndex : candidates)
+    {
+        const std::string_view lowerName = GetLowerName(nameIndex);
+        size_t position = lowerName.find(lowerQuery);
+        if (position == std::string_view::npos)
+            continue;
+
+        uint32_t tier = 0;
+        if (position == 0)
+        {
+            tier = lowerName.size() == lowerQuery.size() ? 3 : 2;
+        }
+        else
+        {
+            for (; position != std::string_view::npos; position = lowerName.find(lowerQuery, position + 1))
+            {
+                if (position >= 2 && lowerName.compare(position - 2, 2, "::") == 0)
+                {
+                    tier = 1;
+                    break;
+                }
+            }
+        }
+
+        const uint32_t lengthScore = 0xffffff - static_cast<uint32_t>(std::min<size_t>(lowerName.size(), 0xffffff));
+        results.push_back(MakeResult(nameIndex, (tier << 24) | lengthScore));
+    }
+
+    SortResults(maxResults, results);
+}
+
+void NameSearchIndex::FindFuzzy(std::string_view query, size_t maxResults, std::vector<Result> &results) const
+{
+    results.clear();
+    std::vector<Trigram> trigrams;
+    CollectTrigrams(ToLower(query), trigrams);
+    if (trigrams.empty())
+    {
+        FindSubstring(query, maxResults, results);
+        return;
+    }
+
+    // Shared trigram counts of the touched names. Reset after every query.
+    thread_local std::vector<uint16_t> sharedCounts;
+    thread_local std::vector<index_t> touchedNames;
+    if (sharedCounts.size() != GetNameCount())
+    {
+        sharedCounts.assign(GetNameCount(), 0);
+    }
+    touchedNames.clear();
+
+    for (Trigram trigram : trigrams)
+    {
+        uint32_t begin;
+        uint32_t end;
+        FindPostings(trigram, begin, end);
+        for (uint32_t posting = begin; posting < end; ++posting)
+        {
+            const index_t nameIndex = m_postings[posting];
+            if (sharedCounts[nameIndex]++ == 0)
+                touchedNames.push_back(nameIndex);
+        }
+    }
+
+    const uint32_t queryCount = static_cast<uint32_t>(trigrams.size());
+    for (index_t nameIndex : touchedNames)
+    {
+        const uint32_t sharedCount = sharedCounts[nameIndex];
+        sharedCounts[nameIndex] = 0;
+        if (sharedCount * 3 < queryCount)
+            continue;
+
+        // Jaccard similarity of the trigram sets, scaled to an integer.
+        const uint32_t unionCount = queryCount + m_nameTrigramCounts[nameIndex] - sharedCount;
+        if (unionCount == 0)
+            continue;
+        results.push_back(MakeResult(nameIndex, static_cast<uint32_t>(uint64_t(sharedCount) * 1000000 / unionCount)));
+    }
+
+    SortResults(maxResults, results);
+}
+
+std::string_view NameSearchIndex::GetName(index_t nameIndex) const
+{
+    const uint32_t begin = m_nameOffsets[nameIndex];
+    return std::string_view(m_names).substr(begin, m_nameOffsets[nameIndex + 1] - begin);
+}
+
+void NameSearchIndex::Save(std::ostream &stream) const
+{
+    WriteValue(stream, FileMagic);
+    WriteValue(stream, m_classBegin);
+    WriteValue(stream, m_namespaceBegin);
+    WriteArray(stream, m_nameOffsets);
+    WriteArray(stream, m_names);
+    WriteArray(stream, m_trigrams);
+    WriteArray(stream, m_postingOffsets);
+    WriteArray(stream, m_postings);
+    WriteArray(stream, m_nameTrigramCounts);
+}
+
+bool NameSearchIndex::Load(std::istream &stream)
+{
+    uint32_t magic;
+    if (!ReadValue(stream, magic) || magic != FileMagic)
+        return false;
+
+    if (!ReadValue(stream, m_classBegin) || !ReadValue(stream, m_namespaceBegin) || !ReadArray(stream, m_nameOffsets)
+        || !ReadArray(stream, m_names) || !ReadArray(stream, m_trigrams) || !ReadArray(stream, m_postingOffsets)
+        || !ReadArray(stream, m_postings) || !ReadArray(stream, m_nameTrigramCounts) || !IsValid())
+    {
+        *this = NameSearchIndex();
+        return false;
+    }
+
+    m_lowerNames = ToLower(m_names);
+    return true;
+}
+
+bool NameSearchIndex::IsValid() const
+{
+    if (m_nameOffsets.empty() || m_nameOffsets.front() != 0 || m_nameOffsets.back() != m_names.size())
+        return false;
+    if (!std::is_sorted(m_nameOffsets.begin(), m_nameOffsets.end()))
+        return false;
+
+    const index_t nameCount = GetNameCount();
+    if (m_classBegin > m_namespaceBegin || m_namespaceBegin > nameCount || m_nameTrigramCounts.size() != nameCount)
+        return false;
+
+    // Trigrams are binary searched, so they must be unique and sorted.
+    if (std::adjacent_find(m_trigrams.begin(), m_trigrams.end(), std::greater_equal<Trigram>()) != m_trigrams.end())
+        return false;
+
+    if (m_postingOffsets.size() != m_trigrams.size() + 1 || m_postingOffsets.front() != 0
+        || m_postingOffsets.back() != m_postings.size())
+        return false;
+    if (!std::is_sorted(m_postingOffsets.begin(), m_postingOffsets.end()))
+        return false;
+    const size_t trigramCount = m_trigrams.size();
+    for (size_t trigramIndex = 0; trigramIndex < trigramCount; ++trigramIndex)
+    {
+        const uint32_t begin = m_postingOffsets[trigramIndex];
+        const uint32_t end = m_postingOffsets[trigramIndex + 1];
+
+        // Posting lists are intersected by merging, so they must be unique and ascending.
+        const auto postingsBegin = m_postings.begin() + begin;
+        const auto postingsEnd = m_postings.begin() + end;
+        if (std::adjacent_find(postingsBegin, postingsEnd, std::greater_equal<index_t>()) != postingsEnd)
+            return false;
+        if (begin != end && m_postings[end - 1] >= nameCount)
+            return false;
+    }
+
+    // Fuzzy queries divide by the trigram counts, so they must match the postings of every name.
+    std::vector<uint32_t> postingCounts(nameCount, 0);
+    for (index_t nameIndex : m_postings)
+    {
+        ++postingCounts[nameIndex];
+    }
+    for (index_t nameIndex = 0; nameIndex < nameCount; ++nameIndex)
+    {
+        const uint32_t trigramCount = postingCounts[nameIndex];
+        if (m_nameTrigramCounts[nameIndex] != std::min<uint32_t>(trigramCount, std::numeric_limits<uint16_t>::max()))
+            return false;
+    }
+    return true;
+}
+
+size_t NameSearchIndex::GetMemoryUsage() const
+{
+    return m_nameOffsets.capacity() * sizeof(uint32_t) + m_names.capacity() + m_lowerNames.capacity()
+        + m_trigrams.capacity() * sizeof(Trigram) + m_postingOffsets.capacity() * sizeof(uint32_t)
+        + m_postings.capacity() * sizeof(index_t) + m_nameTrigramCounts.capacity() * sizeof(uint16_t);
+}
+
+void NameSearchIndex::AddNames(const Functions &functions, const Classes &classes, const Namespaces &namespaces)
+{
+    m_nameOffsets.assign(1, 0);
+    m_names.clear();
+    m_lowerNames.clear();
+
+    for (const Function &function : functions)
+    {
+        AddName(function.m_name);
+    }
+    m_classBegin = GetNameCount();
+    for (const Class &classType : classes)
+    {
+        AddName(classType.m_name);
+    }
+    m_namespaceBegin = GetNameCount();
+    for (const Namespace &namespaceType : namespaces)
+    {
+        AddName(namespaceType.m_name);
+    }
+}
+
+void NameSearchIndex::AddName(std::string_view name)
+{
+    m_names.append(name);
+    m_lowerNames.append(ToLower(name));
+    assert(m_names.size() <= std::numeric_limits<uint32_t>::max());
+    m_nameOffsets.push_back(static_cast<uint32_t>(m_names.size()));
+}
+
+std::string_view NameSearchIndex::GetLowerName(index_t nameIndex) const
+{
+    const uint32_t begin = m_nameOffsets[nameIndex];
+    return std::string_view(m_lowerNames).substr(begin, m_nameOffsets[nameIndex + 1] - begin);
+}
+
+NameSearchIndex::Result NameSearchIndex::MakeResult(index_t nameIndex, uint32_t score) const
+{
+    Result result;
+    result.m_score = score;
+    if (nameIndex >= m_namespaceBegin)
+    {
+        result.m_entityKind = EntityKind::Namespace;
+        result.m_index = nameIndex - m_namespaceBegin;
+    }
+    else if (nameIndex >= m_classBegin)
+    {
+        result.m_entityKind = EntityKind::Class;
+        result.m_index = nameIndex - m_classBegin;
+    }
+    else
+    {
+        result.m_entityKind = EntityKind::Function;
+        result.m_index = nameIndex;
+    }
+    return result;
+}
+
+void NameSearchIndex::FindPostings(Trigram trigram, uint32_t &begin, uint32_t &end) const
+{
+    std::vector<Trigram>::const_iterator it = std::lower_bound(m_trigrams.begin(), m_trigrams.end(), trigram);
+    if (it == m_trigrams.end() || *it != trigram)
+    {
+        begin = 0;
+        end = 0;
+        return;
+    }
+
+    const size_t trigramIndex = it - m_trigrams.begin();
+    begin = m_postingOffsets[trigramIndex];
+    end = m_postingOffsets[trigramIndex + 1];
+}
+
+void NameSearchIndex::CollectTrigrams(std::string_view lowerName, std::vector<Trigram> &trigrams)
+{
+    trigrams.clear();
+    for (size_t i = 0; i + 3 <= lowerName.size(); ++i)
+    {
+        trigrams.push_back(
+            (Trigram(uint8_t(lowerName[i])) << 16) | (Trigram(uint8_t(lowerName[i + 1])) << 8)
+            | Trigram(uint8_t(lowerName[i + 2])));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+std::string NameSearchIndex::ToLower(std::string_view name)
+{
+    std::string lowerName(name);
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ToLowerAscii);
+    return lowerName;
+}
+
+void NameSearchIndex::SortResults(size_t maxResults, std::vector<Result> &results)
+{
+    const auto isBetter = [](const Result &result1, const Result &result2) {
+        if (result1.m_score != result2.m_score)
+            return result1.m_score > result2.m_score;
+        if (result1.m_entityKind != result2.m_entityKind)
+            return result1.m_entityKind < result2.m_entityKind;
+        return result1.m_index < result2.m_index;
+    };
+
+    const size_t count = std::min(maxResults, results.size());
+    std::partial_sort(results.begin(), results.begin() + count, results.end(), isBetter);
+    results.resize(count);
+}
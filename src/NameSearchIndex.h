@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class ThreadPool;
+
+// Search index over the names of all functions, classes and namespaces. Names are lowered to ASCII lowercase and split
+// into overlapping trigrams. Every trigram has a sorted posting list of names in compressed sparse row form.
+// Substring queries intersect the posting lists of the query trigrams and verify the candidates. Fuzzy queries rank
+// names by the share of trigrams they have in common with the query.
+class NameSearchIndex
+{
+public:
+    enum class EntityKind : uint8_t
+    {
+        Function,
+        Class,
+        Namespace,
+    };
+
+    struct Result
+    {
+        EntityKind m_entityKind = EntityKind::Function;
+        index_t m_index = InvalidIndex; // Index of the function, class or namespace.
+        uint32_t m_score = 0; // Higher is better. Only comparable between results of one query.
+    };
+
+public:
+    // Tokenizes the names in parallel.
+    void Build(
+        const Functions &functions,
+        const Classes &classes,
+        const Namespaces &namespaces,
+        ThreadPool &threadPool);
+
+    // Finds names that contain the query, ignoring case. Exact matches rank first, then prefixes, then matches after a
+    // scope separator, each shorter names first.
+    void FindSubstring(std::string_view query, size_t maxResults, std::vector<Result> &results) const;
+    // Finds names that share at least a third of their trigrams with the query, most similar first.
+    void FindFuzzy(std::string_view query, size_t maxResults, std::vector<Result> &results) const;
+
+    index_t GetNameCount() const { return static_cast<index_t>(m_nameOffsets.size() - 1); }
+    std::string_view GetName(index_t nameIndex) const;
+
+    // Writes and reads the index in a host endian binary format, which the model file stores in its NameSearchIndex
+    // section. Load returns false and leaves an empty index if the data is not a valid index.
+    void Save(std::ostream &stream) const;
+    bool Load(std::istream &stream);
+
+    size_t GetMemoryUsage() const;
+
+private:
+    using Trigram = uint32_t; // Three lowercase bytes.
+
+    void AddNames(const Functions &functions, const Classes &classes, const Namespaces &namespaces);
+    void AddName(std::string_view name);
+    std::string_view GetLowerName(index_t nameIndex) const;
+    Result MakeResult(index_t nameIndex, uint32_t score) const;
+    // Checks the offsets, sort orders and indices of loaded data.
+    bool IsValid() const;
+    // Returns the posting list bounds of the trigram, or an empty range.
+    void FindPostings(Trigram trigram, uint32_t &begin, uint32_t &end) const;
+
+    static void CollectTrigrams(std::string_view lowerName, std::vector<Trigram> &trigrams);
+    static std::string ToLower(std::string_view name);
+    static void SortResults(size_t maxResults, std::vector<Result> &results);
+
+private:
+    std::vector<uint32_t> m_nameOffsets = {0}; // Offsets into m_names and m_lowerNames, one more than names.
+    std::string m_names;
+    std::string m_lowerNames;
+    index_t m_classBegin = 0; // First name of a class. Functions come before.
+    index_t m_namespaceBegin = 0; // First name of a namespace. Classes come before.
+
+    std::vector<Trigram> m_trigrams; // Sorted unique trigrams.
+    std::vector<uint32_t> m_postingOffsets; // Offsets into m_postings, one more than trigrams.
+    std::vector<index_t> m_postings; // Name indices, ascending per trigram.
+    std::vector<uint16_t> m_nameTrigramCounts; // Unique trigrams per name.
+};
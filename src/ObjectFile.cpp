@@ -0,0 +1,132 @@
+#include "ObjectFile.h"
+
+#include <cstring>
+
+#include <mach-o/nlist.h>
+
+namespace
+{
+// Subset of <mach-o/loader.h>, which depends on headers that are not part of the bundled SDK.
+constexpr uint32_t MH_MAGIC = 0xfeedface;
+constexpr uint32_t MH_MAGIC_64 = 0xfeedfacf;
+constexpr uint32_t LC_SYMTAB = 0x2;
+
+struct mach_header
+{
+    uint32_t magic;
+    int32_t cputype;
+    int32_t cpusubtype;
+    uint32_t filetype;
+    uint32_t ncmds;
+    uint32_t sizeofcmds;
+    uint32_t flags;
+};
+
+struct load_command
+{
+    uint32_t cmd;
+    uint32_t cmdsize;
+};
+
+struct symtab_command
+{
+    uint32_t cmd;
+    uint32_t cmdsize;
+    uint32_t symoff;
+    uint32_t nsyms;
+    uint32_t stroff;
+    uint32_t strsize;
+};
+
+template<typename T>
+bool ReadStruct(const uint8_t *data, size_t size, size_t offset, T &value)
+{
+    if (offset > size || size - offset < sizeof(T))
+        return false;
+
+    // Load commands and symbols are not guaranteed to be aligned in the mapping.
+    std::memcpy(&value, data + offset, sizeof(T));
+    return true;
+}
+
+template<typename NList>
+bool ReadSymbolTable(const uint8_t *data, size_t size, const symtab_command &symtab, SymbolEntries &symbols)
+{
+    if (symtab.stroff > size || size - symtab.stroff < symtab.strsize)
+        return false;
+    if (symtab.symoff > size || (size - symtab.symoff) / sizeof(NList) < symtab.nsyms)
+        return false;
+
+    const char *strings = reinterpret_cast<const char *>(data + symtab.stroff);
+
+    symbols.resize(symtab.nsyms);
+    for (uint32_t i = 0; i < symtab.nsyms; ++i)
+    {
+        NList entry;
+        std::memcpy(&entry, data + symtab.symoff + size_t(i) * sizeof(NList), sizeof(NList));
+
+        SymbolEntry &symbol = symbols[i];
+        const uint32_t strx = static_cast<uint32_t>(entry.n_un.n_strx);
+        if (strx != 0 && strx < symtab.strsize)
+        {
+            const char *name = strings + strx;
+            symbol.m_name = std::string_view(name, strnlen(name, symtab.strsize - strx));
+        }
+        symbol.m_value = entry.n_value;
+        symbol.m_description = static_cast<uint16_t>(entry.n_desc);
+        symbol.m_type = entry.n_type;
+        symbol.m_section = entry.n_sect;
+    }
+    return true;
+}
+} // namespace
+
+bool ObjectFile::Load(const std::string &filepath)
+{
+    return m_file.Open(filepath);
+}
+
+void ObjectFile::Unload()
+{
+    m_file.Close();
+}
+
+bool ObjectFile::ReadSymbols(SymbolEntries &symbols) const
+{
+    const uint8_t *data = m_file.GetData();
+    const size_t size = m_file.GetSize();
+
+    mach_header header;
+    if (!ReadStruct(data, size, 0, header))
+        return false;
+
+    // Only objects in host byte order are supported. Fat objects are not supported.
+    size_t offset;
+    if (header.magic == MH_MAGIC)
+        offset = sizeof(mach_header);
+    else if (header.magic == MH_MAGIC_64)
+        offset = sizeof(mach_header) + sizeof(uint32_t); // mach_header_64 has a reserved field.
+    else
+        return false;
+
+    for (uint32_t i = 0; i < header.ncmds; ++i)
+    {
+        load_command command;
+        if (!ReadStruct(data, size, offset, command) || command.cmdsize < sizeof(load_command))
+            return false;
+
+        if (command.cmd == LC_SYMTAB)
+        {
+            symtab_command symtab;
+            if (!ReadStruct(data, size, offset, symtab))
+                return false;
+
+            if (header.magic == MH_MAGIC_64)
+                return ReadSymbolTable<struct nlist_64>(data, size, symtab, symbols);
+            else
+                return ReadSymbolTable<struct nlist>(data, size, symtab, symbols);
+        }
+        offset += command.cmdsize;
+    }
+    return false;
+}
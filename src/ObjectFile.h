@@ -0,0 +1,34 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct SymbolEntry // Symbol table entry. The name references the string table of the binary or object file.
+{
+    std::string_view m_name;
+    uint64_t m_value = 0; // n_value
+    uint16_t m_description = 0; // n_desc
+    uint8_t m_type = 0; // n_type
+    uint8_t m_section = 0; // n_sect
+};
+
+using SymbolEntries = std::vector<SymbolEntry>;
+
+// Mach-O object file that is read in place from a memory mapping.
+// Only the symbol table is understood. Names of read symbols are valid as long as the object file is loaded.
+class ObjectFile
+{
+public:
+    bool Load(const std::string &filepath);
+    void Unload();
+
+    // Reads all symbol table entries in symbol table order. Requires Load.
+    bool ReadSymbols(SymbolEntries &symbols) const;
+
+private:
+    MappedFile m_file;
+};
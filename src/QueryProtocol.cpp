@@ -0,0 +1,111 @@
+#include "QueryProtocol.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace QueryProtocol
+{
+void Writer::WriteUInt8(uint8_t value)
+{
+    m_data.push_back(value);
+}
+
+void Writer::WriteUInt16(uint16_t value)
+{
+    m_data.push_back(static_cast<uint8_t>(value));
+    m_data.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void Writer::WriteUInt32(uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        m_data.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void Writer::WriteUInt64(uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        m_data.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+void Writer::WriteString(std::string_view value)
+{
+    WriteUInt32(static_cast<uint32_t>(value.size()));
+    m_data.insert(m_data.end(), value.begin(), value.end());
+}
+
+void Writer::PatchUInt8(size_t offset, uint8_t value)
+{
+    assert(offset < m_data.size());
+    m_data[offset] = value;
+}
+
+void Writer::PatchUInt16(size_t offset, uint16_t value)
+{
+    assert(offset + 2 <= m_data.size());
+    m_data[offset] = static_cast<uint8_t>(value);
+    m_data[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+bool Reader::ReadUInt8(uint8_t &value)
+{
+    return ReadLittleEndian(value);
+}
+
+bool Reader::ReadUInt16(uint16_t &value)
+{
+    return ReadLittleEndian(value);
+}
+
+bool Reader::ReadUInt32(uint32_t &value)
+{
+    return ReadLittleEndian(value);
+}
+
+bool Reader::ReadUInt64(uint64_t &value)
+{
+    return ReadLittleEndian(value);
+}
+
+bool Reader::ReadString(std::string_view &value)
+{
+    uint32_t size;
+    if (!ReadUInt32(size))
+        return false;
+    if (size > m_size - m_offset)
+        return false;
+
+    value = std::string_view(reinterpret_cast<const char *>(m_data + m_offset), size);
+    m_offset += size;
+    return true;
+}
+
+bool Reader::ReadBytes(void *bytes, size_t count)
+{
+    if (count > m_size - m_offset)
+        return false;
+
+    std::memcpy(bytes, m_data + m_offset, count);
+    m_offset += count;
+    return true;
+}
+
+template<typename T>
+bool Reader::ReadLittleEndian(T &value)
+{
+    uint8_t bytes[sizeof(T)];
+    if (!ReadBytes(bytes, sizeof(T)))
+        return false;
+
+    value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(static_cast<T>(bytes[i]) << (8 * i));
+    }
+    return true;
+}
+} // namespace QueryProtocol
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Binary protocol of the query server. All integers are little endian, strings are a uint32 length and the bytes.
+//
+// Frame:    uint32 payload size, payload.
+// Request:  uint16 model index, uint16 query count, queries. Every query is a uint8 QueryKind and its arguments.
+// Response: uint16 query count, results. Every result is a uint8 QueryStatus, followed by the values if Ok.
+//
+// Processing stops at the first query that cannot be decoded. Its status is the last result of the response.
+namespace QueryProtocol
+{
+constexpr uint32_t MaxFrameSize = 16 * 1024 * 1024;
+
+enum class QueryKind : uint8_t
+{
+    FunctionByAddress = 1, // uint64 address -> uint32 function, uint32 line, string function name, string file name
+    FunctionByName = 2, // string name -> uint32 function, uint64 address
+    ClassByName = 3, // string name -> uint32 class
+    FunctionName = 4, // uint32 function -> string name
+    ClassName = 5, // uint32 class -> string name
+    IsDerivedFrom = 6, // uint32 class, uint32 base class -> uint8 derived, uint16 base offset
+    DerivedClasses = 7, // uint32 class -> uint32 count, count * uint32 class
+    BaseClasses = 8, // uint32 class -> uint32 count, count * (uint32 class, uint16 offset, uint8 virtual)
+    VTables = 9, // uint32 class -> uint16 count, count * (uint16 offset, uint16 count, count * VTableEntry)
+                 // VTableEntry: uint32 function, uint32 thunk, uint16 flags, string name
+    Overrides = 10, // uint32 class, uint16 entry -> uint32 count, count * (uint32 class, uint32 function)
+    SearchNames = 11, // string query, uint8 fuzzy, uint16 max results -> uint32 count, count * SearchResult
+                      // SearchResult: uint8 NameSearchIndex::EntityKind, uint32 index, uint32 score
+    Callers = 12, // uint32 function, uint8 transitive -> uint32 count, count * uint32 function
+    Callees = 13, // uint32 function -> uint32 count, count * uint32 function
+    TemplateInstantiations = 14, // string template -> uint32 template, uint32 count, count * uint32 class,
+                                 // uint32 count, count * uint32 function
+};
+
+enum class QueryStatus : uint8_t
+{
+    Ok = 0,
+    NotFound = 1,
+    InvalidArgument = 2, // Index out of range.
+    InvalidQuery = 3, // Unknown kind or truncated arguments.
+    InvalidModel = 4, // Model index out of range.
+};
+
+// Appends values to a byte buffer.
+class Writer
+{
+public:
+    void WriteUInt8(uint8_t value);
+    void WriteUInt16(uint16_t value);
+    void WriteUInt32(uint32_t value);
+    void WriteUInt64(uint64_t value);
+    void WriteString(std::string_view value);
+    // Overwrite values that were written before.
+    void PatchUInt8(size_t offset, uint8_t value);
+    void PatchUInt16(size_t offset, uint16_t value);
+
+    void Clear() { m_data.clear(); }
+    void Truncate(size_t size) { m_data.resize(size); }
+    size_t GetSize() const { return m_data.size(); }
+    const std::vector<uint8_t> &GetData() const { return m_data; }
+
+private:
+    std::vector<uint8_t> m_data;
+};
+
+// Reads values from a byte buffer. Every read returns false if the buffer is too short.
+class Reader
+{
+public:
+    Reader(const uint8_t *data, size_t size) : m_data(data), m_size(size) {}
+
+    bool ReadUInt8(uint8_t &value);
+    bool ReadUInt16(uint16_t &value);
+    bool ReadUInt32(uint32_t &value);
+    bool ReadUInt64(uint64_t &value);
+    // The string refers to the buffer.
+    bool ReadString(std::string_view &value);
+
+    bool IsAtEnd() const { return m_offset == m_size; }
+
+private:
+    bool ReadBytes(void *bytes, size_t count);
+    template<typename T>
+    bool ReadLittleEndian(T &value);
+
+private:
+    const uint8_t *m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_offset = 0;
+};
+} // namespace QueryProtocol
@@ -0,0 +1,707 @@
+#include "QueryServer.h"
+
+#include "ThreadPool.h"
+
+#include <fmt/core.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <system_error>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using QueryProtocol::QueryKind;
+using QueryProtocol::QueryStatus;
+
+namespace
+{
+constexpr int PollTimeoutMilliseconds = 500;
+
+uint32_t ReadFrameSize(const uint8_t *data)
+{
+    return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+} // namespace
+
+QueryServer::QueryServer(const QueryServerOptions &options) : m_options(options), m_stop(false)
+{
+}
+
+QueryServer::~QueryServer() = default;
+
+bool QueryServer::AddModel(const std::string &filepath)
+{
+    std::shared_ptr<const Model> model = LoadModel(filepath);
+    if (model == nullptr)
+        return false;
+
+    ModelSlot slot;
+    slot.m_filepath = filepath;
+    slot.m_model = std::move(model);
+    m_models.push_back(std::move(slot));
+    return true;
+}
+
+void QueryServer::Stop()
+{
+    m_stop = true;
+}
+
+std::shared_ptr<const QueryServer::Model> QueryServer::LoadModel(const std::string &filepath) const
+{
+    std::error_code error;
+    const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(filepath, error);
+    if (error)
+        return nullptr;
+
+    std::shared_ptr<Model> model = std::make_shared<Model>();
+    model->m_reader = std::make_unique<MachOReader>(m_options.m_readerOptions);
+    if (!model->m_reader->Load(filepath, m_options.m_cpuType))
+        return nullptr;
+
+    // Builds the class model, the search index and the call graph now, so that queries never build or demangle.
+    const Functions &functions = model->m_reader->GetFunctions();
+    model->m_reader->GetClasses();
+    model->m_reader->GetNameSearchIndex();
+    model->m_reader->GetCallGraph();
+
+    const index_t functionCount = functions.size();
+    model->m_functionNameToIndex.reserve(functionCount);
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        model->m_functionNameToIndex.emplace(functions[functionIndex].m_name, functionIndex);
+    }
+    model->m_writeTime = writeTime;
+    return model;
+}
+
+std::shared_ptr<const QueryServer::Model> QueryServer::GetModel(size_t modelIndex) const
+{
+    if (modelIndex >= m_models.size())
+        return nullptr;
+    return std::atomic_load(&m_models[modelIndex].m_model);
+}
+
+void QueryServer::ReloadLoop()
+{
+    const std::chrono::seconds interval(m_options.m_reloadIntervalSeconds);
+    std::unique_lock<std::mutex> lock(m_reloadMutex);
+    while (!m_stop)
+    {
+        m_reloadCondition.wait_for(lock, interval);
+        if (m_stop)
+            break;
+
+        for (ModelSlot &slot : m_models)
+        {
+            std::error_code error;
+            const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(slot.m_filepath, error);
+            if (error || writeTime == std::atomic_load(&slot.m_model)->m_writeTime)
+                continue;
+
+            // The old model serves queries while the new one loads.
+            std::shared_ptr<const Model> model = LoadModel(slot.m_filepath);
+            if (model == nullptr)
+            {
+                fmt::print(stderr, "Failed to reload '{}'\n", slot.m_filepath);
+                continue;
+            }
+            std::atomic_store(&slot.m_model, std::move(model));
+            fmt::print(stderr, "Reloaded '{}'\n", slot.m_filepath);
+        }
+    }
+}
+
+void QueryServer::ProcessRequest(const uint8_t *data, size_t size, QueryProtocol::Writer &writer) const
+{
+    QueryProtocol::Reader reader(data, size);
+    writer.Clear();
+    writer.WriteUInt16(0);
+
+    uint16_t modelIndex;
+    uint16_t queryCount;
+    if (!reader.ReadUInt16(modelIndex) || !reader.ReadUInt16(queryCount))
+    {
+        writer.PatchUInt16(0, 1);
+        writer.WriteUInt8(static_cast<uint8_t>(QueryStatus::InvalidQuery));
+        return;
+    }
+
+    const std::shared_ptr<const Model> model = GetModel(modelIndex);
+    if (model == nullptr)
+    {
+        writer.PatchUInt16(0, 1);
+        writer.WriteUInt8(static_cast<uint8_t>(QueryStatus::InvalidModel));
+        return;
+    }
+
+    uint16_t resultCount = 0;
+    for (uint16_t queryIndex = 0; queryIndex < queryCount; ++queryIndex)
+    {
+        ++resultCount;
+        uint8_t kind;
+        if (!reader.ReadUInt8(kind))
+        {
+            writer.WriteUInt8(static_cast<uint8_t>(QueryStatus::InvalidQuery));
+            break;
+        }
+
+        // Values are written after the status, which is patched when the query is done.
+        const size_t statusOffset = writer.GetSize();
+        writer.WriteUInt8(0);
+        const QueryStatus status = ProcessQuery(static_cast<QueryKind>(kind), *model, reader, writer);
+        if (status != QueryStatus::Ok)
+        {
+            writer.Truncate(statusOffset + 1);
+        }
+        writer.PatchUInt8(statusOffset, static_cast<uint8_t>(status));
+        if (status == QueryStatus::InvalidQuery)
+            break;
+    }
+    writer.PatchUInt16(0, resultCount);
+}
+
+QueryStatus QueryServer::ProcessQuery(
+    QueryKind kind,
+    const Model &model,
+    QueryProtocol::Reader &reader,
+    QueryProtocol::Writer &writer)
+{
+    MachOReader &machOReader = *model.m_reader;
+    const Functions &functions = machOReader.GetFunctions();
+    const Classes &classes = machOReader.GetClasses();
+    const index_t functionCount = functions.size();
+    const index_t classCount = classes.size();
+
+    switch (kind)
+    {
+        case QueryKind::FunctionByAddress: {
+            uint64_t address;
+            if (!reader.ReadUInt64(address))
+                return QueryStatus::InvalidQuery;
+
+            const index_t functionIndex = machOReader.FindFunctionByAddress(address);
+            if (functionIndex == InvalidIndex)
+                return QueryStatus::NotFound;
+
+            const Function &function = functions[functionIndex];
+            LineTableRow row;
+            std::string_view fileName;
+            if (machOReader.FindLine(address, row))
+            {
+                if (row.m_headerFileIndex != InvalidIndex)
+                    fileName = machOReader.GetHeaderFiles()[row.m_headerFileIndex].m_name;
+                else if (row.m_sourceFileIndex != InvalidIndex)
+                    fileName = machOReader.GetSourceFiles()[row.m_sourceFileIndex].m_name;
+            }
+            else if (function.m_sourceFileIndex != InvalidIndex)
+            {
+                fileName = machOReader.GetSourceFiles()[function.m_sourceFileIndex].m_name;
+            }
+
+            writer.WriteUInt32(functionIndex);
+            writer.WriteUInt32(row.m_line);
+            writer.WriteString(function.m_name);
+            writer.WriteString(fileName);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::FunctionByName: {
+            std::string_view name;
+            if (!reader.ReadString(name))
+                return QueryStatus::InvalidQuery;
+
+            StringViewToIndexMap::const_iterator it = model.m_functionNameToIndex.find(name);
+            if (it == model.m_functionNameToIndex.end())
+                return QueryStatus::NotFound;
+
+            const Function &function = functions[it->second];
+            writer.WriteUInt32(it->second);
+            writer.WriteUInt64(function.m_variants.empty() ? 0 : function.m_variants.front().m_address);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::ClassByName: {
+            std::string_view name;
+            if (!reader.ReadString(name))
+                return QueryStatus::InvalidQuery;
+
+            const ScopeTrie &scopeTrie = machOReader.GetScopeTrie();
+            const index_t nodeIndex = scopeTrie.FindNode(name);
+            if (nodeIndex == InvalidIndex || scopeTrie.GetNode(nodeIndex).m_classIndex == InvalidIndex)
+                return QueryStatus::NotFound;
+
+            writer.WriteUInt32(scopeTrie.GetNode(nodeIndex).m_classIndex);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::FunctionName: {
+            uint32_t functionIndex;
+            if (!reader.ReadUInt32(functionIndex))
+                return QueryStatus::InvalidQuery;
+            if (functionIndex >= functionCount)
+                return QueryStatus::InvalidArgument;
+
+            writer.WriteString(functions[functionIndex].m_name);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::ClassName: {
+            uint32_t classIndex;
+            if (!reader.ReadUInt32(classIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            writer.WriteString(classes[classIndex].m_name);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::IsDerivedFrom: {
+            uint32_t classIndex;
+            uint32_t baseClassIndex;
+            if (!reader.ReadUInt32(classIndex) || !reader.ReadUInt32(baseClassIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount || baseClassIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            uint16_t baseOffset = 0;
+            const bool isDerived = machOReader.GetClassHierarchy().GetBaseOffset(classIndex, baseClassIndex, baseOffset);
+            writer.WriteUInt8(isDerived ? 1 : 0);
+            writer.WriteUInt16(baseOffset);
+            return QueryStatus::Ok;
+        }
+        case QueryKind::DerivedClasses: {
+            uint32_t classIndex;
+            if (!reader.ReadUInt32(classIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            thread_local std::vector<index_t> derivedClassIndices;
+            machOReader.GetClassHierarchy().GetDerivedClasses(classIndex, derivedClassIndices);
+            writer.WriteUInt32(static_cast<uint32_t>(derivedClassIndices.size()));
+            for (index_t derivedClassIndex : derivedClassIndices)
+            {
+                writer.WriteUInt32(derivedClassIndex);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::BaseClasses: {
+            uint32_t classIndex;
+            if (!reader.ReadUInt32(classIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            const std::vector<BaseClass> &baseClasses = classes[classIndex].m_allBaseClasses;
+            writer.WriteUInt32(static_cast<uint32_t>(baseClasses.size()));
+            for (const BaseClass &baseClass : baseClasses)
+            {
+                writer.WriteUInt32(baseClass.m_classIndex);
+                writer.WriteUInt16(baseClass.m_baseOffset);
+                writer.WriteUInt8(baseClass.m_isVirtual ? 1 : 0);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::VTables: {
+            uint32_t classIndex;
+            if (!reader.ReadUInt32(classIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            const Class &classType = classes[classIndex];
+            writer.WriteUInt16(static_cast<uint16_t>(classType.m_vtables.size()));
+            for (const VTable &vtable : classType.m_vtables)
+            {
+                writer.WriteUInt16(vtable.m_offset);
+                writer.WriteUInt16(vtable.Size());
+                for (const VTableEntry &entry : classType.GetVTableEntries(vtable))
+                {
+                    writer.WriteUInt32(entry.GetFunctionIndex());
+                    writer.WriteUInt32(entry.GetThunkIndex());
+                    writer.WriteUInt16(entry.m_flags);
+                    writer.WriteString(machOReader.GetVTableEntryName(entry));
+                }
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::Overrides: {
+            uint32_t classIndex;
+            uint16_t entryIndex;
+            if (!reader.ReadUInt32(classIndex) || !reader.ReadUInt16(entryIndex))
+                return QueryStatus::InvalidQuery;
+            if (classIndex >= classCount)
+                return QueryStatus::InvalidArgument;
+
+            const tcb::span<const VirtualOverrideIndex::Override> overrides =
+                machOReader.GetVirtualOverrideIndex().GetOverrides(classIndex, entryIndex);
+            writer.WriteUInt32(static_cast<uint32_t>(overrides.size()));
+            for (const VirtualOverrideIndex::Override &virtualOverride : overrides)
+            {
+                writer.WriteUInt32(virtualOverride.m_classIndex);
+                writer.WriteUInt32(virtualOverride.m_functionIndex);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::SearchNames: {
+            std::string_view query;
+            uint8_t fuzzy;
+            uint16_t maxResults;
+            if (!reader.ReadString(query) || !reader.ReadUInt8(fuzzy) || !reader.ReadUInt16(maxResults))
+                return QueryStatus::InvalidQuery;
+
+            thread_local std::vector<NameSearchIndex::Result> results;
+            const NameSearchIndex &nameSearchIndex = machOReader.GetNameSearchIndex();
+            if (fuzzy != 0)
+                nameSearchIndex.FindFuzzy(query, maxResults, results);
+            else
+                nameSearchIndex.FindSubstring(query, maxResults, results);
+
+            writer.WriteUInt32(static_cast<uint32_t>(results.size()));
+            for (const NameSearchIndex::Result &result : results)
+            {
+                writer.WriteUInt8(static_cast<uint8_t>(result.m_entityKind));
+                writer.WriteUInt32(result.m_index);
+                writer.WriteUInt32(result.m_score);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::Callers: {
+            uint32_t functionIndex;
+            uint8_t transitive;
+            if (!reader.ReadUInt32(functionIndex) || !reader.ReadUInt8(transitive))
+                return QueryStatus::InvalidQuery;
+            if (functionIndex >= functionCount)
+                return QueryStatus::InvalidArgument;
+
+            thread_local std::vector<index_t> callerIndices;
+            const CallGraph &callGraph = machOReader.GetCallGraph();
+            if (transitive != 0)
+            {
+                callGraph.GetTransitiveCallers(functionIndex, callerIndices);
+            }
+            else
+            {
+                const tcb::span<const index_t> callers = callGraph.GetCallers(functionIndex);
+                callerIndices.assign(callers.begin(), callers.end());
+            }
+
+            writer.WriteUInt32(static_cast<uint32_t>(callerIndices.size()));
+            for (index_t callerIndex : callerIndices)
+            {
+                writer.WriteUInt32(callerIndex);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::Callees: {
+            uint32_t functionIndex;
+            if (!reader.ReadUInt32(functionIndex))
+                return QueryStatus::InvalidQuery;
+            if (functionIndex >= functionCount)
+                return QueryStatus::InvalidArgument;
+
+            const tcb::span<const index_t> callees = machOReader.GetCallGraph().GetCallees(functionIndex);
+            writer.WriteUInt32(static_cast<uint32_t>(callees.size()));
+            for (index_t calleeIndex : callees)
+            {
+                writer.WriteUInt32(calleeIndex);
+            }
+            return QueryStatus::Ok;
+        }
+        case QueryKind::TemplateInstantiations: {
+            std::string_view name;
+            if (!reader.ReadString(name))
+                return QueryStatus::InvalidQuery;
+
+            const TemplateIndex &templates = machOReader.GetTemplateIndex();
+            const index_t templateIndex = templates.FindTemplate(name);
+            if (templateIndex == InvalidIndex)
+                return QueryStatus::NotFound;
+
+            const TemplateIndex::Template &templateType = templates.GetTemplate(templateIndex);
+            writer.WriteUInt32(templateIndex);
+            writer.WriteUInt32(static_cast<uint32_t>(templateType.m_classIndices.size()));
+            for (index_t classIndex : templateType.m_classIndices)
+            {
+                writer.WriteUInt32(classIndex);
+            }
+            writer.WriteUInt32(static_cast<uint32_t>(templateType.m_functionIndices.size()));
+            for (index_t functionIndex : templateType.m_functionIndices)
+            {
+                writer.WriteUInt32(functionIndex);
+            }
+            return QueryStatus::Ok;
+        }
+    }
+    return QueryStatus::InvalidQuery;
+}
+
+#ifdef _WIN32
+
+bool QueryServer::Run()
+{
+    // Unix domain sockets are not supported on Windows.
+    return false;
+}
+
+#else
+
+bool QueryServer::Run()
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (m_options.m_socketPath.empty() || m_options.m_socketPath.size() >= sizeof(address.sun_path))
+        return false;
+    std::memcpy(address.sun_path, m_options.m_socketPath.c_str(), m_options.m_socketPath.size() + 1);
+
+    const int listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0)
+        return false;
+
+    unlink(m_options.m_socketPath.c_str());
+    if (bind(listenSocket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+        || listen(listenSocket, SOMAXCONN) != 0 || pipe(m_wakePipe) != 0)
+    {
+        close(listenSocket);
+        return false;
+    }
+    fcntl(listenSocket, F_SETFL, O_NONBLOCK);
+    fcntl(m_wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(m_wakePipe[1], F_SETFL, O_NONBLOCK);
+
+    // Clients that disconnect early must not terminate the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::thread reloadThread;
+    if (m_options.m_reloadIntervalSeconds != 0)
+    {
+        reloadThread = std::thread(&QueryServer::ReloadLoop, this);
+    }
+
+    std::unordered_map<uint64_t, Connection> connections;
+    {
+        ThreadPool threadPool(m_options.m_threadCount);
+        uint64_t nextConnectionId = 0;
+        std::vector<pollfd> pollSockets;
+        std::vector<uint64_t> pollConnectionIds;
+        while (!m_stop)
+        {
+            pollSockets.clear();
+            pollConnectionIds.clear();
+            pollSockets.push_back({listenSocket, POLLIN, 0});
+            pollSockets.push_back({m_wakePipe[0], POLLIN, 0});
+            for (const auto &[connectionId, connection] : connections)
+            {
+                if (connection.m_closed)
+                    continue;
+                // A busy connection is not read, so a client cannot queue unbounded input.
+                short events = connection.m_busy ? 0 : POLLIN;
+                if (connection.m_outputOffset < connection.m_output.size())
+                    events |= POLLOUT;
+                pollSockets.push_back({connection.m_socket, events, 0});
+                pollConnectionIds.push_back(connectionId);
+            }
+
+            if (poll(pollSockets.data(), pollSockets.size(), PollTimeoutMilliseconds) <= 0)
+                continue;
+
+            if (pollSockets[1].revents != 0)
+            {
+                uint8_t bytes[64];
+                while (read(m_wakePipe[0], bytes, sizeof(bytes)) > 0)
+                {
+                }
+                CompleteRequests(connections, threadPool);
+            }
+
+            for (size_t i = 0; i < pollConnectionIds.size(); ++i)
+            {
+                const short revents = pollSockets[i + 2].revents;
+                if (revents == 0)
+                    continue;
+
+                Connection &connection = connections[pollConnectionIds[i]];
+                if ((revents & POLLOUT) && !SendAvailable(connection))
+                    connection.m_closed = true;
+                if ((revents & (POLLIN | POLLHUP | POLLERR)) && !connection.m_busy && !ReceiveAvailable(connection))
+                    connection.m_closed = true;
+                if ((revents & (POLLHUP | POLLERR)) && connection.m_busy)
+                    connection.m_closed = true;
+                if (!connection.m_closed)
+                    SubmitRequest(pollConnectionIds[i], connection, threadPool);
+            }
+
+            if (pollSockets[0].revents != 0)
+            {
+                for (;;)
+                {
+                    const int connectionSocket = accept(listenSocket, nullptr, nullptr);
+                    if (connectionSocket < 0)
+                        break;
+                    fcntl(connectionSocket, F_SETFL, O_NONBLOCK);
+                    connections[nextConnectionId++].m_socket = connectionSocket;
+                }
+            }
+
+            for (auto it = connections.begin(); it != connections.end();)
+            {
+                if (it->second.m_closed && !it->second.m_busy)
+                {
+                    close(it->second.m_socket);
+                    it = connections.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        // The pool finishes the submitted requests. Their responses are dropped.
+    }
+
+    for (const auto &entry : connections)
+    {
+        close(entry.second.m_socket);
+    }
+    m_completions.clear();
+
+    if (reloadThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_reloadMutex);
+        }
+        m_reloadCondition.notify_all();
+        reloadThread.join();
+    }
+
+    close(m_wakePipe[0]);
+    close(m_wakePipe[1]);
+    close(listenSocket);
+    unlink(m_options.m_socketPath.c_str());
+    return true;
+}
+
+void QueryServer::SubmitRequest(uint64_t connectionId, Connection &connection, ThreadPool &threadPool)
+{
+    if (connection.m_busy || connection.m_input.size() < sizeof(uint32_t))
+        return;
+
+    const uint32_t requestSize = ReadFrameSize(connection.m_input.data());
+    if (requestSize > QueryProtocol::MaxFrameSize)
+    {
+        connection.m_closed = true;
+        return;
+    }
+    if (connection.m_input.size() < sizeof(uint32_t) + requestSize)
+        return;
+
+    std::vector<uint8_t> request(
+        connection.m_input.begin() + sizeof(uint32_t), connection.m_input.begin() + sizeof(uint32_t) + requestSize);
+    connection.m_input.erase(connection.m_input.begin(), connection.m_input.begin() + sizeof(uint32_t) + requestSize);
+    connection.m_busy = true;
+
+    threadPool.Enqueue([this, connectionId, request = std::move(request)]() {
+        QueryProtocol::Writer response;
+        ProcessRequest(request.data(), request.size(), response);
+
+        QueryProtocol::Writer frame;
+        frame.WriteUInt32(static_cast<uint32_t>(response.GetSize()));
+        Completion completion;
+        completion.m_connectionId = connectionId;
+        completion.m_response.reserve(frame.GetSize() + response.GetSize());
+        completion.m_response.insert(completion.m_response.end(), frame.GetData().begin(), frame.GetData().end());
+        completion.m_response.insert(
+            completion.m_response.end(), response.GetData().begin(), response.GetData().end());
+        {
+            std::lock_guard<std::mutex> lock(m_completionMutex);
+            m_completions.push_back(std::move(completion));
+        }
+
+        // The pipe is non-blocking. A full pipe already wakes the poll.
+        const uint8_t wake = 0;
+        [[maybe_unused]] const ssize_t written = write(m_wakePipe[1], &wake, sizeof(wake));
+    });
+}
+
+void QueryServer::CompleteRequests(std::unordered_map<uint64_t, Connection> &connections, ThreadPool &threadPool)
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_completionMutex);
+        completions.swap(m_completions);
+    }
+
+    for (Completion &completion : completions)
+    {
+        Connection &connection = connections[completion.m_connectionId];
+        connection.m_busy = false;
+        if (connection.m_closed)
+            continue;
+
+        if (connection.m_outputOffset == connection.m_output.size())
+        {
+            connection.m_output = std::move(completion.m_response);
+            connection.m_outputOffset = 0;
+        }
+        else
+        {
+            connection.m_output.insert(
+                connection.m_output.end(), completion.m_response.begin(), completion.m_response.end());
+        }
+
+        // The next request may be received already.
+        SubmitRequest(completion.m_connectionId, connection, threadPool);
+    }
+}
+
+bool QueryServer::ReceiveAvailable(Connection &connection)
+{
+    uint8_t bytes[4096];
+    for (;;)
+    {
+        const ssize_t received = recv(connection.m_socket, bytes, sizeof(bytes), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (received <= 0)
+            return false;
+
+        connection.m_input.insert(connection.m_input.end(), bytes, bytes + received);
+        // Requests are submitted one at a time, so reading stops once one is complete.
+        if (connection.m_input.size() >= sizeof(uint32_t)
+            && connection.m_input.size() >= sizeof(uint32_t) + ReadFrameSize(connection.m_input.data()))
+            return true;
+    }
+}
+
+bool QueryServer::SendAvailable(Connection &connection)
+{
+    while (connection.m_outputOffset < connection.m_output.size())
+    {
+        const ssize_t sent = send(
+            connection.m_socket,
+            connection.m_output.data() + connection.m_outputOffset,
+            connection.m_output.size() - connection.m_outputOffset,
+            0);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        if (sent <= 0)
+            return false;
+
+        connection.m_outputOffset += static_cast<size_t>(sent);
+    }
+    connection.m_output.clear();
+    connection.m_outputOffset = 0;
+    return true;
+}
+
+#endif
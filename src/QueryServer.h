@@ -0,0 +1,114 @@
+#pragma once
+
+#include "MachOReader.h"
+#include "QueryProtocol.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class ThreadPool;
+
+struct QueryServerOptions
+{
+    std::string m_socketPath;
+    // Number of request worker threads. 0 uses one thread per hardware thread.
+    size_t m_threadCount = 0;
+    // Checks the modification time of the binaries and reloads changed ones. 0 disables reloading.
+    uint32_t m_reloadIntervalSeconds = 2;
+    LIEF::MachO::Header::CPU_TYPE m_cpuType = LIEF::MachO::Header::CPU_TYPE::X86;
+    MachOReaderOptions m_readerOptions;
+};
+
+// Serves queries over loaded models on a Unix domain socket, see QueryProtocol.h. One thread polls all connections and
+// submits complete requests to a thread pool, so idle clients do not hold workers. Requests of one connection are
+// processed one at a time, so responses keep the request order. Models are immutable once loaded, so requests read
+// them without locks. A reloaded model replaces the old one atomically, and requests that still use the old model keep
+// it alive until they finish.
+class QueryServer
+{
+public:
+    explicit QueryServer(const QueryServerOptions &options);
+    ~QueryServer();
+
+    QueryServer(const QueryServer &) = delete;
+    QueryServer &operator=(const QueryServer &) = delete;
+
+    // Loads a binary before Run. The model index is the order of the calls.
+    bool AddModel(const std::string &filepath);
+
+    // Accepts connections until Stop is called. Returns false if the socket cannot be created.
+    bool Run();
+    // Can be called from a signal handler.
+    void Stop();
+
+    // Processes one request payload. Exposed for clients in the same process.
+    void ProcessRequest(const uint8_t *data, size_t size, QueryProtocol::Writer &writer) const;
+
+private:
+    struct Model
+    {
+        std::unique_ptr<MachOReader> m_reader;
+        StringViewToIndexMap m_functionNameToIndex; // First function by demangled name. Views into the reader.
+        std::filesystem::file_time_type m_writeTime;
+    };
+
+    struct ModelSlot
+    {
+        std::string m_filepath;
+        std::shared_ptr<const Model> m_model; // Accessed with std::atomic_load and std::atomic_store.
+    };
+
+    // Only accessed by the thread that runs Run.
+    struct Connection
+    {
+        int m_socket = -1;
+        std::vector<uint8_t> m_input; // Received bytes that are not part of a submitted request.
+        std::vector<uint8_t> m_output; // Response frames that are not sent yet.
+        size_t m_outputOffset = 0;
+        bool m_busy = false; // A request of the connection is in the pool.
+        bool m_closed = false; // Closed by the client or after an error. Removed when it is not busy.
+    };
+
+    struct Completion
+    {
+        uint64_t m_connectionId = 0;
+        std::vector<uint8_t> m_response; // Response frame with the size.
+    };
+
+private:
+    std::shared_ptr<const Model> LoadModel(const std::string &filepath) const;
+    std::shared_ptr<const Model> GetModel(size_t modelIndex) const;
+    void ReloadLoop();
+
+    static bool ReceiveAvailable(Connection &connection);
+    static bool SendAvailable(Connection &connection);
+    // Submits the next complete request of the connection to the pool, if it is not busy.
+    void SubmitRequest(uint64_t connectionId, Connection &connection, ThreadPool &threadPool);
+    // Queues the responses of the pool for sending.
+    void CompleteRequests(std::unordered_map<uint64_t, Connection> &connections, ThreadPool &threadPool);
+
+    static QueryProtocol::QueryStatus ProcessQuery(
+        QueryProtocol::QueryKind kind,
+        const Model &model,
+        QueryProtocol::Reader &reader,
+        QueryProtocol::Writer &writer);
+
+private:
+    QueryServerOptions m_options;
+    std::vector<ModelSlot> m_models;
+
+    std::atomic<bool> m_stop;
+    std::mutex m_reloadMutex;
+    std::condition_variable m_reloadCondition;
+
+    // Responses of the pool, picked up by Run. A byte on the wake pipe interrupts its poll.
+    std::mutex m_completionMutex;
+    std::vector<Completion> m_completions;
+    int m_wakePipe[2] = {-1, -1};
+};
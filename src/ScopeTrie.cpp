@@ -0,0 +1,172 @@
+#include "ScopeTrie.h"
+
+#include <cassert>
+
+ScopeTrie::ScopeTrie()
+{
+    m_nodes.emplace_back();
+}
+
+void ScopeTrie::FindOrCreatePath(std::string_view name, Path &path)
+{
+    path.clear();
+
+    index_t nodeIndex = RootNodeIndex;
+    size_t begin = 0;
+    while (begin < name.size())
+    {
+        const size_t end = FindScopeSeparator(name, begin);
+        const index_t componentId = FindOrCreateComponentId(name.substr(begin, end - begin));
+        const uint64_t key = MakeChildKey(nodeIndex, componentId);
+
+        HashToIndexMap::iterator it = m_childKeyToNodeIndex.find(key);
+        if (it != m_childKeyToNodeIndex.end())
+        {
+            nodeIndex = it->second;
+        }
+        else
+        {
+            const index_t childNodeIndex = m_nodes.size();
+            Node node;
+            node.m_parentNodeIndex = nodeIndex;
+            node.m_componentId = componentId;
+            node.m_depth = m_nodes[nodeIndex].m_depth + 1;
+            m_nodes.push_back(std::move(node));
+            m_nodes[nodeIndex].m_childNodeIndices.push_back(childNodeIndex);
+            m_childKeyToNodeIndex.emplace(key, childNodeIndex);
+            nodeIndex = childNodeIndex;
+        }
+
+        Step step;
+        step.m_nodeIndex = nodeIndex;
+        step.m_nameEnd = static_cast<uint32_t>(end);
+        path.push_back(step);
+
+        begin = end + 2;
+    }
+}
+
+index_t ScopeTrie::FindNode(std::string_view name) const
+{
+    index_t nodeIndex = RootNodeIndex;
+    size_t begin = 0;
+    while (begin < name.size())
+    {
+        const size_t end = FindScopeSeparator(name, begin);
+        const index_t componentId = FindComponentId(name.substr(begin, end - begin));
+        if (componentId == InvalidIndex)
+            return InvalidIndex;
+
+        HashToIndexMap::const_iterator it = m_childKeyToNodeIndex.find(MakeChildKey(nodeIndex, componentId));
+        if (it == m_childKeyToNodeIndex.end())
+            return InvalidIndex;
+
+        nodeIndex = it->second;
+        begin = end + 2;
+    }
+    return nodeIndex;
+}
+
+void ScopeTrie::SetNamespaceIndex(index_t nodeIndex, index_t namespaceIndex)
+{
+    assert(nodeIndex != RootNodeIndex);
+    assert(m_nodes[nodeIndex].m_namespaceIndex == InvalidIndex);
+    m_nodes[nodeIndex].m_namespaceIndex = namespaceIndex;
+}
+
+void ScopeTrie::SetClassIndex(index_t nodeIndex, index_t classIndex)
+{
+    assert(nodeIndex != RootNodeIndex);
+    assert(m_nodes[nodeIndex].m_classIndex == InvalidIndex);
+    m_nodes[nodeIndex].m_classIndex = classIndex;
+}
+
+tcb::span<const index_t> ScopeTrie::GetChildNodeIndices(index_t nodeIndex) const
+{
+    const std::vector<index_t> &childNodeIndices = m_nodes[nodeIndex].m_childNodeIndices;
+    return tcb::span<const index_t>(childNodeIndices.data(), childNodeIndices.size());
+}
+
+std::string_view ScopeTrie::GetComponent(index_t nodeIndex) const
+{
+    const index_t componentId = m_nodes[nodeIndex].m_componentId;
+    if (componentId == InvalidIndex)
+        return std::string_view();
+
+    return m_components[componentId];
+}
+
+std::string ScopeTrie::GetQualifiedName(index_t nodeIndex) const
+{
+    size_t size = 0;
+    for (index_t index = nodeIndex; index != RootNodeIndex; index = m_nodes[index].m_parentNodeIndex)
+    {
+        size += GetComponent(index).size() + 2;
+    }
+
+    std::string name(size > 2 ? size - 2 : 0, '\0');
+    size_t end = name.size();
+    for (index_t index = nodeIndex; index != RootNodeIndex; index = m_nodes[index].m_parentNodeIndex)
+    {
+        const std::string_view component = GetComponent(index);
+        end -= component.size();
+        name.replace(end, component.size(), component.data(), component.size());
+        if (end != 0)
+        {
+            end -= 2;
+            name.replace(end, 2, "::");
+        }
+    }
+    return name;
+}
+
+size_t ScopeTrie::FindScopeSeparator(std::string_view name, size_t pos)
+{
+    int groupCount = 0;
+    for (size_t i = pos; i < name.size(); ++i)
+    {
+        const char c = name[i];
+        if (c == '<' || c == '(' || c == '{')
+        {
+            ++groupCount;
+            continue;
+        }
+        if (c == '>' || c == ')' || c == '}')
+        {
+            --groupCount;
+            continue;
+        }
+        if (groupCount > 0)
+            continue;
+        if (c == ':' && i + 1 < name.size() && name[i + 1] == ':')
+            return i;
+    }
+    return name.size();
+}
+
+index_t ScopeTrie::FindOrCreateComponentId(std::string_view component)
+{
+    StringViewToIndexMap::iterator it = m_componentToId.find(component);
+    if (it != m_componentToId.end())
+        return it->second;
+
+    const index_t componentId = m_components.size();
+    m_componentStrings.emplace_back(component);
+    m_components.push_back(m_componentStrings.back());
+    m_componentToId.emplace(m_components.back(), componentId);
+    return componentId;
+}
+
+index_t ScopeTrie::FindComponentId(std::string_view component) const
+{
+    StringViewToIndexMap::const_iterator it = m_componentToId.find(component);
+    if (it != m_componentToId.end())
+        return it->second;
+
+    return InvalidIndex;
+}
+
+uint64_t ScopeTrie::MakeChildKey(index_t parentNodeIndex, index_t componentId)
+{
+    return (uint64_t(parentNodeIndex) << 32) | componentId;
+}
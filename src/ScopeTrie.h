@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tcb/span.hpp>
+#include <vector>
+
+// Trie of qualified scope names, such as "a::b<c::d>::e", keyed by interned path components. Every node is one scope
+// and can be a namespace, a class or both. Names are split at "::" outside of template argument lists, parentheses
+// and braces, so "b<c::d>" is a single component.
+class ScopeTrie
+{
+public:
+    struct Node
+    {
+        index_t m_parentNodeIndex = InvalidIndex;
+        index_t m_componentId = InvalidIndex;
+        uint32_t m_depth = 0; // Number of components. The root has depth 0.
+        index_t m_namespaceIndex = InvalidIndex;
+        index_t m_classIndex = InvalidIndex;
+        std::vector<index_t> m_childNodeIndices;
+    };
+
+    // One node of a walked name. The qualified name of the node is the name prefix up to m_nameEnd.
+    struct Step
+    {
+        index_t m_nodeIndex = InvalidIndex;
+        uint32_t m_nameEnd = 0;
+    };
+    using Path = std::vector<Step>;
+
+    static constexpr index_t RootNodeIndex = 0;
+
+public:
+    ScopeTrie();
+
+    // Walks all components of the name in one pass and creates missing nodes. Writes one step per component.
+    void FindOrCreatePath(std::string_view name, Path &path);
+    // Returns InvalidIndex if the name is not in the trie.
+    index_t FindNode(std::string_view name) const;
+
+    const Node &GetNode(index_t nodeIndex) const { return m_nodes[nodeIndex]; }
+    void SetNamespaceIndex(index_t nodeIndex, index_t namespaceIndex);
+    void SetClassIndex(index_t nodeIndex, index_t classIndex);
+
+    index_t GetNodeCount() const { return static_cast<index_t>(m_nodes.size()); }
+    index_t GetParentNodeIndex(index_t nodeIndex) const { return m_nodes[nodeIndex].m_parentNodeIndex; }
+    tcb::span<const index_t> GetChildNodeIndices(index_t nodeIndex) const;
+    std::string_view GetComponent(index_t nodeIndex) const;
+    // Joins the components of the node and its parents.
+    std::string GetQualifiedName(index_t nodeIndex) const;
+
+    // Returns the position of the next "::" at nesting level 0, or the name size.
+    static size_t FindScopeSeparator(std::string_view name, size_t pos);
+
+private:
+    index_t FindOrCreateComponentId(std::string_view component);
+    index_t FindComponentId(std::string_view component) const;
+    static uint64_t MakeChildKey(index_t parentNodeIndex, index_t componentId);
+
+private:
+    std::vector<Node> m_nodes;
+    HashToIndexMap m_childKeyToNodeIndex;
+
+    std::deque<std::string> m_componentStrings; // Stable storage for component names.
+    std::vector<std::string_view> m_components; // Component names by id.
+    StringViewToIndexMap m_componentToId;
+};
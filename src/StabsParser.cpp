@@ -0,0 +1,707 @@
+#include "StabsParser.h"
+
+#include <cctype>
+#include <limits>
+
+namespace
+{
+StabsVisibility ToVisibility(char c)
+{
+    switch (c)
+    {
+        case '0':
+            return StabsVisibility::Private;
+        case '1':
+            return StabsVisibility::Protected;
+        default:
+            return StabsVisibility::Public;
+    }
+}
+
+bool IsTypeNumberBegin(char c)
+{
+    return c == '(' || c == '-' || std::isdigit(static_cast<unsigned char>(c));
+}
+
+template<typename T>
+void MoveStackToList(
+    std::vector<T> &stack,
+    size_t stackBegin,
+    std::vector<T> &list,
+    uint32_t &listBegin,
+    uint32_t &listCount)
+{
+    listBegin = static_cast<uint32_t>(list.size());
+    listCount = static_cast<uint32_t>(stack.size() - stackBegin);
+    list.insert(list.end(), stack.begin() + stackBegin, stack.end());
+    stack.resize(stackBegin);
+}
+} // namespace
+
+bool StabsParser::Parse(std::string_view string)
+{
+    m_string = string;
+    m_pos = 0;
+    m_symbol = StabsSymbol();
+    m_types.clear();
+    m_fieldStack.clear();
+    m_fields.clear();
+    m_baseStack.clear();
+    m_baseClasses.clear();
+    m_enumerators.clear();
+    m_argumentStack.clear();
+    m_arguments.clear();
+
+    if (!ParseQualifiedName(m_symbol.m_name, true))
+        return false;
+    if (!Expect(':'))
+        return false;
+
+    const char c = Peek();
+    if (!IsTypeNumberBegin(c))
+    {
+        ++m_pos;
+        m_symbol.m_descriptor = c;
+        if (c == 'c')
+            return true; // Constant, such as "c=i5". Has no type.
+        if (c == 'T')
+        {
+            m_symbol.m_isTag = true;
+            if (Peek() == 't')
+            {
+                ++m_pos;
+                m_symbol.m_isTypedef = true;
+            }
+        }
+        else if (c == 't')
+        {
+            m_symbol.m_isTypedef = true;
+        }
+    }
+
+    m_symbol.m_type = ParseType();
+    return m_symbol.m_type != InvalidStabsNode;
+}
+
+tcb::span<const StabsField> StabsParser::GetFields(const StabsType &type) const
+{
+    if (type.m_listCount == 0 || !(type.m_kind == StabsTypeKind::Struct || type.m_kind == StabsTypeKind::Union))
+        return {};
+    return tcb::span<const StabsField>(m_fields.data() + type.m_listBegin, type.m_listCount);
+}
+
+tcb::span<const StabsBaseClass> StabsParser::GetBaseClasses(const StabsType &type) const
+{
+    if (type.m_baseCount == 0)
+        return {};
+    return tcb::span<const StabsBaseClass>(m_baseClasses.data() + type.m_baseBegin, type.m_baseCount);
+}
+
+tcb::span<const StabsEnumerator> StabsParser::GetEnumerators(const StabsType &type) const
+{
+    if (type.m_listCount == 0 || type.m_kind != StabsTypeKind::Enum)
+        return {};
+    return tcb::span<const StabsEnumerator>(m_enumerators.data() + type.m_listBegin, type.m_listCount);
+}
+
+tcb::span<const uint32_t> StabsParser::GetArguments(const StabsType &type) const
+{
+    if (type.m_listCount == 0 || type.m_kind != StabsTypeKind::Method)
+        return {};
+    return tcb::span<const uint32_t>(m_arguments.data() + type.m_listBegin, type.m_listCount);
+}
+
+bool StabsParser::GetBuiltinType(int32_t number, std::string_view &name, uint32_t &size)
+{
+    struct BuiltinType
+    {
+        const char *name;
+        uint32_t size;
+    };
+
+    // Predefined types of the GNU stabs format.
+    static const BuiltinType s_builtinTypes[] = {
+        {"int", 4},
+        {"char", 1},
+        {"short", 2},
+        {"long", 4},
+        {"unsigned char", 1},
+        {"signed char", 1},
+        {"unsigned short", 2},
+        {"unsigned int", 4},
+        {"unsigned", 4},
+        {"unsigned long", 4},
+        {"void", 0},
+        {"float", 4},
+        {"double", 8},
+        {"long double", 16},
+        {"integer", 4},
+        {"bool", 4},
+        {"short real", 4},
+        {"real", 8},
+        {"stringptr", 4},
+        {"character", 1},
+        {"logical*1", 1},
+        {"logical*2", 2},
+        {"logical*4", 4},
+        {"logical", 4},
+        {"complex", 8},
+        {"double complex", 16},
+        {"integer*1", 1},
+        {"integer*2", 2},
+        {"integer*4", 4},
+        {"wchar", 2},
+        {"long long", 8},
+        {"unsigned long long", 8},
+        {"logical*8", 8},
+        {"integer*8", 8},
+    };
+
+    const int32_t index = -number - 1;
+    if (index < 0 || index >= int32_t(sizeof(s_builtinTypes) / sizeof(s_builtinTypes[0])))
+        return false;
+
+    name = s_builtinTypes[index].name;
+    size = s_builtinTypes[index].size;
+    return true;
+}
+
+uint32_t StabsParser::ParseType()
+{
+    const uint32_t node = static_cast<uint32_t>(m_types.size());
+    m_types.emplace_back();
+
+    if (IsTypeNumberBegin(Peek()))
+    {
+        StabsTypeNumber number;
+        if (!ParseTypeNumber(number))
+            return InvalidStabsNode;
+
+        m_types[node].m_number = number;
+        if (Peek() != '=')
+        {
+            m_types[node].m_kind = StabsTypeKind::Number;
+            return node;
+        }
+        ++m_pos;
+        m_types[node].m_isDefinition = true;
+    }
+
+    if (!ParseTypeDefinition(node))
+        return InvalidStabsNode;
+
+    return node;
+}
+
+bool StabsParser::ParseTypeDefinition(uint32_t node)
+{
+    // Type attributes, such as the size in bits "@s32;".
+    while (Peek() == '@' && std::isalpha(static_cast<unsigned char>(Peek(1))))
+    {
+        m_pos += 2;
+        if (m_string[m_pos - 1] == 's')
+        {
+            int64_t bits;
+            if (!ParseInteger(bits))
+                return false;
+            m_types[node].m_size = static_cast<uint32_t>(bits / 8);
+        }
+        if (!SkipPast(';'))
+            return false;
+    }
+
+    const char c = Peek();
+    if (IsTypeNumberBegin(c))
+    {
+        const uint32_t target = ParseType();
+        if (target == InvalidStabsNode)
+            return false;
+
+        StabsType &type = m_types[node];
+        const StabsType &targetType = m_types[target];
+        if (type.m_isDefinition && targetType.m_kind == StabsTypeKind::Number && targetType.m_number == type.m_number)
+        {
+            type.m_kind = StabsTypeKind::Void;
+        }
+        else
+        {
+            type.m_kind = StabsTypeKind::Alias;
+            type.m_target = target;
+        }
+        return true;
+    }
+
+    ++m_pos;
+    switch (c)
+    {
+        case 'r': {
+            const uint32_t target = ParseType();
+            if (target == InvalidStabsNode)
+                return false;
+            int64_t low;
+            int64_t high;
+            bool lowOverflow;
+            bool highOverflow;
+            if (!Expect(';') || !ParseInteger(low, lowOverflow) || !Expect(';') || !ParseInteger(high, highOverflow)
+                || !Expect(';'))
+                return false;
+
+            StabsType &type = m_types[node];
+            type.m_kind = StabsTypeKind::Range;
+            type.m_target = target;
+            type.m_low = low;
+            type.m_high = high;
+            if (type.m_size == 0)
+            {
+                type.m_size = GetRangeSize(low, high, lowOverflow || highOverflow);
+            }
+            return true;
+        }
+        case '*':
+        case '&':
+        case 'k':
+        case 'B':
+        case 'f': {
+            const uint32_t target = ParseType();
+            if (target == InvalidStabsNode)
+                return false;
+
+            StabsType &type = m_types[node];
+            type.m_target = target;
+            switch (c)
+            {
+                case '*':
+                    type.m_kind = StabsTypeKind::Pointer;
+                    break;
+                case '&':
+                    type.m_kind = StabsTypeKind::LValueReference;
+                    break;
+                case 'k':
+                    type.m_kind = StabsTypeKind::Const;
+                    break;
+                case 'B':
+                    type.m_kind = StabsTypeKind::Volatile;
+                    break;
+                default:
+                    type.m_kind = StabsTypeKind::Function;
+                    break;
+            }
+            return true;
+        }
+        case 'a': {
+            // Index type is a range, followed by the element type: "ar(0,1);0;9;(0,2)".
+            const uint32_t index = ParseType();
+            if (index == InvalidStabsNode)
+                return false;
+            const uint32_t element = ParseType();
+            if (element == InvalidStabsNode)
+                return false;
+
+            StabsType &type = m_types[node];
+            const StabsType &indexType = m_types[index];
+            type.m_kind = StabsTypeKind::Array;
+            type.m_target = element;
+            if (indexType.m_kind == StabsTypeKind::Range)
+            {
+                type.m_low = indexType.m_low;
+                type.m_high = indexType.m_high;
+            }
+            return true;
+        }
+        case '#': {
+            // Method: "#CLASS,RETURN,ARG,...;" or "##RETURN;".
+            const size_t argumentStackBegin = m_argumentStack.size();
+            uint32_t target;
+            if (Peek() == '#')
+            {
+                ++m_pos;
+                target = ParseType();
+                if (target == InvalidStabsNode)
+                    return false;
+            }
+            else
+            {
+                if (ParseType() == InvalidStabsNode || !Expect(','))
+                    return false;
+                target = ParseType();
+                if (target == InvalidStabsNode)
+                    return false;
+                while (Peek() == ',')
+                {
+                    ++m_pos;
+                    const uint32_t argument = ParseType();
+                    if (argument == InvalidStabsNode)
+                        return false;
+                    m_argumentStack.push_back(argument);
+                }
+            }
+            if (!Expect(';'))
+                return false;
+
+            StabsType &type = m_types[node];
+            type.m_kind = StabsTypeKind::Method;
+            type.m_target = target;
+            MoveStackToList(m_argumentStack, argumentStackBegin, m_arguments, type.m_listBegin, type.m_listCount);
+            return true;
+        }
+        case '@': {
+            // Pointer to member: "@CLASS,MEMBER".
+            if (ParseType() == InvalidStabsNode || !Expect(','))
+                return false;
+            const uint32_t target = ParseType();
+            if (target == InvalidStabsNode)
+                return false;
+
+            StabsType &type = m_types[node];
+            type.m_kind = StabsTypeKind::MemberPointer;
+            type.m_target = target;
+            return true;
+        }
+        case 's':
+        case 'u': {
+            m_types[node].m_kind = c == 's' ? StabsTypeKind::Struct : StabsTypeKind::Union;
+            return ParseStruct(node);
+        }
+        case 'e': {
+            m_types[node].m_kind = StabsTypeKind::Enum;
+            return ParseEnum(node);
+        }
+        case 'x': {
+            const char kind = Peek();
+            if (!(kind == 's' || kind == 'u' || kind == 'e'))
+                return false;
+            ++m_pos;
+            std::string_view name;
+            if (!ParseQualifiedName(name, false) || !Expect(':'))
+                return false;
+
+            StabsType &type = m_types[node];
+            type.m_kind = StabsTypeKind::CrossReference;
+            type.m_crossReferenceKind = kind;
+            type.m_name = name;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool StabsParser::ParseStruct(uint32_t node)
+{
+    int64_t size;
+    if (!ParseInteger(size))
+        return false;
+    m_types[node].m_size = static_cast<uint32_t>(size);
+
+    // C++ base classes: "!COUNT,VIRTUAL VISIBILITY OFFSET,TYPE;...".
+    const size_t baseStackBegin = m_baseStack.size();
+    if (Peek() == '!')
+    {
+        ++m_pos;
+        int64_t count;
+        if (!ParseInteger(count) || !Expect(','))
+            return false;
+
+        for (int64_t i = 0; i < count; ++i)
+        {
+            if (m_pos + 2 > m_string.size())
+                return false;
+
+            StabsBaseClass baseClass;
+            baseClass.m_isVirtual = m_string[m_pos] == '1';
+            baseClass.m_visibility = ToVisibility(m_string[m_pos + 1]);
+            m_pos += 2;
+
+            int64_t bitOffset;
+            if (!ParseInteger(bitOffset) || !Expect(','))
+                return false;
+            baseClass.m_bitOffset = static_cast<uint32_t>(bitOffset);
+            baseClass.m_type = ParseType();
+            if (baseClass.m_type == InvalidStabsNode || !Expect(';'))
+                return false;
+
+            m_baseStack.push_back(baseClass);
+        }
+    }
+
+    // Fields "NAME:TYPE,BITOFFSET,BITSIZE;", static fields "NAME:TYPE:PHYSNAME;" and methods "NAME::...".
+    const size_t fieldStackBegin = m_fieldStack.size();
+    while (!AtEnd() && Peek() != ';')
+    {
+        std::string_view name;
+        if (!ParseNameUntil(name, ':'))
+            return false;
+
+        if (Peek() == ':')
+        {
+            ++m_pos;
+            if (!ParseMethods())
+                return false;
+            continue;
+        }
+
+        StabsField field;
+        field.m_name = name;
+        if (Peek() == '/')
+        {
+            field.m_visibility = ToVisibility(Peek(1));
+            m_pos += 2;
+        }
+        field.m_type = ParseType();
+        if (field.m_type == InvalidStabsNode)
+            return false;
+
+        if (Peek() == ':')
+        {
+            ++m_pos;
+            if (!SkipPast(';'))
+                return false;
+            field.m_isStatic = true;
+        }
+        else
+        {
+            int64_t bitOffset;
+            int64_t bitSize;
+            if (!Expect(',') || !ParseInteger(bitOffset) || !Expect(',') || !ParseInteger(bitSize) || !Expect(';'))
+                return false;
+            field.m_bitOffset = static_cast<uint32_t>(bitOffset);
+            field.m_bitSize = static_cast<uint32_t>(bitSize);
+        }
+        m_fieldStack.push_back(field);
+    }
+    if (!Expect(';'))
+        return false;
+
+    // Virtual function table owner: "~%TYPE;".
+    if (Peek() == '~')
+    {
+        ++m_pos;
+        if (Peek() == '%')
+        {
+            ++m_pos;
+            if (ParseType() == InvalidStabsNode)
+                return false;
+        }
+        if (!SkipPast(';'))
+            return false;
+    }
+
+    StabsType &type = m_types[node];
+    MoveStackToList(m_baseStack, baseStackBegin, m_baseClasses, type.m_baseBegin, type.m_baseCount);
+    MoveStackToList(m_fieldStack, fieldStackBegin, m_fields, type.m_listBegin, type.m_listCount);
+    return true;
+}
+
+bool StabsParser::ParseMethods()
+{
+    // Overloads of one method name: "TYPE:PHYSNAME;VISIBILITY MODIFIER KIND[...];" terminated by ";".
+    for (;;)
+    {
+        if (ParseType() == InvalidStabsNode || !Expect(':') || !SkipPast(';'))
+            return false;
+        if (m_pos + 3 > m_string.size())
+            return false;
+
+        const char kind = m_string[m_pos + 2];
+        m_pos += 3;
+        if (kind == '*')
+        {
+            // Virtual: "VTABLEINDEX;CLASS;".
+            int64_t vtableIndex;
+            if (!ParseInteger(vtableIndex) || !Expect(';'))
+                return false;
+            if (IsTypeNumberBegin(Peek()))
+            {
+                if (ParseType() == InvalidStabsNode || !Expect(';'))
+                    return false;
+            }
+        }
+
+        if (Peek() == ';')
+        {
+            ++m_pos;
+            return true;
+        }
+        if (AtEnd())
+            return false;
+    }
+}
+
+bool StabsParser::ParseEnum(uint32_t node)
+{
+    // Enumerators: "NAME:VALUE,...;".
+    StabsType &type = m_types[node];
+    type.m_listBegin = static_cast<uint32_t>(m_enumerators.size());
+    while (!AtEnd() && Peek() != ';')
+    {
+        StabsEnumerator enumerator;
+        if (!ParseNameUntil(enumerator.m_name, ':') || !ParseInteger(enumerator.m_value) || !Expect(','))
+            return false;
+        m_enumerators.push_back(enumerator);
+    }
+    type.m_listCount = static_cast<uint32_t>(m_enumerators.size()) - type.m_listBegin;
+    return Expect(';');
+}
+
+bool StabsParser::ParseTypeNumber(StabsTypeNumber &number)
+{
+    int64_t value;
+    if (Peek() == '(')
+    {
+        ++m_pos;
+        if (!ParseInteger(value) || !Expect(','))
+            return false;
+        number.m_file = static_cast<int32_t>(value);
+        if (!ParseInteger(value) || !Expect(')'))
+            return false;
+        number.m_number = static_cast<int32_t>(value);
+        return true;
+    }
+
+    if (!ParseInteger(value))
+        return false;
+    number.m_file = 0;
+    number.m_number = static_cast<int32_t>(value);
+    return true;
+}
+
+bool StabsParser::ParseInteger(int64_t &value, bool &overflow)
+{
+    // Decimal or octal with leading 0. Bounds of 64 bit ranges do not fit and are flagged as overflow.
+    // An empty number is accepted before ';', for example for unbounded arrays.
+    bool negative = false;
+    if (Peek() == '-')
+    {
+        negative = true;
+        ++m_pos;
+    }
+
+    const uint64_t base = (Peek() == '0' && std::isdigit(static_cast<unsigned char>(Peek(1)))) ? 8 : 10;
+    uint64_t result = 0;
+    size_t digitCount = 0;
+    overflow = false;
+    while (!AtEnd() && std::isdigit(static_cast<unsigned char>(Peek())))
+    {
+        const uint64_t digit = static_cast<uint64_t>(Peek() - '0');
+        if (result > (std::numeric_limits<uint64_t>::max() - digit) / base)
+            overflow = true;
+        result = result * base + digit;
+        ++digitCount;
+        ++m_pos;
+    }
+
+    if (digitCount == 0 && (negative || Peek() != ';'))
+        return false;
+
+    value = static_cast<int64_t>(negative ? 0 - result : result);
+    return true;
+}
+
+bool StabsParser::ParseInteger(int64_t &value)
+{
+    bool overflow;
+    return ParseInteger(value, overflow);
+}
+
+bool StabsParser::ParseQualifiedName(std::string_view &name, bool allowScope)
+{
+    // Colons inside template argument lists belong to the name.
+    // With allowScope, "::" outside of template argument lists belongs to the name as well.
+    int depth = 0;
+    size_t i = m_pos;
+    for (; i < m_string.size(); ++i)
+    {
+        const char c = m_string[i];
+        if (c == '<')
+        {
+            ++depth;
+        }
+        else if (c == '>')
+        {
+            if (depth > 0)
+                --depth;
+        }
+        else if (c == ':' && depth == 0)
+        {
+            if (allowScope && i + 1 < m_string.size() && m_string[i + 1] == ':')
+            {
+                ++i;
+                continue;
+            }
+            break;
+        }
+    }
+    if (i >= m_string.size())
+        return false;
+
+    name = m_string.substr(m_pos, i - m_pos);
+    m_pos = i;
+    return true;
+}
+
+bool StabsParser::ParseNameUntil(std::string_view &name, char terminator)
+{
+    const size_t end = m_string.find(terminator, m_pos);
+    if (end == std::string_view::npos)
+        return false;
+
+    name = m_string.substr(m_pos, end - m_pos);
+    m_pos = end + 1;
+    return true;
+}
+
+bool StabsParser::SkipPast(char c)
+{
+    const size_t end = m_string.find(c, m_pos);
+    if (end == std::string_view::npos)
+        return false;
+
+    m_pos = end + 1;
+    return true;
+}
+
+bool StabsParser::Expect(char c)
+{
+    if (Peek() != c)
+        return false;
+
+    ++m_pos;
+    return true;
+}
+
+char StabsParser::Peek(size_t offset) const
+{
+    const size_t pos = m_pos + offset;
+    return pos < m_string.size() ? m_string[pos] : '\0';
+}
+
+uint32_t StabsParser::GetRangeSize(int64_t low, int64_t high, bool overflow)
+{
+    if (overflow)
+        return 8;
+    if (low > 0 && high == 0)
+        return static_cast<uint32_t>(low); // Floating point type. Low bound is the size in bytes.
+    if (low == 0 && high == -1)
+        return 8; // Unsigned 64 bit.
+    if (low == high)
+        return 0;
+
+    if (low < 0)
+    {
+        if (low >= INT8_MIN && high <= INT8_MAX)
+            return 1;
+        if (low >= INT16_MIN && high <= INT16_MAX)
+            return 2;
+        if (low >= INT32_MIN && high <= INT32_MAX)
+            return 4;
+        return 8;
+    }
+
+    if (high <= UINT8_MAX)
+        return 1;
+    if (high <= UINT16_MAX)
+        return 2;
+    if (high <= int64_t(UINT32_MAX))
+        return 4;
+    return 8;
+}
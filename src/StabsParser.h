@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <tcb/span.hpp>
+#include <vector>
+
+constexpr uint32_t InvalidStabsNode = ~uint32_t(0);
+
+struct StabsTypeNumber
+{
+    bool operator==(const StabsTypeNumber &other) const
+    {
+        return m_file == other.m_file && m_number == other.m_number;
+    }
+
+    int32_t m_file = 0; // File number. 0 is the source file, >=1 are N_BINCL/N_EXCL header files.
+    int32_t m_number = 0; // Negative numbers are predefined builtin types.
+};
+
+enum class StabsTypeKind : uint8_t
+{
+    Unknown, // Type descriptor is not supported.
+    Number, // Reference to a type number.
+    Alias, // Type number defined as another type.
+    Void, // Type number defined as itself.
+    Range, // Integral or floating point builtin type.
+    Pointer,
+    LValueReference,
+    Const,
+    Volatile,
+    Array,
+    Function,
+    Method,
+    MemberPointer,
+    Struct,
+    Union,
+    Enum,
+    CrossReference, // Reference to a struct, union or enum by name.
+};
+
+enum class StabsVisibility : uint8_t
+{
+    Private,
+    Protected,
+    Public,
+};
+
+struct StabsType
+{
+    StabsTypeKind m_kind = StabsTypeKind::Unknown;
+    bool m_isDefinition = false; // m_number is defined by this type.
+    char m_crossReferenceKind = 0; // 's', 'u' or 'e'.
+    StabsTypeNumber m_number; // Defined or referenced type number.
+    std::string_view m_name; // Cross reference name.
+    uint32_t m_size = 0; // Size in bytes for struct, union, range and types with size attribute.
+    int64_t m_low = 0; // Range or array lower bound.
+    int64_t m_high = 0; // Range or array upper bound.
+    uint32_t m_target = InvalidStabsNode; // Aliased, pointee, element, return or member type.
+    uint32_t m_listBegin = 0; // First field (struct, union), enumerator (enum) or argument (method).
+    uint32_t m_listCount = 0;
+    uint32_t m_baseBegin = 0; // First base class (struct).
+    uint32_t m_baseCount = 0;
+};
+
+struct StabsField
+{
+    std::string_view m_name;
+    uint32_t m_type = InvalidStabsNode;
+    uint32_t m_bitOffset = 0;
+    uint32_t m_bitSize = 0;
+    StabsVisibility m_visibility = StabsVisibility::Public;
+    bool m_isStatic = false; // Static member. Has no offset and size.
+};
+
+struct StabsBaseClass
+{
+    uint32_t m_type = InvalidStabsNode;
+    uint32_t m_bitOffset = 0;
+    StabsVisibility m_visibility = StabsVisibility::Public;
+    bool m_isVirtual = false;
+};
+
+struct StabsEnumerator
+{
+    std::string_view m_name;
+    int64_t m_value = 0;
+};
+
+struct StabsSymbol
+{
+    std::string_view m_name;
+    char m_descriptor = 0; // 0 for local variables, otherwise 't', 'T', 'p', 'F', 'G', 'S' ...
+    bool m_isTypedef = false; // 't' or 'Tt'.
+    bool m_isTag = false; // 'T' or 'Tt'.
+    uint32_t m_type = InvalidStabsNode;
+};
+
+// Zero-copy recursive descent parser for stab strings, such as "name:Tt(1,2)=s12field:(0,1),0,32;;".
+// All names are views into the parsed string. Results are valid until the next call to Parse.
+// Internal buffers are reused, so parsing does not allocate once they have grown to the largest string.
+class StabsParser
+{
+public:
+    // Returns false if the string is not understood.
+    bool Parse(std::string_view string);
+
+    const StabsSymbol &GetSymbol() const { return m_symbol; }
+    const StabsType &GetType(uint32_t node) const { return m_types[node]; }
+    tcb::span<const StabsField> GetFields(const StabsType &type) const;
+    tcb::span<const StabsBaseClass> GetBaseClasses(const StabsType &type) const;
+    tcb::span<const StabsEnumerator> GetEnumerators(const StabsType &type) const;
+    tcb::span<const uint32_t> GetArguments(const StabsType &type) const;
+
+    // Gets name and size of a predefined type with a negative type number.
+    static bool GetBuiltinType(int32_t number, std::string_view &name, uint32_t &size);
+
+private:
+    uint32_t ParseType();
+    bool ParseTypeDefinition(uint32_t node);
+    bool ParseStruct(uint32_t node);
+    bool ParseMethods();
+    bool ParseEnum(uint32_t node);
+    bool ParseTypeNumber(StabsTypeNumber &number);
+    bool ParseInteger(int64_t &value, bool &overflow);
+    bool ParseInteger(int64_t &value);
+    bool ParseQualifiedName(std::string_view &name, bool allowScope);
+    bool ParseNameUntil(std::string_view &name, char terminator);
+    bool SkipPast(char c);
+    bool Expect(char c);
+    char Peek(size_t offset = 0) const;
+    bool AtEnd() const { return m_pos >= m_string.size(); }
+
+    static uint32_t GetRangeSize(int64_t low, int64_t high, bool overflow);
+
+private:
+    std::string_view m_string;
+    size_t m_pos = 0;
+    StabsSymbol m_symbol;
+    std::vector<StabsType> m_types;
+
+    // Lists of nested types are collected on stacks and moved to the final lists when their type is complete,
+    // so that the entries of every list are contiguous.
+    std::vector<StabsField> m_fieldStack;
+    std::vector<StabsField> m_fields;
+    std::vector<StabsBaseClass> m_baseStack;
+    std::vector<StabsBaseClass> m_baseClasses;
+    std::vector<StabsEnumerator> m_enumerators;
+    std::vector<uint32_t> m_argumentStack;
+    std::vector<uint32_t> m_arguments;
+};
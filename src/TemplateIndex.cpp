@@ -0,0 +1,225 @@
+#include "TemplateIndex.h"
+
+#include "utility.h"
+
+#include <cassert>
+
+namespace
+{
+std::string_view Trim(std::string_view str)
+{
+    while (!str.empty() && str.front() == ' ')
+        str.remove_prefix(1);
+    while (!str.empty() && str.back() == ' ')
+        str.remove_suffix(1);
+    return str;
+}
+} // namespace
+
+void TemplateIndex::Build(const Classes &classes, const Functions &functions)
+{
+    m_classInstantiations.assign(classes.size(), Instantiation());
+    m_functionInstantiations.assign(functions.size(), Instantiation());
+
+    const index_t classCount = classes.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        Instantiation &instantiation = m_classInstantiations[classIndex];
+        const index_t templateIndex = AddInstantiation(classes[classIndex].m_name, instantiation);
+        if (templateIndex != InvalidIndex)
+        {
+            m_templates[templateIndex].m_classIndices.push_back(classIndex);
+        }
+    }
+
+    const index_t functionCount = functions.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        Instantiation &instantiation = m_functionInstantiations[functionIndex];
+        const index_t templateIndex = AddInstantiation(functions[functionIndex].m_functionName, instantiation);
+        if (templateIndex != InvalidIndex)
+        {
+            m_templates[templateIndex].m_functionIndices.push_back(functionIndex);
+        }
+    }
+}
+
+bool TemplateIndex::SplitTemplateName(
+    std::string_view name,
+    std::string_view &templateName,
+    std::vector<std::string_view> &arguments)
+{
+    arguments.clear();
+
+    if (name.empty() || name.back() != '>')
+        return false;
+    if (ends_with(name, "operator>") || ends_with(name, "operator>>") || ends_with(name, "operator->"))
+        return false;
+
+    // Find the opening bracket of the trailing argument list.
+    int groupCount = 0;
+    size_t open = std::string_view::npos;
+    for (size_t i = name.size() - 1; i != std::string_view::npos; --i)
+    {
+        const char c = name[i];
+        if (c == '>')
+        {
+            ++groupCount;
+        }
+        else if (c == '<')
+        {
+            if (--groupCount == 0)
+            {
+                open = i;
+                break;
+            }
+        }
+    }
+    if (open == std::string_view::npos || open == 0)
+        return false;
+
+    // "operator< <int>" has a space between the name and the arguments.
+    templateName = Trim(name.substr(0, open));
+
+    // Split the arguments at commas outside of nested brackets.
+    const size_t close = name.size() - 1;
+    size_t begin = open + 1;
+    groupCount = 0;
+    for (size_t i = begin; i < close; ++i)
+    {
+        const char c = name[i];
+        if (c == '<' || c == '(')
+        {
+            ++groupCount;
+        }
+        else if (c == '>' || c == ')')
+        {
+            --groupCount;
+        }
+        else if (c == ',' && groupCount == 0)
+        {
+            arguments.push_back(Trim(name.substr(begin, i - begin)));
+            begin = i + 1;
+        }
+    }
+    const std::string_view lastArgument = Trim(name.substr(begin, close - begin));
+    if (!lastArgument.empty() || !arguments.empty())
+    {
+        arguments.push_back(lastArgument);
+    }
+    return true;
+}
+
+index_t TemplateIndex::FindTemplate(std::string_view name) const
+{
+    StringToIndexMap::const_iterator it = m_nameToTemplateIndex.find(std::string(name));
+    if (it != m_nameToTemplateIndex.end())
+        return it->second;
+
+    return InvalidIndex;
+}
+
+index_t TemplateIndex::GetFunctionTemplateIndex(index_t functionIndex) const
+{
+    return m_functionInstantiations[functionIndex].m_templateIndex;
+}
+
+tcb::span<const index_t> TemplateIndex::GetClassArguments(index_t classIndex) const
+{
+    return GetArguments(m_classInstantiations[classIndex]);
+}
+
+tcb::span<const index_t> TemplateIndex::GetFunctionArguments(index_t functionIndex) const
+{
+    return GetArguments(m_functionInstantiations[functionIndex]);
+}
+
+std::vector<uint64_t> TemplateIndex::ComputeCodeSizes(const Classes &classes, const Functions &functions) const
+{
+    std::vector<uint64_t> codeSizes(m_templates.size(), 0);
+
+    const index_t classCount = m_classInstantiations.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const index_t templateIndex = m_classInstantiations[classIndex].m_templateIndex;
+        if (templateIndex == InvalidIndex)
+            continue;
+
+        for (index_t functionIndex : classes[classIndex].m_functionIndices)
+        {
+            codeSizes[templateIndex] += GetCodeSize(functions[functionIndex]);
+        }
+    }
+
+    const index_t functionCount = m_functionInstantiations.size();
+    for (index_t functionIndex = 0; functionIndex < functionCount; ++functionIndex)
+    {
+        const index_t templateIndex = m_functionInstantiations[functionIndex].m_templateIndex;
+        if (templateIndex == InvalidIndex)
+            continue;
+
+        codeSizes[templateIndex] += GetCodeSize(functions[functionIndex]);
+    }
+
+    return codeSizes;
+}
+
+index_t TemplateIndex::AddInstantiation(std::string_view name, Instantiation &instantiation)
+{
+    std::string_view templateName;
+    if (!SplitTemplateName(name, templateName, m_splitArguments))
+        return InvalidIndex;
+
+    instantiation.m_templateIndex = FindOrCreateTemplate(templateName);
+    instantiation.m_argumentBegin = static_cast<uint32_t>(m_arguments.size());
+    instantiation.m_argumentCount = static_cast<uint32_t>(m_splitArguments.size());
+    for (std::string_view argument : m_splitArguments)
+    {
+        m_arguments.push_back(FindOrCreateArgumentId(argument));
+    }
+    return instantiation.m_templateIndex;
+}
+
+index_t TemplateIndex::FindOrCreateTemplate(std::string_view name)
+{
+    std::string key(name);
+    StringToIndexMap::iterator it = m_nameToTemplateIndex.find(key);
+    if (it != m_nameToTemplateIndex.end())
+        return it->second;
+
+    Template templateType;
+    templateType.m_name = key;
+    m_templates.push_back(std::move(templateType));
+    const index_t index = m_templates.size() - 1;
+    m_nameToTemplateIndex.emplace(std::move(key), index);
+    return index;
+}
+
+index_t TemplateIndex::FindOrCreateArgumentId(std::string_view argument)
+{
+    StringViewToIndexMap::iterator it = m_argumentToId.find(argument);
+    if (it != m_argumentToId.end())
+        return it->second;
+
+    const index_t argumentId = m_argumentNames.size();
+    m_argumentStrings.emplace_back(argument);
+    m_argumentNames.push_back(m_argumentStrings.back());
+    m_argumentToId.emplace(m_argumentNames.back(), argumentId);
+    return argumentId;
+}
+
+tcb::span<const index_t> TemplateIndex::GetArguments(const Instantiation &instantiation) const
+{
+    assert(instantiation.m_argumentBegin + instantiation.m_argumentCount <= m_arguments.size());
+    return tcb::span<const index_t>(m_arguments.data() + instantiation.m_argumentBegin, instantiation.m_argumentCount);
+}
+
+uint64_t TemplateIndex::GetCodeSize(const Function &function)
+{
+    uint64_t size = 0;
+    for (const FunctionVariant &variant : function.m_variants)
+    {
+        size += variant.m_size;
+    }
+    return size;
+}
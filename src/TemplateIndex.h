@@ -0,0 +1,79 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <tcb/span.hpp>
+#include <vector>
+
+// Groups class and function template instantiations under their template. "std::vector<Foo, std::allocator<Foo> >"
+// is an instantiation of "std::vector" with the arguments "Foo" and "std::allocator<Foo>". Argument names are interned,
+// so instantiations with the same arguments share their ids.
+class TemplateIndex
+{
+public:
+    struct Template
+    {
+        std::string m_name; // Qualified name without the trailing argument list.
+        std::vector<index_t> m_classIndices; // Class instantiations.
+        std::vector<index_t> m_functionIndices; // Function instantiations.
+    };
+
+    struct Instantiation
+    {
+        index_t m_templateIndex = InvalidIndex;
+        uint32_t m_argumentBegin = 0;
+        uint32_t m_argumentCount = 0;
+    };
+
+public:
+    // Parses every class and function name once. Functions are grouped by their qualified name without parameters.
+    void Build(const Classes &classes, const Functions &functions);
+
+    // Splits "a::b<c, d<e> >" into "a::b" and the arguments "c" and "d<e>". Returns false if the name does not end with
+    // a template argument list.
+    static bool SplitTemplateName(
+        std::string_view name,
+        std::string_view &templateName,
+        std::vector<std::string_view> &arguments);
+
+    index_t GetTemplateCount() const { return static_cast<index_t>(m_templates.size()); }
+    const Template &GetTemplate(index_t templateIndex) const { return m_templates[templateIndex]; }
+    index_t FindTemplate(std::string_view name) const;
+
+    // Returns InvalidIndex if the class or function is not a template instantiation.
+    index_t GetClassTemplateIndex(index_t classIndex) const { return m_classInstantiations[classIndex].m_templateIndex; }
+    index_t GetFunctionTemplateIndex(index_t functionIndex) const;
+    // Interned argument ids of an instantiation.
+    tcb::span<const index_t> GetClassArguments(index_t classIndex) const;
+    tcb::span<const index_t> GetFunctionArguments(index_t functionIndex) const;
+    std::string_view GetArgumentName(index_t argumentId) const { return m_argumentNames[argumentId]; }
+
+    // Sums the code size of all function variants per template, in one pass over the instantiations. Member functions
+    // of class instantiations count towards the class template.
+    std::vector<uint64_t> ComputeCodeSizes(const Classes &classes, const Functions &functions) const;
+
+private:
+    index_t AddInstantiation(std::string_view name, Instantiation &instantiation);
+    index_t FindOrCreateTemplate(std::string_view name);
+    index_t FindOrCreateArgumentId(std::string_view argument);
+    tcb::span<const index_t> GetArguments(const Instantiation &instantiation) const;
+    static uint64_t GetCodeSize(const Function &function);
+
+private:
+    std::vector<Template> m_templates;
+    StringToIndexMap m_nameToTemplateIndex;
+
+    std::vector<Instantiation> m_classInstantiations; // By class index.
+    std::vector<Instantiation> m_functionInstantiations; // By function index.
+    std::vector<index_t> m_arguments; // Argument ids of all instantiations.
+
+    std::deque<std::string> m_argumentStrings; // Stable storage for argument names.
+    std::vector<std::string_view> m_argumentNames; // Argument names by id.
+    StringViewToIndexMap m_argumentToId;
+
+    std::vector<std::string_view> m_splitArguments; // Reused split buffer.
+};
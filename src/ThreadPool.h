@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run queued jobs.
+class ThreadPool
+{
+public:
+    // Creates one worker per hardware thread if threadCount is 0.
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    // Calls function(index) for every index in [0, count) on the worker threads and waits until all calls returned.
+    // Indices are handed out in ascending order, but may complete in any order. If a call throws, no further indices
+    // are handed out, and the first exception is rethrown here once the running calls returned. Can be called from
+    // several threads, but not from a job of the same pool, which would wait for itself.
+    template<typename Function>
+    void ParallelFor(size_t count, Function &&function);
+
+    // Queues a job for the next free worker. The destructor runs all queued jobs before it returns. Jobs must not throw.
+    void Enqueue(std::function<void()> job);
+
+private:
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
+
+template<typename Function>
+void ThreadPool::ParallelFor(size_t count, Function &&function)
+{
+    if (count == 0)
+        return;
+
+    std::atomic<size_t> nextIndex(0);
+    size_t jobsLeft = std::min(count, m_threads.size());
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    std::exception_ptr exception;
+
+    const size_t jobCount = jobsLeft;
+    for (size_t job = 0; job < jobCount; ++job)
+    {
+        Enqueue([&]() {
+            try
+            {
+                for (size_t index = nextIndex++; index < count; index = nextIndex++)
+                {
+                    function(index);
+                }
+            }
+            catch (...)
+            {
+                // The other jobs stop after their current index.
+                nextIndex = count;
+                std::lock_guard<std::mutex> lock(doneMutex);
+                if (!exception)
+                    exception = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--jobsLeft == 0)
+                doneCondition.notify_one();
+        });
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCondition.wait(lock, [&]() { return jobsLeft == 0; });
+    }
+    if (exception)
+        std::rethrow_exception(exception);
+}
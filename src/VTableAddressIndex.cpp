@@ -0,0 +1,58 @@
+#include "VTableAddressIndex.h"
+
+#include "utility.h"
+
+#include <LIEF/MachO.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+void VTableAddressIndex::Build(const LIEF::MachO::Binary &binary)
+{
+    std::vector<uint64_t> begins;
+    std::vector<uint64_t> ends;
+    for (const LIEF::MachO::Symbol &symbol : binary.symbols())
+    {
+        if (starts_with(symbol.name(), "__ZTV") && symbol.value() != 0)
+        {
+            const LIEF::MachO::Section *section = binary.section_from_virtual_address(symbol.value());
+            if (section == nullptr)
+                continue;
+
+            begins.push_back(symbol.value());
+            ends.push_back(section->virtual_address() + section->size());
+        }
+    }
+
+    std::vector<size_t> order(begins.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&begins](size_t a, size_t b) { return begins[a] < begins[b]; });
+
+    m_begins.clear();
+    m_ends.clear();
+    for (size_t i : order)
+    {
+        if (!m_begins.empty() && m_begins.back() == begins[i])
+            continue; // Stab and external symbol of the same vtable.
+
+        if (!m_ends.empty())
+            m_ends.back() = std::min(m_ends.back(), begins[i]);
+        m_begins.push_back(begins[i]);
+        m_ends.push_back(ends[i]);
+    }
+}
+
+bool VTableAddressIndex::FindVTable(uint64_t addressPoint, uint64_t &vtableAddress) const
+{
+    auto it = std::upper_bound(m_begins.begin(), m_begins.end(), addressPoint);
+    if (it == m_begins.begin())
+        return false;
+
+    const size_t index = (it - m_begins.begin()) - 1;
+    const uint64_t begin = m_begins[index];
+    if (addressPoint < begin + 8 || addressPoint >= m_ends[index] || (addressPoint - begin) % 4 != 0)
+        return false;
+
+    vtableAddress = begin;
+    return true;
+}
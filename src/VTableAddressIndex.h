@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LIEF::MachO
+{
+class Binary;
+} // namespace LIEF::MachO
+
+// Sorted address ranges of all __ZTV vtable symbols, regardless of their symbol type. Objects store address points
+// into these ranges as their vtable pointers. A range extends to the next vtable symbol or the end of its section.
+class VTableAddressIndex
+{
+public:
+    void Build(const LIEF::MachO::Binary &binary);
+
+    // Returns true if the address is a possible address point, which lies past the offset to top and the typeinfo of
+    // a vtable. Returns the address of the vtable symbol.
+    bool FindVTable(uint64_t addressPoint, uint64_t &vtableAddress) const;
+
+    size_t GetVTableCount() const { return m_begins.size(); }
+
+private:
+    std::vector<uint64_t> m_begins; // Vtable symbol addresses in ascending order.
+    std::vector<uint64_t> m_ends;
+};
@@ -0,0 +1,132 @@
+#include "VirtualOverrideIndex.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+void VirtualOverrideIndex::Build(const Classes &classes, std::vector<Record> &records)
+{
+    AddSecondaryVtableRecords(classes, records);
+
+    records.erase(
+        std::remove_if(records.begin(), records.end(), [](const Record &record) { return record.m_isImplicit; }),
+        records.end());
+
+    std::sort(records.begin(), records.end(), [](const Record &record1, const Record &record2) {
+        const uint64_t key1 = MakeKey(record1.m_declaringClassIndex, record1.m_declaringEntryIndex);
+        const uint64_t key2 = MakeKey(record2.m_declaringClassIndex, record2.m_declaringEntryIndex);
+        if (key1 != key2)
+            return key1 < key2;
+        return record1.m_override.m_classIndex < record2.m_override.m_classIndex;
+    });
+
+    m_slotKeys.clear();
+    m_slotOffsets.clear();
+    m_overrides.clear();
+    m_overrides.reserve(records.size());
+    for (const Record &record : records)
+    {
+        const uint64_t key = MakeKey(record.m_declaringClassIndex, record.m_declaringEntryIndex);
+        if (m_slotKeys.empty() || m_slotKeys.back() != key)
+        {
+            m_slotKeys.push_back(key);
+            m_slotOffsets.push_back(static_cast<uint32_t>(m_overrides.size()));
+        }
+        else if (m_overrides.back().m_classIndex == record.m_override.m_classIndex)
+        {
+            // The primary and a secondary vtable of a class can override the same function.
+            continue;
+        }
+        m_overrides.push_back(record.m_override);
+    }
+    m_slotOffsets.push_back(static_cast<uint32_t>(m_overrides.size()));
+}
+
+tcb::span<const VirtualOverrideIndex::Override> VirtualOverrideIndex::GetOverrides(
+    index_t declaringClassIndex,
+    uint16_t declaringEntryIndex) const
+{
+    const uint64_t key = MakeKey(declaringClassIndex, declaringEntryIndex);
+    std::vector<uint64_t>::const_iterator it = std::lower_bound(m_slotKeys.begin(), m_slotKeys.end(), key);
+    if (it == m_slotKeys.end() || *it != key)
+        return tcb::span<const Override>();
+
+    const size_t slotIndex = it - m_slotKeys.begin();
+    const uint32_t begin = m_slotOffsets[slotIndex];
+    const uint32_t end = m_slotOffsets[slotIndex + 1];
+    return tcb::span<const Override>(m_overrides.data() + begin, end - begin);
+}
+
+size_t VirtualOverrideIndex::GetMemoryUsage() const
+{
+    return m_slotKeys.capacity() * sizeof(uint64_t) + m_slotOffsets.capacity() * sizeof(uint32_t)
+        + m_overrides.capacity() * sizeof(Override);
+}
+
+void VirtualOverrideIndex::AddSecondaryVtableRecords(const Classes &classes, std::vector<Record> &records) const
+{
+    // Slots of primary vtable entries that override or inherit a function of a base class.
+    std::unordered_map<uint64_t, uint64_t> entryToSlot;
+    entryToSlot.reserve(records.size());
+    for (const Record &record : records)
+    {
+        entryToSlot.emplace(
+            MakeKey(record.m_override.m_classIndex, record.m_entryIndex),
+            MakeKey(record.m_declaringClassIndex, record.m_declaringEntryIndex));
+    }
+
+    const index_t classCount = classes.size();
+    for (index_t classIndex = 0; classIndex < classCount; ++classIndex)
+    {
+        const Class &classType = classes[classIndex];
+        const size_t vtableCount = classType.m_vtables.size();
+        for (size_t vtableIndex = 1; vtableIndex < vtableCount; ++vtableIndex)
+        {
+            const VTable &vtable = classType.m_vtables[vtableIndex];
+            const BaseClass *baseClass = classType.GetBaseClass(vtable.m_offset);
+            if (baseClass == nullptr)
+                continue;
+
+            const Class &baseClassType = classes[baseClass->m_classIndex];
+            if (baseClassType.m_vtables.empty())
+                continue;
+
+            const tcb::span<const VTableEntry> entries = classType.GetVTableEntries(vtable);
+            const tcb::span<const VTableEntry> baseEntries =
+                baseClassType.GetVTableEntries(baseClassType.m_vtables.front());
+            const uint16_t entryCount = static_cast<uint16_t>(std::min(entries.size(), baseEntries.size()));
+            for (uint16_t entryIndex = 0; entryIndex < entryCount; ++entryIndex)
+            {
+                const VTableEntry &entry = entries[entryIndex];
+                if (!entry.IsOverride())
+                    continue;
+
+                Record record;
+                if (baseEntries[entryIndex].IsFirstDeclaration())
+                {
+                    record.m_declaringClassIndex = baseClass->m_classIndex;
+                    record.m_declaringEntryIndex = entryIndex;
+                }
+                else
+                {
+                    std::unordered_map<uint64_t, uint64_t>::const_iterator it =
+                        entryToSlot.find(MakeKey(baseClass->m_classIndex, entryIndex));
+                    if (it == entryToSlot.end())
+                        continue;
+
+                    record.m_declaringClassIndex = static_cast<index_t>(it->second >> 16);
+                    record.m_declaringEntryIndex = static_cast<uint16_t>(it->second);
+                }
+                record.m_entryIndex = entryIndex;
+                record.m_override.m_classIndex = classIndex;
+                record.m_override.m_functionIndex = entry.GetFunctionIndex();
+                record.m_override.m_thunkIndex = entry.GetThunkIndex();
+                records.push_back(record);
+            }
+        }
+    }
+}
+
+uint64_t VirtualOverrideIndex::MakeKey(index_t classIndex, uint16_t entryIndex)
+{
+    return (uint64_t(classIndex) << 16) | entryIndex;
+}
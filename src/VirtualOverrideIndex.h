@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CppTypes.h"
+
+#include <cstdint>
+#include <tcb/span.hpp>
+#include <vector>
+
+// Inverted index of virtual function overrides. A slot is the vtable entry of the class that first declares a virtual
+// function, identified by the class and the entry index in its primary vtable. Every slot lists the classes that
+// override the function, in compressed sparse row form.
+class VirtualOverrideIndex
+{
+public:
+    struct Override
+    {
+        index_t m_classIndex = InvalidIndex; // Overriding class.
+        index_t m_functionIndex = InvalidIndex;
+        index_t m_thunkIndex = InvalidIndex;
+    };
+
+    // A resolved vtable entry of a class, as found by MachOReader.
+    struct Record
+    {
+        index_t m_declaringClassIndex = InvalidIndex;
+        uint16_t m_declaringEntryIndex = 0; // Entry index in the primary vtable of the declaring class.
+        uint16_t m_entryIndex = 0; // Entry index in the vtable of the overriding class.
+        bool m_isImplicit = false; // Inherited without override. Only used to resolve secondary vtables.
+        Override m_override;
+    };
+
+public:
+    // Builds the index from the resolved primary vtable entries of all classes. Secondary vtable overrides are
+    // resolved through the primary vtable of the base class at the vtable offset.
+    void Build(const Classes &classes, std::vector<Record> &records);
+
+    // Gets the overrides of a virtual function, ordered by class index.
+    tcb::span<const Override> GetOverrides(index_t declaringClassIndex, uint16_t declaringEntryIndex) const;
+
+    size_t GetSlotCount() const { return m_slotKeys.size(); }
+    size_t GetMemoryUsage() const;
+
+private:
+    void AddSecondaryVtableRecords(const Classes &classes, std::vector<Record> &records) const;
+    static uint64_t MakeKey(index_t classIndex, uint16_t entryIndex);
+
+private:
+    std::vector<uint64_t> m_slotKeys; // Sorted slot keys.
+    std::vector<uint32_t> m_slotOffsets; // Offsets into m_overrides, one more than slots.
+    std::vector<Override> m_overrides;
+};
@@ -0,0 +1,633 @@
+#include "X86Decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+enum class Operand : uint8_t
+{
+    None,
+    Imm8,
+    Imm16,
+    Imm32, // 16 bits with the operand size prefix.
+    Imm16Imm8, // enter
+    Rel8,
+    Rel32,
+    Moffs, // Absolute address, 16 bits with the address size prefix.
+    Ptr, // Far pointer, 16 bit selector and 32 bit offset.
+    Invalid,
+};
+
+struct OpcodeInfo
+{
+    bool m_hasModRM = false;
+    Operand m_operand = Operand::None;
+};
+
+OpcodeInfo GetOneByteOpcodeInfo(uint8_t opcode, uint8_t modRM)
+{
+    // ALU block 00-3F: op r/m,r, op r,r/m, op al,imm8, op eax,imm32, and single byte instructions.
+    if (opcode < 0x40)
+    {
+        switch (opcode & 7)
+        {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                return {true, Operand::None};
+            case 4:
+                return {false, Operand::Imm8};
+            case 5:
+                return {false, Operand::Imm32};
+            default:
+                return {false, Operand::None}; // push/pop segment, daa, das, aaa, aas.
+        }
+    }
+
+    switch (opcode)
+    {
+        case 0x62: // bound
+        case 0x63: // arpl
+        case 0x84: // test
+        case 0x85:
+        case 0x86: // xchg
+        case 0x87:
+        case 0x88: // mov
+        case 0x89:
+        case 0x8a:
+        case 0x8b:
+        case 0x8c:
+        case 0x8d: // lea
+        case 0x8e:
+        case 0x8f: // pop r/m
+        case 0xc4: // les
+        case 0xc5: // lds
+        case 0xd0: // shift
+        case 0xd1:
+        case 0xd2:
+        case 0xd3:
+        case 0xd8: // x87
+        case 0xd9:
+        case 0xda:
+        case 0xdb:
+        case 0xdc:
+        case 0xdd:
+        case 0xde:
+        case 0xdf:
+        case 0xfe:
+        case 0xff:
+            return {true, Operand::None};
+        case 0x69: // imul r,r/m,imm32
+        case 0x81:
+        case 0xc7:
+            return {true, Operand::Imm32};
+        case 0x6b: // imul r,r/m,imm8
+        case 0x80:
+        case 0x82:
+        case 0x83:
+        case 0xc0:
+        case 0xc1:
+        case 0xc6:
+            return {true, Operand::Imm8};
+        case 0xf6: // test r/m8,imm8 has an immediate, the other group 3 instructions have none.
+            return {true, ((modRM >> 3) & 7) <= 1 ? Operand::Imm8 : Operand::None};
+        case 0xf7:
+            return {true, ((modRM >> 3) & 7) <= 1 ? Operand::Imm32 : Operand::None};
+        case 0x6a: // push imm8
+        case 0xa8: // test al,imm8
+        case 0xcd: // int
+        case 0xd4: // aam
+        case 0xd5: // aad
+        case 0xe4: // in
+        case 0xe5:
+        case 0xe6: // out
+        case 0xe7:
+            return {false, Operand::Imm8};
+        case 0x68: // push imm32
+        case 0xa9: // test eax,imm32
+            return {false, Operand::Imm32};
+        case 0xe0: // loopne
+        case 0xe1: // loope
+        case 0xe2: // loop
+        case 0xe3: // jecxz
+        case 0xeb: // jmp rel8
+            return {false, Operand::Rel8};
+        case 0xe8: // call rel32
+        case 0xe9: // jmp rel32
+            return {false, Operand::Rel32};
+        case 0xa0: // mov al/eax,moffs and mov moffs,al/eax
+        case 0xa1:
+        case 0xa2:
+        case 0xa3:
+            return {false, Operand::Moffs};
+        case 0xc2: // ret imm16
+        case 0xca: // retf imm16
+            return {false, Operand::Imm16};
+        case 0xc8: // enter
+            return {false, Operand::Imm16Imm8};
+        case 0x9a: // call far
+        case 0xea: // jmp far
+            return {false, Operand::Ptr};
+        case 0x0f: // Handled by the caller.
+        case 0x26: // Prefixes are handled by the caller.
+        case 0x2e:
+        case 0x36:
+        case 0x3e:
+        case 0x64:
+        case 0x65:
+        case 0x66:
+        case 0x67:
+        case 0xf0:
+        case 0xf2:
+        case 0xf3:
+        case 0xd6: // Undefined.
+        case 0xf1:
+            return {false, Operand::Invalid};
+    }
+
+    if (opcode >= 0x70 && opcode <= 0x7f) // jcc rel8
+        return {false, Operand::Rel8};
+    if (opcode >= 0xb0 && opcode <= 0xb7) // mov r8,imm8
+        return {false, Operand::Imm8};
+    if (opcode >= 0xb8 && opcode <= 0xbf) // mov r32,imm32
+        return {false, Operand::Imm32};
+
+    // inc, dec, push, pop, pusha, popa, nop, xchg, cwde, cdq, string instructions, ret, leave, int3, hlt...
+    return {false, Operand::None};
+}
+
+OpcodeInfo GetTwoByteOpcodeInfo(uint8_t opcode)
+{
+    if (opcode >= 0x80 && opcode <= 0x8f) // jcc rel32
+        return {false, Operand::Rel32};
+    if (opcode >= 0xc8 && opcode <= 0xcf) // bswap
+        return {false, Operand::None};
+
+    switch (opcode)
+    {
+        case 0x05: // syscall
+        case 0x06: // clts
+        case 0x07: // sysret
+        case 0x08: // invd
+        case 0x09: // wbinvd
+        case 0x0b: // ud2
+        case 0x30: // wrmsr
+        case 0x31: // rdtsc
+        case 0x32: // rdmsr
+        case 0x33: // rdpmc
+        case 0x34: // sysenter
+        case 0x35: // sysexit
+        case 0x77: // emms
+        case 0xa0: // push fs
+        case 0xa1: // pop fs
+        case 0xa2: // cpuid
+        case 0xa8: // push gs
+        case 0xa9: // pop gs
+        case 0xaa: // rsm
+            return {false, Operand::None};
+        case 0x70: // pshuf
+        case 0x71: // shift by immediate
+        case 0x72:
+        case 0x73:
+        case 0xa4: // shld imm8
+        case 0xac: // shrd imm8
+        case 0xba: // bt group imm8
+        case 0xc2: // cmpps
+        case 0xc4: // pinsrw
+        case 0xc5: // pextrw
+        case 0xc6: // shufps
+            return {true, Operand::Imm8};
+        case 0x04: // Undefined.
+        case 0x0a:
+        case 0x0c:
+        case 0x0e:
+        case 0x0f: // 3DNow!
+        case 0x24:
+        case 0x25:
+        case 0x26:
+        case 0x27:
+        case 0x36:
+        case 0x39:
+        case 0x3b:
+        case 0x3c:
+        case 0x3d:
+        case 0x3e:
+        case 0x3f:
+        case 0xff:
+            return {false, Operand::Invalid};
+    }
+
+    return {true, Operand::None};
+}
+
+uint32_t GetOperandSize(Operand operand, uint8_t prefixes)
+{
+    switch (operand)
+    {
+        case Operand::None:
+        case Operand::Invalid:
+            return 0;
+        case Operand::Imm8:
+        case Operand::Rel8:
+            return 1;
+        case Operand::Imm16:
+            return 2;
+        case Operand::Imm32:
+            return (prefixes & X86Instruction::Prefix_OperandSize) ? 2 : 4;
+        case Operand::Imm16Imm8:
+            return 3;
+        case Operand::Rel32:
+            return 4;
+        case Operand::Moffs:
+            return (prefixes & X86Instruction::Prefix_AddressSize) ? 2 : 4;
+        case Operand::Ptr:
+            return 6;
+    }
+    return 0;
+}
+
+int32_t ReadSigned(const uint8_t *data, uint32_t size)
+{
+    switch (size)
+    {
+        case 1:
+            return static_cast<int8_t>(data[0]);
+        case 2: {
+            int16_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+        case 4: {
+            int32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+    }
+    return 0;
+}
+
+// Decodes ModRM, SIB and displacement at the offset. Returns false if the bytes end early.
+bool DecodeModRM(const uint8_t *code, size_t size, size_t &offset, X86Instruction &instruction)
+{
+    if (offset >= size)
+        return false;
+
+    const uint8_t modRM = code[offset++];
+    instruction.m_hasModRM = true;
+    instruction.m_mod = modRM >> 6;
+    instruction.m_reg = (modRM >> 3) & 7;
+    instruction.m_rm = modRM & 7;
+    if (instruction.m_mod == 3)
+        return true;
+
+    uint32_t displacementSize = 0;
+    if (instruction.m_prefixes & X86Instruction::Prefix_AddressSize)
+    {
+        // 16-bit addressing. Register pairs are not modeled, the operand is only skipped.
+        if (instruction.m_mod == 0 && instruction.m_rm == 6)
+            displacementSize = 2;
+        else if (instruction.m_mod == 1)
+            displacementSize = 1;
+        else if (instruction.m_mod == 2)
+            displacementSize = 2;
+    }
+    else
+    {
+        instruction.m_baseRegister = instruction.m_rm;
+        if (instruction.m_rm == X86Register_Esp)
+        {
+            if (offset >= size)
+                return false;
+
+            const uint8_t sib = code[offset++];
+            instruction.m_scale = static_cast<uint8_t>(1 << (sib >> 6));
+            const uint8_t index = (sib >> 3) & 7;
+            instruction.m_indexRegister = index == X86Register_Esp ? static_cast<uint8_t>(X86Register_None) : index;
+            instruction.m_baseRegister = sib & 7;
+            if (instruction.m_mod == 0 && instruction.m_baseRegister == X86Register_Ebp)
+            {
+                instruction.m_baseRegister = X86Register_None;
+                displacementSize = 4;
+            }
+        }
+        else if (instruction.m_mod == 0 && instruction.m_rm == X86Register_Ebp)
+        {
+            instruction.m_baseRegister = X86Register_None;
+            displacementSize = 4;
+        }
+
+        if (instruction.m_mod == 1)
+            displacementSize = 1;
+        else if (instruction.m_mod == 2)
+            displacementSize = 4;
+    }
+
+    if (offset + displacementSize > size)
+        return false;
+
+    instruction.m_displacement = ReadSigned(code + offset, displacementSize);
+    offset += displacementSize;
+    return true;
+}
+} // namespace
+
+bool X86Instruction::HasBaseDisplacementOperand() const
+{
+    return HasMemoryOperand() && m_baseRegister != X86Register_None && m_indexRegister == X86Register_None
+        && (m_prefixes & Prefix_AddressSize) == 0;
+}
+
+uint8_t X86Instruction::GetMemoryOperandSize() const
+{
+    if (!HasMemoryOperand())
+        return 0;
+
+    const uint8_t wordSize = (m_prefixes & Prefix_OperandSize) ? 2 : 4;
+    if (m_opcode >= 0x0f00)
+    {
+        const uint8_t opcode = static_cast<uint8_t>(m_opcode);
+        switch (opcode)
+        {
+            case 0x90: // setcc
+            case 0x91:
+            case 0x92:
+            case 0x93:
+            case 0x94:
+            case 0x95:
+            case 0x96:
+            case 0x97:
+            case 0x98:
+            case 0x99:
+            case 0x9a:
+            case 0x9b:
+            case 0x9c:
+            case 0x9d:
+            case 0x9e:
+            case 0x9f:
+            case 0xb0: // cmpxchg r/m8
+            case 0xb6: // movzx r,r/m8
+            case 0xbe: // movsx r,r/m8
+            case 0xc0: // xadd r/m8
+                return 1;
+            case 0xb7: // movzx r,r/m16
+            case 0xbf: // movsx r,r/m16
+                return 2;
+            case 0x18: // prefetch
+            case 0x0d:
+            case 0x01: // System instructions.
+            case 0x00:
+            case 0xae: // fxsave, ldmxcsr...
+                return 0;
+            case 0x6e: // movd
+            case 0x7e:
+                return (m_prefixes & Prefix_Rep) ? 8 : 4;
+            case 0xd6: // movq
+                return 8;
+        }
+
+        // SSE and MMX: scalar single, scalar double or full register.
+        if ((opcode >= 0x10 && opcode <= 0x17) || (opcode >= 0x28 && opcode <= 0x2f) || (opcode >= 0x50 && opcode <= 0x7f)
+            || opcode == 0xc2 || opcode >= 0xd0)
+        {
+            if (m_prefixes & Prefix_Rep)
+                return 4;
+            if (m_prefixes & Prefix_RepNe)
+                return 8;
+            return (opcode >= 0x60 && (m_prefixes & Prefix_OperandSize) == 0) ? 8 : 16;
+        }
+        return wordSize;
+    }
+
+    const uint8_t opcode = static_cast<uint8_t>(m_opcode);
+    if (opcode < 0x40)
+        return (opcode & 1) ? wordSize : 1;
+
+    switch (opcode)
+    {
+        case 0x8d: // lea
+        case 0xc4: // les
+        case 0xc5: // lds
+        case 0x62: // bound
+            return 0;
+        case 0x80:
+        case 0x82:
+        case 0x84:
+        case 0x86:
+        case 0x88:
+        case 0x8a:
+        case 0xc0:
+        case 0xc6:
+        case 0xd0:
+        case 0xd2:
+        case 0xf6:
+        case 0xfe:
+            return 1;
+        case 0x8c: // mov r/m16,sreg
+        case 0x8e:
+        case 0x63: // arpl
+            return 2;
+        case 0xd8: // Float arithmetic with m32.
+        case 0xda: // Integer arithmetic with m32.
+            return 4;
+        case 0xdc: // Float arithmetic with m64.
+            return 8;
+        case 0xde: // Integer arithmetic with m16.
+            return 2;
+        case 0xd9: // fld, fst, fstp m32. The others are environment and control word.
+            return m_reg <= 3 ? 4 : 0;
+        case 0xdb: // fild, fisttp, fist, fistp m32, fld, fstp m80.
+            return m_reg <= 3 ? 4 : (m_reg == 5 || m_reg == 7) ? 10 : 0;
+        case 0xdd: // fld, fisttp, fst, fstp m64. The others are state.
+            return m_reg <= 3 ? 8 : 0;
+        case 0xdf: // fild, fisttp, fist, fistp m16, fbld, fild, fbstp, fistp m64.
+            return m_reg <= 3 ? 2 : (m_reg == 4 || m_reg == 6) ? 10 : 8;
+        case 0xff: // Far call and jmp have a 6 byte pointer.
+            return (m_reg == 3 || m_reg == 5) ? 6 : wordSize;
+    }
+    return wordSize;
+}
+
+uint8_t X86Instruction::GetMemoryAccess() const
+{
+    if (!HasMemoryOperand())
+        return MemoryAccess_None;
+
+    constexpr uint8_t Read = MemoryAccess_Read;
+    constexpr uint8_t ReadWrite = MemoryAccess_Read | MemoryAccess_Write;
+    const uint8_t reg = m_reg;
+
+    if (m_opcode >= 0x0f00)
+    {
+        const uint8_t opcode = static_cast<uint8_t>(m_opcode);
+        if (opcode >= 0x90 && opcode <= 0x9f) // setcc
+            return MemoryAccess_Write;
+
+        switch (opcode)
+        {
+            case 0x11: // movups, movss, movupd, movsd
+            case 0x13: // movlps
+            case 0x17: // movhps
+            case 0x29: // movaps
+            case 0x2b: // movntps
+            case 0x7f: // movq, movdqa
+            case 0xd6: // movq
+            case 0xe7: // movntq
+                return MemoryAccess_Write;
+            case 0x7e: // movq xmm,m64 with F3, movd r/m32,xmm otherwise.
+                return (m_prefixes & Prefix_Rep) ? MemoryAccess_Read : MemoryAccess_Write;
+            case 0xa4: // shld, shrd, bts, btr, btc, cmpxchg, xadd
+            case 0xa5:
+            case 0xab:
+            case 0xac:
+            case 0xad:
+            case 0xb0:
+            case 0xb1:
+            case 0xb3:
+            case 0xbb:
+            case 0xc0:
+            case 0xc1:
+                return ReadWrite;
+            case 0xba: // bt group
+                return reg == 4 ? Read : ReadWrite;
+        }
+        return MemoryAccess_Read;
+    }
+
+    const uint8_t opcode = static_cast<uint8_t>(m_opcode);
+    if (opcode < 0x40)
+    {
+        const bool isCompare = ((opcode >> 3) & 7) == 7;
+        const bool registerIsDestination = (opcode & 2) != 0;
+        return (isCompare || registerIsDestination) ? Read : ReadWrite;
+    }
+
+    switch (opcode)
+    {
+        case 0x80:
+        case 0x81:
+        case 0x82:
+        case 0x83:
+            return reg == 7 ? Read : ReadWrite; // cmp or arithmetic.
+        case 0x86: // xchg
+        case 0x87:
+        case 0xc0: // shift
+        case 0xc1:
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3:
+            return ReadWrite;
+        case 0x88: // mov r/m,r
+        case 0x89:
+        case 0x8c:
+        case 0x8f: // pop r/m
+        case 0xc6: // mov r/m,imm
+        case 0xc7:
+            return MemoryAccess_Write;
+        case 0x8d: // lea
+            return MemoryAccess_None;
+        case 0xf6: // not, neg
+        case 0xf7:
+            return (reg == 2 || reg == 3) ? ReadWrite : Read;
+        case 0xfe: // inc, dec
+        case 0xff:
+            return reg <= 1 ? ReadWrite : Read;
+        case 0xd9: // fst, fstp, fnstenv, fnstcw
+            return (reg == 2 || reg == 3 || reg >= 6) ? MemoryAccess_Write : MemoryAccess_Read;
+        case 0xdb: // fisttp, fist, fistp, fstp m80
+        case 0xdd: // fisttp, fst, fstp, fnsave, fnstsw
+        case 0xdf: // fisttp, fist, fistp, fbstp, fistp m64
+            return (reg == 1 || reg == 2 || reg == 3 || reg >= 6) ? MemoryAccess_Write : MemoryAccess_Read;
+    }
+    return MemoryAccess_Read;
+}
+
+bool X86Decoder::Decode(const uint8_t *code, size_t size, X86Instruction &instruction)
+{
+    instruction = X86Instruction();
+
+    size_t offset = 0;
+    for (; offset < size; ++offset)
+    {
+        const uint8_t byte = code[offset];
+        if (byte == 0x66)
+            instruction.m_prefixes |= X86Instruction::Prefix_OperandSize;
+        else if (byte == 0x67)
+            instruction.m_prefixes |= X86Instruction::Prefix_AddressSize;
+        else if (byte == 0xf3)
+            instruction.m_prefixes |= X86Instruction::Prefix_Rep;
+        else if (byte == 0xf2)
+            instruction.m_prefixes |= X86Instruction::Prefix_RepNe;
+        else if (byte == 0xf0)
+            instruction.m_prefixes |= X86Instruction::Prefix_Lock;
+        else if (byte == 0x26 || byte == 0x2e || byte == 0x36 || byte == 0x3e || byte == 0x64 || byte == 0x65)
+            instruction.m_prefixes |= X86Instruction::Prefix_Segment;
+        else
+            break;
+    }
+    if (offset >= size || offset > 4)
+        return false;
+
+    OpcodeInfo info;
+    uint8_t opcode = code[offset++];
+    if (opcode == 0x0f)
+    {
+        if (offset >= size)
+            return false;
+
+        opcode = code[offset++];
+        instruction.m_opcode = static_cast<uint16_t>(0x0f00 | opcode);
+        if (opcode == 0x38 || opcode == 0x3a)
+        {
+            // Three byte opcodes always have ModRM. The 0F3A map has an immediate byte.
+            if (offset >= size)
+                return false;
+
+            ++offset;
+            info = {true, opcode == 0x3a ? Operand::Imm8 : Operand::None};
+        }
+        else
+        {
+            info = GetTwoByteOpcodeInfo(opcode);
+        }
+    }
+    else
+    {
+        instruction.m_opcode = opcode;
+        info = GetOneByteOpcodeInfo(opcode, offset < size ? code[offset] : 0);
+    }
+
+    if (info.m_operand == Operand::Invalid)
+        return false;
+
+    if (info.m_hasModRM && !DecodeModRM(code, size, offset, instruction))
+        return false;
+
+    const uint32_t operandSize = GetOperandSize(info.m_operand, instruction.m_prefixes);
+    if (offset + operandSize > size)
+        return false;
+
+    if (info.m_operand == Operand::Rel8 || info.m_operand == Operand::Rel32)
+    {
+        instruction.m_displacement = ReadSigned(code + offset, operandSize);
+    }
+    else if (info.m_operand == Operand::Moffs)
+    {
+        instruction.m_displacement = ReadSigned(code + offset, operandSize);
+    }
+    else if (operandSize != 0)
+    {
+        // Only the frame size of enter and the offset of far pointers.
+        const uint32_t valueSize = info.m_operand == Operand::Imm16Imm8 ? 2 : std::min<uint32_t>(operandSize, 4);
+        instruction.m_immediate = static_cast<uint32_t>(ReadSigned(code + offset, valueSize));
+        if (valueSize == 2 && info.m_operand != Operand::Imm32)
+            instruction.m_immediate &= 0xffff;
+        instruction.m_hasImmediate = true;
+    }
+    offset += operandSize;
+
+    instruction.m_length = static_cast<uint8_t>(offset);
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum X86Register : uint8_t
+{
+    X86Register_Eax,
+    X86Register_Ecx,
+    X86Register_Edx,
+    X86Register_Ebx,
+    X86Register_Esp,
+    X86Register_Ebp,
+    X86Register_Esi,
+    X86Register_Edi,
+    X86Register_Count,
+    X86Register_None = 0xff,
+};
+
+// One decoded i386 instruction in 32-bit mode. Only the parts that are needed to follow registers and memory
+// operands are decoded: prefixes, opcode, ModRM, SIB, displacement and immediate.
+struct X86Instruction
+{
+    enum Prefix : uint8_t
+    {
+        Prefix_None = 0,
+        Prefix_OperandSize = 1 << 0, // 66
+        Prefix_AddressSize = 1 << 1, // 67
+        Prefix_Rep = 1 << 2, // F3
+        Prefix_RepNe = 1 << 3, // F2
+        Prefix_Lock = 1 << 4, // F0
+        Prefix_Segment = 1 << 5, // 26, 2E, 36, 3E, 64, 65
+    };
+
+    enum MemoryAccess : uint8_t
+    {
+        MemoryAccess_None = 0,
+        MemoryAccess_Read = 1 << 0,
+        MemoryAccess_Write = 1 << 1,
+    };
+
+    bool HasMemoryOperand() const { return m_hasModRM && m_mod != 3; }
+    // Memory operand without index register, such as [ebx+8].
+    bool HasBaseDisplacementOperand() const;
+    // Size of the memory operand in bytes. 0 if it is not accessed, such as for lea, or if the size is unknown.
+    uint8_t GetMemoryOperandSize() const;
+    // Whether the memory operand is read, written or both. None for lea and for instructions without memory operand.
+    uint8_t GetMemoryAccess() const;
+
+    uint8_t m_length = 0;
+    uint8_t m_prefixes = Prefix_None;
+    uint16_t m_opcode = 0; // One byte opcode, or 0F00 | second byte for two byte opcodes.
+    bool m_hasModRM = false;
+    uint8_t m_mod = 0;
+    uint8_t m_reg = 0; // Register or opcode extension.
+    uint8_t m_rm = 0; // Register if m_mod is 3.
+    uint8_t m_baseRegister = X86Register_None; // Memory operand base.
+    uint8_t m_indexRegister = X86Register_None; // Memory operand index.
+    uint8_t m_scale = 1;
+    int32_t m_displacement = 0; // Memory operand displacement, or branch displacement of relative jumps and calls.
+    uint32_t m_immediate = 0; // 8 and 16 bit immediates of word sized operations are sign extended.
+    bool m_hasImmediate = false;
+};
+
+// Instruction length decoder for the i386 one and two byte opcode maps. Knows the size and direction of memory
+// operands, but not what instructions compute.
+class X86Decoder
+{
+public:
+    // Returns false if the bytes do not form a known instruction, or the instruction exceeds the size.
+    static bool Decode(const uint8_t *code, size_t size, X86Instruction &instruction);
+};
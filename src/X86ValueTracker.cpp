@@ -0,0 +1,544 @@
+#include "X86ValueTracker.h"
+
+#include <algorithm>
+
+void X86ValueTracker::Reset(bool hasThis, int32_t thisOffset)
+{
+    *this = X86ValueTracker();
+    if (hasThis)
+        SetStackValue(thisOffset, {X86Value::This, 0});
+}
+
+void X86ValueTracker::ClearRegisters()
+{
+    for (uint8_t reg = 0; reg < X86Register_Count; ++reg)
+    {
+        m_registers[reg] = X86Value();
+    }
+}
+
+void X86ValueTracker::SetRegister(uint8_t reg, const X86Value &value)
+{
+    ClearRegister(reg);
+    m_registers[reg] = value;
+}
+
+X86Value X86ValueTracker::GetMemoryValue(const X86Instruction &instruction) const
+{
+    int32_t offset;
+    if (!GetStackSlot(instruction, offset))
+        return X86Value();
+
+    return GetStackValue(offset);
+}
+
+X86Value X86ValueTracker::GetArgument(uint32_t argumentIndex) const
+{
+    if (!m_espKnown)
+        return X86Value();
+
+    return GetStackValue(m_espOffset + static_cast<int32_t>(argumentIndex * 4));
+}
+
+X86Value X86ValueTracker::GetStoredValue(const X86Instruction &instruction) const
+{
+    if (instruction.m_prefixes & X86Instruction::Prefix_OperandSize)
+        return X86Value(); // Partial store.
+
+    if (instruction.m_opcode == 0x89)
+        return m_registers[instruction.m_reg];
+    if (instruction.m_opcode == 0xc7 && instruction.m_reg == 0)
+        return {X86Value::Constant, instruction.m_immediate};
+    return X86Value();
+}
+
+void X86ValueTracker::Track(const X86Instruction &instruction, uint64_t address)
+{
+    const bool picRegisterPending = m_picRegisterPending;
+    m_picRegisterPending = false;
+
+    const uint8_t reg = instruction.m_reg;
+    const uint8_t rm = instruction.m_rm;
+    const bool registerOperand = instruction.m_hasModRM && instruction.m_mod == 3;
+
+    // Memory writes to tracked stack slots.
+    int32_t slot;
+    if ((instruction.GetMemoryAccess() & X86Instruction::MemoryAccess_Write) && GetStackSlot(instruction, slot))
+        SetStackValue(slot, GetStoredValue(instruction));
+
+    if (instruction.m_opcode >= 0x0f00)
+    {
+        const uint8_t opcode = static_cast<uint8_t>(instruction.m_opcode);
+        if ((opcode >= 0x40 && opcode <= 0x4f) || opcode == 0xaf || opcode == 0xb6 || opcode == 0xb7
+            || opcode == 0xbe || opcode == 0xbf || opcode == 0xbc || opcode == 0xbd || opcode == 0x02
+            || opcode == 0x03 || opcode == 0x50 || opcode == 0xc5 || opcode == 0xd7 || opcode == 0x2c
+            || opcode == 0x2d)
+        {
+            ClearRegister(reg);
+        }
+        else if (registerOperand && opcode >= 0x90 && opcode <= 0x9f) // setcc
+        {
+            ClearByteRegister(rm);
+        }
+        else if (
+            registerOperand
+            && (opcode == 0xa4 || opcode == 0xa5 || opcode == 0xac || opcode == 0xad || opcode == 0xab
+                || opcode == 0xb3 || opcode == 0xbb || opcode == 0xba || opcode == 0x7e))
+        {
+            ClearRegister(rm);
+        }
+        else if (opcode == 0xb0 || opcode == 0xc0) // cmpxchg, xadd r/m8,r8
+        {
+            ClearRegister(X86Register_Eax);
+            ClearByteRegister(reg);
+            if (registerOperand)
+                ClearByteRegister(rm);
+        }
+        else if (opcode == 0xb1 || opcode == 0xc1)
+        {
+            ClearRegister(X86Register_Eax);
+            ClearRegister(reg);
+            if (registerOperand)
+                ClearRegister(rm);
+        }
+        else if (opcode >= 0xc8 && opcode <= 0xcf)
+        {
+            ClearRegister(opcode & 7);
+        }
+        else if (opcode == 0x31 || opcode == 0xa2)
+        {
+            ClearRegister(X86Register_Eax);
+            ClearRegister(X86Register_Ecx);
+            ClearRegister(X86Register_Edx);
+            ClearRegister(X86Register_Ebx);
+        }
+        return;
+    }
+
+    const uint8_t opcode = static_cast<uint8_t>(instruction.m_opcode);
+    if (opcode < 0x40)
+    {
+        const bool isCompare = ((opcode >> 3) & 7) == 7;
+        if (isCompare)
+            return;
+
+        switch (opcode & 7)
+        {
+            case 0:
+                if (registerOperand)
+                    ClearByteRegister(rm);
+                return;
+            case 1:
+                if (registerOperand)
+                    ClearRegister(rm);
+                return;
+            case 2:
+                ClearByteRegister(reg);
+                return;
+            case 3:
+                ClearRegister(reg);
+                return;
+            case 4:
+            case 5:
+                if (opcode == 0x05 && m_registers[X86Register_Eax].m_kind == X86Value::Constant)
+                    m_registers[X86Register_Eax].m_value += instruction.m_immediate;
+                else
+                    ClearRegister(X86Register_Eax);
+                return;
+        }
+        return;
+    }
+
+    if (opcode >= 0x40 && opcode <= 0x4f) // inc, dec
+    {
+        ClearRegister(opcode & 7);
+        return;
+    }
+    if (opcode >= 0x50 && opcode <= 0x57) // push
+    {
+        Push(m_registers[opcode & 7]);
+        return;
+    }
+    if (opcode >= 0x58 && opcode <= 0x5f) // pop
+    {
+        const X86Value value = picRegisterPending ? X86Value{X86Value::Constant, m_picAddress}
+            : m_espKnown                          ? GetStackValue(m_espOffset)
+                                                  : X86Value();
+        AdjustStack(4);
+        SetRegister(opcode & 7, value);
+        return;
+    }
+    if (opcode >= 0x91 && opcode <= 0x97) // xchg eax,r
+    {
+        ClearRegister(X86Register_Eax);
+        ClearRegister(opcode & 7);
+        return;
+    }
+    if (opcode >= 0xb0 && opcode <= 0xb7) // mov r8,imm8
+    {
+        ClearByteRegister(opcode & 7);
+        return;
+    }
+    if (opcode >= 0xb8 && opcode <= 0xbf) // mov r32,imm32
+    {
+        SetRegister(opcode & 7, {X86Value::Constant, instruction.m_immediate});
+        return;
+    }
+    if (opcode >= 0xa4 && opcode <= 0xaf) // String instructions.
+    {
+        ClearRegister(X86Register_Eax);
+        ClearRegister(X86Register_Ecx);
+        ClearRegister(X86Register_Esi);
+        ClearRegister(X86Register_Edi);
+        return;
+    }
+
+    switch (opcode)
+    {
+        case 0x60: // pusha
+            AdjustStack(-32);
+            return;
+        case 0x61: // popa
+            for (uint8_t r = 0; r < X86Register_Count; ++r)
+            {
+                if (r != X86Register_Esp)
+                    ClearRegister(r);
+            }
+            AdjustStack(32);
+            return;
+        case 0x68: // push imm
+        case 0x6a:
+            Push({X86Value::Constant, instruction.m_immediate});
+            return;
+        case 0x9c: // pushfd
+            Push(X86Value());
+            return;
+        case 0x9d: // popfd
+            AdjustStack(4);
+            return;
+        case 0x8f: { // pop r/m
+            const X86Value value = m_espKnown ? GetStackValue(m_espOffset) : X86Value();
+            AdjustStack(4);
+            if (registerOperand)
+                SetRegister(rm, value);
+            return;
+        }
+        case 0x69: // imul r,r/m,imm
+        case 0x6b:
+        case 0xc4:
+        case 0xc5:
+            ClearRegister(reg);
+            return;
+        case 0x8a: // mov r8,r/m8
+            ClearByteRegister(reg);
+            return;
+        case 0x8b: // mov r,r/m
+            if (registerOperand)
+            {
+                if (reg == X86Register_Ebp && rm == X86Register_Esp)
+                {
+                    SetRegister(reg, X86Value());
+                    m_ebpKnown = m_espKnown;
+                    m_ebpOffset = m_espOffset;
+                }
+                else if (reg == X86Register_Esp && rm == X86Register_Ebp)
+                {
+                    m_espKnown = m_ebpKnown;
+                    m_espOffset = m_ebpOffset;
+                }
+                else
+                {
+                    SetRegister(reg, m_registers[rm]);
+                }
+            }
+            else
+            {
+                SetRegister(reg, GetMemoryValue(instruction));
+            }
+            return;
+        case 0x89: // mov r/m,r
+            if (registerOperand)
+            {
+                if (rm == X86Register_Ebp && reg == X86Register_Esp)
+                {
+                    SetRegister(rm, X86Value());
+                    m_ebpKnown = m_espKnown;
+                    m_ebpOffset = m_espOffset;
+                }
+                else if (rm == X86Register_Esp && reg == X86Register_Ebp)
+                {
+                    m_espKnown = m_ebpKnown;
+                    m_espOffset = m_ebpOffset;
+                }
+                else
+                {
+                    SetRegister(rm, m_registers[reg]);
+                }
+            }
+            return;
+        case 0x8d: // lea
+            if (reg == X86Register_Esp && instruction.HasBaseDisplacementOperand()
+                && instruction.m_baseRegister == X86Register_Ebp && m_ebpKnown)
+            {
+                m_espKnown = true;
+                m_espOffset = m_ebpOffset + instruction.m_displacement;
+                return;
+            }
+            if (instruction.HasBaseDisplacementOperand()
+                && m_registers[instruction.m_baseRegister].m_kind == X86Value::Constant)
+            {
+                const uint32_t value =
+                    m_registers[instruction.m_baseRegister].m_value + instruction.m_displacement;
+                SetRegister(reg, {X86Value::Constant, value});
+                return;
+            }
+            if (instruction.m_baseRegister == X86Register_None && instruction.m_indexRegister == X86Register_None)
+            {
+                SetRegister(reg, {X86Value::Constant, static_cast<uint32_t>(instruction.m_displacement)});
+                return;
+            }
+            ClearRegister(reg);
+            return;
+        case 0x81: // Arithmetic with immediate.
+        case 0x83:
+            if (registerOperand && rm == X86Register_Esp && m_espKnown && (reg == 0 || reg == 5))
+            {
+                const int32_t delta = static_cast<int32_t>(instruction.m_immediate);
+                AdjustStack(reg == 0 ? delta : -delta);
+                return;
+            }
+            if (registerOperand && reg == 0 && m_registers[rm].m_kind == X86Value::Constant)
+            {
+                m_registers[rm].m_value += instruction.m_immediate;
+                return;
+            }
+            if (registerOperand && reg != 7)
+                ClearRegister(rm);
+            return;
+        case 0x80:
+        case 0x82:
+            if (registerOperand && reg != 7)
+                ClearByteRegister(rm);
+            return;
+        case 0x86: // xchg
+            ClearByteRegister(reg);
+            if (registerOperand)
+                ClearByteRegister(rm);
+            return;
+        case 0x87:
+            ClearRegister(reg);
+            if (registerOperand)
+                ClearRegister(rm);
+            return;
+        case 0x88:
+        case 0xc6:
+            if (registerOperand)
+                ClearByteRegister(rm);
+            return;
+        case 0xc7: // mov r/m,imm32
+            if (registerOperand)
+                SetRegister(rm, {X86Value::Constant, instruction.m_immediate});
+            return;
+        case 0xc0: // shift
+        case 0xd0:
+        case 0xd2:
+            if (registerOperand)
+                ClearByteRegister(rm);
+            return;
+        case 0xc1:
+        case 0xd1:
+        case 0xd3:
+            if (registerOperand)
+                ClearRegister(rm);
+            return;
+        case 0xf6: // not, neg, mul, imul, div, idiv. Byte multiplies and divides only write ax.
+            if (reg >= 4)
+            {
+                ClearRegister(X86Register_Eax);
+            }
+            else if (registerOperand && reg >= 2)
+            {
+                ClearByteRegister(rm);
+            }
+            return;
+        case 0xf7:
+            if (reg >= 4)
+            {
+                ClearRegister(X86Register_Eax);
+                ClearRegister(X86Register_Edx);
+            }
+            else if (registerOperand && reg >= 2)
+            {
+                ClearRegister(rm);
+            }
+            return;
+        case 0xfe: // inc, dec
+            if (registerOperand && reg <= 1)
+                ClearByteRegister(rm);
+            return;
+        case 0xff:
+            if (registerOperand && reg <= 1)
+            {
+                ClearRegister(rm);
+            }
+            else if (reg == 2 || reg == 3) // call
+            {
+                ClearRegister(X86Register_Eax);
+                ClearRegister(X86Register_Ecx);
+                ClearRegister(X86Register_Edx);
+            }
+            else if (reg == 6) // push
+            {
+                Push(GetMemoryValue(instruction));
+            }
+            return;
+        case 0xe8: // call
+            if (instruction.m_displacement == 0)
+            {
+                // call $+5 and pop loads the address of the pop for position independent code.
+                m_picRegisterPending = true;
+                m_picAddress = static_cast<uint32_t>(address + instruction.m_length);
+                AdjustStack(-4);
+                return;
+            }
+            ClearRegister(X86Register_Eax);
+            ClearRegister(X86Register_Ecx);
+            ClearRegister(X86Register_Edx);
+            return;
+        case 0x98: // cwde
+        case 0xa1:
+            ClearRegister(X86Register_Eax);
+            return;
+        case 0x9f: // lahf
+        case 0xa0: // mov al,moffs8
+        case 0xd7: // xlat
+            ClearByteRegister(X86Register_Eax);
+            return;
+        case 0x99: // cdq
+            ClearRegister(X86Register_Edx);
+            return;
+        case 0xc8: // enter
+            AdjustStack(-4);
+            m_registers[X86Register_Ebp] = X86Value();
+            m_ebpKnown = m_espKnown;
+            m_ebpOffset = m_espOffset;
+            AdjustStack(-static_cast<int32_t>(instruction.m_immediate));
+            return;
+        case 0xc9: // leave
+            m_espKnown = m_ebpKnown;
+            m_espOffset = m_ebpOffset + 4;
+            ClearRegister(X86Register_Ebp);
+            return;
+    }
+}
+
+bool X86ValueTracker::GetStackSlot(const X86Instruction &instruction, int32_t &offset) const
+{
+    if (!instruction.HasBaseDisplacementOperand())
+        return false;
+
+    if (instruction.m_baseRegister == X86Register_Esp && m_espKnown)
+    {
+        offset = m_espOffset + instruction.m_displacement;
+        return true;
+    }
+    if (instruction.m_baseRegister == X86Register_Ebp && m_ebpKnown)
+    {
+        offset = m_ebpOffset + instruction.m_displacement;
+        return true;
+    }
+    return false;
+}
+
+X86Value X86ValueTracker::GetStackValue(int32_t offset) const
+{
+    for (uint32_t i = 0; i < m_stackSlotCount; ++i)
+    {
+        if (m_stackSlots[i].m_offset == offset)
+            return m_stackSlots[i].m_value;
+    }
+    return X86Value();
+}
+
+void X86ValueTracker::SetStackValue(int32_t offset, const X86Value &value)
+{
+    for (uint32_t i = 0; i < m_stackSlotCount; ++i)
+    {
+        if (m_stackSlots[i].m_offset == offset)
+        {
+            if (value.m_kind != X86Value::Unknown)
+                m_stackSlots[i].m_value = value;
+            else
+                m_stackSlots[i] = m_stackSlots[--m_stackSlotCount];
+            return;
+        }
+    }
+
+    if (value.m_kind == X86Value::Unknown)
+        return;
+
+    uint32_t i = m_stackSlotCount;
+    if (m_stackSlotCount < MaxStackSlots)
+    {
+        ++m_stackSlotCount;
+    }
+    else
+    {
+        // Incoming arguments above the return address, such as this, are pinned. Locals and outgoing arguments are
+        // replaced round robin. If all slots are arguments, the next slot is replaced.
+        i = m_nextEvictedSlot;
+        for (uint32_t attempt = 0; attempt < MaxStackSlots; ++attempt)
+        {
+            const uint32_t slot = (m_nextEvictedSlot + attempt) % MaxStackSlots;
+            if (m_stackSlots[slot].m_offset <= 0)
+            {
+                i = slot;
+                break;
+            }
+        }
+        m_nextEvictedSlot = (i + 1) % MaxStackSlots;
+    }
+    m_stackSlots[i].m_offset = offset;
+    m_stackSlots[i].m_value = value;
+}
+
+void X86ValueTracker::ClearRegister(uint8_t reg)
+{
+    m_registers[reg] = X86Value();
+    if (reg == X86Register_Esp)
+        m_espKnown = false;
+    else if (reg == X86Register_Ebp)
+        m_ebpKnown = false;
+}
+
+void X86ValueTracker::ClearByteRegister(uint8_t reg)
+{
+    // Byte registers 4 to 7 are ah, ch, dh and bh, which are parts of eax to ebx.
+    ClearRegister(reg & 3);
+}
+
+void X86ValueTracker::AdjustStack(int32_t delta)
+{
+    if (!m_espKnown)
+        return;
+
+    m_espOffset += delta;
+
+    // Pushed values overwrite slots, popped slots are free.
+    const int32_t end = delta < 0 ? m_espOffset - delta : m_espOffset;
+    const int32_t begin = delta < 0 ? m_espOffset : m_espOffset - delta;
+    for (uint32_t i = 0; i < m_stackSlotCount;)
+    {
+        if (m_stackSlots[i].m_offset >= begin && m_stackSlots[i].m_offset < end)
+            m_stackSlots[i] = m_stackSlots[--m_stackSlotCount];
+        else
+            ++i;
+    }
+}
+
+void X86ValueTracker::Push(const X86Value &value)
+{
+    AdjustStack(-4);
+    if (m_espKnown)
+        SetStackValue(m_espOffset, value);
+}
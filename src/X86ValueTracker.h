@@ -0,0 +1,77 @@
+#pragma once
+
+#include "X86Decoder.h"
+
+#include <cstdint>
+
+struct X86Value
+{
+    enum Kind : uint8_t
+    {
+        Unknown,
+        This, // The this pointer of the analyzed member function.
+        Constant,
+        NewObject, // Return value of operator new. m_value is the allocation size.
+    };
+
+    Kind m_kind = Unknown;
+    uint32_t m_value = 0;
+};
+
+// Follows the values of registers and stack slots through a linear decode of one i386 function. Knows the this
+// pointer in its cdecl argument slot, constants from immediates, lea and position independent code
+// bases (call $+5, pop), and moves between registers and stack slots. Stack slots are addressed relative to esp at
+// function entry, through esp or an ebp frame. Calls clobber the cdecl scratch registers. Branches are not followed,
+// so values flow from one instruction to the next in address order.
+class X86ValueTracker
+{
+public:
+    // Starts a function. Puts this into the argument slot at [esp+thisOffset] if the function has one. this is the
+    // first argument at [esp+4], or the second at [esp+8] if the function returns a class through a hidden pointer.
+    void Reset(bool hasThis, int32_t thisOffset = 4);
+    // Forgets all register values, such as after bytes that could not be decoded.
+    void ClearRegisters();
+
+    // Updates the registers, the stack frame and the stack slots after the instruction at the address.
+    void Track(const X86Instruction &instruction, uint64_t address);
+
+    const X86Value &GetRegister(uint8_t reg) const { return m_registers[reg]; }
+    void SetRegister(uint8_t reg, const X86Value &value);
+    // Value of the memory operand, if it is a tracked stack slot.
+    X86Value GetMemoryValue(const X86Instruction &instruction) const;
+    // Value of the outgoing cdecl argument at [esp+4*argumentIndex], for the call at the current instruction.
+    X86Value GetArgument(uint32_t argumentIndex) const;
+    // Value the instruction stores into its memory operand: a register or an immediate.
+    X86Value GetStoredValue(const X86Instruction &instruction) const;
+
+private:
+    static constexpr uint32_t MaxStackSlots = 8;
+
+    struct StackSlot
+    {
+        int32_t m_offset = 0; // Relative to esp at function entry.
+        X86Value m_value;
+    };
+
+    // Returns the stack slot of an esp or ebp relative memory operand.
+    bool GetStackSlot(const X86Instruction &instruction, int32_t &offset) const;
+    X86Value GetStackValue(int32_t offset) const;
+    void SetStackValue(int32_t offset, const X86Value &value);
+    void ClearRegister(uint8_t reg);
+    // Clears the register that contains the byte register of a ModRM or opcode register field.
+    void ClearByteRegister(uint8_t reg);
+    void AdjustStack(int32_t delta);
+    void Push(const X86Value &value);
+
+private:
+    X86Value m_registers[X86Register_Count];
+    bool m_espKnown = true;
+    bool m_ebpKnown = false;
+    int32_t m_espOffset = 0; // Relative to esp at function entry.
+    int32_t m_ebpOffset = 0;
+    StackSlot m_stackSlots[MaxStackSlots]; // Known slots. Unknown values are not stored.
+    uint32_t m_stackSlotCount = 0;
+    uint32_t m_nextEvictedSlot = 0; // Round robin replacement of local slots if all slots are used.
+    bool m_picRegisterPending = false; // Previous instruction was call $+5, the next pop loads its address.
+    uint32_t m_picAddress = 0;
+};
@@ -137,3 +137,259 @@ std::string itanium_demangle(std::string_view mangled) {
     std::free(demangled);
     return ret;
 }
+
+namespace {
+using llvm::itanium_demangle::Node;
+using llvm::itanium_demangle::OutputStream;
+
+struct output_range {
+    size_t offset;
+    size_t size;
+};
+
+// Per-thread state of itanium_demangle_function.
+struct function_demangle_arena {
+    llvm::itanium_demangle::ManglingParser<DefaultAllocator> parser{nullptr, nullptr};
+    char *buffer = nullptr;
+    size_t capacity = 0;
+    std::vector<output_range> parameter_ranges;
+    std::vector<output_range> parameter_base_ranges;
+
+    ~function_demangle_arena() { std::free(buffer); }
+};
+
+thread_local function_demangle_arena arena;
+
+output_range print_node(const Node *node, OutputStream &S) {
+    const size_t begin = S.getCurrentPosition();
+    node->print(S);
+    return {begin, S.getCurrentPosition() - begin};
+}
+
+// Same as llvm::ItaniumPartialDemangler::getFunctionBaseName
+const Node *get_base_name(const Node *name) {
+    while (true) {
+        switch (name->getKind()) {
+        case Node::KAbiTagAttr:
+            name = static_cast<const llvm::itanium_demangle::AbiTagAttr *>(name)->Base;
+            continue;
+        case Node::KStdQualifiedName:
+            name = static_cast<const llvm::itanium_demangle::StdQualifiedName *>(name)->Child;
+            continue;
+        case Node::KNestedName:
+            name = static_cast<const llvm::itanium_demangle::NestedName *>(name)->Name;
+            continue;
+        case Node::KLocalName:
+            name = static_cast<const llvm::itanium_demangle::LocalName *>(name)->Entity;
+            continue;
+        case Node::KNameWithTemplateArgs:
+            name = static_cast<const llvm::itanium_demangle::NameWithTemplateArgs *>(name)->Name;
+            continue;
+        default:
+            return name;
+        }
+    }
+}
+
+// Same as llvm::ItaniumPartialDemangler::getFunctionDeclContextName
+output_range print_decl_context_name(const Node *name, OutputStream &S) {
+    const size_t begin = S.getCurrentPosition();
+    while (true) {
+        while (true) {
+            if (name->getKind() == Node::KAbiTagAttr) {
+                name = static_cast<const llvm::itanium_demangle::AbiTagAttr *>(name)->Base;
+                continue;
+            }
+            if (name->getKind() == Node::KNameWithTemplateArgs) {
+                name = static_cast<const llvm::itanium_demangle::NameWithTemplateArgs *>(name)->Name;
+                continue;
+            }
+            break;
+        }
+
+        switch (name->getKind()) {
+        case Node::KStdQualifiedName:
+            S += "std";
+            break;
+        case Node::KNestedName:
+            static_cast<const llvm::itanium_demangle::NestedName *>(name)->Qual->print(S);
+            break;
+        case Node::KLocalName: {
+            auto *local_name = static_cast<const llvm::itanium_demangle::LocalName *>(name);
+            local_name->Encoding->print(S);
+            S += "::";
+            name = local_name->Entity;
+            continue;
+        }
+        default:
+            break;
+        }
+        return {begin, S.getCurrentPosition() - begin};
+    }
+}
+
+// Strips pointers, references, cv qualifiers and arrays from a type. "Foo const* (&)[2]" becomes "Foo".
+const Node *get_base_type(const Node *type) {
+    while (true) {
+        const Node *inner = nullptr;
+        auto first = [&inner](const Node *node, auto &&...) { inner = node; };
+        switch (type->getKind()) {
+        case Node::KPointerType:
+            static_cast<const llvm::itanium_demangle::PointerType *>(type)->match(first);
+            break;
+        case Node::KReferenceType:
+            static_cast<const llvm::itanium_demangle::ReferenceType *>(type)->match(first);
+            break;
+        case Node::KQualType:
+            static_cast<const llvm::itanium_demangle::QualType *>(type)->match(first);
+            break;
+        case Node::KArrayType:
+            static_cast<const llvm::itanium_demangle::ArrayType *>(type)->match(first);
+            break;
+        default:
+            return type;
+        }
+        if (inner == nullptr)
+            return type;
+        type = inner;
+    }
+}
+
+// Same as llvm::ItaniumPartialDemangler::isCtorOrDtor
+bool is_ctor_or_dtor(const Node *node) {
+    while (node) {
+        switch (node->getKind()) {
+        default:
+            return false;
+        case Node::KCtorDtorName:
+            return true;
+        case Node::KAbiTagAttr:
+            node = static_cast<const llvm::itanium_demangle::AbiTagAttr *>(node)->Base;
+            break;
+        case Node::KFunctionEncoding:
+            node = static_cast<const llvm::itanium_demangle::FunctionEncoding *>(node)->getName();
+            break;
+        case Node::KLocalName:
+            node = static_cast<const llvm::itanium_demangle::LocalName *>(node)->Entity;
+            break;
+        case Node::KNameWithTemplateArgs:
+            node = static_cast<const llvm::itanium_demangle::NameWithTemplateArgs *>(node)->Name;
+            break;
+        case Node::KNestedName:
+            node = static_cast<const llvm::itanium_demangle::NestedName *>(node)->Name;
+            break;
+        case Node::KStdQualifiedName:
+            node = static_cast<const llvm::itanium_demangle::StdQualifiedName *>(node)->Child;
+            break;
+        }
+    }
+    return false;
+}
+}  // unnamed namespace
+
+static bool demangle_function(std::string_view mangled, itanium_function_parts &parts, bool scope_only) {
+    parts.name = {};
+    parts.base_name = {};
+    parts.decl_context_name = {};
+    parts.function_name = {};
+    parts.parameters = {};
+    parts.return_type = {};
+    parts.parameter_types.clear();
+    parts.parameter_base_types.clear();
+    parts.is_function = false;
+    parts.is_ctor_or_dtor = false;
+    parts.is_const = false;
+
+    if (mangled.empty())
+        return false;
+
+    // Frees the node blocks of the previous name, except the first block, which is inline in the parser.
+    arena.parser.reset(mangled.data(), mangled.data() + mangled.size());
+    const Node *root = arena.parser.parse();
+    if (root == nullptr)
+        return false;
+
+    OutputStream S;
+    if (!llvm::itanium_demangle::initializeOutputStream(arena.buffer, &arena.capacity, S, 1024))
+        return false;
+
+    output_range name{0, 0};
+    if (!scope_only)
+        name = print_node(root, S);
+    output_range base_name{0, 0};
+    output_range decl_context_name{0, 0};
+    output_range function_name{0, 0};
+    output_range parameters{0, 0};
+    output_range return_type{0, 0};
+    arena.parameter_ranges.clear();
+    arena.parameter_base_ranges.clear();
+
+    parts.is_function = root->getKind() == Node::KFunctionEncoding;
+    parts.is_ctor_or_dtor = is_ctor_or_dtor(root);
+
+    if (parts.is_function) {
+        auto *encoding = static_cast<const llvm::itanium_demangle::FunctionEncoding *>(root);
+        base_name = print_node(get_base_name(encoding->getName()), S);
+        decl_context_name = print_decl_context_name(encoding->getName(), S);
+        function_name = print_node(encoding->getName(), S);
+
+        if (!scope_only) {
+            const size_t parameters_begin = S.getCurrentPosition();
+            S += '(';
+            encoding->getParams().printWithComma(S);
+            S += ')';
+            parameters = {parameters_begin, S.getCurrentPosition() - parameters_begin};
+        }
+
+        // Empty parameter pack expansions print nothing and are not parameters.
+        for (const Node *parameter : encoding->getParams()) {
+            const Node *base_type = get_base_type(parameter);
+            if (scope_only) {
+                const output_range base_range = print_node(base_type, S);
+                if (base_range.size != 0)
+                    arena.parameter_base_ranges.push_back(base_range);
+                continue;
+            }
+            const output_range range = print_node(parameter, S);
+            if (range.size == 0)
+                continue;
+            arena.parameter_ranges.push_back(range);
+            arena.parameter_base_ranges.push_back(base_type == parameter ? range : print_node(base_type, S));
+        }
+
+        if (!scope_only) {
+            if (const Node *ret = encoding->getReturnType())
+                return_type = print_node(ret, S);
+        }
+
+        parts.is_const = (encoding->getCVQuals() & llvm::itanium_demangle::QualConst) != 0;
+    }
+
+    // The buffer may have moved while printing. Views are made at the end.
+    arena.buffer = S.getBuffer();
+    arena.capacity = S.getBufferCapacity();
+
+    auto view = [](output_range range) { return std::string_view(arena.buffer + range.offset, range.size); };
+    parts.name = view(name);
+    parts.base_name = view(base_name);
+    parts.decl_context_name = view(decl_context_name);
+    parts.function_name = view(function_name);
+    parts.parameters = view(parameters);
+    parts.return_type = view(return_type);
+    parts.parameter_types.reserve(arena.parameter_ranges.size());
+    for (const output_range &range : arena.parameter_ranges)
+        parts.parameter_types.push_back(view(range));
+    parts.parameter_base_types.reserve(arena.parameter_base_ranges.size());
+    for (const output_range &range : arena.parameter_base_ranges)
+        parts.parameter_base_types.push_back(view(range));
+
+    return true;
+}
+
+bool itanium_demangle_function(std::string_view mangled, itanium_function_parts &parts) {
+    return demangle_function(mangled, parts, false);
+}
+
+bool itanium_demangle_function_scope(std::string_view mangled, itanium_function_parts &parts) {
+    return demangle_function(mangled, parts, true);
+}
@@ -1,5 +1,32 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 std::string itanium_demangle(std::string_view mangled);
+
+// Parts of a demangled name, as llvm::ItaniumPartialDemangler reports them. All views point into one output buffer of
+// the calling thread and are valid until the next call to itanium_demangle_function on the same thread.
+struct itanium_function_parts {
+    std::string_view name; // The entire demangled name.
+    std::string_view base_name; // Does not include trailing template arguments.
+    std::string_view decl_context_name; // For "a::b::c", this becomes "a::b".
+    std::string_view function_name;
+    std::string_view parameters; // "(int, char const*)"
+    std::string_view return_type;
+    std::vector<std::string_view> parameter_types; // Printed from the parameter nodes.
+    std::vector<std::string_view> parameter_base_types; // Parameter types without pointers, references, cv and arrays.
+    bool is_function = false; // All fields except name are empty if this is not a function.
+    bool is_ctor_or_dtor = false;
+    bool is_const = false;
+};
+
+// Parses the mangled name once and prints all parts into one per-thread buffer, which is kept between calls. Nodes are
+// allocated by a per-thread parser, which keeps only its first block between calls. Returns false if the name is not an
+// Itanium mangled name.
+bool itanium_demangle_function(std::string_view mangled, itanium_function_parts &parts);
+
+// Prints only base_name, decl_context_name, function_name and parameter_base_types, and sets the flags. The other
+// fields are empty. Used to build the class model without printing the full names.
+bool itanium_demangle_function_scope(std::string_view mangled, itanium_function_parts &parts);
@@ -1,12 +1,341 @@
-
+#include "BreakpadSymbolWriter.h"
+#include "FunctionMatcher.h"
+#include "FunctionMatcherImage.h"
 #include "MachOReader.h"
+#include "ModelDiff.h"
+#include "ModelFormatWriter.h"
+#include "QueryServer.h"
+#include "ThreadPool.h"
+#include "llvm/demangle.h"
 
-int main(int argc, char **argv)
+#include <cxxopts.hpp>
+#include <fmt/core.h>
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+constexpr LIEF::MachO::Header::CPU_TYPE CpuType = LIEF::MachO::Header::CPU_TYPE::X86;
+
+QueryServer *s_queryServer = nullptr;
+
+void StopQueryServer(int)
+{
+    if (s_queryServer != nullptr)
+        s_queryServer->Stop();
+}
+
+int Load(const std::string &filepath, const MachOReaderOptions &readerOptions)
 {
-    MachOReader machOReader;
-    // TODO: Make it configurable.
-    if (!machOReader.Load("zh", LIEF::MachO::Header::CPU_TYPE::X86))
+    MachOReader machOReader(readerOptions);
+    if (!machOReader.Load(filepath, CpuType))
         return 1;
 
     return 0;
 }
+
+int Includes(const std::string &filepath, size_t count, const MachOReaderOptions &readerOptions)
+{
+    MachOReader machOReader(readerOptions);
+    if (!machOReader.Load(filepath, CpuType))
+    {
+        fmt::print(stderr, "Failed to load '{}'\n", filepath);
+        return 1;
+    }
+
+    const IncludeGraph &includeGraph = machOReader.GetIncludeGraph();
+    const HeaderFiles &headerFiles = machOReader.GetHeaderFiles();
+
+    fmt::print("Header files by translation units:\n");
+    for (index_t headerFileIndex : includeGraph.GetHeaderFilesByTranslationUnitCount(count))
+    {
+        fmt::print(
+            "{:8} {:10} {}\n",
+            includeGraph.GetTranslationUnitCount(headerFileIndex),
+            includeGraph.GetCodeSize(headerFileIndex),
+            headerFiles[headerFileIndex].m_name);
+    }
+
+    fmt::print("Header files by code bytes:\n");
+    for (index_t headerFileIndex : includeGraph.GetHeaderFilesByCodeSize(count))
+    {
+        fmt::print(
+            "{:8} {:10} {}\n",
+            includeGraph.GetTranslationUnitCount(headerFileIndex),
+            includeGraph.GetCodeSize(headerFileIndex),
+            headerFiles[headerFileIndex].m_name);
+    }
+    return 0;
+}
+
+int ExportBreakpad(const std::string &filepath, std::string outputPath, const MachOReaderOptions &readerOptions)
+{
+    MachOReader machOReader(readerOptions);
+    if (!machOReader.Load(filepath, CpuType))
+    {
+        fmt::print(stderr, "Failed to load '{}'\n", filepath);
+        return 1;
+    }
+
+    const std::string moduleName = std::filesystem::path(filepath).filename().string();
+    if (outputPath.empty())
+    {
+        outputPath = moduleName + ".sym";
+    }
+
+    std::ofstream stream(outputPath, std::ios::binary);
+    BreakpadSymbolWriter writer(stream);
+    if (!stream || !writer.Write(machOReader, moduleName))
+    {
+        fmt::print(stderr, "Failed to write '{}'\n", outputPath);
+        return 1;
+    }
+    return 0;
+}
+
+int ExportModel(const std::string &filepath, std::string outputPath, const MachOReaderOptions &readerOptions)
+{
+    MachOReader machOReader(readerOptions);
+    if (!machOReader.Load(filepath, CpuType))
+    {
+        fmt::print(stderr, "Failed to load '{}'\n", filepath);
+        return 1;
+    }
+
+    if (outputPath.empty())
+    {
+        outputPath = std::filesystem::path(filepath).filename().string() + ".model";
+    }
+
+    std::ofstream stream(outputPath, std::ios::binary);
+    ModelFormatWriter writer;
+    if (!stream || !writer.Write(machOReader, stream))
+    {
+        fmt::print(stderr, "Failed to write '{}'\n", outputPath);
+        return 1;
+    }
+    return 0;
+}
+
+int Diff(const std::string &filepath1, const std::string &filepath2, const MachOReaderOptions &readerOptions)
+{
+    MachOReader machOReader1(readerOptions);
+    MachOReader machOReader2(readerOptions);
+    MachOReader *machOReaders[] = {&machOReader1, &machOReader2};
+    const std::string *filepaths[] = {&filepath1, &filepath2};
+    ModelDiff::ModelSignatures signatures[2];
+    bool loaded[2] = {false, false};
+
+    // Both builds are loaded and signed in parallel.
+    {
+        ThreadPool threadPool(2);
+        threadPool.ParallelFor(2, [&](size_t index) {
+            loaded[index] = machOReaders[index]->Load(*filepaths[index], CpuType);
+            if (loaded[index])
+            {
+                ModelDiff::ComputeSignatures(*machOReaders[index], signatures[index]);
+            }
+        });
+    }
+
+    for (size_t index = 0; index < 2; ++index)
+    {
+        if (!loaded[index])
+        {
+            fmt::print(stderr, "Failed to load '{}'\n", *filepaths[index]);
+            return 1;
+        }
+    }
+
+    ModelDiff modelDiff;
+    modelDiff.Compare(machOReader1, signatures[0], machOReader2, signatures[1]);
+    modelDiff.Print();
+    return 0;
+}
+
+const char *GetMatchKindName(FunctionMatcher::MatchKind kind)
+{
+    switch (kind)
+    {
+        case FunctionMatcher::MatchKind::Exact:
+            return "exact";
+        case FunctionMatcher::MatchKind::Code:
+            return "code";
+        case FunctionMatcher::MatchKind::Structure:
+            return "structure";
+    }
+    return "";
+}
+
+int Match(const std::string &filepath1, const std::string &filepath2, const MachOReaderOptions &readerOptions)
+{
+    MachOReader machOReader1(readerOptions);
+    MachOReader machOReader2(readerOptions);
+    MachOReader *machOReaders[] = {&machOReader1, &machOReader2};
+    const std::string *filepaths[] = {&filepath1, &filepath2};
+    FunctionMatcherImage images[2];
+    FunctionFingerprints fingerprints[2];
+    bool loaded[2] = {false, false};
+
+    // Both builds are loaded and fingerprinted in parallel.
+    {
+        ThreadPool threadPool(2);
+        threadPool.ParallelFor(2, [&](size_t index) {
+            MachOReader &machOReader = *machOReaders[index];
+            loaded[index] = machOReader.Load(*filepaths[index], CpuType)
+                && images[index].Read(machOReader.GetBinary(), machOReader.GetFunctions());
+            if (loaded[index])
+            {
+                FunctionMatcher::ComputeFingerprints(images[index], machOReader.GetThreadPool(), fingerprints[index]);
+            }
+        });
+    }
+
+    for (size_t index = 0; index < 2; ++index)
+    {
+        if (!loaded[index])
+        {
+            fmt::print(stderr, "Failed to load '{}'\n", *filepaths[index]);
+            return 1;
+        }
+    }
+
+    FunctionMatcher::Matches matches;
+    FunctionMatcher::MatchFunctions(fingerprints[0], fingerprints[1], matches);
+
+    for (const FunctionMatcher::Match &match : matches)
+    {
+        const FunctionMatcherImage::FunctionStart &functionStart1 = images[0].m_functionStarts[match.m_functionIndex1];
+        const FunctionMatcherImage::FunctionStart &functionStart2 = images[1].m_functionStarts[match.m_functionIndex2];
+        const std::string_view name = functionStart1.m_name.empty() ? functionStart2.m_name : functionStart1.m_name;
+        fmt::print(
+            "{:08x} {:08x} {:9} {}\n",
+            functionStart1.m_address,
+            functionStart2.m_address,
+            GetMatchKindName(match.m_kind),
+            name.empty() ? std::string("?") : itanium_demangle(name));
+    }
+    fmt::print(
+        "Matched {} of {} and {} functions\n",
+        matches.size(),
+        images[0].m_functionStarts.size(),
+        images[1].m_functionStarts.size());
+    return 0;
+}
+
+int Serve(const std::vector<std::string> &filepaths, const QueryServerOptions &options)
+{
+    QueryServer queryServer(options);
+    for (const std::string &filepath : filepaths)
+    {
+        if (!queryServer.AddModel(filepath))
+        {
+            fmt::print(stderr, "Failed to load '{}'\n", filepath);
+            return 1;
+        }
+    }
+
+    s_queryServer = &queryServer;
+    std::signal(SIGINT, StopQueryServer);
+    std::signal(SIGTERM, StopQueryServer);
+
+    fmt::print(stderr, "Serving {} model(s) on '{}'\n", filepaths.size(), options.m_socketPath);
+    const bool served = queryServer.Run();
+    s_queryServer = nullptr;
+    if (!served)
+    {
+        fmt::print(stderr, "Failed to listen on '{}'\n", options.m_socketPath);
+        return 1;
+    }
+    return 0;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    cxxopts::Options options("MachOCodeGen", "Reads C++ types and functions from Mach-O binaries with STABS.");
+    options.add_options()
+        ("command", "load, includes, breakpad, export, diff, match or serve", cxxopts::value<std::string>()->default_value("load"))
+        ("files", "Binaries", cxxopts::value<std::vector<std::string>>())
+        ("output", "Output path of breakpad and export", cxxopts::value<std::string>()->default_value(""))
+        ("count", "Number of header files that includes lists", cxxopts::value<size_t>()->default_value("20"))
+        ("socket", "Unix socket path of serve", cxxopts::value<std::string>()->default_value("MachOCodeGen.sock"))
+        ("threads", "Worker threads, 0 for all hardware threads", cxxopts::value<size_t>()->default_value("0"))
+        ("follow-object-files", "Read the stabs from the N_OSO object files of a debug map binary")
+        ("lazy-demangling", "Demangle function names when first accessed instead of during load")
+        ("find-identical-code", "Hash the code of all functions to find identical copies")
+        ("reload", "Seconds between reload checks of serve, 0 to disable", cxxopts::value<uint32_t>()->default_value("2"))
+        ("h,help", "Prints usage");
+    options.parse_positional({"command", "files"});
+    options.positional_help(
+        "[load <binary> | includes <binary> | breakpad <binary> | export <binary> | diff <binary1> <binary2> | "
+        "match <binary1> <binary2> | serve <binary>...]");
+
+    try
+    {
+        const cxxopts::ParseResult result = options.parse(argc, argv);
+        if (result.count("help"))
+        {
+            fmt::print("{}\n", options.help());
+            return 0;
+        }
+
+        std::vector<std::string> files;
+        if (result.count("files"))
+        {
+            files = result["files"].as<std::vector<std::string>>();
+        }
+
+        MachOReaderOptions readerOptions;
+        readerOptions.m_threadCount = result["threads"].as<size_t>();
+        readerOptions.m_followObjectFiles = result["follow-object-files"].as<bool>();
+        readerOptions.m_lazyDemangling = result["lazy-demangling"].as<bool>();
+        readerOptions.m_findIdenticalCode = result["find-identical-code"].as<bool>();
+
+        const std::string &command = result["command"].as<std::string>();
+        if (command == "load" && files.size() == 1)
+        {
+            return Load(files[0], readerOptions);
+        }
+        if (command == "includes" && files.size() == 1)
+        {
+            return Includes(files[0], result["count"].as<size_t>(), readerOptions);
+        }
+        if (command == "breakpad" && files.size() == 1)
+        {
+            return ExportBreakpad(files[0], result["output"].as<std::string>(), readerOptions);
+        }
+        if (command == "export" && files.size() == 1)
+        {
+            return ExportModel(files[0], result["output"].as<std::string>(), readerOptions);
+        }
+        if (command == "diff" && files.size() == 2)
+        {
+            return Diff(files[0], files[1], readerOptions);
+        }
+        if (command == "match" && files.size() == 2)
+        {
+            return Match(files[0], files[1], readerOptions);
+        }
+        if (command == "serve" && !files.empty())
+        {
+            QueryServerOptions serverOptions;
+            serverOptions.m_socketPath = result["socket"].as<std::string>();
+            serverOptions.m_threadCount = result["threads"].as<size_t>();
+            serverOptions.m_reloadIntervalSeconds = result["reload"].as<uint32_t>();
+            serverOptions.m_cpuType = CpuType;
+            serverOptions.m_readerOptions = readerOptions;
+            return Serve(files, serverOptions);
+        }
+    }
+    catch (const cxxopts::exceptions::exception &e)
+    {
+        fmt::print(stderr, "{}\n", e.what());
+        return 1;
+    }
+
+    fmt::print(stderr, "{}\n", options.help());
+    return 1;
+}
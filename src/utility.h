@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
 
 inline bool starts_with(std::string_view str, std::string_view prefix)
@@ -11,3 +12,8 @@ inline bool ends_with(std::string_view str, std::string_view suffix)
 {
     return str.size() >= suffix.size() && str.compare(str.size()-suffix.size(), suffix.size(), suffix) == 0;
 }
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value)
+{
+    return (seed ^ value) * 0x9e3779b97f4a7c15ull + (seed >> 29);
+}
@@ -0,0 +1,72 @@
+#include "Test.h"
+
+#include "ClassHierarchy.h"
+
+#include <vector>
+
+namespace
+{
+BaseClass MakeBaseClass(index_t classIndex, uint16_t baseOffset, bool isVirtual = false)
+{
+    BaseClass baseClass;
+    baseClass.m_classIndex = classIndex;
+    baseClass.m_baseOffset = baseOffset;
+    baseClass.m_isVirtual = isVirtual;
+    return baseClass;
+}
+
+std::vector<index_t> GetDerivedClasses(const ClassHierarchy &hierarchy, index_t baseClassIndex)
+{
+    std::vector<index_t> derivedClassIndices;
+    hierarchy.GetDerivedClasses(baseClassIndex, derivedClassIndices);
+    return derivedClassIndices;
+}
+
+std::vector<index_t> GetCommonBaseClasses(const ClassHierarchy &hierarchy, index_t classIndex1, index_t classIndex2)
+{
+    std::vector<index_t> baseClassIndices;
+    hierarchy.GetCommonBaseClasses(classIndex1, classIndex2, baseClassIndices);
+    return baseClassIndices;
+}
+} // namespace
+
+void TestClassHierarchy()
+{
+    // 0 Base, 1 A : Base, 2 B : A, 3 Mixin, 4 C : A, Mixin, 5 V : virtual Base, 6 D : C, 7 Unrelated.
+    // B has single inheritance only. C, V and D keep closure rows.
+    Classes classes(8);
+    classes[1].m_directBaseClasses = {MakeBaseClass(0, 0)};
+    classes[1].m_allBaseClasses = {MakeBaseClass(0, 0)};
+    classes[2].m_directBaseClasses = {MakeBaseClass(1, 0)};
+    classes[2].m_allBaseClasses = {MakeBaseClass(1, 0), MakeBaseClass(0, 0)};
+    classes[4].m_directBaseClasses = {MakeBaseClass(1, 0), MakeBaseClass(3, 8)};
+    classes[4].m_allBaseClasses = {MakeBaseClass(1, 0), MakeBaseClass(0, 0), MakeBaseClass(3, 8)};
+    classes[5].m_directBaseClasses = {MakeBaseClass(0, 4, true)};
+    classes[5].m_allBaseClasses = {MakeBaseClass(0, 4, true)};
+    classes[6].m_directBaseClasses = {MakeBaseClass(4, 0)};
+    classes[6].m_allBaseClasses = {MakeBaseClass(4, 0), MakeBaseClass(1, 0), MakeBaseClass(0, 0), MakeBaseClass(3, 8)};
+
+    ClassHierarchy hierarchy;
+    hierarchy.Build(classes);
+
+    TEST_CHECK(hierarchy.IsDerivedFrom(2, 0) && hierarchy.IsDerivedFrom(2, 1));
+    TEST_CHECK(!hierarchy.IsDerivedFrom(0, 2) && !hierarchy.IsDerivedFrom(0, 0));
+    TEST_CHECK(hierarchy.IsDerivedFrom(4, 3) && hierarchy.IsDerivedFrom(6, 3) && hierarchy.IsDerivedFrom(5, 0));
+    TEST_CHECK(!hierarchy.IsDerivedFrom(3, 0) && !hierarchy.IsDerivedFrom(7, 0) && !hierarchy.IsDerivedFrom(2, 3));
+
+    // Derived classes outside the tree of the first base class are found through the closure rows.
+    TEST_CHECK((GetDerivedClasses(hierarchy, 0) == std::vector<index_t>{1, 2, 4, 5, 6}));
+    TEST_CHECK((GetDerivedClasses(hierarchy, 1) == std::vector<index_t>{2, 4, 6}));
+    TEST_CHECK((GetDerivedClasses(hierarchy, 3) == std::vector<index_t>{4, 6}));
+    TEST_CHECK(GetDerivedClasses(hierarchy, 7).empty());
+
+    uint16_t baseOffset = 0;
+    TEST_CHECK(hierarchy.GetBaseOffset(6, 3, baseOffset) && baseOffset == 8);
+    TEST_CHECK(hierarchy.GetBaseOffset(5, 0, baseOffset) && baseOffset == 4);
+    TEST_CHECK(!hierarchy.GetBaseOffset(2, 3, baseOffset));
+
+    TEST_CHECK((GetCommonBaseClasses(hierarchy, 2, 6) == std::vector<index_t>{0, 1}));
+    TEST_CHECK((GetCommonBaseClasses(hierarchy, 6, 4) == std::vector<index_t>{0, 1, 3}));
+    TEST_CHECK((GetCommonBaseClasses(hierarchy, 4, 5) == std::vector<index_t>{0}));
+    TEST_CHECK(GetCommonBaseClasses(hierarchy, 2, 7).empty());
+}
@@ -0,0 +1,43 @@
+#include "Test.h"
+
+#include "DataAddressIndex.h"
+
+#include <vector>
+
+void TestDataAddressIndex()
+{
+    TEST_CHECK(DataAddressIndex::IsIndexedSection("__bss"));
+    TEST_CHECK(!DataAddressIndex::IsIndexedSection("__text"));
+
+    DataAddressIndex index;
+    index.AddSection("__DATA,__bss", 0x3000, 0x100);
+    index.AddSection("__DATA,__data", 0x2000, 0x100);
+    index.AddVariable(0x2010, 0, 1); // Unknown size, ends at the next variable.
+    index.AddVariable(0x2000, 4, 0);
+    index.AddVariable(0x2000, 8, 5); // Same address, the first one wins.
+    index.AddVariable(0x2020, 0x40, 2); // Too large, ends at the next variable.
+    index.AddVariable(0x2030, 0, 3); // Unknown size, ends at the end of the section.
+    index.AddVariable(0x30f0, 4, 4);
+    index.AddVariable(0x4000, 4, 6); // Outside of the sections.
+    index.Finalize();
+
+    TEST_CHECK(index.GetIntervalCount() == 5);
+    TEST_CHECK(index.GetSections().front().m_address == 0x2000);
+
+    TEST_CHECK(index.FindVariable(0x1fff) == InvalidIndex);
+    TEST_CHECK(index.FindVariable(0x2003) == 0);
+    TEST_CHECK(index.FindVariable(0x2004) == InvalidIndex);
+    TEST_CHECK(index.FindVariable(0x201f) == 1);
+    TEST_CHECK(index.FindVariable(0x202f) == 2);
+    TEST_CHECK(index.FindVariable(0x20ff) == 3);
+    TEST_CHECK(index.FindVariable(0x2100) == InvalidIndex);
+    TEST_CHECK(index.FindVariable(0x30f2) == 4);
+    TEST_CHECK(index.FindVariable(0x4000) == InvalidIndex);
+
+    // Batched lookups give the same results in any address order.
+    const std::vector<uint64_t> addresses = {0x2000, 0x2010, 0x2011, 0x2050, 0x30f3, 0x30f4, 0x2004, 0x2022};
+    const std::vector<index_t> expected = {0, 1, 1, 3, 4, InvalidIndex, InvalidIndex, 2};
+    std::vector<index_t> variableIndices(addresses.size());
+    index.FindVariables(addresses.data(), variableIndices.data(), addresses.size());
+    TEST_CHECK(variableIndices == expected);
+}
@@ -0,0 +1,79 @@
+#include "Test.h"
+
+#include "llvm/demangle.h"
+
+#include <string>
+
+void TestDemangler()
+{
+    TEST_CHECK(itanium_demangle("_ZN4Game6UpdateEf") == "Game::Update(float)");
+    TEST_CHECK(itanium_demangle("main") == "main");
+
+    itanium_function_parts parts;
+    TEST_CHECK(itanium_demangle_function("_ZNK2ns4Game7GetNameEv", parts));
+    TEST_CHECK(parts.is_function && parts.is_const && !parts.is_ctor_or_dtor);
+    TEST_CHECK(parts.name == "ns::Game::GetName() const");
+    TEST_CHECK(parts.base_name == "GetName");
+    TEST_CHECK(parts.decl_context_name == "ns::Game");
+    TEST_CHECK(parts.function_name == "ns::Game::GetName");
+    TEST_CHECK(parts.parameters == "()");
+    TEST_CHECK(parts.return_type.empty());
+
+    TEST_CHECK(itanium_demangle_function("_ZN4GameC1Ev", parts));
+    TEST_CHECK(parts.is_ctor_or_dtor && !parts.is_const && parts.base_name == "Game");
+
+    // Template functions print their return type. The base name has no template arguments.
+    TEST_CHECK(itanium_demangle_function("_Z3maxIiET_S0_S0_", parts));
+    TEST_CHECK(parts.name == "int max<int>(int, int)");
+    TEST_CHECK(parts.base_name == "max" && parts.function_name == "max<int>" && parts.return_type == "int");
+
+    // Parameter types are printed from their nodes. Base types drop pointers, references, cv qualifiers and arrays.
+    TEST_CHECK(itanium_demangle_function("_ZN4Game4DrawERKN2ns6SpriteEPA2_PKcSt4pairIiiE", parts));
+    TEST_CHECK(parts.parameter_types.size() == 3 && parts.parameter_base_types.size() == 3);
+    if (parts.parameter_types.size() == 3 && parts.parameter_base_types.size() == 3)
+    {
+        TEST_CHECK(parts.parameter_types[0] == "ns::Sprite const&");
+        TEST_CHECK(parts.parameter_types[1] == "char const* (*) [2]");
+        TEST_CHECK(parts.parameter_types[2] == "std::pair<int, int>");
+        TEST_CHECK(parts.parameter_base_types[0] == "ns::Sprite");
+        TEST_CHECK(parts.parameter_base_types[1] == "char");
+        TEST_CHECK(parts.parameter_base_types[2] == "std::pair<int, int>");
+    }
+
+    // Functions without parameters have none, not one of type void.
+    TEST_CHECK(itanium_demangle_function("_Z1fv", parts));
+    TEST_CHECK(parts.parameter_types.empty() && parts.parameter_base_types.empty());
+
+    // The scope variant prints only what the class model needs.
+    TEST_CHECK(itanium_demangle_function_scope("_ZNK2ns4Game4DrawERKN2ns6SpriteE", parts));
+    TEST_CHECK(parts.is_function && parts.is_const && parts.name.empty() && parts.parameters.empty());
+    TEST_CHECK(parts.base_name == "Draw" && parts.decl_context_name == "ns::Game");
+    TEST_CHECK(parts.function_name == "ns::Game::Draw" && parts.parameter_types.empty());
+    TEST_CHECK(parts.parameter_base_types.size() == 1 && parts.parameter_base_types[0] == "ns::Sprite");
+
+    // Variables are names, but not functions.
+    TEST_CHECK(itanium_demangle_function("_ZN4Game7s_countE", parts));
+    TEST_CHECK(!parts.is_function && parts.name == "Game::s_count" && parts.base_name.empty());
+
+    TEST_CHECK(!itanium_demangle_function("_ZN4Game", parts));
+    TEST_CHECK(!itanium_demangle_function("", parts));
+    TEST_CHECK(parts.name.empty() && !parts.is_function);
+
+    // Names that need more nodes than the first block grow the allocator, and the blocks are freed on the next call.
+    std::string mangled = "_Z1fIJ";
+    std::string expected = "void f<";
+    for (int i = 0; i < 200; ++i)
+    {
+        mangled += "PKc";
+        expected += i == 0 ? "char const*" : ", char const*";
+    }
+    mangled += "EEvv";
+    expected += ">()";
+    for (int i = 0; i < 4; ++i)
+    {
+        TEST_CHECK(itanium_demangle_function(mangled, parts));
+        TEST_CHECK(parts.name == expected);
+        TEST_CHECK(itanium_demangle_function("_ZN4Game6UpdateEf", parts));
+        TEST_CHECK(parts.name == "Game::Update(float)");
+    }
+}
@@ -0,0 +1,134 @@
+#include "Test.h"
+
+#include "FunctionMatcher.h"
+#include "FunctionMatcherImage.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+// Hand built image of five functions at the given addresses.
+// f0 calls f1. f1 pushes the typeinfo address. f2 and f3 have the same code and are virtual. f4 returns a constant.
+struct TestImage
+{
+    TestImage(const uint64_t (&addresses)[5], uint64_t typeInfoAddress, uint8_t constant)
+    {
+        const uint32_t callDisplacement = static_cast<uint32_t>(addresses[1] - (addresses[0] + 8));
+        m_code[0] = {0x55, 0x89, 0xe5, 0xe8};
+        AppendUInt32(m_code[0], callDisplacement);
+        m_code[0].insert(m_code[0].end(), {0x5d, 0xc3});
+        m_code[1] = {0x68};
+        AppendUInt32(m_code[1], static_cast<uint32_t>(typeInfoAddress));
+        m_code[1].push_back(0xc3);
+        m_code[2] = {0x31, 0xc0, 0xc3};
+        m_code[3] = {0x31, 0xc0, 0xc3};
+        m_code[4] = {0xb8, constant, 0x00, 0x00, 0x00, 0xc3};
+
+        m_image.m_imageBegin = 0x1000;
+        m_image.m_imageEnd = 0x9000;
+        for (size_t index = 0; index < 5; ++index)
+        {
+            FunctionMatcherImage::FunctionStart functionStart;
+            functionStart.m_address = addresses[index];
+            functionStart.m_data = m_code[index].data();
+            functionStart.m_size = static_cast<uint32_t>(m_code[index].size());
+            m_image.m_functionStarts.push_back(functionStart);
+        }
+        std::sort(
+            m_image.m_functionStarts.begin(),
+            m_image.m_functionStarts.end(),
+            [](const FunctionMatcherImage::FunctionStart &a, const FunctionMatcherImage::FunctionStart &b) {
+                return a.m_address < b.m_address;
+            });
+
+        FunctionMatcherImage::TypeInfo typeInfo;
+        typeInfo.m_address = typeInfoAddress;
+        typeInfo.m_nameHash = 42;
+        m_image.m_typeInfos.push_back(typeInfo);
+
+        const uint32_t typeInfoWord = static_cast<uint32_t>(typeInfoAddress);
+        m_vtableWords[0] = {0, typeInfoWord, static_cast<uint32_t>(addresses[2])};
+        m_vtableWords[1] = {0, typeInfoWord, 0, static_cast<uint32_t>(addresses[3])};
+        m_vtableWords[2] = {0, 0, 0, 0, 0, static_cast<uint32_t>(addresses[2])};
+    }
+
+    void AddVTable(std::string_view name, size_t index)
+    {
+        FunctionMatcherImage::VTable vtable;
+        vtable.m_name = name;
+        vtable.m_data = reinterpret_cast<const uint8_t *>(m_vtableWords[index].data());
+        vtable.m_size = static_cast<uint32_t>(m_vtableWords[index].size() * 4);
+        m_image.m_vtables.push_back(vtable);
+    }
+
+    static void AppendUInt32(std::vector<uint8_t> &code, uint32_t value)
+    {
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            code.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    std::vector<uint8_t> m_code[5];
+    std::vector<uint32_t> m_vtableWords[3];
+    FunctionMatcherImage m_image;
+};
+} // namespace
+
+void TestFunctionMatcher()
+{
+    // The second build moves all functions and the typeinfo, reverses the function order and lists the vtables in
+    // the opposite order.
+    const uint64_t addresses1[] = {0x1000, 0x1010, 0x1020, 0x1030, 0x1040};
+    const uint64_t addresses2[] = {0x2040, 0x2030, 0x2020, 0x2010, 0x2000};
+    TestImage image1(addresses1, 0x8000, 1);
+    TestImage image2(addresses2, 0x8100, 2);
+    image1.AddVTable("_ZTV1A", 0);
+    image1.AddVTable("_ZTV1B", 1);
+    image1.AddVTable("_ZTV1C", 2);
+    image2.AddVTable("_ZTV1C", 2);
+    image2.AddVTable("_ZTV1B", 1);
+    image2.AddVTable("_ZTV1A", 0);
+
+    TEST_CHECK(image1.m_image.FindFunctionStart(0x1020) == 2);
+    TEST_CHECK(image1.m_image.FindFunctionStart(0x1021) == InvalidIndex);
+    TEST_CHECK(image2.m_image.FindTypeInfo(0x8100) == 42 && image2.m_image.FindTypeInfo(0x8000) == 0);
+
+    ThreadPool threadPool(2);
+    FunctionFingerprints fingerprints1;
+    FunctionFingerprints fingerprints2;
+    FunctionMatcher::ComputeFingerprints(image1.m_image, threadPool, fingerprints1);
+    FunctionMatcher::ComputeFingerprints(image2.m_image, threadPool, fingerprints2);
+    TEST_CHECK(fingerprints1.size() == 5 && fingerprints2.size() == 5);
+    if (fingerprints1.size() != 5 || fingerprints2.size() != 5)
+        return;
+
+    // Function k of the first build is function 4 - k of the second build.
+    TEST_CHECK(fingerprints1[0].m_callCount == 1 && fingerprints2[4].m_callCount == 1);
+    TEST_CHECK(fingerprints1[0].m_codeHash == fingerprints2[4].m_codeHash);
+    TEST_CHECK(fingerprints1[1].m_typeInfoHash != 0);
+    TEST_CHECK(fingerprints1[1].m_typeInfoHash == fingerprints2[3].m_typeInfoHash);
+    TEST_CHECK(fingerprints1[2].m_codeHash == fingerprints1[3].m_codeHash);
+    TEST_CHECK(fingerprints1[4].m_codeHash != fingerprints2[0].m_codeHash);
+
+    // The vtable slot is the smallest (vtable name, slot), whatever the vtable order.
+    TEST_CHECK(fingerprints1[2].m_vtableCount == 2 && fingerprints2[2].m_vtableCount == 2);
+    TEST_CHECK(fingerprints1[2].m_vtableSlotHash == fingerprints2[2].m_vtableSlotHash);
+    TEST_CHECK(fingerprints1[3].m_vtableSlotHash == fingerprints2[1].m_vtableSlotHash);
+    TEST_CHECK(fingerprints1[2].m_vtableSlotHash != fingerprints1[3].m_vtableSlotHash);
+    TEST_CHECK(fingerprints1[4].m_vtableCount == 0 && fingerprints1[4].m_vtableSlotHash == 0);
+
+    FunctionMatcher::Matches matches;
+    FunctionMatcher::MatchFunctions(fingerprints1, fingerprints2, matches);
+    TEST_CHECK(matches.size() == 5);
+    for (const FunctionMatcher::Match &match : matches)
+    {
+        TEST_CHECK(match.m_functionIndex2 == 4 - match.m_functionIndex1);
+        const FunctionMatcher::MatchKind expectedKind =
+            match.m_functionIndex1 == 4 ? FunctionMatcher::MatchKind::Structure : FunctionMatcher::MatchKind::Exact;
+        TEST_CHECK(match.m_kind == expectedKind);
+    }
+}
@@ -0,0 +1,94 @@
+#include "Test.h"
+
+#include "IncludeGraph.h"
+#include "IncludeTable.h"
+#include "ThreadPool.h"
+
+#include <vector>
+
+namespace
+{
+struct IncludeRow
+{
+    uint64_t m_address;
+    index_t m_headerFileIndex;
+};
+
+void AddFunction(
+    Functions &functions,
+    SourceFile &sourceFile,
+    IncludeTable &includeTable,
+    uint64_t address,
+    uint32_t size,
+    const std::vector<IncludeRow> &rows)
+{
+    FunctionVariant variant;
+    variant.m_address = address;
+    variant.m_size = size;
+    if (!rows.empty())
+    {
+        variant.m_includeSequenceIndex = includeTable.BeginSequence(address, size);
+        for (const IncludeRow &row : rows)
+        {
+            const index_t sourceFileIndex = row.m_headerFileIndex == InvalidIndex ? 0 : InvalidIndex;
+            includeTable.AddRow(row.m_address, row.m_headerFileIndex, sourceFileIndex);
+        }
+        includeTable.EndSequence();
+    }
+
+    sourceFile.m_functionIndices.push_back(static_cast<index_t>(functions.size()));
+    functions.emplace_back();
+    functions.back().m_variants.push_back(variant);
+}
+} // namespace
+
+void TestIncludeGraph()
+{
+    SourceFiles sourceFiles(2);
+    HeaderFiles headerFiles(3);
+    Functions functions;
+    IncludeTable includeTable;
+    // Header 0 from 0x1010 to 0x1020 and header 1 from 0x1030 to the function end.
+    AddFunction(
+        functions,
+        sourceFiles[0],
+        includeTable,
+        0x1000,
+        0x80,
+        {{0x1000, InvalidIndex}, {0x1010, 0}, {0x1020, InvalidIndex}, {0x1030, 1}});
+    AddFunction(functions, sourceFiles[0], includeTable, 0x2000, 0x20, {{0x2000, 0}});
+    AddFunction(functions, sourceFiles[1], includeTable, 0x3000, 0x10, {{0x3000, 0}});
+    AddFunction(functions, sourceFiles[1], includeTable, 0x4000, 0x10, {});
+    includeTable.Finalize();
+
+    ThreadPool threadPool(2);
+    IncludeGraph includeGraph;
+    includeGraph.Build(sourceFiles, headerFiles, functions, includeTable, threadPool);
+
+    TEST_CHECK(includeGraph.GetSourceFileCount() == 2 && includeGraph.GetHeaderFileCount() == 3);
+
+    // Bytes of one header are summed over the functions of a source file.
+    const tcb::span<const index_t> sourceHeaders = includeGraph.GetHeaderFiles(0);
+    const tcb::span<const uint64_t> sourceHeaderBytes = includeGraph.GetHeaderFileBytes(0);
+    TEST_CHECK(sourceHeaders.size() == 2 && sourceHeaderBytes.size() == 2);
+    if (sourceHeaders.size() == 2 && sourceHeaderBytes.size() == 2)
+    {
+        TEST_CHECK(sourceHeaders[0] == 0 && sourceHeaderBytes[0] == 0x30);
+        TEST_CHECK(sourceHeaders[1] == 1 && sourceHeaderBytes[1] == 0x50);
+    }
+
+    const tcb::span<const index_t> headerSources = includeGraph.GetSourceFiles(0);
+    const tcb::span<const uint64_t> headerSourceBytes = includeGraph.GetSourceFileBytes(0);
+    TEST_CHECK(headerSources.size() == 2 && headerSourceBytes.size() == 2);
+    if (headerSources.size() == 2 && headerSourceBytes.size() == 2)
+    {
+        TEST_CHECK(headerSources[0] == 0 && headerSourceBytes[0] == 0x30);
+        TEST_CHECK(headerSources[1] == 1 && headerSourceBytes[1] == 0x10);
+    }
+    TEST_CHECK(includeGraph.GetSourceFiles(2).size() == 0);
+
+    TEST_CHECK(includeGraph.GetTranslationUnitCount(0) == 2 && includeGraph.GetCodeSize(0) == 0x40);
+    TEST_CHECK(includeGraph.GetTranslationUnitCount(1) == 1 && includeGraph.GetCodeSize(1) == 0x50);
+    TEST_CHECK((includeGraph.GetHeaderFilesByTranslationUnitCount(10) == std::vector<index_t>{0, 1, 2}));
+    TEST_CHECK((includeGraph.GetHeaderFilesByCodeSize(2) == std::vector<index_t>{1, 0}));
+}
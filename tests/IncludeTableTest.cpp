@@ -0,0 +1,68 @@
+#include "Test.h"
+
+#include "IncludeTable.h"
+
+#include <vector>
+
+void TestIncludeTable()
+{
+    // File ids interleave source files (even) and header files (odd).
+    TEST_CHECK(IncludeTable::MakeFileId(InvalidIndex, 5) == 10);
+    TEST_CHECK(IncludeTable::MakeFileId(70, InvalidIndex) == 141);
+    index_t headerFileIndex;
+    index_t sourceFileIndex;
+    IncludeTable::SplitFileId(141, headerFileIndex, sourceFileIndex);
+    TEST_CHECK(headerFileIndex == 70 && sourceFileIndex == InvalidIndex);
+
+    IncludeTable table;
+    const index_t sequenceIndex0 = table.BeginSequence(0x1000, 0x400);
+    table.AddRow(0x1000, InvalidIndex, 0);
+    table.AddRow(0x1000 + 300, 70, InvalidIndex);
+    table.AddRow(0x1000 + 305, 70, InvalidIndex); // Same file, dropped.
+    table.AddRow(0x1200, InvalidIndex, 0);
+    table.AddRow(0x1300, 3, InvalidIndex);
+    table.EndSequence();
+    const index_t sequenceIndex1 = table.BeginSequence(0x100, 0x10);
+    table.AddRow(0x100, 3, InvalidIndex);
+    table.EndSequence();
+    table.Finalize();
+
+    // Rows are pairs of varints: the address delta and the zigzag encoded file id delta.
+    const std::vector<uint8_t> expectedData = {
+        0x00, 0x00, // +0, +0
+        0xac, 0x02, 0x9a, 0x02, // +300, +141
+        0xd4, 0x01, 0x99, 0x02, // +212, -141
+        0x80, 0x02, 0x0e, // +256, +7
+        0x00, 0x0e, // +0, +7
+    };
+    TEST_CHECK(table.GetData() == expectedData);
+    TEST_CHECK(table.GetSequence(sequenceIndex0).m_rowCount == 4);
+
+    std::vector<IncludeTableRow> rows;
+    table.GetRows(sequenceIndex0, rows);
+    TEST_CHECK(rows.size() == 4);
+    if (rows.size() == 4)
+    {
+        TEST_CHECK(rows[0].m_address == 0x1000 && rows[0].m_sourceFileIndex == 0);
+        TEST_CHECK(rows[1].m_address == 0x1000 + 300 && rows[1].m_headerFileIndex == 70);
+        TEST_CHECK(rows[2].m_address == 0x1200 && rows[2].m_sourceFileIndex == 0);
+        TEST_CHECK(rows[3].m_address == 0x1300 && rows[3].m_headerFileIndex == 3);
+    }
+
+    IncludeTableRow row;
+    TEST_CHECK(table.FindRow(sequenceIndex0, 0x1000 + 305, row) && row.m_headerFileIndex == 70);
+    TEST_CHECK(table.FindRow(sequenceIndex0, 0x12ff, row) && row.m_sourceFileIndex == 0);
+    TEST_CHECK(!table.FindRow(sequenceIndex1, 0xff, row));
+
+    // File ranges end at the next row, and the last one at the end of the sequence.
+    std::vector<uint64_t> rangeEnds;
+    table.ForEachFileRange(sequenceIndex0, [&](const IncludeTableRow &, uint64_t addressEnd) {
+        rangeEnds.push_back(addressEnd);
+    });
+    TEST_CHECK((rangeEnds == std::vector<uint64_t>{0x1000 + 300, 0x1200, 0x1300, 0x1400}));
+
+    TEST_CHECK(table.FindSequence(0x105) == sequenceIndex1);
+    TEST_CHECK(table.FindSequence(0x13ff) == sequenceIndex0);
+    TEST_CHECK(table.FindSequence(0x110) == InvalidIndex);
+    TEST_CHECK(table.FindSequence(0x1400) == InvalidIndex);
+}
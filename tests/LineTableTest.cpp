@@ -0,0 +1,58 @@
+#include "Test.h"
+
+#include "IncludeTable.h"
+#include "LineTable.h"
+
+void TestLineTable()
+{
+    // The code from 0x1010 comes from header file 2.
+    IncludeTable includeTable;
+    const index_t includeSequenceIndex = includeTable.BeginSequence(0x1000, 0x20);
+    includeTable.AddRow(0x1000, InvalidIndex, 0);
+    includeTable.AddRow(0x1010, 2, InvalidIndex);
+    includeTable.EndSequence();
+    includeTable.Finalize();
+
+    LineTable lineTable;
+    // Added after a range at a higher address, and with rows out of order.
+    const index_t rangeIndex1 = lineTable.BeginRange(0x2000, 7);
+    lineTable.AddRow(0x2000, 100);
+    lineTable.EndRange(0x8, includeTable, InvalidIndex);
+    const index_t rangeIndex0 = lineTable.BeginRange(0x1000, 3);
+    lineTable.AddRow(0x1000, 10);
+    lineTable.AddRow(0x1018, 40);
+    lineTable.AddRow(0x1008, 20);
+    lineTable.AddRow(0x1008, 21);
+    lineTable.AddRow(0x1010, 30);
+    lineTable.EndRange(0x20, includeTable, includeSequenceIndex);
+    lineTable.Finalize();
+
+    TEST_CHECK(lineTable.GetRange(rangeIndex0).m_rowCount == 5);
+    TEST_CHECK(lineTable.GetRange(rangeIndex0).m_functionIndex == 3);
+
+    // Rows are sorted, and rows at the same address keep their order.
+    const uint16_t expectedLines[] = {10, 20, 21, 30, 40};
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        TEST_CHECK(lineTable.GetRow(rangeIndex0, i).m_line == expectedLines[i]);
+    }
+
+    // Files come from the active include table row.
+    const LineTableRow sourceRow = lineTable.GetRow(rangeIndex0, 2);
+    TEST_CHECK(sourceRow.m_sourceFileIndex == 0 && sourceRow.m_headerFileIndex == InvalidIndex);
+    const LineTableRow headerRow = lineTable.GetRow(rangeIndex0, 3);
+    TEST_CHECK(headerRow.m_headerFileIndex == 2 && headerRow.m_sourceFileIndex == InvalidIndex);
+    const LineTableRow noFileRow = lineTable.GetRow(rangeIndex1, 0);
+    TEST_CHECK(noFileRow.m_headerFileIndex == InvalidIndex && noFileRow.m_sourceFileIndex == InvalidIndex);
+
+    TEST_CHECK(lineTable.FindRange(0x0fff) == InvalidIndex);
+    TEST_CHECK(lineTable.FindRange(0x101f) == rangeIndex0);
+    TEST_CHECK(lineTable.FindRange(0x1020) == InvalidIndex);
+    TEST_CHECK(lineTable.FindRange(0x2004) == rangeIndex1);
+
+    LineTableRow row;
+    TEST_CHECK(lineTable.FindLine(0x100f, row) && row.m_line == 21 && row.m_address == 0x1008);
+    TEST_CHECK(lineTable.FindLine(0x101f, row) && row.m_line == 40);
+    TEST_CHECK(lineTable.FindLine(0x2007, row) && row.m_line == 100);
+    TEST_CHECK(!lineTable.FindLine(0x2008, row));
+}
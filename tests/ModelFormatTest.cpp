@@ -0,0 +1,183 @@
+#include "Test.h"
+
+#include "ModelFormatBuilder.h"
+#include "NameSearchIndex.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// Model files are mapped 8 byte aligned.
+std::vector<uint64_t> ToAlignedData(const std::string &file)
+{
+    std::vector<uint64_t> data((file.size() + 7) / 8);
+    std::memcpy(data.data(), file.data(), file.size());
+    return data;
+}
+
+ModelFormat::SectionHeader &GetSectionHeader(std::vector<uint64_t> &data, ModelFormat::SectionId id)
+{
+    return reinterpret_cast<ModelFormat::SectionHeader *>(data.data() + sizeof(ModelFormat::FileHeader) / 8)[id];
+}
+
+bool Open(ModelFormat::Reader &reader, const std::vector<uint64_t> &data, size_t size)
+{
+    std::string error;
+    return reader.Open(data.data(), size, error);
+}
+
+NameSearchIndex BuildNameSearchIndex()
+{
+    Functions functions(2);
+    functions[0].m_name = "Game::Update";
+    functions[1].m_name = "Game::Render";
+    Classes classes(1);
+    classes[0].m_name = "Game";
+    ThreadPool threadPool(1);
+    NameSearchIndex index;
+    index.Build(functions, classes, Namespaces(), threadPool);
+    return index;
+}
+
+// Two functions that call each other, and one class with an inferred field and a vtable store.
+std::string WriteModel(const std::string &nameSearchIndexData, uint32_t calleeIndex)
+{
+    ModelFormatBuilder builder;
+
+    ModelFormat::Class classRecord;
+    classRecord.m_name = builder.AddString("Game");
+    classRecord.m_functionIndices = builder.AddIndices(std::vector<uint32_t>{0, 1});
+    builder.Append(classRecord);
+
+    const char *const names[] = {"Game::Update", "Game::Render"};
+    for (uint32_t functionIndex = 0; functionIndex < 2; ++functionIndex)
+    {
+        ModelFormat::FunctionVariant variant;
+        variant.m_address = 0x1000 + functionIndex * 0x10;
+        variant.m_size = 0x10;
+        ModelFormat::Function function;
+        function.m_name = builder.AddString(names[functionIndex]);
+        function.m_parentClassIndex = 0;
+        const uint32_t variantBegin = builder.GetCount<ModelFormat::FunctionVariant>();
+        builder.Append(variant);
+        function.m_variants = builder.MakeRange<ModelFormat::FunctionVariant>(variantBegin);
+        builder.Append(function);
+
+        ModelFormat::AddressRecord address;
+        address.m_address = variant.m_address;
+        address.m_functionIndex = functionIndex;
+        builder.Append(address);
+    }
+
+    ModelFormat::FunctionCalls calls;
+    calls.m_calleeIndices = builder.AddIndices(std::vector<uint32_t>{calleeIndex});
+    builder.Append(calls);
+    calls.m_calleeIndices = ModelFormat::Range();
+    calls.m_callerIndices = builder.AddIndices(std::vector<uint32_t>{0});
+    builder.Append(calls);
+
+    ModelFormat::CodeCluster cluster;
+    cluster.m_hash = 0x1234;
+    cluster.m_size = 0x10;
+    for (uint32_t functionIndex = 0; functionIndex < 2; ++functionIndex)
+    {
+        ModelFormat::CodeClusterVariant variant;
+        variant.m_functionIndex = functionIndex;
+        builder.Append(variant);
+    }
+    cluster.m_variants = builder.MakeRange<ModelFormat::CodeClusterVariant>(0);
+    builder.Append(cluster);
+
+    ModelFormat::ClassLayout layout;
+    layout.m_allocationSize = 12;
+    layout.m_vtableFunctionIndex = 1;
+    ModelFormat::InferredField field;
+    field.m_offset = 4;
+    field.m_size = 4;
+    field.m_flags = ModelFormat::InferredFieldFlag_Read;
+    builder.Append(field);
+    layout.m_fields = builder.MakeRange<ModelFormat::InferredField>(0);
+    ModelFormat::VTableStore store;
+    store.m_addressPointOffset = 8;
+    store.m_vtableAddress = 0x2000;
+    builder.Append(store);
+    layout.m_vtableStores = builder.MakeRange<ModelFormat::VTableStore>(0);
+    builder.Append(layout);
+
+    builder.SetBytes(ModelFormat::SectionId_NameSearchIndex, nameSearchIndexData);
+
+    std::ostringstream stream;
+    builder.WriteFile(stream);
+    return stream.str();
+}
+} // namespace
+
+void TestModelFormat()
+{
+    std::ostringstream nameSearchIndexStream;
+    BuildNameSearchIndex().Save(nameSearchIndexStream);
+    const std::string file = WriteModel(nameSearchIndexStream.str(), 1);
+    std::vector<uint64_t> data = ToAlignedData(file);
+
+    ModelFormat::Reader reader;
+    std::string error;
+    TEST_CHECK(reader.Open(data.data(), file.size(), error));
+    TEST_CHECK(reader.Validate(error));
+    TEST_CHECK(reader.GetMinorVersion() == ModelFormat::MinorVersion);
+
+    const ModelFormat::Table<ModelFormat::Function> functions = reader.GetTable<ModelFormat::Function>();
+    TEST_CHECK(functions.Size() == 2);
+    TEST_CHECK(reader.GetString(functions[1].m_name) == "Game::Render");
+    uint32_t functionIndex = InvalidIndex;
+    uint32_t variantIndex = InvalidIndex;
+    TEST_CHECK(reader.FindFunctionByAddress(0x1018, functionIndex, variantIndex));
+    TEST_CHECK(functionIndex == 1 && variantIndex == 0);
+    TEST_CHECK(!reader.FindFunctionByAddress(0x1020, functionIndex, variantIndex));
+
+    const ModelFormat::Table<ModelFormat::FunctionCalls> calls = reader.GetTable<ModelFormat::FunctionCalls>();
+    TEST_CHECK(calls.Size() == 2);
+    TEST_CHECK(reader.GetIndices(calls[0].m_calleeIndices).Size() == 1);
+    TEST_CHECK(reader.GetIndices(calls[1].m_callerIndices)[0] == 0);
+
+    const ModelFormat::Table<ModelFormat::CodeCluster> clusters = reader.GetTable<ModelFormat::CodeCluster>();
+    TEST_CHECK(clusters.Size() == 1 && clusters[0].m_hash == 0x1234);
+    TEST_CHECK(reader.GetTable<ModelFormat::CodeClusterVariant>(clusters[0].m_variants)[1].m_functionIndex == 1);
+
+    const ModelFormat::Table<ModelFormat::ClassLayout> layouts = reader.GetTable<ModelFormat::ClassLayout>();
+    TEST_CHECK(layouts.Size() == 1 && layouts[0].m_allocationSize == 12);
+    TEST_CHECK(reader.GetTable<ModelFormat::InferredField>(layouts[0].m_fields)[0].m_offset == 4);
+    TEST_CHECK(reader.GetTable<ModelFormat::VTableStore>(layouts[0].m_vtableStores)[0].m_vtableAddress == 0x2000);
+
+    // The name search index comes back from its section.
+    std::istringstream nameSearchIndexData(std::string(reader.GetNameSearchIndexData()));
+    NameSearchIndex nameSearchIndex;
+    TEST_CHECK(nameSearchIndex.Load(nameSearchIndexData));
+    std::vector<NameSearchIndex::Result> results;
+    nameSearchIndex.FindSubstring("render", 10, results);
+    TEST_CHECK(results.size() == 1 && results[0].m_index == 1);
+
+    // Strings and indices are addressed without the stride, so it must be the element size.
+    {
+        std::vector<uint64_t> stridedData = data;
+        GetSectionHeader(stridedData, ModelFormat::SectionId_Strings).m_stride = 2;
+        ModelFormat::Reader stridedReader;
+        TEST_CHECK(!Open(stridedReader, stridedData, file.size()));
+
+        stridedData = data;
+        GetSectionHeader(stridedData, ModelFormat::SectionId_Indices).m_stride = 8;
+        TEST_CHECK(!Open(stridedReader, stridedData, file.size()));
+    }
+
+    // Indices of the new sections are validated.
+    {
+        const std::string badFile = WriteModel(std::string(), 2);
+        const std::vector<uint64_t> badData = ToAlignedData(badFile);
+        ModelFormat::Reader badReader;
+        TEST_CHECK(Open(badReader, badData, badFile.size()));
+        TEST_CHECK(!badReader.Validate(error));
+    }
+}
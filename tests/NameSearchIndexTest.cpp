@@ -0,0 +1,92 @@
+#include "Test.h"
+
+#include "NameSearchIndex.h"
+#include "ThreadPool.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+bool IsResult(const NameSearchIndex::Result &result, NameSearchIndex::EntityKind entityKind, index_t index)
+{
+    return result.m_entityKind == entityKind && result.m_index == index;
+}
+} // namespace
+
+void TestNameSearchIndex()
+{
+    using EntityKind = NameSearchIndex::EntityKind;
+
+    Functions functions(4);
+    functions[0].m_name = "Game::Update";
+    functions[1].m_name = "Game::UpdateAll";
+    functions[2].m_name = "Update";
+    functions[3].m_name = "Render";
+    Classes classes(2);
+    classes[0].m_name = "Game";
+    classes[1].m_name = "GameUpdater";
+    Namespaces namespaces(1);
+    namespaces[0].m_name = "game";
+
+    ThreadPool threadPool(2);
+    NameSearchIndex index;
+    index.Build(functions, classes, namespaces, threadPool);
+    TEST_CHECK(index.GetNameCount() == 7);
+
+    // Exact matches, then matches after a scope separator, then other matches. Shorter names first.
+    std::vector<NameSearchIndex::Result> results;
+    index.FindSubstring("UPDATE", 10, results);
+    TEST_CHECK(results.size() == 4);
+    if (results.size() == 4)
+    {
+        TEST_CHECK(IsResult(results[0], EntityKind::Function, 2));
+        TEST_CHECK(IsResult(results[1], EntityKind::Function, 0));
+        TEST_CHECK(IsResult(results[2], EntityKind::Function, 1));
+        TEST_CHECK(IsResult(results[3], EntityKind::Class, 1));
+    }
+
+    // Equal scores rank classes before namespaces. Prefixes follow the exact matches.
+    index.FindSubstring("game", 3, results);
+    TEST_CHECK(results.size() == 3);
+    if (results.size() == 3)
+    {
+        TEST_CHECK(IsResult(results[0], EntityKind::Class, 0));
+        TEST_CHECK(IsResult(results[1], EntityKind::Namespace, 0));
+        TEST_CHECK(IsResult(results[2], EntityKind::Class, 1));
+    }
+
+    // Fuzzy results rank by the Jaccard similarity of the trigram sets.
+    index.FindFuzzy("updat", 10, results);
+    TEST_CHECK(results.size() == 4);
+    if (results.size() == 4)
+    {
+        TEST_CHECK(IsResult(results[0], EntityKind::Function, 2) && results[0].m_score == 750000);
+        TEST_CHECK(IsResult(results[1], EntityKind::Class, 1));
+        TEST_CHECK(IsResult(results[2], EntityKind::Function, 0));
+        TEST_CHECK(IsResult(results[3], EntityKind::Function, 1));
+    }
+
+    // Queries without trigrams fall back to substrings.
+    index.FindFuzzy("Re", 10, results);
+    TEST_CHECK(results.size() == 1 && IsResult(results[0], EntityKind::Function, 3));
+
+    std::stringstream stream;
+    index.Save(stream);
+    const std::string data = stream.str();
+
+    NameSearchIndex loadedIndex;
+    std::istringstream loadedStream(data);
+    TEST_CHECK(loadedIndex.Load(loadedStream) && loadedIndex.GetNameCount() == 7);
+    loadedIndex.FindFuzzy("updat", 10, results);
+    TEST_CHECK(results.size() == 4 && IsResult(results[0], EntityKind::Function, 2));
+
+    // The trigram counts come last. A count that does not match the postings is rejected, because a zero count would
+    // divide by zero in fuzzy queries.
+    std::string corruptData = data;
+    corruptData[corruptData.size() - 2] = 0;
+    corruptData[corruptData.size() - 1] = 0;
+    std::istringstream corruptStream(corruptData);
+    TEST_CHECK(!loadedIndex.Load(corruptStream) && loadedIndex.GetNameCount() == 0);
+}
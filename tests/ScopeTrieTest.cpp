@@ -0,0 +1,43 @@
+#include "Test.h"
+
+#include "ScopeTrie.h"
+
+void TestScopeTrie()
+{
+    // Separators inside template arguments, parameter lists and braces do not split.
+    TEST_CHECK(ScopeTrie::FindScopeSeparator("a::b", 0) == 1);
+    TEST_CHECK(ScopeTrie::FindScopeSeparator("std::map<a, b::c>::d", 5) == 17);
+    TEST_CHECK(ScopeTrie::FindScopeSeparator("f(x::y)", 0) == 7);
+    TEST_CHECK(ScopeTrie::FindScopeSeparator("{lambda()#1}::a", 0) == 12);
+
+    ScopeTrie trie;
+    ScopeTrie::Path path;
+    trie.FindOrCreatePath("a::b<c::d>::e", path);
+    TEST_CHECK(path.size() == 3);
+    if (path.size() == 3)
+    {
+        TEST_CHECK(path[0].m_nameEnd == 1 && trie.GetComponent(path[0].m_nodeIndex) == "a");
+        TEST_CHECK(path[1].m_nameEnd == 10 && trie.GetComponent(path[1].m_nodeIndex) == "b<c::d>");
+        TEST_CHECK(path[2].m_nameEnd == 13 && trie.GetComponent(path[2].m_nodeIndex) == "e");
+        TEST_CHECK(trie.GetNode(path[2].m_nodeIndex).m_depth == 3);
+        TEST_CHECK(trie.GetParentNodeIndex(path[0].m_nodeIndex) == ScopeTrie::RootNodeIndex);
+        TEST_CHECK(trie.GetQualifiedName(path[2].m_nodeIndex) == "a::b<c::d>::e");
+        TEST_CHECK(trie.FindNode("a::b<c::d>") == path[1].m_nodeIndex);
+    }
+    TEST_CHECK(trie.FindNode("a::b") == InvalidIndex);
+    TEST_CHECK(trie.FindNode("c") == InvalidIndex);
+
+    // Existing prefixes are shared, and interned components are reused under other parents.
+    const index_t nodeCount = trie.GetNodeCount();
+    ScopeTrie::Path otherPath;
+    trie.FindOrCreatePath("a::f(int (*)(x::y))::a", otherPath);
+    TEST_CHECK(otherPath.size() == 3);
+    TEST_CHECK(trie.GetNodeCount() == nodeCount + 2);
+    if (otherPath.size() == 3 && path.size() == 3)
+    {
+        TEST_CHECK(otherPath[0].m_nodeIndex == path[0].m_nodeIndex);
+        TEST_CHECK(trie.GetComponent(otherPath[1].m_nodeIndex) == "f(int (*)(x::y))");
+        TEST_CHECK(trie.GetChildNodeIndices(path[0].m_nodeIndex).size() == 2);
+        TEST_CHECK(trie.FindNode("a::f(int (*)(x::y))::a") == otherPath[2].m_nodeIndex);
+    }
+}
@@ -0,0 +1,88 @@
+#include "Test.h"
+
+#include "StabsParser.h"
+
+void TestStabsParser()
+{
+    StabsParser parser;
+
+    // Builtin ranges. The size follows from the bounds.
+    TEST_CHECK(parser.Parse("int:t(0,1)=r(0,1);-2147483648;2147483647;"));
+    TEST_CHECK(parser.GetSymbol().m_name == "int" && parser.GetSymbol().m_isTypedef);
+    const StabsType &intType = parser.GetType(parser.GetSymbol().m_type);
+    TEST_CHECK(intType.m_kind == StabsTypeKind::Range && intType.m_isDefinition && intType.m_size == 4);
+    TEST_CHECK((intType.m_number == StabsTypeNumber{0, 1}));
+    TEST_CHECK(parser.GetType(intType.m_target).m_kind == StabsTypeKind::Number);
+
+    TEST_CHECK(parser.Parse("long long unsigned int:t(0,2)=r(0,2);0;01777777777777777777777;"));
+    TEST_CHECK(parser.GetType(parser.GetSymbol().m_type).m_size == 8);
+    TEST_CHECK(parser.Parse("double:t(0,3)=r(0,1);8;0;"));
+    TEST_CHECK(parser.GetType(parser.GetSymbol().m_type).m_size == 8);
+    TEST_CHECK(parser.Parse("void:t(0,4)=(0,4)"));
+    TEST_CHECK(parser.GetType(parser.GetSymbol().m_type).m_kind == StabsTypeKind::Void);
+
+    // Class with a base class, a nested struct, a method and a static member.
+    TEST_CHECK(parser.Parse("Derived:Tt(0,5)=s12!1,020,(0,6);"
+                            "m_x:/1(0,1),32,32;"
+                            "m_inner:(0,7)=s4a:(0,1),0,32;;,64,32;"
+                            "Method::(0,8)=#(0,5),(0,1),(0,1);:_ZN7Derived6MethodEi;2A*1;(0,5);;"
+                            "s_count:(0,1):_ZN7Derived7s_countE;;"
+                            "~%(0,6);"));
+    const StabsSymbol &classSymbol = parser.GetSymbol();
+    TEST_CHECK(classSymbol.m_descriptor == 'T' && classSymbol.m_isTag && classSymbol.m_isTypedef);
+    const StabsType &classType = parser.GetType(classSymbol.m_type);
+    TEST_CHECK(classType.m_kind == StabsTypeKind::Struct && classType.m_size == 12);
+
+    const tcb::span<const StabsBaseClass> baseClasses = parser.GetBaseClasses(classType);
+    TEST_CHECK(baseClasses.size() == 1);
+    if (baseClasses.size() == 1)
+    {
+        TEST_CHECK(!baseClasses[0].m_isVirtual && baseClasses[0].m_visibility == StabsVisibility::Public);
+        TEST_CHECK((parser.GetType(baseClasses[0].m_type).m_number == StabsTypeNumber{0, 6}));
+    }
+
+    // Fields of the nested struct do not interleave with the fields of the class.
+    const tcb::span<const StabsField> fields = parser.GetFields(classType);
+    TEST_CHECK(fields.size() == 3);
+    if (fields.size() == 3)
+    {
+        TEST_CHECK(fields[0].m_name == "m_x" && fields[0].m_visibility == StabsVisibility::Protected);
+        TEST_CHECK(fields[0].m_bitOffset == 32 && fields[0].m_bitSize == 32);
+        TEST_CHECK(fields[1].m_name == "m_inner" && fields[1].m_bitOffset == 64);
+        TEST_CHECK(fields[2].m_name == "s_count" && fields[2].m_isStatic);
+
+        const tcb::span<const StabsField> innerFields = parser.GetFields(parser.GetType(fields[1].m_type));
+        TEST_CHECK(innerFields.size() == 1 && innerFields[0].m_name == "a");
+    }
+
+    TEST_CHECK(parser.Parse("Color:T(0,9)=eRed:0,Green:1,Blue:-2,;"));
+    const tcb::span<const StabsEnumerator> enumerators =
+        parser.GetEnumerators(parser.GetType(parser.GetSymbol().m_type));
+    TEST_CHECK(enumerators.size() == 3);
+    if (enumerators.size() == 3)
+    {
+        TEST_CHECK(enumerators[1].m_name == "Green" && enumerators[2].m_value == -2);
+    }
+
+    // Colons inside template arguments belong to the name.
+    TEST_CHECK(parser.Parse("p:(0,10)=*(0,11)=xsPair<ns::A>:"));
+    const StabsType &pointerType = parser.GetType(parser.GetSymbol().m_type);
+    TEST_CHECK(pointerType.m_kind == StabsTypeKind::Pointer);
+    const StabsType &crossReference = parser.GetType(pointerType.m_target);
+    TEST_CHECK(crossReference.m_kind == StabsTypeKind::CrossReference && crossReference.m_crossReferenceKind == 's');
+    TEST_CHECK(crossReference.m_name == "Pair<ns::A>");
+
+    TEST_CHECK(parser.Parse("ns::Value:G(0,1)"));
+    TEST_CHECK(parser.GetSymbol().m_name == "ns::Value" && parser.GetSymbol().m_descriptor == 'G');
+
+    TEST_CHECK(parser.Parse("table:G(0,12)=ar(0,1);0;9;(0,1)"));
+    const StabsType &arrayType = parser.GetType(parser.GetSymbol().m_type);
+    TEST_CHECK(arrayType.m_kind == StabsTypeKind::Array && arrayType.m_low == 0 && arrayType.m_high == 9);
+
+    TEST_CHECK(parser.Parse("kMax:c=i5"));
+    TEST_CHECK(parser.GetSymbol().m_descriptor == 'c');
+
+    TEST_CHECK(!parser.Parse("bad:t(0,1)=z"));
+    TEST_CHECK(!parser.Parse("truncated:T(0,5)=s12m_x:(0,1),32"));
+    TEST_CHECK(!parser.Parse("noColon"));
+}
@@ -0,0 +1,86 @@
+#include "Test.h"
+
+#include "TemplateIndex.h"
+
+#include <string_view>
+#include <vector>
+
+namespace
+{
+bool Split(std::string_view name, std::string_view expectedName, const std::vector<std::string_view> &expectedArguments)
+{
+    std::string_view templateName;
+    std::vector<std::string_view> arguments;
+    return TemplateIndex::SplitTemplateName(name, templateName, arguments) && templateName == expectedName
+        && arguments == expectedArguments;
+}
+
+bool IsNotTemplate(std::string_view name)
+{
+    std::string_view templateName;
+    std::vector<std::string_view> arguments;
+    return !TemplateIndex::SplitTemplateName(name, templateName, arguments);
+}
+} // namespace
+
+void TestTemplateIndex()
+{
+    TEST_CHECK(Split("std::vector<Foo, std::allocator<Foo> >", "std::vector", {"Foo", "std::allocator<Foo>"}));
+    TEST_CHECK(Split("a::b<c, d<e> >::f<g>", "a::b<c, d<e> >::f", {"g"}));
+    TEST_CHECK(Split("Callback<void (*)(int, char)>", "Callback", {"void (*)(int, char)"}));
+    TEST_CHECK(Split("Empty<>", "Empty", {}));
+    TEST_CHECK(Split("operator< <int>", "operator<", {"int"}));
+    TEST_CHECK(Split("operator<< <char>", "operator<<", {"char"}));
+    TEST_CHECK(IsNotTemplate("Foo"));
+    TEST_CHECK(IsNotTemplate("Foo::operator>"));
+    TEST_CHECK(IsNotTemplate("Foo::operator->"));
+    TEST_CHECK(IsNotTemplate("<int>"));
+
+    Classes classes(3);
+    classes[0].m_name = "Pair<int, char>";
+    classes[1].m_name = "Pair<char, int>";
+    classes[2].m_name = "Game";
+    classes[0].m_functionIndices = {0};
+
+    Functions functions(3);
+    functions[0].m_functionName = "Pair<int, char>::Swap";
+    functions[1].m_functionName = "Max<int>";
+    functions[2].m_functionName = "Max<char>";
+    const uint32_t sizes[] = {0x10, 0x20, 0x40};
+    for (size_t functionIndex = 0; functionIndex < functions.size(); ++functionIndex)
+    {
+        FunctionVariant variant;
+        variant.m_size = sizes[functionIndex];
+        functions[functionIndex].m_variants.push_back(variant);
+    }
+
+    TemplateIndex index;
+    index.Build(classes, functions);
+    TEST_CHECK(index.GetTemplateCount() == 2);
+
+    const index_t pairIndex = index.FindTemplate("Pair");
+    const index_t maxIndex = index.FindTemplate("Max");
+    TEST_CHECK(pairIndex != InvalidIndex && maxIndex != InvalidIndex);
+    TEST_CHECK(index.FindTemplate("Game") == InvalidIndex);
+    if (pairIndex == InvalidIndex || maxIndex == InvalidIndex)
+        return;
+
+    TEST_CHECK((index.GetTemplate(pairIndex).m_classIndices == std::vector<index_t>{0, 1}));
+    TEST_CHECK((index.GetTemplate(maxIndex).m_functionIndices == std::vector<index_t>{1, 2}));
+    TEST_CHECK(index.GetClassTemplateIndex(2) == InvalidIndex);
+    TEST_CHECK(index.GetFunctionTemplateIndex(0) == InvalidIndex);
+
+    // Arguments are interned, so swapped arguments share their ids.
+    const tcb::span<const index_t> arguments0 = index.GetClassArguments(0);
+    const tcb::span<const index_t> arguments1 = index.GetClassArguments(1);
+    TEST_CHECK(arguments0.size() == 2 && arguments1.size() == 2);
+    if (arguments0.size() == 2 && arguments1.size() == 2)
+    {
+        TEST_CHECK(arguments0[0] == arguments1[1] && arguments0[1] == arguments1[0]);
+        TEST_CHECK(index.GetArgumentName(arguments0[1]) == "char");
+    }
+
+    // Member functions of class instantiations count towards the class template.
+    const std::vector<uint64_t> codeSizes = index.ComputeCodeSizes(classes, functions);
+    TEST_CHECK(codeSizes[pairIndex] == 0x10 && codeSizes[maxIndex] == 0x60);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal test harness without dependencies. A failed check prints its location and the test continues.
+namespace Test
+{
+int &GetFailureCount();
+} // namespace Test
+
+#define TEST_CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++Test::GetFailureCount(); \
+        } \
+    } while (false)
+
+void TestClassHierarchy();
+void TestDataAddressIndex();
+void TestDemangler();
+void TestFunctionMatcher();
+void TestIncludeGraph();
+void TestIncludeTable();
+void TestLineTable();
+void TestModelFormat();
+void TestNameSearchIndex();
+void TestScopeTrie();
+void TestStabsParser();
+void TestTemplateIndex();
+void TestVirtualOverrideIndex();
+void TestX86Decoder();
+void TestX86ValueTracker();
@@ -0,0 +1,64 @@
+#include "Test.h"
+
+#include <cstring>
+
+namespace
+{
+struct TestCase
+{
+    const char *m_name;
+    void (*m_function)();
+};
+
+const TestCase TestCases[] = {
+    {"ClassHierarchy", TestClassHierarchy},
+    {"DataAddressIndex", TestDataAddressIndex},
+    {"Demangler", TestDemangler},
+    {"FunctionMatcher", TestFunctionMatcher},
+    {"IncludeGraph", TestIncludeGraph},
+    {"IncludeTable", TestIncludeTable},
+    {"LineTable", TestLineTable},
+    {"ModelFormat", TestModelFormat},
+    {"NameSearchIndex", TestNameSearchIndex},
+    {"ScopeTrie", TestScopeTrie},
+    {"StabsParser", TestStabsParser},
+    {"TemplateIndex", TestTemplateIndex},
+    {"VirtualOverrideIndex", TestVirtualOverrideIndex},
+    {"X86Decoder", TestX86Decoder},
+    {"X86ValueTracker", TestX86ValueTracker},
+};
+} // namespace
+
+int &Test::GetFailureCount()
+{
+    static int failureCount = 0;
+    return failureCount;
+}
+
+// Runs the named tests, or all tests if no name is given.
+int main(int argc, char **argv)
+{
+    bool found = argc < 2;
+    for (const TestCase &testCase : TestCases)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+        {
+            selected |= std::strcmp(argv[i], testCase.m_name) == 0;
+        }
+        if (!selected)
+            continue;
+
+        found = true;
+        const int failureCount = Test::GetFailureCount();
+        testCase.m_function();
+        std::printf("%s: %s\n", testCase.m_name, Test::GetFailureCount() == failureCount ? "passed" : "FAILED");
+    }
+
+    if (!found)
+    {
+        std::fprintf(stderr, "Unknown test\n");
+        return 1;
+    }
+    return Test::GetFailureCount() == 0 ? 0 : 1;
+}
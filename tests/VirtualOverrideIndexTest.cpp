@@ -0,0 +1,115 @@
+#include "Test.h"
+
+#include "VirtualOverrideIndex.h"
+
+#include <vector>
+
+namespace
+{
+BaseClass MakeBaseClass(index_t classIndex, uint16_t baseOffset)
+{
+    BaseClass baseClass;
+    baseClass.m_classIndex = classIndex;
+    baseClass.m_baseOffset = baseOffset;
+    return baseClass;
+}
+
+VTableEntry MakeEntry(index_t index, uint16_t flags)
+{
+    VTableEntry entry;
+    entry.m_index = index;
+    entry.m_flags = flags;
+    return entry;
+}
+
+void AddVTable(Class &classType, uint16_t offset, const std::vector<VTableEntry> &entries)
+{
+    VTable vtable;
+    vtable.m_entryBegin = static_cast<uint32_t>(classType.m_vtableEntries.size());
+    vtable.m_entryCount = static_cast<uint16_t>(entries.size());
+    vtable.m_offset = offset;
+    classType.m_vtables.push_back(vtable);
+    classType.m_vtableEntries.insert(classType.m_vtableEntries.end(), entries.begin(), entries.end());
+}
+
+VirtualOverrideIndex::Record MakeRecord(
+    index_t classIndex,
+    uint16_t entryIndex,
+    index_t declaringClassIndex,
+    uint16_t declaringEntryIndex,
+    index_t functionIndex)
+{
+    VirtualOverrideIndex::Record record;
+    record.m_declaringClassIndex = declaringClassIndex;
+    record.m_declaringEntryIndex = declaringEntryIndex;
+    record.m_entryIndex = entryIndex;
+    record.m_isImplicit = functionIndex == InvalidIndex;
+    record.m_override.m_classIndex = classIndex;
+    record.m_override.m_functionIndex = functionIndex;
+    return record;
+}
+} // namespace
+
+void TestVirtualOverrideIndex()
+{
+    // 0 Shape { Draw, Area }, 1 Mixin { Print }, 2 Circle : Shape, Mixin { Draw }, 3 Small : Circle { Draw, Area },
+    // 4 Other { Foo }, 5 X : Other, Circle { Draw }. The secondary vtables of Circle and Small override Print through
+    // thunks. The one of X overrides Draw, which is found through the primary vtable of Circle.
+    constexpr uint16_t Override = VTableEntry::Flag_Override;
+    constexpr uint16_t Thunk = VTableEntry::Flag_Override | VTableEntry::Flag_Thunk;
+    Classes classes(6);
+    AddVTable(classes[0], 0, {MakeEntry(0, 0), MakeEntry(1, 0)});
+    AddVTable(classes[1], 0, {MakeEntry(2, 0)});
+    classes[2].m_allBaseClasses = {MakeBaseClass(1, 4), MakeBaseClass(0, 0)};
+    AddVTable(classes[2], 0, {MakeEntry(3, Override), MakeEntry(1, VTableEntry::Flag_Implicit)});
+    AddVTable(classes[2], 4, {MakeEntry(0, Thunk)});
+    classes[3].m_allBaseClasses = {MakeBaseClass(1, 4), MakeBaseClass(0, 0), MakeBaseClass(2, 0)};
+    AddVTable(classes[3], 0, {MakeEntry(4, Override), MakeEntry(5, Override)});
+    AddVTable(classes[3], 4, {MakeEntry(1, Thunk)});
+    AddVTable(classes[4], 0, {MakeEntry(6, 0)});
+    classes[5].m_allBaseClasses = {MakeBaseClass(0, 8), MakeBaseClass(1, 12), MakeBaseClass(2, 8), MakeBaseClass(4, 0)};
+    AddVTable(classes[5], 0, {MakeEntry(6, VTableEntry::Flag_Implicit), MakeEntry(7, Override)});
+    AddVTable(classes[5], 8, {MakeEntry(2, Thunk), MakeEntry(1, VTableEntry::Flag_Implicit)});
+
+    std::vector<VirtualOverrideIndex::Record> records = {
+        MakeRecord(2, 0, 0, 0, 3),
+        MakeRecord(2, 1, 0, 1, InvalidIndex),
+        MakeRecord(3, 0, 0, 0, 4),
+        MakeRecord(3, 1, 0, 1, 5),
+        MakeRecord(5, 1, 0, 0, 7),
+    };
+
+    VirtualOverrideIndex index;
+    index.Build(classes, records);
+    TEST_CHECK(index.GetSlotCount() == 3);
+
+    // The primary and the secondary vtable of X both override Draw, which lists X once.
+    const tcb::span<const VirtualOverrideIndex::Override> drawOverrides = index.GetOverrides(0, 0);
+    TEST_CHECK(drawOverrides.size() == 3);
+    if (drawOverrides.size() == 3)
+    {
+        TEST_CHECK(drawOverrides[0].m_classIndex == 2 && drawOverrides[0].m_functionIndex == 3);
+        TEST_CHECK(drawOverrides[1].m_classIndex == 3 && drawOverrides[1].m_functionIndex == 4);
+        TEST_CHECK(drawOverrides[2].m_classIndex == 5);
+    }
+
+    // Implicit inheritance is not an override.
+    const tcb::span<const VirtualOverrideIndex::Override> areaOverrides = index.GetOverrides(0, 1);
+    TEST_CHECK(areaOverrides.size() == 1);
+    if (areaOverrides.size() == 1)
+    {
+        TEST_CHECK(areaOverrides[0].m_classIndex == 3 && areaOverrides[0].m_functionIndex == 5);
+    }
+
+    const tcb::span<const VirtualOverrideIndex::Override> printOverrides = index.GetOverrides(1, 0);
+    TEST_CHECK(printOverrides.size() == 2);
+    if (printOverrides.size() == 2)
+    {
+        TEST_CHECK(printOverrides[0].m_classIndex == 2 && printOverrides[0].m_thunkIndex == 0);
+        TEST_CHECK(printOverrides[1].m_classIndex == 3 && printOverrides[1].m_thunkIndex == 1);
+        TEST_CHECK(printOverrides[1].m_functionIndex == InvalidIndex);
+    }
+
+    TEST_CHECK(index.GetOverrides(4, 0).size() == 0);
+    TEST_CHECK(index.GetOverrides(2, 0).size() == 0);
+}
@@ -0,0 +1,66 @@
+#include "Test.h"
+
+#include "X86Decoder.h"
+
+#include <vector>
+
+namespace
+{
+struct LengthCase
+{
+    std::vector<uint8_t> m_code;
+    uint8_t m_length;
+};
+
+const LengthCase LengthCases[] = {
+    {{0x55}, 1}, // push ebp
+    {{0x89, 0xe5}, 2}, // mov ebp, esp
+    {{0x83, 0xec, 0x18}, 3}, // sub esp, 0x18
+    {{0x8b, 0x45, 0x08}, 3}, // mov eax, [ebp+8]
+    {{0x8b, 0x05, 0x00, 0x10, 0x00, 0x00}, 6}, // mov eax, [0x1000]
+    {{0x8b, 0x84, 0x24, 0x00, 0x01, 0x00, 0x00}, 7}, // mov eax, [esp+0x100]
+    {{0xc7, 0x44, 0x24, 0x04, 0x01, 0x00, 0x00, 0x00}, 8}, // mov dword [esp+4], 1
+    {{0x66, 0xc7, 0x40, 0x04, 0x34, 0x12}, 6}, // mov word [eax+4], 0x1234
+    {{0x0f, 0xb6, 0x45, 0x08}, 4}, // movzx eax, byte [ebp+8]
+    {{0xf6, 0xc1, 0x01}, 3}, // test cl, 1
+    {{0xf7, 0xc1, 0x01, 0x00, 0x00, 0x00}, 6}, // test ecx, 1
+    {{0x6b, 0xc0, 0x08}, 3}, // imul eax, eax, 8
+    {{0x69, 0xc0, 0x00, 0x01, 0x00, 0x00}, 6}, // imul eax, eax, 0x100
+    {{0xdd, 0x45, 0xf8}, 3}, // fld qword [ebp-8]
+    {{0xe8, 0x00, 0x00, 0x00, 0x00}, 5}, // call $+5
+    {{0x0f, 0x84, 0x10, 0x00, 0x00, 0x00}, 6}, // jz rel32
+    {{0x74, 0x10}, 2}, // jz rel8
+    {{0xc2, 0x04, 0x00}, 3}, // ret 4
+    {{0xc3}, 1}, // ret
+};
+} // namespace
+
+void TestX86Decoder()
+{
+    for (const LengthCase &lengthCase : LengthCases)
+    {
+        X86Instruction instruction;
+        const bool decoded = X86Decoder::Decode(lengthCase.m_code.data(), lengthCase.m_code.size(), instruction);
+        TEST_CHECK(decoded && instruction.m_length == lengthCase.m_length);
+
+        // The instruction must not be decoded from fewer bytes.
+        X86Instruction truncated;
+        TEST_CHECK(!X86Decoder::Decode(lengthCase.m_code.data(), lengthCase.m_code.size() - 1, truncated));
+    }
+
+    // mov dword [esp+4], 1
+    const uint8_t store[] = {0xc7, 0x44, 0x24, 0x04, 0x01, 0x00, 0x00, 0x00};
+    X86Instruction instruction;
+    TEST_CHECK(X86Decoder::Decode(store, sizeof(store), instruction));
+    TEST_CHECK(instruction.m_baseRegister == X86Register_Esp && instruction.m_indexRegister == X86Register_None);
+    TEST_CHECK(instruction.m_displacement == 4 && instruction.m_hasImmediate && instruction.m_immediate == 1);
+    TEST_CHECK(instruction.GetMemoryOperandSize() == 4);
+    TEST_CHECK(instruction.GetMemoryAccess() == X86Instruction::MemoryAccess_Write);
+
+    // lea eax, [ecx+edx*4+8] does not access memory.
+    const uint8_t lea[] = {0x8d, 0x44, 0x91, 0x08};
+    TEST_CHECK(X86Decoder::Decode(lea, sizeof(lea), instruction));
+    TEST_CHECK(instruction.m_length == 4 && instruction.m_baseRegister == X86Register_Ecx);
+    TEST_CHECK(instruction.m_indexRegister == X86Register_Edx && instruction.m_scale == 4);
+    TEST_CHECK(instruction.GetMemoryAccess() == X86Instruction::MemoryAccess_None);
+}
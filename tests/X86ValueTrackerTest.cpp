@@ -0,0 +1,116 @@
+#include "Test.h"
+
+#include "X86ValueTracker.h"
+
+#include <vector>
+
+namespace
+{
+bool Track(X86ValueTracker &tracker, const std::vector<uint8_t> &code, uint64_t address = 0x1000)
+{
+    X86Instruction instruction;
+    if (!X86Decoder::Decode(code.data(), code.size(), instruction) || instruction.m_length != code.size())
+        return false;
+
+    tracker.Track(instruction, address);
+    return true;
+}
+
+bool IsValue(const X86Value &value, X86Value::Kind kind, uint32_t constant = 0)
+{
+    return value.m_kind == kind && (kind != X86Value::Constant || value.m_value == constant);
+}
+
+struct ByteWriteCase
+{
+    std::vector<uint8_t> m_code;
+    uint8_t m_clearedRegisters; // Bit per register.
+};
+
+constexpr uint8_t Eax = 1 << X86Register_Eax;
+constexpr uint8_t Ecx = 1 << X86Register_Ecx;
+constexpr uint8_t Ebx = 1 << X86Register_Ebx;
+
+// Byte registers 4 to 7 are ah, ch, dh and bh. Writing them must not clear esp, ebp, esi or edi.
+const ByteWriteCase ByteWriteCases[] = {
+    {{0x00, 0xcc}, Eax}, // add ah, cl
+    {{0x02, 0x3b}, Ebx}, // add bh, [ebx]
+    {{0x8a, 0x39}, Ebx}, // mov bh, [ecx]
+    {{0x86, 0xfc}, Eax | Ebx}, // xchg ah, bh
+    {{0xc0, 0xe4, 0x03}, Eax}, // shl ah, 3
+    {{0xd0, 0xe7}, Ebx}, // shl bh, 1
+    {{0xd2, 0xe7}, Ebx}, // shl bh, cl
+    {{0xf6, 0xd4}, Eax}, // not ah
+    {{0xf6, 0xdf}, Ebx}, // neg bh
+    {{0xfe, 0xc5}, Ecx}, // inc ch
+    {{0xb5, 0x01}, Ecx}, // mov ch, 1
+    {{0x0f, 0x95, 0xc7}, Ebx}, // setne bh
+    {{0x0f, 0xb0, 0xe7}, Eax | Ebx}, // cmpxchg bh, ah
+    {{0x0f, 0xc0, 0xfc}, Eax | Ebx}, // xadd ah, bh
+};
+} // namespace
+
+void TestX86ValueTracker()
+{
+    const uint8_t trackedRegisters[] = {
+        X86Register_Eax, X86Register_Ecx, X86Register_Edx, X86Register_Ebx, X86Register_Esi, X86Register_Edi};
+
+    for (const ByteWriteCase &byteWriteCase : ByteWriteCases)
+    {
+        X86ValueTracker tracker;
+        tracker.Reset(true);
+        // mov r, [esp+4] loads this into all general registers but esp and ebp.
+        for (uint8_t reg : trackedRegisters)
+        {
+            TEST_CHECK(Track(tracker, {0x8b, static_cast<uint8_t>(0x44 | reg << 3), 0x24, 0x04}));
+        }
+
+        TEST_CHECK(Track(tracker, byteWriteCase.m_code));
+        for (uint8_t reg : trackedRegisters)
+        {
+            const bool isCleared = (byteWriteCase.m_clearedRegisters >> reg) & 1;
+            TEST_CHECK(IsValue(tracker.GetRegister(reg), isCleared ? X86Value::Unknown : X86Value::This));
+        }
+        // The stack pointer is still known, so the this argument is found.
+        TEST_CHECK(IsValue(tracker.GetArgument(1), X86Value::This));
+    }
+
+    // Constants from immediates and additions. Calls clobber the scratch registers.
+    X86ValueTracker tracker;
+    tracker.Reset(false);
+    TEST_CHECK(Track(tracker, {0xb8, 0x10, 0x00, 0x00, 0x00})); // mov eax, 0x10
+    TEST_CHECK(Track(tracker, {0x05, 0x08, 0x00, 0x00, 0x00})); // add eax, 8
+    TEST_CHECK(Track(tracker, {0x89, 0xc3})); // mov ebx, eax
+    TEST_CHECK(IsValue(tracker.GetRegister(X86Register_Eax), X86Value::Constant, 0x18));
+    TEST_CHECK(Track(tracker, {0xe8, 0x10, 0x00, 0x00, 0x00})); // call
+    TEST_CHECK(IsValue(tracker.GetRegister(X86Register_Eax), X86Value::Unknown));
+    TEST_CHECK(IsValue(tracker.GetRegister(X86Register_Ebx), X86Value::Constant, 0x18));
+
+    // call $+5 and pop load the address of the pop.
+    TEST_CHECK(Track(tracker, {0xe8, 0x00, 0x00, 0x00, 0x00}, 0x2000));
+    TEST_CHECK(Track(tracker, {0x5b}, 0x2005)); // pop ebx
+    TEST_CHECK(IsValue(tracker.GetRegister(X86Register_Ebx), X86Value::Constant, 0x2005));
+
+    // Stack slots through an ebp frame. this is at [ebp+8] after push ebp and mov ebp, esp.
+    tracker.Reset(true);
+    TEST_CHECK(Track(tracker, {0x55})); // push ebp
+    TEST_CHECK(Track(tracker, {0x89, 0xe5})); // mov ebp, esp
+    TEST_CHECK(Track(tracker, {0x83, 0xec, 0x18})); // sub esp, 0x18
+    TEST_CHECK(Track(tracker, {0x8b, 0x4d, 0x08})); // mov ecx, [ebp+8]
+    TEST_CHECK(IsValue(tracker.GetRegister(X86Register_Ecx), X86Value::This));
+    TEST_CHECK(Track(tracker, {0x89, 0x0c, 0x24})); // mov [esp], ecx
+    TEST_CHECK(IsValue(tracker.GetArgument(0), X86Value::This));
+    TEST_CHECK(Track(tracker, {0xc9})); // leave
+    TEST_CHECK(IsValue(tracker.GetArgument(1), X86Value::This));
+
+    // More pushes than stack slots evict locals and outgoing arguments, but never the incoming this argument.
+    tracker.Reset(true);
+    const uint8_t pushCount = 12;
+    for (uint8_t i = 0; i < pushCount; ++i)
+    {
+        TEST_CHECK(Track(tracker, {0x6a, i})); // push i
+    }
+    TEST_CHECK(IsValue(tracker.GetArgument(pushCount + 1), X86Value::This));
+    TEST_CHECK(IsValue(tracker.GetArgument(0), X86Value::Constant, pushCount - 1));
+    TEST_CHECK(IsValue(tracker.GetArgument(1), X86Value::Constant, pushCount - 2));
+}